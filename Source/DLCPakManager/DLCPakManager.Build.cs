@@ -19,8 +19,29 @@ public class DLCPakManager : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+                "AssetRegistry",
                 "ChunkDownloader",
+                "HTTP",
+                "Json",
             }
 			);
+
+		// Benchmarks, tests and CDN tools (see "DLC.Benchmark" console command and "UDLCPakToolsCommandlet")
+		// are compiled out of shipping builds together with HTTP server they use
+		bool bWithDLCPakTools = Target.Configuration != UnrealTargetConfiguration.Shipping;
+		if (bWithDLCPakTools)
+		{
+			PrivateDependencyModuleNames.Add("HTTPServer");
+		}
+
+		PrivateDefinitions.Add("WITH_DLC_PAK_TOOLS=" + (bWithDLCPakTools ? "1" : "0"));
+
+		// Awaitable API of "DLCPackageManagerCoroutines.h" and its benchmark need C++20 coroutines. They are compiled
+		// only if module is built with the latest standard of toolchain and toolchain supports coroutines
+		bool bWithDLCCoroutines = false;
+		if (bWithDLCCoroutines)
+		{
+			CppStandard = CppStandardVersion.Latest;
+		}
     }
 }
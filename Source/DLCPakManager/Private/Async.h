@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Async/Future.h"
+#include "Async/Async.h"
+#include "HAL/CriticalSection.h"
+#include "DLCPackageManagerTrace.h"
 
 namespace DLCPackageManagerPrivate
 {
@@ -10,8 +13,36 @@ namespace DLCPackageManagerPrivate
 	template<typename TValue>
 	TFuture<typename TRemoveReference<TValue>::Type> FilledFuture(const TValue& Value);
 
+	// Future of pooled ready state. It costs only reference counting instead of promise and state allocations
 	inline TFuture<void> FilledFuture();
 
+	// Future of pooled ready state with default value (for example, null pointer)
+	template<typename TValue>
+	TFuture<TValue> DefaultFilledFuture();
+
+	// - - - - - - - - - - - - -
+
+	// Ready shared state of future, made without promise. Ready state may be shared by any number of futures ("TFuture<>"
+	// is constructed from state): continuation of ready state is called at once instead of being stored, and results are only read
+	template<typename TValue>
+	TSharedRef<TFutureState<typename TDecay<TValue>::Type>, ESPMode::ThreadSafe> MakeReadyFutureState(TValue&& Value);
+
+	// State of "TFuture<void>" keeps dummy integer result
+	inline TSharedRef<TFutureState<int>, ESPMode::ThreadSafe> MakeReadyFutureState();
+
+	// Ready states of resolved values, so repeated requests of same value cost no allocations.
+	// Game thread only. Dropped state of value that is requested again is made again
+	template<typename TKey, typename TValue>
+	class TReadyFutureStates
+	{
+	public:
+		TFuture<TValue> MakeFuture(const TKey& Key, const TValue& Value);
+		void Reset() { States.Reset(); }
+
+	private:
+		TMap<TKey, TSharedRef<TFutureState<TValue>, ESPMode::ThreadSafe>> States;
+	};
+
 	// - - - - - - - - - - - - -
 	
 	template<typename ResultType>
@@ -23,6 +54,8 @@ namespace DLCPackageManagerPrivate
 	{
 		using FPromiseBase = TPromiseBase<int>;
 		using FPromiseBaseStateType = TSharedPtr<TFutureState<int>, ESPMode::ThreadSafe>;
+		//NB: Promise base is expected to keep only its state. Layout change would break the cast
+		static_assert(sizeof(FPromiseBase) == sizeof(FPromiseBaseStateType), "Unexpected layout of TPromiseBase<>");
 		FPromiseBase& PromiseBase = static_cast<FPromiseBase&>(Promise);
 		FPromiseBaseStateType& PromiseBaseState = reinterpret_cast<FPromiseBaseStateType&>(PromiseBase);
 		PromiseBaseState.Reset();
@@ -41,8 +74,27 @@ namespace DLCPackageManagerPrivate
 		~TPromiseWithWorkaroundedCanceling();
 	};
 
+	// - - - - - - - - - - - - -
+
+	// Calls continuation at once if future is ready. Otherwise continuation is called when future is fulfilled.
+	// Ready stages of pipelines cost no continuation future allocations
+	template<typename FunctionType>
+	void WhenReady(TFuture<void>&& Future, FunctionType&& Continuation);
+
+	// Calls continuation once when all futures are ready, at once if they are all ready or there are no futures.
+	// Futures are expected to be fulfilled on the game thread
+	template<typename FunctionType>
+	void WhenAllReady(TArray<TFuture<void>>&& Futures, FunctionType&& Continuation);
+
+	// Calls function on the game thread and forwards result of its future.
+	// Used by API that may be called from any thread while its state is changed only on the game thread
+	template<typename T>
+	TFuture<T> CallOnGameThread(TUniqueFunction<TFuture<T>()>&& Function);
+
 	//------------------------------------- TMultiPromise -----------------------------------------------
 	
+	// Promise with any number of futures. All methods may be called from any thread.
+	// Futures are fulfilled outside of the lock, so continuations may use the promise again
 	template<typename T>
 	class TMultiPromise
 	{
@@ -59,10 +111,13 @@ namespace DLCPackageManagerPrivate
 		~TMultiPromise();
 
 	private:
-		void Notify_ValueSet();
-		void CancelPromises();
+		void Notify_ValueSet(TArray<TPromise<TSharedPtr<T>>>&& PromisesToNotify, const TSharedPtr<T>& NewValue);
+		static void CancelPromises(TArray<TPromise<TSharedPtr<T>>>&& PromisesToCancel);
 
+		mutable FCriticalSection Mutex;
 		TSharedPtr<T> Value;
+		// Shared by futures that are made after value setting
+		TSharedPtr<TFutureState<TSharedPtr<T>>, ESPMode::ThreadSafe> ReadyState;
 		TArray<TPromise<TSharedPtr<T>>> WaitingPromises;
 	};
 
@@ -81,8 +136,7 @@ namespace DLCPackageManagerPrivate
 		~TMultiPromise();
 
 	private:
-		void Notify_ValueSet();
-
+		mutable FCriticalSection Mutex;
 		bool bIsSet = false;
 		TArray<TPromise<void>> WaitingPromises;
 	};
@@ -4,24 +4,59 @@ namespace DLCPackageManagerPrivate
 	template<typename TValue>
 	TFuture<typename TRemoveReference<TValue>::Type> FilledFuture(TValue&& Value)
 	{
-		TPromise<typename TRemoveReference<TValue>::Type> DummyPromise;
-		DummyPromise.EmplaceValue(Value);
-		return DummyPromise.GetFuture();
+		return TFuture<typename TRemoveReference<TValue>::Type>{ MakeReadyFutureState(Forward<TValue>(Value)) };
 	}
 
 	template<typename TValue>
 	TFuture<typename TRemoveReference<TValue>::Type> FilledFuture(const TValue& Value)
 	{
-		TPromise<typename TRemoveReference<TValue>::Type> DummyPromise;
-		DummyPromise.SetValue(Value);
-		return DummyPromise.GetFuture();
+		return TFuture<typename TRemoveReference<TValue>::Type>{ MakeReadyFutureState(Value) };
 	}
 
 	inline TFuture<void> FilledFuture()
 	{
-		TPromise<void> DummyPromise;
-		DummyPromise.EmplaceValue();
-		return DummyPromise.GetFuture();
+		static const TSharedRef<TFutureState<int>, ESPMode::ThreadSafe> ReadyState = MakeReadyFutureState();
+
+		return TFuture<void>{ ReadyState };
+	}
+
+	template<typename TValue>
+	TFuture<TValue> DefaultFilledFuture()
+	{
+		static const TSharedRef<TFutureState<TValue>, ESPMode::ThreadSafe> ReadyState = MakeReadyFutureState(TValue{ });
+
+		return TFuture<TValue>{ ReadyState };
+	}
+
+	template<typename TValue>
+	TSharedRef<TFutureState<typename TDecay<TValue>::Type>, ESPMode::ThreadSafe> MakeReadyFutureState(TValue&& Value)
+	{
+		const TSharedRef<TFutureState<typename TDecay<TValue>::Type>, ESPMode::ThreadSafe> State = MakeShared<TFutureState<typename TDecay<TValue>::Type>, ESPMode::ThreadSafe>();
+		State->EmplaceResult(Forward<TValue>(Value));
+		return State;
+	}
+
+	inline TSharedRef<TFutureState<int>, ESPMode::ThreadSafe> MakeReadyFutureState()
+	{
+		return MakeReadyFutureState(0);
+	}
+
+	template<typename TKey, typename TValue>
+	TFuture<TValue> TReadyFutureStates<TKey, TValue>::MakeFuture(const TKey& Key, const TValue& Value)
+	{
+		check(IsInGameThread());
+
+		if (const TSharedRef<TFutureState<TValue>, ESPMode::ThreadSafe>* State = States.Find(Key))
+		{
+			//NB: Value of key may be changed, for example, object may be loaded again after garbage collection
+			if ((*State)->GetResult() == Value)
+				return TFuture<TValue>{ *State };
+		}
+
+		const TSharedRef<TFutureState<TValue>, ESPMode::ThreadSafe> NewState = MakeReadyFutureState(Value);
+		States.Add(Key, NewState);
+
+		return TFuture<TValue>{ NewState };
 	}
 
 	template<typename ResultType>
@@ -29,6 +64,8 @@ namespace DLCPackageManagerPrivate
 	{
 		using FPromiseBase = TPromiseBase<ResultType>;
 		using FPromiseBaseStateType = TSharedPtr<TFutureState<ResultType>, ESPMode::ThreadSafe>;
+		//NB: Promise base is expected to keep only its state. Layout change would break the cast
+		static_assert(sizeof(FPromiseBase) == sizeof(FPromiseBaseStateType), "Unexpected layout of TPromiseBase<>");
 		FPromiseBase& PromiseBase = static_cast<FPromiseBase&>(Promise);
 		FPromiseBaseStateType& PromiseBaseState = reinterpret_cast<FPromiseBaseStateType&>(PromiseBase);
 		PromiseBaseState.Reset();
@@ -42,97 +79,196 @@ namespace DLCPackageManagerPrivate
 		CancelPromiseWorkaround(*this);
 	}
 	
+	template<typename FunctionType>
+	void WhenReady(TFuture<void>&& Future, FunctionType&& Continuation)
+	{
+		if (Future.IsReady())
+		{
+			Continuation();
+			return;
+		}
+
+		Future.Next([Continuation = Forward<FunctionType>(Continuation)](int32) mutable
+		{
+			Continuation();
+		});
+	}
+
+	template<typename FunctionType>
+	void WhenAllReady(TArray<TFuture<void>>&& Futures, FunctionType&& Continuation)
+	{
+		if (Futures.Num() == 0)
+		{
+			Continuation();
+			return;
+		}
+
+		struct FState
+		{
+			int32 PendingFuturesNum;
+			typename TDecay<FunctionType>::Type Continuation;
+		};
+
+		const TSharedRef<FState> State = MakeShareable(new FState{ Futures.Num(), Forward<FunctionType>(Continuation) });
+
+		for (TFuture<void>& Future : Futures)
+		{
+			WhenReady(MoveTemp(Future), [State]()
+			{
+				if (--State->PendingFuturesNum == 0)
+				{
+					State->Continuation();
+				}
+			});
+		}
+	}
+
+	template<typename T>
+	TFuture<T> CallOnGameThread(TUniqueFunction<TFuture<T>()>&& Function)
+	{
+		if (IsInGameThread())
+			return Function();
+
+		auto Promise = MakeShared<TPromiseWithWorkaroundedCanceling<T>, ESPMode::ThreadSafe>();
+		TFuture<T> Future = Promise->GetFuture();
+
+		AsyncTask(ENamedThreads::GameThread, [Promise, Function = MoveTemp(Function)]()
+		{
+			Function().Next([Promise](T Result)
+			{
+				Promise->EmplaceValue(MoveTemp(Result));
+			});
+		});
+
+		return Future;
+	}
+
 	// - - - - TMultiPromise<Type> - - - -
 
 	template<typename T>
 	void TMultiPromise<T>::SetValue(const T& InValue)
 	{
-		checkf(!Value.IsValid(), TEXT("Cannot setup promise twice"));
-		Value = MakeShared<T>(InValue);
-		Notify_ValueSet();
+		EmplaceValue(T{ InValue });
 	}
 
 	template<typename T>
 	void TMultiPromise<T>::EmplaceValue(T&& InValue)
 	{
-		checkf(!Value.IsValid(), TEXT("Cannot setup promise twice"));
-		Value = MakeShared<T>(MoveTemp(InValue));
-		Notify_ValueSet();
+		TSharedPtr<T> NewValue = MakeShared<T>(MoveTemp(InValue));
+		TSharedPtr<TFutureState<TSharedPtr<T>>, ESPMode::ThreadSafe> NewReadyState = MakeReadyFutureState(NewValue);
+
+		TArray<TPromise<TSharedPtr<T>>> PromisesToNotify;
+		{
+			FScopeLock Lock{ &Mutex };
+
+			checkf(!Value.IsValid(), TEXT("Cannot setup promise twice"));
+			Value = NewValue;
+			ReadyState = MoveTemp(NewReadyState);
+			PromisesToNotify = MoveTemp(WaitingPromises);
+		}
+
+		Notify_ValueSet(MoveTemp(PromisesToNotify), NewValue);
 	}
 
 	template<typename T>
 	TFuture<TSharedPtr<T>> TMultiPromise<T>::MakeFuture()
 	{
-		return Value.IsValid() ?
-			FilledFuture<TSharedPtr<T>>(Value) :
-			WaitingPromises[WaitingPromises.Emplace()].GetFuture();
+		FScopeLock Lock{ &Mutex };
+
+		if (ReadyState.IsValid())
+			return TFuture<TSharedPtr<T>>{ ReadyState };
+
+		TRACE_COUNTER_INCREMENT(DLCWaitingPromises);
+		return WaitingPromises[WaitingPromises.Emplace()].GetFuture();
 	}
 
 	template<typename T>
 	bool TMultiPromise<T>::IsSet() const
 	{
+		FScopeLock Lock{ &Mutex };
 		return Value.IsValid();
 	}
 
 	template<typename T>
 	void TMultiPromise<T>::Reset()
 	{
-		Value.Reset();
-		CancelPromises();
+		TArray<TPromise<TSharedPtr<T>>> PromisesToCancel;
+		{
+			FScopeLock Lock{ &Mutex };
+
+			Value.Reset();
+			ReadyState.Reset();
+			PromisesToCancel = MoveTemp(WaitingPromises);
+		}
+
+		CancelPromises(MoveTemp(PromisesToCancel));
 	}
 
 	template<typename T>
 	TMultiPromise<T>::~TMultiPromise()
 	{
-		CancelPromises();
+		CancelPromises(MoveTemp(WaitingPromises));
 	}
 
 	template<typename T>
-	void TMultiPromise<T>::Notify_ValueSet()
+	void TMultiPromise<T>::Notify_ValueSet(TArray<TPromise<TSharedPtr<T>>>&& PromisesToNotify, const TSharedPtr<T>& NewValue)
 	{
-		for (TPromise<TSharedPtr<T>>& WaitingPromise : WaitingPromises)
-			WaitingPromise.SetValue(Value);
+		TRACE_COUNTER_SUBTRACT(DLCWaitingPromises, PromisesToNotify.Num());
 
-		WaitingPromises.Empty();
+		for (TPromise<TSharedPtr<T>>& WaitingPromise : PromisesToNotify)
+			WaitingPromise.SetValue(NewValue);
 	}
 
 	template<typename T>
-	void TMultiPromise<T>::CancelPromises()
+	void TMultiPromise<T>::CancelPromises(TArray<TPromise<TSharedPtr<T>>>&& PromisesToCancel)
 	{
-		for (TPromise<TSharedPtr<T>>& WaitingPromise : WaitingPromises)
+		TRACE_COUNTER_SUBTRACT(DLCWaitingPromises, PromisesToCancel.Num());
+
+		for (TPromise<TSharedPtr<T>>& WaitingPromise : PromisesToCancel)
 			CancelPromiseWorkaround(WaitingPromise);
 	}
 
 	// - - - - TMultiPromise<void> - - - -
 
-	void TMultiPromise<void>::SetValue()
+	inline void TMultiPromise<void>::SetValue()
 	{
-		checkf(!bIsSet, TEXT("Cannot setup promise twice"));
-		bIsSet = true;
-		Notify_ValueSet();
+		TArray<TPromise<void>> PromisesToNotify;
+		{
+			FScopeLock Lock{ &Mutex };
+
+			checkf(!bIsSet, TEXT("Cannot setup promise twice"));
+			bIsSet = true;
+			PromisesToNotify = MoveTemp(WaitingPromises);
+		}
+
+		TRACE_COUNTER_SUBTRACT(DLCWaitingPromises, PromisesToNotify.Num());
+
+		for (TPromise<void>& WaitingPromise : PromisesToNotify)
+			WaitingPromise.SetValue();
 	}
 
-	TFuture<void> TMultiPromise<void>::MakeFuture()
+	inline TFuture<void> TMultiPromise<void>::MakeFuture()
 	{
-		return bIsSet ? FilledFuture() : WaitingPromises[WaitingPromises.Emplace()].GetFuture();
+		FScopeLock Lock{ &Mutex };
+
+		if (bIsSet)
+			return FilledFuture();
+
+		TRACE_COUNTER_INCREMENT(DLCWaitingPromises);
+		return WaitingPromises[WaitingPromises.Emplace()].GetFuture();
 	}
 
-	bool TMultiPromise<void>::IsSet() const
+	inline bool TMultiPromise<void>::IsSet() const
 	{
+		FScopeLock Lock{ &Mutex };
 		return bIsSet;
 	}
 
-	TMultiPromise<void>::~TMultiPromise()
+	inline TMultiPromise<void>::~TMultiPromise()
 	{
-		for (TPromise<void>& WaitingPromise : WaitingPromises)
-			CancelPromiseWorkaround(WaitingPromise);
-	}
+		TRACE_COUNTER_SUBTRACT(DLCWaitingPromises, WaitingPromises.Num());
 
-	void TMultiPromise<void>::Notify_ValueSet()
-	{
 		for (TPromise<void>& WaitingPromise : WaitingPromises)
-			WaitingPromise.SetValue();
-
-		WaitingPromises.Empty();
+			CancelPromiseWorkaround(WaitingPromise);
 	}
-}
\ No newline at end of file
+}
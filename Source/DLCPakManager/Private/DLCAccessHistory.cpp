@@ -0,0 +1,246 @@
+#include "DLCAccessHistory.h"
+
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "Misc/DefaultValueHelper.h"
+
+namespace DLCPackageManagerPrivate
+{
+	FDLCAccessHistory::~FDLCAccessHistory()
+	{
+		if (SavingFuture.IsValid())
+		{
+			SavingFuture.Wait();
+		}
+	}
+
+	void FDLCAccessHistory::RecordAccess(const FName& PackageName)
+	{
+		LastAccessTimes.FindOrAdd(PackageName) = FDateTime::UtcNow();
+		TrimLastAccessTimes(PackageName);
+
+		// Repeated request of same package gives no information about order
+		if (RecentAccesses.Num() > 0 && RecentAccesses.Last() == PackageName)
+		{
+			++UnsavedAccessesNum;
+			return;
+		}
+
+		for (int32 Distance = 1; Distance <= RecentAccesses.Num(); ++Distance)
+		{
+			const FName& PreviousPackageName = RecentAccesses[RecentAccesses.Num() - Distance];
+			if (PreviousPackageName == PackageName)
+				continue;
+
+			const float Weight = 1.f / Distance;
+
+			FSuccessors& Successors = PackagesSuccessors.FindOrAdd(PreviousPackageName);
+			Successors.Weights.FindOrAdd(PackageName) += Weight;
+			Successors.TotalWeight += Weight;
+
+			TrimSuccessors(Successors, PackageName);
+			TrimPackages(PreviousPackageName);
+		}
+
+		RecentAccesses.Add(PackageName);
+		if (RecentAccesses.Num() > SuccessorsWindowSize)
+		{
+			RecentAccesses.RemoveAt(0);
+		}
+
+		++UnsavedAccessesNum;
+	}
+
+	TArray<FDLCAccessHistory::FPrediction> FDLCAccessHistory::PredictSuccessors(const FName& PackageName, const int32 MaxPredictionsNum, const float MinProbability) const
+	{
+		TArray<FPrediction> Result;
+
+		const FSuccessors* Successors = PackagesSuccessors.Find(PackageName);
+		if (!Successors || Successors->TotalWeight <= 0.f)
+			return Result;
+
+		for (const TPair<FName, float>& SuccessorWeight : Successors->Weights)
+		{
+			const float Probability = SuccessorWeight.Value / Successors->TotalWeight;
+			if (Probability >= MinProbability)
+			{
+				Result.Add(FPrediction{ SuccessorWeight.Key, Probability });
+			}
+		}
+
+		Result.Sort([](const FPrediction& A, const FPrediction& B) { return A.Probability > B.Probability; });
+
+		if (Result.Num() > MaxPredictionsNum)
+		{
+			Result.SetNum(MaxPredictionsNum);
+		}
+
+		return Result;
+	}
+
+	FDateTime FDLCAccessHistory::GetLastAccessTime(const FName& PackageName) const
+	{
+		const FDateTime* LastAccessTime = LastAccessTimes.Find(PackageName);
+		return LastAccessTime ? *LastAccessTime : FDateTime::MinValue();
+	}
+
+	bool FDLCAccessHistory::LoadFromFile(const FString& FilePath)
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath))
+			return false;
+
+		PackagesSuccessors.Reset();
+		LastAccessTimes.Reset();
+
+		TArray<FString> LineElements;
+		for (const FString& Line : Lines)
+		{
+			Line.ParseIntoArrayWS(LineElements);
+
+			//NB: History saved before access times were recorded has no such lines, so its packages are least recently used
+			int64 AccessTicks = 0;
+			if (LineElements.Num() == 2 && FDefaultValueHelper::ParseInt64(LineElements[1], AccessTicks) && AccessTicks >= 0)
+			{
+				const FName PackageName{ *LineElements[0] };
+				LastAccessTimes.Add(PackageName, FDateTime{ AccessTicks });
+				TrimLastAccessTimes(PackageName);
+				continue;
+			}
+
+			float Weight = 0.f;
+			if (LineElements.Num() != 3 || !FDefaultValueHelper::ParseFloat(LineElements[2], Weight))
+				continue;
+
+			const FName PackageName{ *LineElements[0] };
+			const FName SuccessorName{ *LineElements[1] };
+
+			FSuccessors& Successors = PackagesSuccessors.FindOrAdd(PackageName);
+			Successors.Weights.FindOrAdd(SuccessorName) += Weight;
+			Successors.TotalWeight += Weight;
+
+			//NB: History saved before limits were introduced may be larger
+			TrimSuccessors(Successors, SuccessorName);
+			TrimPackages(PackageName);
+		}
+
+		UnsavedAccessesNum = 0;
+		return true;
+	}
+
+	bool FDLCAccessHistory::SaveToFile(const FString& FilePath) const
+	{
+		// Older history of asynchronous saving should not overwrite newer one
+		if (SavingFuture.IsValid())
+		{
+			SavingFuture.Wait();
+		}
+
+		const bool bSaved = SaveToFile(FilePath, PackagesSuccessors, LastAccessTimes);
+		if (bSaved)
+		{
+			UnsavedAccessesNum = 0;
+		}
+
+		return bSaved;
+	}
+
+	void FDLCAccessHistory::SaveToFileAsync(const FString& FilePath)
+	{
+		if (SavingFuture.IsValid() && !SavingFuture.IsReady())
+			return;
+
+		//NB: Copy of history is cheaper than formatting of its lines, so only copying is done on the game thread
+		SavingFuture = Async(EAsyncExecution::ThreadPool, [FilePath, PackagesSuccessorsCopy = PackagesSuccessors, LastAccessTimesCopy = LastAccessTimes]()
+		{
+			return SaveToFile(FilePath, PackagesSuccessorsCopy, LastAccessTimesCopy);
+		});
+
+		UnsavedAccessesNum = 0;
+	}
+
+	void FDLCAccessHistory::TrimSuccessors(FSuccessors& Successors, const FName& KeptSuccessorName)
+	{
+		if (Successors.Weights.Num() <= MaxSuccessorsNum)
+			return;
+
+		const TPair<FName, float>* LeastSuccessorWeight = nullptr;
+		for (const TPair<FName, float>& SuccessorWeight : Successors.Weights)
+		{
+			if (SuccessorWeight.Key != KeptSuccessorName && (!LeastSuccessorWeight || SuccessorWeight.Value < LeastSuccessorWeight->Value))
+			{
+				LeastSuccessorWeight = &SuccessorWeight;
+			}
+		}
+
+		if (LeastSuccessorWeight)
+		{
+			Successors.TotalWeight -= LeastSuccessorWeight->Value;
+			Successors.Weights.Remove(FName{ LeastSuccessorWeight->Key });
+		}
+	}
+
+	void FDLCAccessHistory::TrimPackages(const FName& KeptPackageName)
+	{
+		if (PackagesSuccessors.Num() <= MaxPackagesNum)
+			return;
+
+		const FName* LeastPackageName = nullptr;
+		float LeastTotalWeight = 0.f;
+		for (const TPair<FName, FSuccessors>& PackageSuccessors : PackagesSuccessors)
+		{
+			if (PackageSuccessors.Key != KeptPackageName && (!LeastPackageName || PackageSuccessors.Value.TotalWeight < LeastTotalWeight))
+			{
+				LeastPackageName = &PackageSuccessors.Key;
+				LeastTotalWeight = PackageSuccessors.Value.TotalWeight;
+			}
+		}
+
+		if (LeastPackageName)
+		{
+			PackagesSuccessors.Remove(FName{ *LeastPackageName });
+		}
+	}
+
+	void FDLCAccessHistory::TrimLastAccessTimes(const FName& KeptPackageName)
+	{
+		if (LastAccessTimes.Num() <= MaxPackagesNum)
+			return;
+
+		const FName* OldestPackageName = nullptr;
+		FDateTime OldestAccessTime = FDateTime::MaxValue();
+		for (const TPair<FName, FDateTime>& LastAccessTime : LastAccessTimes)
+		{
+			if (LastAccessTime.Key != KeptPackageName && (!OldestPackageName || LastAccessTime.Value < OldestAccessTime))
+			{
+				OldestPackageName = &LastAccessTime.Key;
+				OldestAccessTime = LastAccessTime.Value;
+			}
+		}
+
+		if (OldestPackageName)
+		{
+			LastAccessTimes.Remove(FName{ *OldestPackageName });
+		}
+	}
+
+	bool FDLCAccessHistory::SaveToFile(const FString& FilePath, const TMap<FName, FSuccessors>& InPackagesSuccessors, const TMap<FName, FDateTime>& InLastAccessTimes)
+	{
+		TArray<FString> Lines;
+		for (const TPair<FName, FSuccessors>& PackageSuccessors : InPackagesSuccessors)
+		{
+			for (const TPair<FName, float>& SuccessorWeight : PackageSuccessors.Value.Weights)
+			{
+				Lines.Add(FString::Printf(TEXT("%s %s %f"),
+					*PackageSuccessors.Key.ToString(), *SuccessorWeight.Key.ToString(), SuccessorWeight.Value));
+			}
+		}
+
+		for (const TPair<FName, FDateTime>& LastAccessTime : InLastAccessTimes)
+		{
+			Lines.Add(FString::Printf(TEXT("%s %lld"), *LastAccessTime.Key.ToString(), LastAccessTime.Value.GetTicks()));
+		}
+
+		return FFileHelper::SaveStringArrayToFile(Lines, *FilePath);
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+namespace DLCPackageManagerPrivate
+{
+	// Records order of DLC package requests and learns which packages are requested after each other.
+	// Packages requested within few steps after a package are counted as its successors with weight
+	// that decreases with distance, so both sequence and co-occurrence patterns are learned.
+	// Time of the latest request of every package is recorded too, so least recently used packages are known across sessions.
+	// History is bounded: packages and successors with the least weight and the oldest access times are forgotten over the limits
+	class FDLCAccessHistory
+	{
+	public:
+		struct FPrediction
+		{
+			FName PackageName;
+			float Probability;
+		};
+
+		static constexpr int32 SuccessorsWindowSize = 3;
+		static constexpr int32 MaxPackagesNum = 4096;
+		static constexpr int32 MaxSuccessorsNum = 16;
+
+		~FDLCAccessHistory();
+
+		void RecordAccess(const FName& PackageName);
+
+		// Most probable successors of the package sorted by probability
+		TArray<FPrediction> PredictSuccessors(const FName& PackageName, const int32 MaxPredictionsNum, const float MinProbability) const;
+
+		// UTC time of the latest request of the package in this or previous sessions. "FDateTime::MinValue()" if package was not requested
+		FDateTime GetLastAccessTime(const FName& PackageName) const;
+
+		// File format: line per successor, "<Package> <Successor> <Weight>", and line per package access time, "<Package> <UTC ticks>"
+		bool LoadFromFile(const FString& FilePath);
+		bool SaveToFile(const FString& FilePath) const;
+		// History is copied and written on worker thread. Saving is skipped while previous one is in progress:
+		// unsaved changes are kept, so they are saved next time
+		void SaveToFileAsync(const FString& FilePath);
+
+		bool HasUnsavedChanges() const { return UnsavedAccessesNum > 0; }
+		int32 GetUnsavedAccessesNum() const { return UnsavedAccessesNum; }
+
+	private:
+		struct FSuccessors
+		{
+			float TotalWeight = 0.f;
+			TMap<FName, float> Weights;
+		};
+
+		// Forgets successor with the least weight except "KeptSuccessorName" if there are too many of them
+		static void TrimSuccessors(FSuccessors& Successors, const FName& KeptSuccessorName);
+		// Forgets package with the least total weight except "KeptPackageName" if there are too many of them
+		void TrimPackages(const FName& KeptPackageName);
+		// Forgets the oldest access time except one of "KeptPackageName" if there are too many of them
+		void TrimLastAccessTimes(const FName& KeptPackageName);
+
+		static bool SaveToFile(const FString& FilePath, const TMap<FName, FSuccessors>& InPackagesSuccessors, const TMap<FName, FDateTime>& InLastAccessTimes);
+
+		TMap<FName, FSuccessors> PackagesSuccessors;
+		TMap<FName, FDateTime> LastAccessTimes;
+
+		// Latest accessed packages of current session, from oldest to newest
+		TArray<FName> RecentAccesses;
+
+		mutable int32 UnsavedAccessesNum = 0;
+		TFuture<bool> SavingFuture;
+	};
+}
@@ -0,0 +1,1804 @@
+#include "DLCBenchmark.h"
+#include "DLCPackageManager.h"
+#include "DLCPackageManagerCoroutines.h"
+#include "DLCPackageManager_Debug.h"
+#include "DLCPackageManager_Private.h"
+#include "DLCLatentActions.h"
+#include "DLCDownloadScheduler.h"
+#include "DLCMountScheduler.h"
+#include "PrivateHacking_ChunkDownloader.h"
+#include "Version.h"
+#include "Async.h"
+
+#include "ChunkDownloader.h"
+#include "Algo/MaxElement.h"
+#include "Async/Async.h"
+#include "Containers/LruCache.h"
+#include "Containers/Ticker.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DefaultValueHelper.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Math/RandomStream.h"
+#include "UObject/UObjectGlobals.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+
+#if WITH_DLC_PAK_TOOLS
+
+namespace DLCPackageManagerPrivate
+{
+	namespace
+	{
+		// Proxy of global allocator. Allocations of game thread are counted, every call is forwarded to wrapped allocator
+		class FCountingMalloc final : public FMalloc
+		{
+		public:
+			explicit FCountingMalloc(FMalloc* InWrappedMalloc)
+				: WrappedMalloc(InWrappedMalloc) { }
+
+			uint64 GetGameThreadAllocationsNum() const { return GameThreadAllocationsNum; }
+
+			virtual void* Malloc(SIZE_T Count, uint32 Alignment) override { CountAllocation(); return WrappedMalloc->Malloc(Count, Alignment); }
+			virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override { CountAllocation(); return WrappedMalloc->TryMalloc(Count, Alignment); }
+			virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override { CountAllocation(); return WrappedMalloc->Realloc(Original, Count, Alignment); }
+			virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override { CountAllocation(); return WrappedMalloc->TryRealloc(Original, Count, Alignment); }
+			virtual void Free(void* Original) override { WrappedMalloc->Free(Original); }
+
+			virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return WrappedMalloc->QuantizeSize(Count, Alignment); }
+			virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return WrappedMalloc->GetAllocationSize(Original, SizeOut); }
+			virtual void Trim(bool bTrimThreadCaches) override { WrappedMalloc->Trim(bTrimThreadCaches); }
+			virtual void SetupTLSCachesOnCurrentThread() override { WrappedMalloc->SetupTLSCachesOnCurrentThread(); }
+			virtual void ClearAndDisableTLSCachesOnCurrentThread() override { WrappedMalloc->ClearAndDisableTLSCachesOnCurrentThread(); }
+			virtual void InitializeStatsMetadata() override { WrappedMalloc->InitializeStatsMetadata(); }
+			virtual void UpdateStats() override { WrappedMalloc->UpdateStats(); }
+			virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { WrappedMalloc->GetAllocatorStats(OutStats); }
+			virtual void DumpAllocatorStats(FOutputDevice& Ar) override { WrappedMalloc->DumpAllocatorStats(Ar); }
+			virtual bool IsInternallyThreadSafe() const override { return WrappedMalloc->IsInternallyThreadSafe(); }
+			virtual bool ValidateHeap() override { return WrappedMalloc->ValidateHeap(); }
+			virtual const TCHAR* GetDescriptiveName() override { return WrappedMalloc->GetDescriptiveName(); }
+
+		private:
+			void CountAllocation()
+			{
+				//NB: Only game thread writes counter, so it is not atomic
+				if (IsInGameThread())
+				{
+					++GameThreadAllocationsNum;
+				}
+			}
+
+			FMalloc* const WrappedMalloc;
+			uint64 GameThreadAllocationsNum = 0;
+		};
+
+		FCountingMalloc& GetCountingMalloc()
+		{
+			check(IsInGameThread());
+
+			//NB: Proxy is never destroyed and never unwrapped, because blocks may be freed through it after counting is finished
+			static FCountingMalloc* CountingMalloc = nullptr;
+			if (CountingMalloc == nullptr)
+			{
+				CountingMalloc = new(FMemory::Malloc(sizeof(FCountingMalloc), alignof(FCountingMalloc))) FCountingMalloc{ GMalloc };
+				GMalloc = CountingMalloc;
+			}
+
+			return *CountingMalloc;
+		}
+
+		// - - - - - - - - - - - - -
+
+		// Shared ready states of resolved objects are compared with ready future allocated per call. Object is loaded
+		// once before measurements and every acquisition of measured calls is released after them
+		void RunResolvedPathBenchmarkCommand(const TArray<FString>& Args)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+
+			FString InstanceName = FDLCPackageManager::DefaultInstanceName.ToString();
+			FParse::Value(*ParamsString, TEXT("Instance="), InstanceName);
+
+			const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ FName{ *InstanceName } };
+
+			FString Path;
+			int32 IterationsNum = 100000;
+			FParse::Value(*ParamsString, TEXT("Iterations="), IterationsNum);
+			if (!FParse::Value(*ParamsString, TEXT("Path="), Path) || IterationsNum <= 0)
+			{
+				DLC_LOG(Logging, Error, TEXT("Path= is not passed or invalid iterations number [%d]"), IterationsNum);
+				return;
+			}
+
+			const FSoftObjectPtr SoftObjectPtr{ FSoftObjectPath{ Path } };
+			FDLCPackageManager::Get(FName{ *InstanceName }).GetLoadedPath(SoftObjectPtr).Next([InstanceName, SoftObjectPtr, IterationsNum](UObject* LoadedObject)
+			{
+				const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ FName{ *InstanceName } };
+
+				if (LoadedObject == nullptr)
+				{
+					DLC_LOG(Logging, Error, TEXT("Cannot load [%s]"), *SoftObjectPtr.ToString());
+					return;
+				}
+
+				FDLCPackageManager& PackageManager = FDLCPackageManager::Get(FName{ *InstanceName });
+
+				double SharedStateSeconds = 0.0;
+				uint64 SharedStateAllocationsNum = 0;
+				{
+					const FDLCAllocationsCounter AllocationsCounter;
+					const double StartSeconds = FPlatformTime::Seconds();
+					for (int32 Index = 0; Index < IterationsNum; ++Index)
+					{
+						PackageManager.GetLoadedPath(SoftObjectPtr);
+					}
+					SharedStateSeconds = FPlatformTime::Seconds() - StartSeconds;
+					SharedStateAllocationsNum = AllocationsCounter.GetAllocationsNum();
+				}
+
+				double PerCallStateSeconds = 0.0;
+				uint64 PerCallStateAllocationsNum = 0;
+				{
+					const FDLCAllocationsCounter AllocationsCounter;
+					const double StartSeconds = FPlatformTime::Seconds();
+					for (int32 Index = 0; Index < IterationsNum; ++Index)
+					{
+						FilledFuture<UObject*>(SoftObjectPtr.Get());
+					}
+					PerCallStateSeconds = FPlatformTime::Seconds() - StartSeconds;
+					PerCallStateAllocationsNum = AllocationsCounter.GetAllocationsNum();
+				}
+
+				// Measured calls and initial loading
+				for (int32 Index = 0; Index <= IterationsNum; ++Index)
+				{
+					PackageManager.ReleaseLoadedPath(SoftObjectPtr);
+				}
+
+				DLC_LOG(Logging, StatusImportant, TEXT("Resolved path [%s], [%d] iterations. GetLoadedPath: [%.1f] ns and [%.2f] allocations per call. Future allocated per call: [%.1f] ns and [%.2f] allocations per call"),
+					*SoftObjectPtr.ToString(), IterationsNum,
+					SharedStateSeconds * 1e9 / IterationsNum, static_cast<double>(SharedStateAllocationsNum) / IterationsNum,
+					PerCallStateSeconds * 1e9 / IterationsNum, static_cast<double>(PerCallStateAllocationsNum) / IterationsNum);
+			});
+		}
+
+		FAutoConsoleCommand DLCResolvedPathBenchmarkCommand(
+			TEXT("DLC.Benchmark.ResolvedPath"),
+			TEXT("Measures time and game thread allocations of loading of already loaded object. Usage: DLC.Benchmark.ResolvedPath Instance=<name> Path=<soft object path> [Iterations=<number>]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunResolvedPathBenchmarkCommand));
+
+		// - - - - - - - - - - - - -
+
+		// Cache of resolved paths as it was made before: dropped completely on overflow
+		class FResettingPathsCache
+		{
+		public:
+			explicit FResettingPathsCache(const int32 InCapacity)
+				: Capacity(InCapacity) { }
+
+			const int32* Find(const FName& Path) { return Paths.Find(Path); }
+
+			void Add(const FName& Path, const int32 Value)
+			{
+				if (Paths.Num() >= Capacity)
+				{
+					Paths.Reset();
+				}
+
+				Paths.Add(Path, Value);
+			}
+
+		private:
+			const int32 Capacity;
+			TMap<FName, int32> Paths;
+		};
+
+		// Least recently used cache as it is made by package manager
+		class FLruPathsCache
+		{
+		public:
+			explicit FLruPathsCache(const int32 InCapacity)
+				: Paths(InCapacity) { }
+
+			const int32* Find(const FName& Path) { return Paths.FindAndTouch(Path); }
+			void Add(const FName& Path, const int32 Value) { Paths.Add(Path, Value); }
+
+		private:
+			TLruCache<FName, int32> Paths;
+		};
+
+		// Classification of path as it was made before string views: path is converted to string and split into array of
+		// elements, and sub-root is split by DLC prefix, all with temporary strings. Sub-root without DLC prefix gives empty id
+		TOptional<FString> GetDLCChunkId_Legacy(const FSoftObjectPath& SoftObjectPath)
+		{
+			if (SoftObjectPath.IsNull())
+				return { };
+
+			TArray<FString> PathElements;
+			SoftObjectPath.ToString().ParseIntoArray(PathElements, TEXT("/"));
+
+			static const FString RootName{ TEXT("Game") };
+			const int32 RootPathElementIndex = PathElements.IndexOfByKey(RootName);
+			if (RootPathElementIndex == INDEX_NONE || (RootPathElementIndex == PathElements.Num() - 1))
+				return { };
+
+			const FString& SubRootPathElement = PathElements[RootPathElementIndex + 1];
+			static const FString DLCSubRootPathElementPrefix{ TEXT("DLC_") };
+
+			FString BeforePrefixString;
+			FString AfterPrefixString;
+			SubRootPathElement.Split(DLCSubRootPathElementPrefix, &BeforePrefixString, &AfterPrefixString, ESearchCase::CaseSensitive);
+
+			if (!BeforePrefixString.IsEmpty())
+				return { };
+
+			return { MoveTemp(AfterPrefixString) };
+		}
+
+		// Classification of every path of corpus by legacy and current classifiers. Current classifier gets path as package
+		// manager passes it: asset path name is written to stack string builder
+		void MeasurePathClassifiers(const TArray<FName>& Paths, const FDLCPackageManager_Debug::FLogging_Benchmark& Logging)
+		{
+			TArray<FSoftObjectPath> SoftObjectPaths;
+			SoftObjectPaths.Reserve(Paths.Num());
+			for (const FName& Path : Paths)
+			{
+				SoftObjectPaths.Emplace(Path);
+			}
+
+			int32 LegacyDLCPathsNum = 0;
+			uint64 LegacyAllocationsNum = 0;
+			const double LegacyStartTime = FPlatformTime::Seconds();
+			{
+				const FDLCAllocationsCounter AllocationsCounter;
+				for (const FSoftObjectPath& SoftObjectPath : SoftObjectPaths)
+				{
+					const TOptional<FString> DLCChunkId = GetDLCChunkId_Legacy(SoftObjectPath);
+					LegacyDLCPathsNum += (DLCChunkId.IsSet() && !DLCChunkId->IsEmpty()) ? 1 : 0;
+				}
+				LegacyAllocationsNum = AllocationsCounter.GetAllocationsNum();
+			}
+
+			int32 DLCPathsNum = 0;
+			uint64 AllocationsNum = 0;
+			const double CurrentStartTime = FPlatformTime::Seconds();
+			{
+				const FDLCAllocationsCounter AllocationsCounter;
+				for (const FName& Path : Paths)
+				{
+					TStringBuilder<NAME_SIZE> PathBuilder;
+					Path.AppendString(PathBuilder);
+
+					DLCPathsNum += FDLCPackageManager_Private::GetDLCChunkId(PathBuilder.ToView()).IsSet() ? 1 : 0;
+				}
+				AllocationsNum = AllocationsCounter.GetAllocationsNum();
+			}
+			const double EndTime = FPlatformTime::Seconds();
+
+			//NB: Results are compared after measurements, so comparison does not add allocations to them
+			int32 MismatchesNum = 0;
+			for (int32 PathIndex = 0; PathIndex < Paths.Num(); ++PathIndex)
+			{
+				TStringBuilder<NAME_SIZE> PathBuilder;
+				Paths[PathIndex].AppendString(PathBuilder);
+
+				const TOptional<FString> LegacyDLCChunkId = GetDLCChunkId_Legacy(SoftObjectPaths[PathIndex]);
+				const TOptional<FStringView> DLCChunkId = FDLCPackageManager_Private::GetDLCChunkId(PathBuilder.ToView());
+				const bool bIsLegacyDLCPath = LegacyDLCChunkId.IsSet() && !LegacyDLCChunkId->IsEmpty();
+				if (bIsLegacyDLCPath != DLCChunkId.IsSet() || (bIsLegacyDLCPath && !DLCChunkId->Equals(*LegacyDLCChunkId, ESearchCase::CaseSensitive)))
+				{
+					++MismatchesNum;
+				}
+			}
+
+			const int32 PathsNum = Paths.Num();
+			const double LegacySeconds = CurrentStartTime - LegacyStartTime;
+			const double CurrentSeconds = EndTime - CurrentStartTime;
+
+			DLC_LOG(Logging, StatusImportant, TEXT("Classification of [%d] paths ([%d] / [%d] in DLC). Legacy: [%.1f] ns and [%.2f] allocations per path. Current: [%.1f] ns and [%.2f] allocations per path, [%.1f] times faster"),
+				PathsNum, LegacyDLCPathsNum, DLCPathsNum,
+				LegacySeconds * 1e9 / PathsNum, static_cast<double>(LegacyAllocationsNum) / PathsNum,
+				CurrentSeconds * 1e9 / PathsNum, static_cast<double>(AllocationsNum) / PathsNum,
+				CurrentSeconds > 0.0 ? LegacySeconds / CurrentSeconds : 0.0);
+
+			if (MismatchesNum > 0)
+			{
+				DLC_LOG(Logging, Error, TEXT("[%d] paths are classified differently by legacy and current classifiers"), MismatchesNum);
+			}
+		}
+
+		// Lookups of synthetic DLC paths: most of them are hot paths, the rest are uniformly spread over all paths,
+		// so hot paths are mixed with scans of cold ones. Missed path is resolved as package manager resolves it
+		template<typename T_Cache>
+		void MeasurePathsCache(const TArray<FName>& Paths, const TArray<int32>& LookupIndices, const int32 Capacity, double& OutSeconds, double& OutHitRate)
+		{
+			T_Cache Cache{ Capacity };
+			int32 HitsNum = 0;
+
+			const double StartSeconds = FPlatformTime::Seconds();
+			for (const int32 PathIndex : LookupIndices)
+			{
+				const FName& Path = Paths[PathIndex];
+				if (Cache.Find(Path))
+				{
+					++HitsNum;
+					continue;
+				}
+
+				TStringBuilder<NAME_SIZE> PathBuilder;
+				Path.AppendString(PathBuilder);
+
+				const TOptional<FStringView> DLCChunkId = FDLCPackageManager_Private::GetDLCChunkId(PathBuilder.ToView());
+				Cache.Add(Path, DLCChunkId.IsSet() ? DLCChunkId.GetValue().Len() : INDEX_NONE);
+			}
+			OutSeconds = FPlatformTime::Seconds() - StartSeconds;
+			OutHitRate = static_cast<double>(HitsNum) / LookupIndices.Num();
+		}
+
+		void RunResolvedPathsCacheBenchmarkCommand(const TArray<FString>& Args)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+			const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ TEXT("ResolvedPathsCache") };
+
+			int32 PathsNum = 16384;
+			int32 HotPathsNum = 3072;
+			int32 HotLookupsPercent = 90;
+			int32 LookupsNum = 1000000;
+			int32 Capacity = 4096;
+			FParse::Value(*ParamsString, TEXT("Paths="), PathsNum);
+			FParse::Value(*ParamsString, TEXT("HotPaths="), HotPathsNum);
+			FParse::Value(*ParamsString, TEXT("HotPercent="), HotLookupsPercent);
+			FParse::Value(*ParamsString, TEXT("Lookups="), LookupsNum);
+			FParse::Value(*ParamsString, TEXT("Capacity="), Capacity);
+			if (PathsNum <= 0 || HotPathsNum <= 0 || HotPathsNum > PathsNum || LookupsNum <= 0 || Capacity <= 0)
+			{
+				DLC_LOG(Logging, Error, TEXT("Invalid paths [%d], hot paths [%d], lookups [%d] or capacity [%d]"), PathsNum, HotPathsNum, LookupsNum, Capacity);
+				return;
+			}
+
+			//NB: Corpus mixes DLC content with base game and engine content, as requests of game do
+			TArray<FName> Paths;
+			Paths.Reserve(PathsNum);
+			for (int32 PathIndex = 0; PathIndex < PathsNum; ++PathIndex)
+			{
+				switch (PathIndex % 8)
+				{
+					case 6:  Paths.Emplace(*FString::Printf(TEXT("/Game/Characters/Hero%d/Meshes/SK_Asset%d.SK_Asset%d"), PathIndex % 32, PathIndex, PathIndex)); break;
+					case 7:  Paths.Emplace(*FString::Printf(TEXT("/Engine/EngineMaterials/M_Asset%d.M_Asset%d"), PathIndex, PathIndex));                           break;
+					default: Paths.Emplace(*FString::Printf(TEXT("/Game/DLC_Bench%d/Meshes/SM_Asset%d.SM_Asset%d"), PathIndex % 64, PathIndex, PathIndex));        break;
+				}
+			}
+
+			MeasurePathClassifiers(Paths, Logging);
+
+			//NB: Lookups are generated before measurements, so both caches see same sequence
+			FRandomStream RandomStream{ 0 };
+			TArray<int32> LookupIndices;
+			LookupIndices.Reserve(LookupsNum);
+			for (int32 LookupIndex = 0; LookupIndex < LookupsNum; ++LookupIndex)
+			{
+				const bool bIsHotLookup = RandomStream.RandRange(0, 99) < HotLookupsPercent;
+				LookupIndices.Add(RandomStream.RandRange(0, (bIsHotLookup ? HotPathsNum : PathsNum) - 1));
+			}
+
+			double ResettingSeconds = 0.0;
+			double ResettingHitRate = 0.0;
+			MeasurePathsCache<FResettingPathsCache>(Paths, LookupIndices, Capacity, ResettingSeconds, ResettingHitRate);
+
+			double LruSeconds = 0.0;
+			double LruHitRate = 0.0;
+			MeasurePathsCache<FLruPathsCache>(Paths, LookupIndices, Capacity, LruSeconds, LruHitRate);
+
+			DLC_LOG(Logging, StatusImportant, TEXT("[%d] lookups of [%d] paths ([%d] hot paths get [%d]%% of lookups), capacity [%d]. Reset on overflow: [%.1f] ns per lookup, hit rate [%.3f]. LRU: [%.1f] ns per lookup, hit rate [%.3f]"),
+				LookupsNum, PathsNum, HotPathsNum, HotLookupsPercent, Capacity,
+				ResettingSeconds * 1e9 / LookupsNum, ResettingHitRate, LruSeconds * 1e9 / LookupsNum, LruHitRate);
+		}
+
+		FAutoConsoleCommand DLCResolvedPathsCacheBenchmarkCommand(
+			TEXT("DLC.Benchmark.ResolvedPathsCache"),
+			TEXT("Compares legacy and current classifiers of DLC paths, and cache of resolved paths that is reset on overflow with LRU cache. Usage: DLC.Benchmark.ResolvedPathsCache [Paths=<number>] [HotPaths=<number>] [HotPercent=<percent>] [Lookups=<number>] [Capacity=<number>]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunResolvedPathsCacheBenchmarkCommand));
+
+		// - - - - - - - - - - - - -
+
+		// Latent action polling completion flag on every update, as it was made before waiting actions were taken out of latent action manager
+		class FPollingLatentAction : public FPendingLatentAction
+		{
+		public:
+			FPollingLatentAction(const FLatentActionInfo& LatentInfo, TFuture<int32>&& Future)
+				:
+				ExecutionFunction(LatentInfo.ExecutionFunction),
+				OutputLink(LatentInfo.Linkage),
+				CallbackTarget(LatentInfo.CallbackTarget),
+				CompletionState(MakeShared<FCompletionState, ESPMode::ThreadSafe>())
+			{
+				Future.Next([CompletionState = CompletionState](const int32 Result)
+				{
+					CompletionState->Result = Result;
+					CompletionState->bIsReady = true;
+				});
+			}
+
+			void UpdateOperation(FLatentResponse& Response) override
+			{
+				Response.FinishAndTriggerIf(CompletionState->bIsReady, ExecutionFunction, OutputLink, CallbackTarget);
+			}
+
+		private:
+			struct FCompletionState
+			{
+				int32 Result = 0;
+				TAtomic<bool> bIsReady{ false };
+			};
+
+			FName ExecutionFunction;
+			int32 OutputLink;
+			FWeakObjectPtr CallbackTarget;
+
+			TSharedRef<FCompletionState, ESPMode::ThreadSafe> CompletionState;
+		};
+
+		// Frame times while many latent loadings are waiting. Phases are measured one after another for same number of frames:
+		//   Idle         - no waiting actions
+		//   Polling      - waiting actions are updated by latent action manager every frame
+		//   Continuation - waiting actions are added to latent action manager by continuations of futures
+		// Futures of actions are completed after each phase, so finished actions do not affect next phase
+		class FLatentActionsBenchmark : public TSharedFromThis<FLatentActionsBenchmark>
+		{
+		public:
+			FLatentActionsBenchmark(UWorld* InWorld, const int32 InActionsNum, const int32 InFramesNum)
+				: World(InWorld), ActionsNum(InActionsNum), FramesNum(InFramesNum) { }
+
+			void Start()
+			{
+				StartPhase(0);
+			}
+
+		private:
+			enum class EPhase : int32 { Idle, Polling, Continuation, Num };
+
+			void StartPhase(const int32 PhaseIndex)
+			{
+				if (PhaseIndex >= static_cast<int32>(EPhase::Num))
+				{
+					Finish();
+					return;
+				}
+
+				UWorld* CurrentWorld = World.Get();
+				if (CurrentWorld == nullptr)
+					return;
+
+				Promises.SetNum(PhaseIndex == static_cast<int32>(EPhase::Idle) ? 0 : ActionsNum);
+				for (int32 ActionIndex = 0; ActionIndex < Promises.Num(); ++ActionIndex)
+				{
+					//NB: Linkage is not set, so finished actions do not execute anything
+					FLatentActionInfo LatentInfo;
+					LatentInfo.CallbackTarget = CurrentWorld;
+					LatentInfo.UUID = PhaseIndex * ActionsNum + ActionIndex;
+
+					if (PhaseIndex == static_cast<int32>(EPhase::Polling))
+					{
+						CurrentWorld->GetLatentActionManager().AddNewAction(CurrentWorld, LatentInfo.UUID, new FPollingLatentAction(LatentInfo, Promises[ActionIndex].GetFuture()));
+					}
+					else
+					{
+						StartFutureLatentAction<int32>(CurrentWorld, LatentInfo, Promises[ActionIndex].GetFuture(), [](const int32&) { });
+					}
+				}
+
+				FramesLeft = FramesNum;
+				FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([This = AsShared(), PhaseIndex](const float DeltaTime)
+				{
+					This->Histograms[PhaseIndex].AddSample(DeltaTime);
+					if (--This->FramesLeft > 0)
+						return true;
+
+					for (TPromise<int32>& Promise : This->Promises)
+					{
+						Promise.SetValue(0);
+					}
+					This->Promises.Reset();
+
+					This->StartPhase(PhaseIndex + 1);
+					return false;
+				}));
+			}
+
+			void Finish()
+			{
+				const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ TEXT("LatentActions") };
+
+				static const TCHAR* const PhaseNames[] = { TEXT("Idle"), TEXT("Polling"), TEXT("Continuation") };
+				for (int32 PhaseIndex = 0; PhaseIndex < static_cast<int32>(EPhase::Num); ++PhaseIndex)
+				{
+					const FDLCLatencyHistogram& Histogram = Histograms[PhaseIndex];
+					DLC_LOG(Logging, StatusImportant, TEXT("[%s] with [%d] waiting actions: frame time P50 [%.2f] ms, P95 [%.2f] ms, max [%.2f] ms over [%d] frames"),
+						PhaseNames[PhaseIndex], PhaseIndex == static_cast<int32>(EPhase::Idle) ? 0 : ActionsNum,
+						Histogram.GetPercentile(50.0) * 1000.0, Histogram.GetPercentile(95.0) * 1000.0, Histogram.GetMax() * 1000.0, Histogram.GetSamplesNum());
+				}
+			}
+
+			const TWeakObjectPtr<UWorld> World;
+			const int32 ActionsNum;
+			const int32 FramesNum;
+
+			TArray<TPromise<int32>> Promises;
+			int32 FramesLeft = 0;
+			FDLCLatencyHistogram Histograms[static_cast<int32>(EPhase::Num)];
+		};
+
+		void RunLatentActionsBenchmarkCommand(const TArray<FString>& Args, UWorld* World)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+			const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ TEXT("LatentActions") };
+
+			int32 ActionsNum = 2000;
+			int32 FramesNum = 300;
+			FParse::Value(*ParamsString, TEXT("Actions="), ActionsNum);
+			FParse::Value(*ParamsString, TEXT("Frames="), FramesNum);
+			if (World == nullptr || ActionsNum <= 0 || FramesNum <= 0)
+			{
+				DLC_LOG(Logging, Error, TEXT("No world or invalid actions number [%d] or frames number [%d]"), ActionsNum, FramesNum);
+				return;
+			}
+
+			MakeShared<FLatentActionsBenchmark>(World, ActionsNum, FramesNum)->Start();
+		}
+
+		FAutoConsoleCommand DLCLatentActionsBenchmarkCommand(
+			TEXT("DLC.Benchmark.LatentActions"),
+			TEXT("Measures frame times while many latent loadings are waiting. Usage: DLC.Benchmark.LatentActions [Actions=<number>] [Frames=<number>]"),
+			FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunLatentActionsBenchmarkCommand));
+
+		// - - - - - - - - - - - - -
+
+		// Stages of synthetic loading pipeline: initialization waiting, downloading and loading. Every stage is future of promise
+		// that is fulfilled later on the game thread, as package manager fulfills them, so every stage of pipeline is suspended
+		class FPipelineStages
+		{
+		public:
+			FPipelineStages() { Promises.Reserve(StagesNum); }
+
+			static constexpr int32 StagesNum = 3;
+
+			TFuture<void> MakeStage() { return Promises.Emplace_GetRef().GetFuture(); }
+
+			// Fulfills stages until pipeline makes no new ones
+			void FulfillAll()
+			{
+				while (Promises.Num() > 0)
+				{
+					TPromise<void> Promise = MoveTemp(Promises.Last());
+					Promises.Pop(false);
+					Promise.SetValue();
+				}
+			}
+
+		private:
+			TArray<TPromise<void>> Promises;
+		};
+
+		// Pipeline as it was made before shared request state: nested continuations copy promise, reference and logging
+		TFuture<UObject*> LoadByNestedContinuations(FPipelineStages& Stages, const FSoftObjectPtr& SoftObjectPtr)
+		{
+			auto LoadingPromise = MakeShared<TPromise<UObject*>>();
+			TFuture<UObject*> LoadingFuture = LoadingPromise->GetFuture();
+			const FDLCPackageManager_Debug::FLogging_Loading Logging{ SoftObjectPtr };
+
+			Stages.MakeStage().Next([&Stages, LoadingPromise, SoftObjectPtr, Logging](int32)
+			{
+				Stages.MakeStage().Next([&Stages, LoadingPromise, SoftObjectPtr, Logging](int32)
+				{
+					Stages.MakeStage().Next([LoadingPromise, SoftObjectPtr, Logging](int32)
+					{
+						LoadingPromise->SetValue(SoftObjectPtr.Get());
+					});
+				});
+			});
+
+			return LoadingFuture;
+		}
+
+		// Pipeline of "FDLCPackageManager::GetLoadedPath()": stages share one request state
+		TFuture<UObject*> LoadBySharedRequest(FPipelineStages& Stages, const FSoftObjectPtr& SoftObjectPtr)
+		{
+			struct FRequest
+			{
+				FRequest(const FSoftObjectPtr& InSoftObjectPtr)
+					: SoftObjectPtr(InSoftObjectPtr), Logging(InSoftObjectPtr) { }
+
+				const FSoftObjectPtr SoftObjectPtr;
+				const FDLCPackageManager_Debug::FLogging_Loading Logging;
+				TPromise<UObject*> Promise;
+			};
+
+			const TSharedRef<FRequest> Request = MakeShared<FRequest>(SoftObjectPtr);
+			TFuture<UObject*> LoadingFuture = Request->Promise.GetFuture();
+
+			WhenReady(Stages.MakeStage(), [&Stages, Request]()
+			{
+				WhenReady(Stages.MakeStage(), [&Stages, Request]()
+				{
+					WhenReady(Stages.MakeStage(), [Request]()
+					{
+						Request->Promise.SetValue(Request->SoftObjectPtr.Get());
+					});
+				});
+			});
+
+			return LoadingFuture;
+		}
+
+#if WITH_DLC_COROUTINES
+		// Pipeline and its user as one coroutine: stages are awaited in coroutine frame, so there are no continuations of
+		// pipeline and no future of result
+		FDLCTask LoadByCoroutine(FPipelineStages& Stages, const FSoftObjectPtr SoftObjectPtr, int32& FinishedRequestsNum)
+		{
+			const FDLCPackageManager_Debug::FLogging_Loading Logging{ SoftObjectPtr };
+
+			for (int32 StageIndex = 0; StageIndex < FPipelineStages::StagesNum; ++StageIndex)
+			{
+				co_await DLCAwait(Stages.MakeStage());
+			}
+
+			SoftObjectPtr.Get();
+			++FinishedRequestsNum;
+		}
+#endif
+
+		// Requests are made one by one: every request is finished by fulfilling of its stages before next one, so time of
+		// request is latency of pipeline from request to its user. Users of future pipelines are continuations of result
+		void RunPipelinesBenchmarkCommand(const TArray<FString>& Args)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+			const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ TEXT("Pipelines") };
+
+			FString Path = TEXT("/Game/DLC_Bench/Asset.Asset");
+			int32 RequestsNum = 100000;
+			FParse::Value(*ParamsString, TEXT("Path="), Path);
+			FParse::Value(*ParamsString, TEXT("Requests="), RequestsNum);
+			if (RequestsNum <= 0)
+			{
+				DLC_LOG(Logging, Error, TEXT("Invalid requests number [%d]"), RequestsNum);
+				return;
+			}
+
+			const FSoftObjectPtr SoftObjectPtr{ FSoftObjectPath{ Path } };
+			FPipelineStages Stages;
+
+			static const TCHAR* const PipelineNames[] = { TEXT("Nested continuations"), TEXT("Shared request"), TEXT("Coroutine") };
+			for (int32 PipelineIndex = 0; PipelineIndex < UE_ARRAY_COUNT(PipelineNames); ++PipelineIndex)
+			{
+				int32 FinishedRequestsNum = 0;
+				uint64 AllocationsNum = 0;
+				const double StartTime = FPlatformTime::Seconds();
+				{
+					const FDLCAllocationsCounter AllocationsCounter;
+					for (int32 RequestIndex = 0; RequestIndex < RequestsNum; ++RequestIndex)
+					{
+						switch (PipelineIndex)
+						{
+							case 0: LoadByNestedContinuations(Stages, SoftObjectPtr).Next([&FinishedRequestsNum](UObject*) { ++FinishedRequestsNum; }); break;
+							case 1: LoadBySharedRequest(Stages, SoftObjectPtr).Next([&FinishedRequestsNum](UObject*) { ++FinishedRequestsNum; });       break;
+#if WITH_DLC_COROUTINES
+							case 2: LoadByCoroutine(Stages, SoftObjectPtr, FinishedRequestsNum);                                                       break;
+#endif
+							default: break;
+						}
+
+						Stages.FulfillAll();
+					}
+					AllocationsNum = AllocationsCounter.GetAllocationsNum();
+				}
+				const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+				if (FinishedRequestsNum == 0)
+				{
+					DLC_LOG(Logging, Warning, TEXT("[%s] pipeline is not measured: coroutines are not supported by toolchain"), PipelineNames[PipelineIndex]);
+					continue;
+				}
+
+				DLC_LOG(Logging, StatusImportant, TEXT("[%s] pipeline, [%d] requests: [%.1f] ns and [%.2f] game thread allocations per request"),
+					PipelineNames[PipelineIndex], RequestsNum, Seconds * 1e9 / RequestsNum, static_cast<double>(AllocationsNum) / RequestsNum);
+
+				if (FinishedRequestsNum != RequestsNum)
+				{
+					DLC_LOG(Logging, Error, TEXT("[%s] pipeline finished [%d] of [%d] requests"), PipelineNames[PipelineIndex], FinishedRequestsNum, RequestsNum);
+				}
+			}
+		}
+
+		FAutoConsoleCommand DLCPipelinesBenchmarkCommand(
+			TEXT("DLC.Benchmark.Pipelines"),
+			TEXT("Measures latency and game thread allocations per request of loading pipelines: nested continuations, shared request and coroutine. Usage: DLC.Benchmark.Pipelines [Path=<soft object path>] [Requests=<number>]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunPipelinesBenchmarkCommand));
+
+		// - - - - - - - - - - - - -
+
+		void RunMountsBenchmarkCommand(const TArray<FString>& Args)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+
+			FString InstanceName = FDLCPackageManager::DefaultInstanceName.ToString();
+			FParse::Value(*ParamsString, TEXT("Instance="), InstanceName);
+
+			const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ FName{ *InstanceName } };
+
+			FString PackagesFilePath;
+			TArray<FString> PackageLines;
+			if (!FParse::Value(*ParamsString, TEXT("PackagesFile="), PackagesFilePath) || !FFileHelper::LoadFileToStringArray(PackageLines, *PackagesFilePath))
+			{
+				DLC_LOG(Logging, Error, TEXT("PackagesFile= is not passed or cannot be read"));
+				return;
+			}
+
+			TArray<FName> PackageNames;
+			for (FString& PackageLine : PackageLines)
+			{
+				PackageLine.TrimStartAndEndInline();
+				if (!PackageLine.IsEmpty() && !PackageLine.StartsWith(TEXT("#")))
+				{
+					PackageNames.Emplace(*PackageLine);
+				}
+			}
+
+			FDLCMountsBenchmark::Run(FName{ *InstanceName }, PackageNames);
+		}
+
+		FAutoConsoleCommand DLCMountsBenchmarkCommand(
+			TEXT("DLC.Benchmark.Mounts"),
+			TEXT("Measures frame times while many downloaded chunks are mounted at once, by ChunkDownloader and by mount scheduler. Usage: DLC.Benchmark.Mounts Instance=<name> PackagesFile=<file>"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunMountsBenchmarkCommand));
+
+		void RunPrioritiesBenchmarkCommand(const TArray<FString>& Args)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+
+			FString InstanceName = FDLCPackageManager::DefaultInstanceName.ToString();
+			FParse::Value(*ParamsString, TEXT("Instance="), InstanceName);
+
+			const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ FName{ *InstanceName } };
+
+			FString PackagesFilePath;
+			TArray<FString> PackageLines;
+			if (!FParse::Value(*ParamsString, TEXT("PackagesFile="), PackagesFilePath) || !FFileHelper::LoadFileToStringArray(PackageLines, *PackagesFilePath))
+			{
+				DLC_LOG(Logging, Error, TEXT("PackagesFile= is not passed or cannot be read"));
+				return;
+			}
+
+			TArray<FName> PackageNames;
+			for (FString& PackageLine : PackageLines)
+			{
+				PackageLine.TrimStartAndEndInline();
+				if (!PackageLine.IsEmpty() && !PackageLine.StartsWith(TEXT("#")))
+				{
+					PackageNames.Emplace(*PackageLine);
+				}
+			}
+
+			int32 ForegroundPackagesNum = 4;
+			FParse::Value(*ParamsString, TEXT("Foreground="), ForegroundPackagesNum);
+
+			FDLCPrioritiesBenchmark::Run(FName{ *InstanceName }, PackageNames, ForegroundPackagesNum);
+		}
+
+		FAutoConsoleCommand DLCPrioritiesBenchmarkCommand(
+			TEXT("DLC.Benchmark.Priorities"),
+			TEXT("Measures latency of foreground downloads under saturated background downloads, by ChunkDownloader and by download scheduler. Usage: DLC.Benchmark.Priorities Instance=<name> PackagesFile=<file> [Foreground=<number>]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunPrioritiesBenchmarkCommand));
+
+		// - - - - - - - - - - - - -
+
+		// Parsing of DLC chunk id "<Name>[_<Version>]" as it was made before string views: strings are split
+		// and version members are parsed from array of strings for every entry
+		TOptional<FDLCCatalogEntry> ParseCatalogEntry_Legacy(const FString& DLCChunkID, const int32 ChunkId)
+		{
+			FString NameString;
+			FString VersionString;
+			if (!DLCChunkID.Split(TEXT("_"), &NameString, &VersionString, ESearchCase::CaseSensitive))
+			{
+				NameString = DLCChunkID;
+			}
+
+			FVersion Version = FVersion::VersionOne;
+			if (!VersionString.IsEmpty())
+			{
+				TArray<FString> Members;
+				VersionString.ParseIntoArray(Members, TEXT("."));
+
+				int32 MemberValues[3] = { 0, 0, 0 };
+				for (int32 MemberIndex = 0; MemberIndex < UE_ARRAY_COUNT(MemberValues) && MemberIndex < Members.Num(); ++MemberIndex)
+				{
+					if (!FDefaultValueHelper::ParseInt(Members[MemberIndex], MemberValues[MemberIndex]))
+						return { };
+				}
+
+				Version = FVersion{ MemberValues[0], MemberValues[1], MemberValues[2] };
+			}
+
+			if (NameString.IsEmpty() || !Version.CanBePackedToKey())
+				return { };
+
+			FDLCCatalogEntry Result;
+			Result.PackageName = FName{ *NameString };
+			Result.VersionKey = Version.ToKey();
+			Result.ChunkId = ChunkId;
+
+			return Result;
+		}
+
+		void RunCatalogBenchmarkCommand(const TArray<FString>& Args)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+
+			FString InstanceName = FDLCPackageManager::DefaultInstanceName.ToString();
+			FParse::Value(*ParamsString, TEXT("Instance="), InstanceName);
+
+			const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ FName{ *InstanceName } };
+
+			FString EntriesNumsString = TEXT("10000,100000");
+			int32 VersionsPerPackage = 2;
+			int32 LookupsNum = 100000;
+			FParse::Value(*ParamsString, TEXT("Entries="), EntriesNumsString, false);
+			FParse::Value(*ParamsString, TEXT("VersionsPerPackage="), VersionsPerPackage);
+			FParse::Value(*ParamsString, TEXT("Lookups="), LookupsNum);
+
+			TArray<FString> EntriesNumStrings;
+			EntriesNumsString.ParseIntoArray(EntriesNumStrings, TEXT(","));
+
+			TArray<int32> EntriesNums;
+			for (const FString& EntriesNumString : EntriesNumStrings)
+			{
+				EntriesNums.Add(FCString::Atoi(*EntriesNumString));
+			}
+
+			if (EntriesNums.Num() == 0 || EntriesNums.Contains(0) || VersionsPerPackage <= 0 || LookupsNum <= 0)
+			{
+				DLC_LOG(Logging, Error, TEXT("Invalid entries numbers [%s], versions per package number [%d] or lookups number [%d]"), *EntriesNumsString, VersionsPerPackage, LookupsNum);
+				return;
+			}
+
+			FDLCCatalogBenchmark::Run(FName{ *InstanceName }, EntriesNums, VersionsPerPackage, LookupsNum);
+		}
+
+		FAutoConsoleCommand DLCCatalogBenchmarkCommand(
+			TEXT("DLC.Benchmark.Catalog"),
+			TEXT("Measures catalog building of synthetic manifest entries by package manager with legacy and current parsing, and package lookups by catalog size. Usage: DLC.Benchmark.Catalog Instance=<name> [Entries=<number>[,<number>...]] [VersionsPerPackage=<number>] [Lookups=<number>]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunCatalogBenchmarkCommand));
+
+		// - - - - - - - - - - - - -
+
+		void RunBenchmarkCommand(const TArray<FString>& Args)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+
+			FDLCBenchmark::FParams Params;
+
+			FString InstanceName = FDLCPackageManager::DefaultInstanceName.ToString();
+			FParse::Value(*ParamsString, TEXT("Instance="), InstanceName);
+			Params.InstanceName = FName{ *InstanceName };
+
+			const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ Params.InstanceName };
+
+			// Paths select objects mode, package names select download and mount mode (see "FDLCBenchmark")
+			FString PathsFilePath;
+			FString PackagesFilePath;
+			const bool bIsObjectsMode = FParse::Value(*ParamsString, TEXT("PathsFile="), PathsFilePath);
+			const bool bIsDownloadAndMountMode = FParse::Value(*ParamsString, TEXT("PackagesFile="), PackagesFilePath);
+			if (bIsObjectsMode == bIsDownloadAndMountMode)
+			{
+				DLC_LOG(Logging, Error, TEXT("Either PathsFile= or PackagesFile= should be passed"));
+				return;
+			}
+
+			const FString& ItemsFilePath = bIsObjectsMode ? PathsFilePath : PackagesFilePath;
+			TArray<FString> ItemLines;
+			if (!FFileHelper::LoadFileToStringArray(ItemLines, *ItemsFilePath))
+			{
+				DLC_LOG(Logging, Error, TEXT("Cannot read file [%s]"), *ItemsFilePath);
+				return;
+			}
+
+			for (FString& ItemLine : ItemLines)
+			{
+				ItemLine.TrimStartAndEndInline();
+				if (ItemLine.IsEmpty() || ItemLine.StartsWith(TEXT("#")))
+					continue;
+
+				if (bIsObjectsMode)
+					Params.SoftObjectPaths.Emplace(ItemLine);
+				else
+					Params.PackageNames.Emplace(*ItemLine);
+			}
+
+			Params.OutputFilePath = FPaths::ProjectSavedDir() / TEXT("DLCBenchmark") / FString::Printf(TEXT("%s-%s.json"), *InstanceName, *FDateTime::Now().ToString());
+			FParse::Value(*ParamsString, TEXT("Output="), Params.OutputFilePath);
+			FParse::Value(*ParamsString, TEXT("Concurrency="), Params.ConcurrentRequestsNum);
+			Params.bCleanCache = Args.Contains(TEXT("CleanCache"));
+
+			FDLCBenchmark::Run(Params);
+		}
+
+		FAutoConsoleCommand DLCBenchmarkCommand(
+			TEXT("DLC.Benchmark"),
+			TEXT("Measures latency of DLC objects loading or DLC packages downloading and mounting. Usage: DLC.Benchmark Instance=<name> (PathsFile=<file> | PackagesFile=<file>) [Output=<file .json>] [Concurrency=<requests>] [CleanCache]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmarkCommand));
+
+		void WriteHistogram(TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>& Writer, const TCHAR* Name, const FDLCLatencyHistogram& Histogram)
+		{
+			Writer.WriteObjectStart(Name);
+			Writer.WriteValue(TEXT("Count"), static_cast<double>(Histogram.GetTotalSamplesNum()));
+			Writer.WriteValue(TEXT("P50"), Histogram.GetPercentile(50.0));
+			Writer.WriteValue(TEXT("P95"), Histogram.GetPercentile(95.0));
+			Writer.WriteValue(TEXT("P99"), Histogram.GetPercentile(99.0));
+			Writer.WriteValue(TEXT("Max"), Histogram.GetMax());
+			Writer.WriteObjectEnd();
+		}
+	}
+
+	FDLCAllocationsCounter::FDLCAllocationsCounter()
+		: StartAllocationsNum(GetCountingMalloc().GetGameThreadAllocationsNum()) { }
+
+	FDLCAllocationsCounter::~FDLCAllocationsCounter() = default;
+
+	uint64 FDLCAllocationsCounter::GetAllocationsNum() const
+	{
+		return GetCountingMalloc().GetGameThreadAllocationsNum() - StartAllocationsNum;
+	}
+
+	// - - - - - - - - - - - - -
+
+	FDLCBenchmark::FDLCBenchmark(const FParams& InParams)
+		: Params(InParams) { }
+
+	void FDLCBenchmark::Run(const FParams& Params)
+	{
+		check(IsInGameThread());
+
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ Params.InstanceName };
+
+		if ((Params.SoftObjectPaths.Num() == 0 && Params.PackageNames.Num() == 0) || Params.ConcurrentRequestsNum <= 0)
+		{
+			DLC_LOG(Logging, Error, TEXT("No paths or packages, or invalid concurrent requests number [%d]. Benchmark is not started"), Params.ConcurrentRequestsNum);
+			return;
+		}
+
+		const TSharedRef<FDLCBenchmark> Benchmark = MakeShareable(new FDLCBenchmark{ Params });
+		Benchmark->Start();
+	}
+
+	int32 FDLCBenchmark::GetItemsNum() const
+	{
+		return IsDownloadAndMountMode() ? Params.PackageNames.Num() : Params.SoftObjectPaths.Num();
+	}
+
+	void FDLCBenchmark::Start()
+	{
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ Params.InstanceName };
+
+		bIsColdInstance = !FDLCPackageManager::HasInstance(Params.InstanceName);
+		if (bIsColdInstance)
+		{
+			const FDLCPackageManagerSettings Settings = FDLCPackageManagerSettings::LoadFromConfig(Params.InstanceName);
+			const FString CacheFolder = (Settings.CacheFolder.IsEmpty() && Params.InstanceName != FDLCPackageManager::DefaultInstanceName) ?
+				FDLCPackageManagerSettings::GetDefaultCacheFolder(Params.InstanceName) :
+				Settings.CacheFolder;
+
+			//NB: Cache folder is deleted only on explicit request. Default cache folder is never deleted, it may hold pak files of the game
+			if (!Params.bCleanCache)
+			{
+				DLC_LOG(Logging, Warning, TEXT("Cache is not cleaned. Pass CleanCache to download pak files cached by previous runs again"));
+			}
+			else if (CacheFolder.IsEmpty())
+			{
+				DLC_LOG(Logging, Warning, TEXT("Instance has no own cache folder, cache is not cleaned. Pak files cached by previous runs are not downloaded"));
+			}
+			else
+			{
+				IFileManager::Get().DeleteDirectory(*CacheFolder, false, true);
+			}
+		}
+		else
+		{
+			DLC_LOG(Logging, Warning, TEXT("Instance is already created. Cold phases measure its current state"));
+		}
+
+		if (IsDownloadAndMountMode())
+			StartDownloadAndMountPhases();
+		else
+			StartObjectsPhases();
+	}
+
+	void FDLCBenchmark::StartObjectsPhases()
+	{
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ Params.InstanceName };
+
+		DLC_LOG(Logging, StatusImportant, TEXT("Started objects loading with [%d] paths and [%d] concurrent requests"),
+			Params.SoftObjectPaths.Num(), Params.ConcurrentRequestsNum);
+
+		const int32 PathsNum = Params.SoftObjectPaths.Num();
+		const TSharedRef<FDLCBenchmark> This = AsShared();
+
+		RequestSequentially(0, 1, ColdStartHistogram, [This, PathsNum]()
+		{
+			This->RequestSequentially(1, PathsNum, This->ColdCacheHistogram, [This, PathsNum]()
+			{
+				This->ReleaseAndCollectGarbage([This, PathsNum]()
+				{
+					This->RequestSequentially(0, PathsNum, This->WarmCacheHistogram, [This, PathsNum]()
+					{
+						This->RequestSequentially(0, PathsNum, This->MountedHistogram, [This, PathsNum]()
+						{
+							This->ReleaseAndCollectGarbage([This, PathsNum]()
+							{
+								This->RequestConcurrently(0, PathsNum, This->Params.ConcurrentRequestsNum, [This]()
+								{
+									This->ReleaseAndCollectGarbage([This]() { This->Finish(); });
+								});
+							});
+						});
+					});
+				});
+			});
+		});
+	}
+
+	void FDLCBenchmark::StartDownloadAndMountPhases()
+	{
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ Params.InstanceName };
+
+		DLC_LOG(Logging, StatusImportant, TEXT("Started downloading and mounting of [%d] packages. Objects are not loaded"), Params.PackageNames.Num());
+
+		const int32 PackagesNum = Params.PackageNames.Num();
+		// Cold packages are split between sequential and concurrent phases, so both of them download
+		const int32 ConcurrentBeginIndex = FMath::Min(PackagesNum, 1 + (PackagesNum - 1) / 2);
+		const TSharedRef<FDLCBenchmark> This = AsShared();
+
+		RequestSequentially(0, 1, ColdStartHistogram, [This, PackagesNum, ConcurrentBeginIndex]()
+		{
+			This->RequestSequentially(1, ConcurrentBeginIndex, This->ColdCacheHistogram, [This, PackagesNum, ConcurrentBeginIndex]()
+			{
+				This->RequestConcurrently(ConcurrentBeginIndex, PackagesNum, PackagesNum - ConcurrentBeginIndex, [This, PackagesNum]()
+				{
+					This->RequestSequentially(0, PackagesNum, This->MountedHistogram, [This]() { This->Finish(); });
+				});
+			});
+		});
+	}
+
+	void FDLCBenchmark::RequestItem(const int32 ItemIndex, TFunction<void(bool)>&& OnFinished)
+	{
+		FDLCPackageManager& PackageManager = FDLCPackageManager::Get(Params.InstanceName);
+
+		if (IsDownloadAndMountMode())
+		{
+			PackageManager.PreloadDLCPackages(MakeArrayView(&Params.PackageNames[ItemIndex], 1)).Next([OnFinished = MoveTemp(OnFinished)](const bool bPreloaded)
+			{
+				OnFinished(bPreloaded);
+			});
+			return;
+		}
+
+		const FSoftObjectPath& SoftObjectPath = Params.SoftObjectPaths[ItemIndex];
+		PackageManager.GetLoadedPath(FSoftObjectPtr{ SoftObjectPath }).Next([This = AsShared(), SoftObjectPath, OnFinished = MoveTemp(OnFinished)](UObject* LoadedObject)
+		{
+			This->HeldPaths.Add(SoftObjectPath);
+			OnFinished(LoadedObject != nullptr);
+		});
+	}
+
+	void FDLCBenchmark::RequestSequentially(const int32 ItemIndex, const int32 EndItemIndex, FDLCLatencyHistogram& Histogram, TFunction<void()>&& OnFinished)
+	{
+		if (ItemIndex >= EndItemIndex)
+		{
+			OnFinished();
+			return;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		const TSharedRef<FDLCBenchmark> This = AsShared();
+		RequestItem(ItemIndex, [This, ItemIndex, EndItemIndex, &Histogram, StartTime, OnFinished = MoveTemp(OnFinished)](const bool bSucceeded) mutable
+		{
+			Histogram.AddSample(FPlatformTime::Seconds() - StartTime);
+			This->FailedRequestsNum += (bSucceeded ? 0 : 1);
+
+			//NB: Next request is made by separate task, so requests finished synchronously do not grow the stack
+			AsyncTask(ENamedThreads::GameThread, [This, ItemIndex, EndItemIndex, &Histogram, OnFinished = MoveTemp(OnFinished)]() mutable
+			{
+				This->RequestSequentially(ItemIndex + 1, EndItemIndex, Histogram, MoveTemp(OnFinished));
+			});
+		});
+	}
+
+	void FDLCBenchmark::RequestConcurrently(const int32 BeginItemIndex, const int32 EndItemIndex, const int32 RequestsNum, TFunction<void()>&& OnFinished)
+	{
+		ConcurrentRequestsNum = EndItemIndex > BeginItemIndex ? RequestsNum : 0;
+		if (ConcurrentRequestsNum <= 0)
+		{
+			OnFinished();
+			return;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		ConcurrentRequestsLeft = ConcurrentRequestsNum;
+
+		//NB: Continuation is shared by requests, last finished request calls it
+		const TSharedRef<TFunction<void()>> SharedOnFinished = MakeShared<TFunction<void()>>(MoveTemp(OnFinished));
+		const TSharedRef<FDLCBenchmark> This = AsShared();
+
+		FrameTimeTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(This, &FDLCBenchmark::SampleFrameTime));
+
+		for (int32 RequestIndex = 0; RequestIndex < ConcurrentRequestsNum; ++RequestIndex)
+		{
+			RequestItem(BeginItemIndex + RequestIndex % (EndItemIndex - BeginItemIndex), [This, StartTime, SharedOnFinished](const bool bSucceeded)
+			{
+				const double CurrentTime = FPlatformTime::Seconds();
+
+				This->ConcurrentHistogram.AddSample(CurrentTime - StartTime);
+				This->FailedRequestsNum += (bSucceeded ? 0 : 1);
+
+				if (--This->ConcurrentRequestsLeft == 0)
+				{
+					This->ConcurrentSeconds = CurrentTime - StartTime;
+
+					FTicker::GetCoreTicker().RemoveTicker(This->FrameTimeTickerHandle);
+					This->FrameTimeTickerHandle.Reset();
+
+					AsyncTask(ENamedThreads::GameThread, [SharedOnFinished]() { (*SharedOnFinished)(); });
+				}
+			});
+		}
+	}
+
+	void FDLCBenchmark::ReleaseAndCollectGarbage(TFunction<void()>&& OnFinished)
+	{
+		FDLCPackageManager& PackageManager = FDLCPackageManager::Get(Params.InstanceName);
+		for (const FSoftObjectPath& HeldPath : HeldPaths)
+		{
+			PackageManager.ReleaseLoadedPath(FSoftObjectPtr{ HeldPath });
+		}
+
+		HeldPaths.Reset();
+
+		//NB: Garbage is collected by ticker, outside of loading callbacks. Released packages are unmounted after collection
+		const TSharedRef<TFunction<void()>> SharedOnFinished = MakeShared<TFunction<void()>>(MoveTemp(OnFinished));
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([SharedOnFinished](const float)
+		{
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			(*SharedOnFinished)();
+			return false;
+		}));
+	}
+
+	void FDLCBenchmark::Finish()
+	{
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ Params.InstanceName };
+
+		const FString MetricsFilePath = FPaths::ChangeExtension(Params.OutputFilePath, TEXT("metrics.json"));
+
+		if (!FFileHelper::SaveStringToFile(ToJson(), *Params.OutputFilePath) || !FDLCPackageManager::Get(Params.InstanceName).GetMetrics().DumpToFile(MetricsFilePath))
+		{
+			DLC_LOG(Logging, Error, TEXT("Cannot write results to [%s] or [%s]"), *Params.OutputFilePath, *MetricsFilePath);
+			return;
+		}
+
+		DLC_LOG(Logging, StatusImportant, TEXT("Finished [%s]: cold start [%.3f] s, cold cache p50 [%.3f] s, warm cache p50 [%.3f] s, mounted p50 [%.6f] s, [%.1f] concurrent requests per second, frame time max [%.3f] s, [%d] failed requests. Results are written to [%s]"),
+			IsDownloadAndMountMode() ? TEXT("DownloadAndMount") : TEXT("Objects"),
+			ColdStartHistogram.GetMax(), ColdCacheHistogram.GetPercentile(50.0), WarmCacheHistogram.GetPercentile(50.0), MountedHistogram.GetPercentile(50.0),
+			ConcurrentSeconds > 0.0 ? ConcurrentRequestsNum / ConcurrentSeconds : 0.0, FrameTimeHistogram.GetMax(), FailedRequestsNum, *Params.OutputFilePath);
+	}
+
+	bool FDLCBenchmark::SampleFrameTime(const float DeltaTime)
+	{
+		FrameTimeHistogram.AddSample(DeltaTime);
+		return true;
+	}
+
+	FString FDLCBenchmark::ToJson() const
+	{
+		FString Result;
+		const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Result);
+
+		Writer->WriteObjectStart();
+
+		Writer->WriteValue(TEXT("Instance"), Params.InstanceName.ToString());
+		Writer->WriteValue(TEXT("Time"), FDateTime::UtcNow().ToIso8601());
+		// Download and mount mode does not load objects, so its latencies are not comparable with objects mode
+		Writer->WriteValue(TEXT("Mode"), IsDownloadAndMountMode() ? TEXT("DownloadAndMount") : TEXT("Objects"));
+		Writer->WriteValue(TEXT("Paths"), static_cast<double>(Params.SoftObjectPaths.Num()));
+		Writer->WriteValue(TEXT("Packages"), static_cast<double>(Params.PackageNames.Num()));
+		Writer->WriteValue(TEXT("ColdInstance"), bIsColdInstance);
+		Writer->WriteValue(TEXT("FailedRequests"), static_cast<double>(FailedRequestsNum));
+
+		Writer->WriteObjectStart(TEXT("Phases"));
+		WriteHistogram(*Writer, TEXT("ColdStart"), ColdStartHistogram);
+		WriteHistogram(*Writer, TEXT("ColdCache"), ColdCacheHistogram);
+		if (!IsDownloadAndMountMode())
+		{
+			WriteHistogram(*Writer, TEXT("WarmCache"), WarmCacheHistogram);
+		}
+		WriteHistogram(*Writer, TEXT("Mounted"), MountedHistogram);
+		WriteHistogram(*Writer, TEXT("Concurrent"), ConcurrentHistogram);
+		Writer->WriteObjectEnd();
+
+		Writer->WriteObjectStart(TEXT("Concurrent"));
+		Writer->WriteValue(TEXT("Requests"), static_cast<double>(ConcurrentRequestsNum));
+		Writer->WriteValue(TEXT("Seconds"), ConcurrentSeconds);
+		Writer->WriteValue(TEXT("RequestsPerSecond"), ConcurrentSeconds > 0.0 ? ConcurrentRequestsNum / ConcurrentSeconds : 0.0);
+		WriteHistogram(*Writer, TEXT("FrameTime"), FrameTimeHistogram);
+		Writer->WriteObjectEnd();
+
+		Writer->WriteObjectEnd();
+		Writer->Close();
+
+		return Result;
+	}
+
+	// - - - - - - - - - - - - -
+
+	FDLCMountsBenchmark::FDLCMountsBenchmark(const FName& InInstanceName, const TArray<FName>& InPackageNames)
+		: InstanceName(InInstanceName), PackageNames(InPackageNames) { }
+
+	void FDLCMountsBenchmark::Run(const FName& InstanceName, const TArray<FName>& PackageNames)
+	{
+		check(IsInGameThread());
+
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ InstanceName };
+
+		if (PackageNames.Num() == 0 || !FCoreDelegates::OnUnmountPak.IsBound())
+		{
+			DLC_LOG(Logging, Error, TEXT("No packages or pak files unmounting is not supported. Benchmark is not started"));
+			return;
+		}
+
+		const TSharedRef<FDLCMountsBenchmark> Benchmark = MakeShareable(new FDLCMountsBenchmark{ InstanceName, PackageNames });
+		Benchmark->Start();
+	}
+
+	void FDLCMountsBenchmark::Start()
+	{
+		FDLCPackageManager::Get(InstanceName).PreloadDLCPackages(PackageNames).Next([This = AsShared()](const bool bPreloaded)
+		{
+			const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ This->InstanceName };
+
+			if (!bPreloaded)
+			{
+				DLC_LOG(Logging, Warning, TEXT("Some packages are not preloaded. They are not benchmarked"));
+			}
+
+			const FDLCPackageManager& PackageManager = FDLCPackageManager::Get(This->InstanceName);
+			for (const FName& PackageName : This->PackageNames)
+			{
+				const TSharedPtr<FDLCPackageManager::FDLCPackage>* DLCPackage = PackageManager.DLCPackages.Find(PackageName);
+				if (DLCPackage && (*DLCPackage)->Status.IsType<FDLCPackageManager::FDLCPackage::FStatus_Mounted>())
+				{
+					This->ChunkIds.AddUnique((*DLCPackage)->Status.Get<FDLCPackageManager::FDLCPackage::FStatus_Mounted>().ChunkId);
+				}
+			}
+
+			if (This->ChunkIds.Num() == 0)
+			{
+				DLC_LOG(Logging, Error, TEXT("No mounted packages. Benchmark is stopped"));
+				return;
+			}
+
+			DLC_LOG(Logging, StatusImportant, TEXT("Started mounting of [%d] chunks"), This->ChunkIds.Num());
+			This->StartPhase(0);
+		});
+	}
+
+	void FDLCMountsBenchmark::StartPhase(const int32 PhaseIndex)
+	{
+		if (PhaseIndex >= static_cast<int32>(EPhase::Num))
+		{
+			Finish();
+			return;
+		}
+
+		if (!UnmountChunks())
+			return;
+
+		FDLCPackageManager& PackageManager = FDLCPackageManager::Get(InstanceName);
+		const TSharedRef<FDLCMountsBenchmark> This = AsShared();
+
+		MountsLeft = ChunkIds.Num();
+		PhaseStartTime = FPlatformTime::Seconds();
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(This, &FDLCMountsBenchmark::SampleFrameTime, PhaseIndex));
+
+		if (PhaseIndex == static_cast<int32>(EPhase::Direct))
+		{
+			for (const int32 ChunkId : ChunkIds)
+			{
+				PackageManager.ChunkDownloader->MountChunk(ChunkId, [This](const bool bSuccess) { This->OnChunkMounted(bSuccess); });
+			}
+		}
+		else
+		{
+			const FDLCPackageManagerSettings& Settings = PackageManager.Settings;
+			MountScheduler = MakeShared<FDLCMountScheduler, ESPMode::ThreadSafe>(PackageManager.ChunkDownloader.ToSharedRef(),
+				Settings.MaxConcurrentMounts, Settings.MountFrameBudgetMilliseconds / 1000.0);
+
+			for (const int32 ChunkId : ChunkIds)
+			{
+				MountScheduler->RequestMount(ChunkId, EDLCLoadPriority::VisibleSoon, [This](const bool bSuccess) { This->OnChunkMounted(bSuccess); });
+			}
+		}
+	}
+
+	bool FDLCMountsBenchmark::UnmountChunks()
+	{
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ InstanceName };
+
+		using FChunk = FHackingType_ChunkDownloader::FChunk;
+		using FPakFile = FHackingType_ChunkDownloader::FPakFile;
+
+		//NB: Same as "FDLCPackageManager::UnmountDLCPackage()", but package status is kept: chunks are mounted again by phase
+		FHackingType_ChunkDownloader& ChunkDownloaderHacked = FDLCPackageManager::Get(InstanceName).GetChunkDownloaderHackedAccess();
+		for (const int32 ChunkId : ChunkIds)
+		{
+			const TSharedRef<FChunk>* Chunk = ChunkDownloaderHacked.Chunks.Find(ChunkId);
+			if (!Chunk)
+				continue;
+
+			for (const TSharedRef<FPakFile>& PakFile : (*Chunk)->PakFiles)
+			{
+				if (!PakFile->bIsMounted)
+					continue;
+
+				const FString PakFilePath = (PakFile->bIsEmbedded ? ChunkDownloaderHacked.EmbeddedFolder : ChunkDownloaderHacked.CacheFolder) / PakFile->Entry.FileName;
+				if (!FCoreDelegates::OnUnmountPak.Execute(PakFilePath))
+				{
+					DLC_LOG(Logging, Error, TEXT("Cannot unmount pak file [%s]. Benchmark is stopped"), *PakFilePath);
+					return false;
+				}
+
+				PakFile->bIsMounted = false;
+			}
+
+			(*Chunk)->bIsMounted = false;
+		}
+
+		return true;
+	}
+
+	void FDLCMountsBenchmark::OnChunkMounted(const bool bSuccess)
+	{
+		FailedMountsNum += (bSuccess ? 0 : 1);
+		--MountsLeft;
+	}
+
+	bool FDLCMountsBenchmark::SampleFrameTime(const float DeltaTime, const int32 PhaseIndex)
+	{
+		//NB: Frame that finished last mount is sampled too, so phase ends on next tick after it
+		FrameTimeHistograms[PhaseIndex].AddSample(DeltaTime);
+		if (MountsLeft > 0)
+			return true;
+
+		PhaseSeconds[PhaseIndex] = FPlatformTime::Seconds() - PhaseStartTime;
+		MountScheduler.Reset();
+
+		AsyncTask(ENamedThreads::GameThread, [This = AsShared(), PhaseIndex]() { This->StartPhase(PhaseIndex + 1); });
+		return false;
+	}
+
+	void FDLCMountsBenchmark::Finish()
+	{
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ InstanceName };
+
+		static const TCHAR* const PhaseNames[] = { TEXT("Direct"), TEXT("Scheduled") };
+		for (int32 PhaseIndex = 0; PhaseIndex < static_cast<int32>(EPhase::Num); ++PhaseIndex)
+		{
+			const FDLCLatencyHistogram& Histogram = FrameTimeHistograms[PhaseIndex];
+			DLC_LOG(Logging, StatusImportant, TEXT("[%s] mounting of [%d] chunks took [%.3f] s: frame time P50 [%.2f] ms, P95 [%.2f] ms, max [%.2f] ms over [%d] frames"),
+				PhaseNames[PhaseIndex], ChunkIds.Num(), PhaseSeconds[PhaseIndex],
+				Histogram.GetPercentile(50.0) * 1000.0, Histogram.GetPercentile(95.0) * 1000.0, Histogram.GetMax() * 1000.0, Histogram.GetSamplesNum());
+		}
+
+		if (FailedMountsNum > 0)
+		{
+			DLC_LOG(Logging, Error, TEXT("[%d] mounts failed"), FailedMountsNum);
+		}
+	}
+
+	// - - - - - - - - - - - - -
+
+	FDLCPrioritiesBenchmark::FDLCPrioritiesBenchmark(const FName& InInstanceName, const TArray<FName>& InPackageNames, const int32 InForegroundPackagesNum)
+		: InstanceName(InInstanceName), PackageNames(InPackageNames), ForegroundPackagesNum(InForegroundPackagesNum) { }
+
+	void FDLCPrioritiesBenchmark::Run(const FName& InstanceName, const TArray<FName>& PackageNames, const int32 ForegroundPackagesNum)
+	{
+		check(IsInGameThread());
+
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ InstanceName };
+
+		if (ForegroundPackagesNum <= 0 || ForegroundPackagesNum >= PackageNames.Num())
+		{
+			DLC_LOG(Logging, Error, TEXT("Invalid foreground packages number [%d] of [%d] packages: background packages are required. Benchmark is not started"),
+				ForegroundPackagesNum, PackageNames.Num());
+			return;
+		}
+
+		const TSharedRef<FDLCPrioritiesBenchmark> Benchmark = MakeShareable(new FDLCPrioritiesBenchmark{ InstanceName, PackageNames, ForegroundPackagesNum });
+		Benchmark->Start();
+	}
+
+	void FDLCPrioritiesBenchmark::Start()
+	{
+		FDLCPackageManager& PackageManager = FDLCPackageManager::Get(InstanceName);
+
+		WhenReady(PackageManager.PackageManagerInitializationPromise->MakeFuture(), [This = AsShared()]()
+		{
+			using FDLCPackage = FDLCPackageManager::FDLCPackage;
+			using FChunk = FHackingType_ChunkDownloader::FChunk;
+
+			const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ This->InstanceName };
+
+			FDLCPackageManager& PackageManager = FDLCPackageManager::Get(This->InstanceName);
+
+			//NB: Downloads of instance would share ChunkDownloader queue with benchmarked ones
+			for (const EDLCLoadPriority Priority : { EDLCLoadPriority::Blocking, EDLCLoadPriority::VisibleSoon, EDLCLoadPriority::Prefetch })
+			{
+				if (PackageManager.DownloadScheduler->GetPendingChunksNum(Priority) > 0 || PackageManager.DownloadScheduler->GetInFlightChunksNum(Priority) > 0)
+				{
+					DLC_LOG(Logging, Error, TEXT("Instance is downloading chunks. Benchmark is not started"));
+					return;
+				}
+			}
+
+			const FHackingType_ChunkDownloader& ChunkDownloaderHacked = PackageManager.GetChunkDownloaderHackedAccess();
+			for (int32 PackageIndex = 0; PackageIndex < This->PackageNames.Num(); ++PackageIndex)
+			{
+				const FName& PackageName = This->PackageNames[PackageIndex];
+				const FDLCPackage* DLCPackage = PackageManager.FindDLCPackage(PackageName);
+				//NB: Cached pak files of pinned packages should be kept, so they are not evicted by benchmark
+				if (!DLCPackage || !DLCPackage->Status.IsType<FDLCPackage::FStatus_NotDownloaded>() || PackageManager.IsDLCPackagePinned(PackageName))
+				{
+					DLC_LOG(Logging, Warning, TEXT("Package [%s] is unknown, pinned, downloaded or requested. It is not benchmarked"), *PackageName.ToString());
+					continue;
+				}
+
+				const int32 ChunkId = DLCPackage->GetLatestVersionInfo().ChunkId;
+				const TSharedRef<FChunk>* Chunk = ChunkDownloaderHacked.Chunks.Find(ChunkId);
+				if (!Chunk || (*Chunk)->PakFiles.ContainsByPredicate([](const TSharedRef<FHackingType_ChunkDownloader::FPakFile>& PakFile) { return PakFile->bIsEmbedded; }))
+				{
+					DLC_LOG(Logging, Warning, TEXT("Chunk [%d] of package [%s] is not in manifest or is embedded. It is not benchmarked"), ChunkId, *PackageName.ToString());
+					continue;
+				}
+
+				if (!This->ForegroundChunkIds.Contains(ChunkId) && !This->BackgroundChunkIds.Contains(ChunkId))
+				{
+					(PackageIndex < This->ForegroundPackagesNum ? This->ForegroundChunkIds : This->BackgroundChunkIds).Add(ChunkId);
+				}
+			}
+
+			if (This->ForegroundChunkIds.Num() == 0 || This->BackgroundChunkIds.Num() == 0)
+			{
+				DLC_LOG(Logging, Error, TEXT("No foreground or background chunks. Benchmark is stopped"));
+				return;
+			}
+
+			DLC_LOG(Logging, StatusImportant, TEXT("Started downloading of [%d] foreground chunks under [%d] background chunks"),
+				This->ForegroundChunkIds.Num(), This->BackgroundChunkIds.Num());
+			This->StartPhase(0);
+		});
+	}
+
+	void FDLCPrioritiesBenchmark::StartPhase(const int32 InPhaseIndex)
+	{
+		PhaseIndex = InPhaseIndex;
+		if (PhaseIndex >= static_cast<int32>(EPhase::Num))
+		{
+			Finish();
+			return;
+		}
+
+		if (!EvictChunks())
+			return;
+
+		if (PhaseIndex == static_cast<int32>(EPhase::Scheduled))
+		{
+			//NB: Resumable downloads are disabled, so both phases differ only by order of downloads
+			const FDLCPackageManager& PackageManager = FDLCPackageManager::Get(InstanceName);
+			DownloadScheduler = MakeShared<FDLCDownloadScheduler, ESPMode::ThreadSafe>(PackageManager.ChunkDownloader.ToSharedRef(),
+				PackageManager.Settings.MaxConcurrentDownloads, MAX_uint64, PackageManager.Settings.MaxResumableDownloadConnections);
+		}
+
+		DownloadsLeft = ForegroundChunkIds.Num() + BackgroundChunkIds.Num();
+		BackgroundDownloadsLeft = BackgroundChunkIds.Num();
+		PhaseStartTime = FPlatformTime::Seconds();
+
+		const TSharedRef<FDLCPrioritiesBenchmark> This = AsShared();
+		for (const int32 ChunkId : BackgroundChunkIds)
+		{
+			RequestChunk(ChunkId, false, [This](const bool bSuccess)
+			{
+				--This->BackgroundDownloadsLeft;
+				This->OnChunkDownloaded(bSuccess);
+			});
+		}
+
+		RequestForegroundChunk(0);
+	}
+
+	bool FDLCPrioritiesBenchmark::EvictChunks()
+	{
+		using FDLCPackage = FDLCPackageManager::FDLCPackage;
+		using FPakFile = FHackingType_ChunkDownloader::FPakFile;
+
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ InstanceName };
+
+		FDLCPackageManager& PackageManager = FDLCPackageManager::Get(InstanceName);
+
+		//NB: Packages may be requested by game between phases. Their chunks are in use then
+		for (const FName& PackageName : PackageNames)
+		{
+			const FDLCPackage* DLCPackage = PackageManager.FindDLCPackage(PackageName);
+			if (DLCPackage && DLCPackage->Status.IsType<FDLCPackage::FStatus_DownloadingAndMounting>())
+			{
+				DLC_LOG(Logging, Error, TEXT("Package [%s] is requested. Benchmark is stopped"), *PackageName.ToString());
+				return false;
+			}
+		}
+
+		//NB: Same as "FDLCPackageManager::ApplyCacheEviction()", but files are deleted at once: they are downloaded again right after it
+		FHackingType_ChunkDownloader& ChunkDownloaderHacked = PackageManager.GetChunkDownloaderHackedAccess();
+		for (const TArray<int32>* ChunkIds : { &ForegroundChunkIds, &BackgroundChunkIds })
+		{
+			for (const int32 ChunkId : *ChunkIds)
+			{
+				for (const TSharedRef<FPakFile>& PakFile : ChunkDownloaderHacked.Chunks.FindChecked(ChunkId)->PakFiles)
+				{
+					if (PakFile->bIsMounted || PakFile->Download.IsValid())
+					{
+						DLC_LOG(Logging, Error, TEXT("Pak file [%s] is mounted or downloading. Benchmark is stopped"), *PakFile->Entry.FileName);
+						return false;
+					}
+
+					if (!PakFile->bIsCached)
+						continue;
+
+					PakFile->bIsCached = false;
+					PakFile->SizeOnDisk = 0;
+					ChunkDownloaderHacked.bNeedsManifestSave = true;
+
+					IFileManager::Get().Delete(*(ChunkDownloaderHacked.CacheFolder / PakFile->Entry.FileName), false, true, true);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	void FDLCPrioritiesBenchmark::RequestChunk(const int32 ChunkId, const bool bIsForeground, TFunction<void(bool)>&& OnFinished)
+	{
+		if (PhaseIndex == static_cast<int32>(EPhase::Unscheduled))
+		{
+			//NB: Every chunk was downloaded with the same priority before download scheduler
+			FDLCPackageManager::Get(InstanceName).ChunkDownloader->DownloadChunk(ChunkId, MoveTemp(OnFinished), 1);
+		}
+		else
+		{
+			DownloadScheduler->RequestChunk(ChunkId, bIsForeground ? EDLCLoadPriority::Blocking : EDLCLoadPriority::Prefetch, MoveTemp(OnFinished));
+		}
+	}
+
+	void FDLCPrioritiesBenchmark::RequestForegroundChunk(const int32 ForegroundChunkIndex)
+	{
+		if (ForegroundChunkIndex >= ForegroundChunkIds.Num())
+		{
+			PendingBackgroundDownloadsNums[PhaseIndex] = BackgroundDownloadsLeft;
+			return;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		RequestChunk(ForegroundChunkIds[ForegroundChunkIndex], true, [This = AsShared(), ForegroundChunkIndex, StartTime](const bool bSuccess)
+		{
+			This->ForegroundHistograms[This->PhaseIndex].AddSample(FPlatformTime::Seconds() - StartTime);
+			This->RequestForegroundChunk(ForegroundChunkIndex + 1);
+			This->OnChunkDownloaded(bSuccess);
+		});
+	}
+
+	void FDLCPrioritiesBenchmark::OnChunkDownloaded(const bool bSuccess)
+	{
+		FailedDownloadsNum += (bSuccess ? 0 : 1);
+		if (--DownloadsLeft > 0)
+			return;
+
+		PhaseSeconds[PhaseIndex] = FPlatformTime::Seconds() - PhaseStartTime;
+
+		//NB: Callback may be called by scheduler or ChunkDownloader that is iterating its downloads, so next phase is started later
+		AsyncTask(ENamedThreads::GameThread, [This = AsShared()]()
+		{
+			This->DownloadScheduler.Reset();
+			This->StartPhase(This->PhaseIndex + 1);
+		});
+	}
+
+	void FDLCPrioritiesBenchmark::Finish()
+	{
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ InstanceName };
+
+		static const TCHAR* const PhaseNames[] = { TEXT("Unscheduled"), TEXT("Scheduled") };
+		for (int32 Index = 0; Index < static_cast<int32>(EPhase::Num); ++Index)
+		{
+			const FDLCLatencyHistogram& Histogram = ForegroundHistograms[Index];
+			DLC_LOG(Logging, StatusImportant, TEXT("[%s] foreground latency of [%d] chunks: P50 [%.1f] ms, P95 [%.1f] ms, max [%.1f] ms. [%d] of [%d] background chunks were downloading after them, phase took [%.3f] s"),
+				PhaseNames[Index], Histogram.GetSamplesNum(), Histogram.GetPercentile(50.0) * 1000.0, Histogram.GetPercentile(95.0) * 1000.0, Histogram.GetMax() * 1000.0,
+				PendingBackgroundDownloadsNums[Index], BackgroundChunkIds.Num(), PhaseSeconds[Index]);
+
+			if (PendingBackgroundDownloadsNums[Index] == 0)
+			{
+				DLC_LOG(Logging, Warning, TEXT("[%s] background queue was drained before foreground chunks were downloaded: downloads are too fast or background chunks are too few"),
+					PhaseNames[Index]);
+			}
+		}
+
+		const double UnscheduledLatency = ForegroundHistograms[static_cast<int32>(EPhase::Unscheduled)].GetPercentile(50.0);
+		const double ScheduledLatency = ForegroundHistograms[static_cast<int32>(EPhase::Scheduled)].GetPercentile(50.0);
+		DLC_LOG(Logging, StatusImportant, TEXT("Foreground P50 latency with download scheduler is [%.1f] times lower"),
+			ScheduledLatency > 0.0 ? UnscheduledLatency / ScheduledLatency : 0.0);
+
+		if (FailedDownloadsNum > 0)
+		{
+			DLC_LOG(Logging, Error, TEXT("[%d] downloads failed"), FailedDownloadsNum);
+		}
+	}
+
+	// - - - - - - - - - - - - -
+
+	void FDLCCatalogBenchmark::Run(const FName& InstanceName, const TArray<int32>& EntriesNums, const int32 VersionsPerPackage, const int32 LookupsNum)
+	{
+		check(IsInGameThread());
+
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ InstanceName };
+
+		if (!FDLCPackageManager::HasInstance(InstanceName) || !FDLCPackageManager::Get(InstanceName).IsInitialized())
+		{
+			DLC_LOG(Logging, Error, TEXT("Instance is not initialized. Benchmark is not started"));
+			return;
+		}
+
+		FDLCPackageManager& PackageManager = FDLCPackageManager::Get(InstanceName);
+		const TArray<FDLCCatalogEntry> NoCatalogEntries;
+
+		for (const int32 EntriesNum : EntriesNums)
+		{
+			TArray<FString> DLCChunkIDs;
+			DLCChunkIDs.Reserve(EntriesNum);
+			for (int32 EntryIndex = 0; EntryIndex < EntriesNum; ++EntryIndex)
+			{
+				DLCChunkIDs.Add(FString::Printf(TEXT("CatalogBenchmark%d_1.%d.0"), EntryIndex / VersionsPerPackage, EntryIndex % VersionsPerPackage));
+			}
+
+			static const TCHAR* const ParsingNames[] = { TEXT("Legacy"), TEXT("Current") };
+			for (int32 ParsingIndex = 0; ParsingIndex < UE_ARRAY_COUNT(ParsingNames); ++ParsingIndex)
+			{
+				//NB: Packages of previous catalog are reused by catalog building, so they are dropped before measurement
+				PackageManager.Initialize_PackagesInfo_Apply(++PackageManager.LastCatalogBuildNumber, NoCatalogEntries);
+
+				const double ParsingStartTime = FPlatformTime::Seconds();
+
+				TArray<FDLCCatalogEntry> CatalogEntries;
+				CatalogEntries.Reserve(EntriesNum);
+				for (int32 EntryIndex = 0; EntryIndex < EntriesNum; ++EntryIndex)
+				{
+					const int32 ChunkId = -(EntryIndex + 1);
+					TOptional<FDLCCatalogEntry> CatalogEntry = (ParsingIndex == 0) ?
+						ParseCatalogEntry_Legacy(DLCChunkIDs[EntryIndex], ChunkId) :
+						FDLCPackageManager_Private::ParseCatalogEntry(DLCChunkIDs[EntryIndex], ChunkId);
+
+					if (CatalogEntry.IsSet())
+					{
+						CatalogEntries.Add(CatalogEntry.GetValue());
+					}
+				}
+
+				const double ApplyingStartTime = FPlatformTime::Seconds();
+				PackageManager.Initialize_PackagesInfo_Apply(++PackageManager.LastCatalogBuildNumber, CatalogEntries);
+				const double EndTime = FPlatformTime::Seconds();
+
+				const double ParsingSeconds = ApplyingStartTime - ParsingStartTime;
+				const double ApplyingSeconds = EndTime - ApplyingStartTime;
+
+				DLC_LOG(Logging, StatusImportant, TEXT("[%s] catalog of [%d] entries, [%d] packages: parsed in [%.3f] ms ([%.1f] ns per entry), applied in [%.3f] ms ([%.1f] ns per entry), total [%.3f] ms"),
+					ParsingNames[ParsingIndex], EntriesNum, PackageManager.DLCPackages.Num(),
+					ParsingSeconds * 1e3, ParsingSeconds * 1e9 / EntriesNum, ApplyingSeconds * 1e3, ApplyingSeconds * 1e9 / EntriesNum, (ParsingSeconds + ApplyingSeconds) * 1e3);
+			}
+
+			//NB: Catalog of current parsing is applied last, so lookups are measured in it
+			MeasureLookups(PackageManager, LookupsNum);
+		}
+
+		PackageManager.Initialize_PackagesInfo();
+	}
+
+	void FDLCCatalogBenchmark::MeasureLookups(FDLCPackageManager& PackageManager, const int32 LookupsNum)
+	{
+		using FDLCPackage = FDLCPackageManager::FDLCPackage;
+
+		const FDLCPackageManager_Debug::FLogging_Benchmark Logging{ PackageManager.InstanceName };
+
+		// Catalog as it was stored before hashing: packages array that is scanned with comparison of name strings
+		struct FLegacyPackage
+		{
+			FString Name;
+			TSharedPtr<FDLCPackage> Package;
+		};
+		TArray<FLegacyPackage> LegacyPackages;
+		LegacyPackages.Reserve(PackageManager.DLCPackages.Num());
+		for (const TPair<FName, TSharedPtr<FDLCPackage>>& DLCPackage : PackageManager.DLCPackages)
+		{
+			LegacyPackages.Add({ DLCPackage.Key.ToString(), DLCPackage.Value });
+		}
+
+		if (LegacyPackages.Num() == 0)
+			return;
+
+		//NB: Same random packages are looked up by every kind of lookup
+		FRandomStream RandomStream{ 0 };
+		TArray<FString> LookupNames;
+		TArray<FName> LookupFNames;
+		LookupNames.Reserve(LookupsNum);
+		LookupFNames.Reserve(LookupsNum);
+		for (int32 LookupIndex = 0; LookupIndex < LookupsNum; ++LookupIndex)
+		{
+			const FLegacyPackage& LegacyPackage = LegacyPackages[RandomStream.RandHelper(LegacyPackages.Num())];
+			LookupNames.Add(LegacyPackage.Name);
+			LookupFNames.Add(LegacyPackage.Package->Name);
+		}
+
+		// Sums of found chunk ids keep lookups from being optimized out and show that every kind of lookup finds same packages
+		int64 ChunkIdsSums[3] = { 0, 0, 0 };
+
+		const int32 LegacyLookupsNum = FMath::Min(LookupsNum, MaxLegacyLookupsNum);
+		const double LegacyStartTime = FPlatformTime::Seconds();
+		for (int32 LookupIndex = 0; LookupIndex < LegacyLookupsNum; ++LookupIndex)
+		{
+			const FString& LookupName = LookupNames[LookupIndex];
+			const FLegacyPackage* LegacyPackage = LegacyPackages.FindByPredicate([&LookupName](const FLegacyPackage& Package) { return Package.Name == LookupName; });
+			if (LegacyPackage)
+			{
+				ChunkIdsSums[0] += Algo::MaxElementBy(LegacyPackage->Package->VersionInfos, &FDLCPackage::FVersionInfo::VersionKey)->ChunkId;
+			}
+		}
+		const double NameStartTime = FPlatformTime::Seconds();
+		for (int32 LookupIndex = 0; LookupIndex < LookupsNum; ++LookupIndex)
+		{
+			if (const FDLCPackage* DLCPackage = PackageManager.FindDLCPackage(LookupFNames[LookupIndex]))
+			{
+				ChunkIdsSums[1] += DLCPackage->GetLatestVersionInfo().ChunkId;
+			}
+		}
+		const double StringStartTime = FPlatformTime::Seconds();
+		for (int32 LookupIndex = 0; LookupIndex < LookupsNum; ++LookupIndex)
+		{
+			if (const FDLCPackage* DLCPackage = PackageManager.FindDLCPackage(FStringView{ LookupNames[LookupIndex] }))
+			{
+				ChunkIdsSums[2] += DLCPackage->GetLatestVersionInfo().ChunkId;
+			}
+		}
+		const double EndTime = FPlatformTime::Seconds();
+
+		const double LegacyLookupNanoseconds = (NameStartTime - LegacyStartTime) * 1e9 / LegacyLookupsNum;
+		const double NameLookupNanoseconds = (StringStartTime - NameStartTime) * 1e9 / LookupsNum;
+		const double StringLookupNanoseconds = (EndTime - StringStartTime) * 1e9 / LookupsNum;
+
+		DLC_LOG(Logging, StatusImportant, TEXT("Lookups in catalog of [%d] packages: legacy [%.1f] ns ([%d] lookups), name [%.1f] ns, string [%.1f] ns ([%d] lookups). Legacy is [%.1f] times slower than name"),
+			LegacyPackages.Num(), LegacyLookupNanoseconds, LegacyLookupsNum, NameLookupNanoseconds, StringLookupNanoseconds, LookupsNum,
+			NameLookupNanoseconds > 0.0 ? LegacyLookupNanoseconds / NameLookupNanoseconds : 0.0);
+
+		//NB: Legacy lookups are limited, so their sum is compared only if all lookups were made
+		if ((LegacyLookupsNum == LookupsNum && ChunkIdsSums[0] != ChunkIdsSums[1]) || ChunkIdsSums[1] != ChunkIdsSums[2])
+		{
+			DLC_LOG(Logging, Error, TEXT("Lookups found different packages: chunk ids sums [%lld], [%lld], [%lld]"), ChunkIdsSums[0], ChunkIdsSums[1], ChunkIdsSums[2]);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DLCPackageManagerMetrics.h"
+
+#if WITH_DLC_PAK_TOOLS
+
+class FDLCPackageManager;
+
+namespace DLCPackageManagerPrivate
+{
+	class FDLCMountScheduler;
+	class FDLCDownloadScheduler;
+
+	// Counts heap allocations made by the game thread while counter is alive. Global allocator is wrapped by counting proxy
+	// on first use and stays wrapped: proxy forwards every call, so blocks allocated before wrapping are freed correctly
+	class FDLCAllocationsCounter
+	{
+	public:
+		FDLCAllocationsCounter();
+		~FDLCAllocationsCounter();
+
+		uint64 GetAllocationsNum() const;
+
+	private:
+		uint64 StartAllocationsNum = 0;
+	};
+
+	// - - - - - - - - - - - - -
+
+	// Micro-benchmarks are started by other console commands:
+	//   DLC.Benchmark.ResolvedPath Instance=<instance name> Path=<soft object path> [Iterations=<number>]
+	//     Time and game thread allocations of "GetLoadedPath()" of already loaded object, compared with
+	//     allocating ready future per call as it was made before ready states were shared
+	//   DLC.Benchmark.ResolvedPathsCache [Paths=<number>] [HotPaths=<number>] [HotPercent=<percent>] [Lookups=<number>] [Capacity=<number>]
+	//     Time and game thread allocations per path of DLC path classification, compared with classification by temporary strings
+	//     as it was made before. Then time per lookup and hit rate of resolved paths cache with LRU eviction, compared with cache
+	//     that is reset on overflow as it was made before. Lookups of synthetic paths mix hot paths with scans of cold ones
+	//   DLC.Benchmark.LatentActions [Actions=<number>] [Frames=<number>]
+	//     Frame times while many latent actions are waiting: without actions, with actions polled every frame and
+	//     with actions added to latent action manager by continuations of futures
+	//   DLC.Benchmark.Pipelines [Path=<soft object path>] [Requests=<number>]
+	//     Latency and game thread allocations per request of synthetic three-stage loading pipeline: nested continuations as
+	//     it was made before shared request state, shared request state of "GetLoadedPath()" and coroutine awaiting stages by
+	//     "DLCAwait()". Coroutine pipeline is measured only if "WITH_DLC_COROUTINES" is set (see "DLCPackageManagerCoroutines.h")
+	//   DLC.Benchmark.Mounts Instance=<instance name> PackagesFile=<file with DLC package name per line>
+	//     Frame times while many downloaded chunks are mounted at once (see "FDLCMountsBenchmark")
+	//   DLC.Benchmark.Priorities Instance=<instance name> PackagesFile=<file with DLC package name per line> [Foreground=<number>]
+	//     Latency of foreground downloads under saturated background downloads, with and without download scheduler (see "FDLCPrioritiesBenchmark")
+	//   DLC.Benchmark.Catalog Instance=<instance name> [Entries=<number>[,<number>...]] [VersionsPerPackage=<number>] [Lookups=<number>]
+	//     Catalog building of synthetic entries by package manager and cost of package lookups by catalog size (see "FDLCCatalogBenchmark")
+	// End-to-end latency benchmark of package manager. Started by console command:
+	//   DLC.Benchmark Instance=<instance name> (PathsFile=<file with soft object path per line> | PackagesFile=<file with DLC package name per line>)
+	//     [Output=<results .json>] [Concurrency=<requests>] [CleanCache]
+	// Benchmark has two modes:
+	//   Objects          - "PathsFile" is passed. Objects of cooked DLC content are requested by "FDLCPackageManager::GetLoadedPath()",
+	//                      so downloading, mounting and loading are measured. Phases:
+	//     ColdStart  - first request of new instance: manifest, downloading, mounting and loading
+	//     ColdCache  - sequential requests of other paths: downloading, mounting and loading
+	//     WarmCache  - sequential requests after release and garbage collection: mounting and loading
+	//     Mounted    - sequential repeated requests of held paths
+	//     Concurrent - all concurrent requests issued at once after release and garbage collection
+	//   DownloadAndMount - "PackagesFile" is passed. Packages are requested by "FDLCPackageManager::PreloadDLCPackages()", objects
+	//                      are not loaded. Packages generated by "GenerateCDN" mode of "UDLCPakToolsCommandlet" have no cooked
+	//                      objects, so they are benchmarked in this mode. Preloaded packages have no users and are not unmounted, so phases are:
+	//     ColdStart  - first request of new instance: manifest, downloading and mounting
+	//     ColdCache  - sequential requests of first half of other packages: downloading and mounting
+	//     Concurrent - concurrent requests of second half of packages issued at once: downloading and mounting
+	//     Mounted    - sequential repeated requests of all packages
+	// Frame times are sampled while concurrent requests are in flight, so hitches are visible in "FrameTime" results.
+	// Results are written as JSON, metrics of instance are written next to them as "<Output>.metrics.json".
+	// Cache folder of instance is deleted before cold start only if "CleanCache" is passed and instance has own cache folder:
+	// "CacheFolder" setting or default subfolder of instance other than default one
+	class FDLCBenchmark : public TSharedFromThis<FDLCBenchmark>
+	{
+	public:
+		struct FParams
+		{
+			FName InstanceName;
+			// One of paths and package names is set. It selects mode of benchmark
+			TArray<FSoftObjectPath> SoftObjectPaths;
+			TArray<FName> PackageNames;
+			int32 ConcurrentRequestsNum = 64;
+			FString OutputFilePath;
+			bool bCleanCache = false;
+		};
+
+		// Game thread only. Benchmark keeps itself alive until results are written
+		static void Run(const FParams& Params);
+
+	private:
+		explicit FDLCBenchmark(const FParams& InParams);
+
+		bool IsDownloadAndMountMode() const { return Params.PackageNames.Num() > 0; }
+		int32 GetItemsNum() const;
+
+		void Start();
+		void StartObjectsPhases();
+		void StartDownloadAndMountPhases();
+
+		// Requests object or package by index. Loaded objects are held until release
+		void RequestItem(const int32 ItemIndex, TFunction<void(bool)>&& OnFinished);
+		void RequestSequentially(const int32 ItemIndex, const int32 EndItemIndex, FDLCLatencyHistogram& Histogram, TFunction<void()>&& OnFinished);
+		// Requests items of range in round robin order
+		void RequestConcurrently(const int32 BeginItemIndex, const int32 EndItemIndex, const int32 RequestsNum, TFunction<void()>&& OnFinished);
+		void ReleaseAndCollectGarbage(TFunction<void()>&& OnFinished);
+		void Finish();
+
+		bool SampleFrameTime(float DeltaTime);
+
+		FString ToJson() const;
+
+		const FParams Params;
+
+		// Instance did not exist before benchmark, so first request includes its initialization
+		bool bIsColdInstance = false;
+
+		// Every finished request of object keeps its package used until release
+		TArray<FSoftObjectPath> HeldPaths;
+		int32 FailedRequestsNum = 0;
+
+		FDLCLatencyHistogram ColdStartHistogram;
+		FDLCLatencyHistogram ColdCacheHistogram;
+		FDLCLatencyHistogram WarmCacheHistogram;
+		FDLCLatencyHistogram MountedHistogram;
+		FDLCLatencyHistogram ConcurrentHistogram;
+
+		int32 ConcurrentRequestsNum = 0;
+		double ConcurrentSeconds = 0.0;
+		int32 ConcurrentRequestsLeft = 0;
+
+		FDLCLatencyHistogram FrameTimeHistogram;
+		FDelegateHandle FrameTimeTickerHandle;
+	};
+
+	// - - - - - - - - - - - - -
+
+	// Hitches of mounting of many downloaded chunks during gameplay. Packages are preloaded, then their chunks are unmounted
+	// and mounted again at once in two phases:
+	//   Direct    - chunks are mounted by ChunkDownloader, as it was made before mount scheduler
+	//   Scheduled - chunks are requested from mount scheduler with limits of instance settings
+	// Frame times are sampled from start of mounting until all mounts are finished. Chunks stay mounted after every phase,
+	// so package manager state is not changed by benchmark. Pak files unmounting should be supported by platform
+	class FDLCMountsBenchmark : public TSharedFromThis<FDLCMountsBenchmark>
+	{
+	public:
+		// Game thread only. Benchmark keeps itself alive until results are logged
+		static void Run(const FName& InstanceName, const TArray<FName>& PackageNames);
+
+	private:
+		enum class EPhase : int32 { Direct, Scheduled, Num };
+
+		FDLCMountsBenchmark(const FName& InInstanceName, const TArray<FName>& InPackageNames);
+
+		void Start();
+		void StartPhase(const int32 PhaseIndex);
+		bool UnmountChunks();
+		void OnChunkMounted(const bool bSuccess);
+		void Finish();
+
+		bool SampleFrameTime(float DeltaTime, const int32 PhaseIndex);
+
+		const FName InstanceName;
+		const TArray<FName> PackageNames;
+
+		TArray<int32> ChunkIds;
+		TSharedPtr<FDLCMountScheduler, ESPMode::ThreadSafe> MountScheduler;
+
+		int32 MountsLeft = 0;
+		int32 FailedMountsNum = 0;
+		double PhaseStartTime = 0.0;
+
+		double PhaseSeconds[static_cast<int32>(EPhase::Num)] = { };
+		FDLCLatencyHistogram FrameTimeHistograms[static_cast<int32>(EPhase::Num)];
+	};
+
+	// - - - - - - - - - - - - -
+
+	// Latency of foreground downloads while background queue is saturated. First packages of list are foreground ones, the rest
+	// are background ones. Cached pak files of latest versions of packages are evicted before every phase, then all background
+	// chunks are requested at once and foreground chunks are requested one by one while background ones are downloading:
+	//   Unscheduled - all chunks are downloaded by ChunkDownloader with the same priority, as it was made before download scheduler
+	//   Scheduled   - background chunks are requested from download scheduler as "Prefetch", foreground ones - as "Blocking"
+	// Both phases download by ChunkDownloader with limits of instance settings, resumable downloads are not used.
+	// Downloads should be slow enough to keep background queue busy, e.g. CDN served by "ServeCDN" mode of "UDLCPakToolsCommandlet"
+	// with "-BandwidthKBps". Only packages that are not downloaded and not requested are benchmarked, they stay not mounted after it
+	class FDLCPrioritiesBenchmark : public TSharedFromThis<FDLCPrioritiesBenchmark>
+	{
+	public:
+		// Game thread only. Benchmark keeps itself alive until results are logged
+		static void Run(const FName& InstanceName, const TArray<FName>& PackageNames, const int32 ForegroundPackagesNum);
+
+	private:
+		enum class EPhase : int32 { Unscheduled, Scheduled, Num };
+
+		FDLCPrioritiesBenchmark(const FName& InInstanceName, const TArray<FName>& InPackageNames, const int32 InForegroundPackagesNum);
+
+		void Start();
+		void StartPhase(const int32 InPhaseIndex);
+		bool EvictChunks();
+		void RequestChunk(const int32 ChunkId, const bool bIsForeground, TFunction<void(bool)>&& OnFinished);
+		void RequestForegroundChunk(const int32 ForegroundChunkIndex);
+		void OnChunkDownloaded(const bool bSuccess);
+		void Finish();
+
+		const FName InstanceName;
+		const TArray<FName> PackageNames;
+		const int32 ForegroundPackagesNum;
+
+		TArray<int32> ForegroundChunkIds;
+		TArray<int32> BackgroundChunkIds;
+		TSharedPtr<FDLCDownloadScheduler, ESPMode::ThreadSafe> DownloadScheduler;
+
+		int32 PhaseIndex = 0;
+		int32 DownloadsLeft = 0;
+		int32 BackgroundDownloadsLeft = 0;
+		int32 FailedDownloadsNum = 0;
+		double PhaseStartTime = 0.0;
+
+		double PhaseSeconds[static_cast<int32>(EPhase::Num)] = { };
+		// Background chunks that were still downloading when foreground chunks were finished
+		int32 PendingBackgroundDownloadsNums[static_cast<int32>(EPhase::Num)] = { };
+		FDLCLatencyHistogram ForegroundHistograms[static_cast<int32>(EPhase::Num)];
+	};
+
+	// - - - - - - - - - - - - -
+
+	// Catalog building of synthetic manifest entries by initialized package manager. For every entries number catalog is built twice,
+	// both times by "FDLCPackageManager::Initialize_PackagesInfo_Apply()" on the game thread:
+	//   Legacy  - DLC chunk ids are parsed by string splitting and version members arrays, as it was made before string views
+	//   Current - DLC chunk ids are parsed by "FDLCPackageManager_Private::ParseCatalogEntry()"
+	// After that random packages of built catalog are looked up with their latest versions, so scaling of lookup cost with catalog size
+	// is visible across entries numbers:
+	//   Legacy  - linear scan of packages array with string comparison of names and search of latest version, as it was made before hashing
+	//   Name    - "FDLCPackageManager::FindDLCPackage()" by name and latest version resolved during catalog building
+	//   String  - same as "Name", but package name is passed as string view and is looked up in name table first
+	// Legacy lookups are limited, because their cost grows with catalog size.
+	// Synthetic entries have negative chunk ids, so they never match cached pak files. Packages in use are kept by catalog
+	// building as for changed manifest. Catalog of instance manifest is built again after benchmark
+	class FDLCCatalogBenchmark
+	{
+	public:
+		// Game thread only
+		static void Run(const FName& InstanceName, const TArray<int32>& EntriesNums, const int32 VersionsPerPackage, const int32 LookupsNum);
+
+	private:
+		static constexpr int32 MaxLegacyLookupsNum = 1000;
+
+		static void MeasureLookups(FDLCPackageManager& PackageManager, const int32 LookupsNum);
+	};
+}
+
+#endif
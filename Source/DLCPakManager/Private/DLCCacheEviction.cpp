@@ -0,0 +1,50 @@
+#include "DLCCacheEviction.h"
+#include "DLCPackageManagerTrace.h"
+
+namespace DLCPackageManagerPrivate
+{
+	TArray<int32> SelectEvictedCandidates(const TArray<FDLCCacheEvictionCandidate>& Candidates, const uint64 UsedBytes, const uint64 BudgetBytes)
+	{
+		DLC_TRACE_CPU_SCOPE(DLC_SelectEvictedCandidates);
+
+		TArray<int32> Result;
+		uint64 RemainingBytes = UsedBytes;
+
+		auto Evict = [&Result, &RemainingBytes, &Candidates](const int32 CandidateIndex)
+		{
+			Result.Add(CandidateIndex);
+			RemainingBytes -= FMath::Min(RemainingBytes, Candidates[CandidateIndex].SizeOnDisk);
+		};
+
+		TArray<int32> ColdCandidateIndices;
+
+		for (int32 CandidateIndex = 0; CandidateIndex < Candidates.Num(); ++CandidateIndex)
+		{
+			if (Candidates[CandidateIndex].bSuperseded)
+			{
+				Evict(CandidateIndex);
+				continue;
+			}
+
+			ColdCandidateIndices.Add(CandidateIndex);
+		}
+
+		if (BudgetBytes == 0 || RemainingBytes <= BudgetBytes)
+			return Result;
+
+		ColdCandidateIndices.Sort([&Candidates](const int32 Left, const int32 Right)
+		{
+			return Candidates[Left].LastAccessTime < Candidates[Right].LastAccessTime;
+		});
+
+		for (const int32 CandidateIndex : ColdCandidateIndices)
+		{
+			if (RemainingBytes <= BudgetBytes)
+				break;
+
+			Evict(CandidateIndex);
+		}
+
+		return Result;
+	}
+}
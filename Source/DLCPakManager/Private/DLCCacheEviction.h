@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace DLCPackageManagerPrivate
+{
+	// Cached pak file that is not mounted, not downloading and does not belong to pinned package
+	struct FDLCCacheEvictionCandidate
+	{
+		FString FileName;
+		FString FilePath;
+		uint64 SizeOnDisk = 0;
+
+		FName PackageName;
+		int32 ChunkId = INDEX_NONE;
+
+		// Pak file of package version that is not the latest one in catalog
+		bool bSuperseded = false;
+
+		// Latest request of package recorded by access history. "FDateTime::MinValue()" if package was never requested
+		FDateTime LastAccessTime = FDateTime::MinValue();
+	};
+
+	// Selects all superseded candidates and then least recently used ones until used bytes fit the budget.
+	// Zero budget means unlimited cache
+	TArray<int32> SelectEvictedCandidates(const TArray<FDLCCacheEvictionCandidate>& Candidates, const uint64 UsedBytes, const uint64 BudgetBytes);
+}
@@ -0,0 +1,134 @@
+#include "DLCCatalogSnapshot.h"
+#include "DLCPackageManagerTrace.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+
+namespace DLCPackageManagerPrivate
+{
+	const FString FDLCCatalogSnapshot::FilePostfix = TEXT(".catalog");
+
+	bool FDLCCatalogSnapshot::Save(const FString& FilePath, const FString& ManifestHash, const int32 PakFilesNum, const TArray<FDLCCatalogEntry>& Entries)
+	{
+		DLC_TRACE_CPU_SCOPE(DLC_SaveCatalogSnapshot);
+
+		if (ManifestHash.Len() != ManifestHashLength)
+			return false;
+
+		TArray<FEntry> SnapshotEntries;
+		SnapshotEntries.Reserve(Entries.Num());
+
+		TMap<FName, int32> NameIndices;
+		TArray<FNameRecord> NameRecords;
+		TArray<ANSICHAR> Names;
+
+		for (const FDLCCatalogEntry& Entry : Entries)
+		{
+			int32& NameIndex = NameIndices.FindOrAdd(Entry.PackageName, INDEX_NONE);
+			if (NameIndex == INDEX_NONE)
+			{
+				const FTCHARToUTF8 Name{ *Entry.PackageName.ToString() };
+
+				NameIndex = NameRecords.Add(FNameRecord{ Names.Num(), Name.Length() });
+				Names.Append(Name.Get(), Name.Length());
+			}
+
+			SnapshotEntries.Add(FEntry{ Entry.VersionKey, Entry.ChunkId, NameIndex });
+		}
+
+		FHeader Header;
+		Header.Magic = Magic;
+		Header.FormatVersion = FormatVersion;
+		FMemory::Memcpy(Header.ManifestHash, TCHAR_TO_ANSI(*ManifestHash), ManifestHashLength);
+		Header.PakFilesNum = PakFilesNum;
+		Header.EntriesNum = SnapshotEntries.Num();
+		Header.NamesNum = NameRecords.Num();
+		Header.NamesBytes = Names.Num();
+
+		TArray<uint8> Data;
+		Data.Reserve(sizeof(FHeader) + SnapshotEntries.Num() * sizeof(FEntry) + NameRecords.Num() * sizeof(FNameRecord) + Names.Num());
+		Data.Append(reinterpret_cast<const uint8*>(&Header), sizeof(FHeader));
+		Data.Append(reinterpret_cast<const uint8*>(SnapshotEntries.GetData()), SnapshotEntries.Num() * sizeof(FEntry));
+		Data.Append(reinterpret_cast<const uint8*>(NameRecords.GetData()), NameRecords.Num() * sizeof(FNameRecord));
+		Data.Append(reinterpret_cast<const uint8*>(Names.GetData()), Names.Num());
+
+		return FFileHelper::SaveArrayToFile(Data, *FilePath);
+	}
+
+	TOptional<TArray<FDLCCatalogEntry>> FDLCCatalogSnapshot::Load(const FString& FilePath, const FString& ManifestHash, const int32 PakFilesNum)
+	{
+		DLC_TRACE_CPU_SCOPE(DLC_LoadCatalogSnapshot);
+
+		if (ManifestHash.Len() != ManifestHashLength)
+			return { };
+
+		//NB: Region is declared after file handle, so it is unmapped before file is closed
+		const TUniquePtr<IMappedFileHandle> MappedFile{ FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath) };
+		const TUniquePtr<IMappedFileRegion> MappedRegion{ MappedFile.IsValid() ? MappedFile->MapRegion() : nullptr };
+
+		if (MappedRegion.IsValid())
+			return Parse(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize(), ManifestHash, PakFilesNum);
+
+		// Platform does not support file mapping
+		TArray<uint8> Data;
+		if (!FFileHelper::LoadFileToArray(Data, *FilePath, FILEREAD_Silent))
+			return { };
+
+		return Parse(Data.GetData(), Data.Num(), ManifestHash, PakFilesNum);
+	}
+
+	TOptional<TArray<FDLCCatalogEntry>> FDLCCatalogSnapshot::Parse(const uint8* Data, const int64 Bytes, const FString& ManifestHash, const int32 PakFilesNum)
+	{
+		if (Bytes < static_cast<int64>(sizeof(FHeader)))
+			return { };
+
+		FHeader Header;
+		FMemory::Memcpy(&Header, Data, sizeof(FHeader));
+
+		if (Header.Magic != Magic || Header.FormatVersion != FormatVersion || Header.PakFilesNum != PakFilesNum ||
+			FMemory::Memcmp(Header.ManifestHash, TCHAR_TO_ANSI(*ManifestHash), ManifestHashLength) != 0)
+			return { };
+
+		if (Header.EntriesNum < 0 || Header.NamesNum < 0 || Header.NamesBytes < 0)
+			return { };
+
+		const int64 EntriesOffset = sizeof(FHeader);
+		const int64 NameRecordsOffset = EntriesOffset + static_cast<int64>(Header.EntriesNum) * sizeof(FEntry);
+		const int64 NamesOffset = NameRecordsOffset + static_cast<int64>(Header.NamesNum) * sizeof(FNameRecord);
+
+		//NB: Snapshot that was not fully written has other size
+		if (NamesOffset + Header.NamesBytes != Bytes)
+			return { };
+
+		const FEntry* Entries = reinterpret_cast<const FEntry*>(Data + EntriesOffset);
+		const FNameRecord* NameRecords = reinterpret_cast<const FNameRecord*>(Data + NameRecordsOffset);
+		const ANSICHAR* Names = reinterpret_cast<const ANSICHAR*>(Data + NamesOffset);
+
+		// Every package name is converted to name once
+		TArray<FName> PackageNames;
+		PackageNames.Reserve(Header.NamesNum);
+		for (int32 NameIndex = 0; NameIndex < Header.NamesNum; ++NameIndex)
+		{
+			const FNameRecord& NameRecord = NameRecords[NameIndex];
+			if (NameRecord.Offset < 0 || NameRecord.Length <= 0 || NameRecord.Offset + NameRecord.Length > Header.NamesBytes)
+				return { };
+
+			const FUTF8ToTCHAR Name{ Names + NameRecord.Offset, NameRecord.Length };
+			PackageNames.Add(FName{ Name.Length(), Name.Get() });
+		}
+
+		TArray<FDLCCatalogEntry> Result;
+		Result.Reserve(Header.EntriesNum);
+		for (int32 EntryIndex = 0; EntryIndex < Header.EntriesNum; ++EntryIndex)
+		{
+			const FEntry& Entry = Entries[EntryIndex];
+			if (!PackageNames.IsValidIndex(Entry.NameIndex))
+				return { };
+
+			Result.Add(FDLCCatalogEntry{ PackageNames[Entry.NameIndex], Entry.VersionKey, Entry.ChunkId });
+		}
+
+		return Result;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DLCPackageManager_Private.h"
+
+namespace DLCPackageManagerPrivate
+{
+	// Binary snapshot of catalog entries parsed from build manifest. It is saved next to cached manifest as
+	// "<Manifest>.catalog" and is valid only for manifest with same content hash and pak files number, so catalog
+	// of unchanged manifest is built without parsing of DLC chunk ids. Snapshot is memory-mapped if platform supports it.
+	// File layout (native byte order, rejected by magic otherwise):
+	//   FHeader
+	//   FEntry[EntriesNum]
+	//   FNameRecord[NamesNum]
+	//   Package names in UTF-8, referenced by name records
+	struct FDLCCatalogSnapshot
+	{
+		static const FString FilePostfix;
+
+		// Changed whenever layout or parsing rules of catalog entries are changed
+		static constexpr uint32 FormatVersion = 1;
+
+		// Blocking calls, so they may be made off the game thread
+		static bool Save(const FString& FilePath, const FString& ManifestHash, const int32 PakFilesNum, const TArray<FDLCCatalogEntry>& Entries);
+		// Returns unset if there is no valid snapshot for the manifest
+		static TOptional<TArray<FDLCCatalogEntry>> Load(const FString& FilePath, const FString& ManifestHash, const int32 PakFilesNum);
+
+	private:
+		static constexpr uint32 Magic = 0x544C4344; // "DCLT"
+		static constexpr int32 ManifestHashLength = 32;
+
+		struct FHeader
+		{
+			uint32 Magic;
+			uint32 FormatVersion;
+			ANSICHAR ManifestHash[ManifestHashLength];
+			int32 PakFilesNum;
+			int32 EntriesNum;
+			int32 NamesNum;
+			int32 NamesBytes;
+		};
+
+		struct FEntry
+		{
+			uint64 VersionKey;
+			int32 ChunkId;
+			int32 NameIndex;
+		};
+
+		struct FNameRecord
+		{
+			int32 Offset;
+			int32 Length;
+		};
+
+		static TOptional<TArray<FDLCCatalogEntry>> Parse(const uint8* Data, const int64 Bytes, const FString& ManifestHash, const int32 PakFilesNum);
+	};
+}
@@ -0,0 +1,92 @@
+#include "DLCDeltaDownload.h"
+#include "DLCDeltaPatch.h"
+#include "DLCPackageManager_Debug.h"
+
+#include "Async/Async.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpResponse.h"
+
+namespace DLCPackageManagerPrivate
+{
+	FDLCDeltaDownload::FDLCDeltaDownload(FParams&& InParams, FCallback&& InCallback)
+		: Params(MoveTemp(InParams)), Callback(MoveTemp(InCallback))
+	{
+		check(Params.Urls.Num() > 0);
+	}
+
+	void FDLCDeltaDownload::Start()
+	{
+		RequestPatch();
+	}
+
+	void FDLCDeltaDownload::RequestPatch()
+	{
+		LastUrl = Params.Urls[UrlIndex];
+
+		const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+		Request->SetURL(LastUrl);
+		Request->SetVerb(TEXT("GET"));
+		Request->OnProcessRequestComplete().BindLambda([This = AsShared()](FHttpRequestPtr, FHttpResponsePtr Response, bool bSucceeded)
+		{
+			This->OnPatchResponse(Response, bSucceeded);
+		});
+
+		Request->ProcessRequest();
+	}
+
+	void FDLCDeltaDownload::OnPatchResponse(FHttpResponsePtr Response, const bool bSucceeded)
+	{
+		FDLCPackageManager_Debug::FLogging_DeltaPatch Logging{ Params.TargetFilePath };
+
+		LastHttpStatus = Response.IsValid() ? Response->GetResponseCode() : 0;
+
+		if (!bSucceeded || LastHttpStatus != EHttpResponseCodes::Ok)
+		{
+			//NB: Missing patch is expected, not every pair of versions has it
+			DLC_LOG(Logging, Status, TEXT("No patch at [%s], response [%d]"), *LastUrl, LastHttpStatus);
+
+			if (++UrlIndex < Params.Urls.Num() && LastHttpStatus != EHttpResponseCodes::NotFound)
+			{
+				RequestPatch();
+				return;
+			}
+
+			Finish(false);
+			return;
+		}
+
+		ReceivedBytes = Response->GetContent().Num();
+
+		//NB: Response keeps content, so it is passed to worker instead of content copy
+		Async(EAsyncExecution::ThreadPool, [This = AsShared(), Response]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			const bool bApplied = FDLCDeltaPatch::Apply(This->Params.BaseFilePath, Response->GetContent(), This->Params.TargetFilePath, This->Params.TargetFileSize);
+			const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+			AsyncTask(ENamedThreads::GameThread, [This, bApplied, Seconds]()
+			{
+				This->ReconstructionSeconds = Seconds;
+				This->Finish(bApplied);
+			});
+		});
+	}
+
+	void FDLCDeltaDownload::Finish(const bool bSuccess)
+	{
+		FDLCPackageManager_Debug::FLogging_DeltaPatch Logging{ Params.TargetFilePath };
+
+		if (bSuccess)
+		{
+			DLC_LOG(Logging, StatusImportant, TEXT("Rebuilt [%lld] bytes from [%lld] bytes of patch in [%.3f] s"),
+				Params.TargetFileSize, ReceivedBytes, ReconstructionSeconds);
+		}
+		else if (ReceivedBytes > 0)
+		{
+			DLC_LOG(Logging, Warning, TEXT("Cannot apply patch from [%s]"), *LastUrl);
+		}
+
+		FCallback FinishedCallback = MoveTemp(Callback);
+		FinishedCallback(*this, bSuccess);
+	}
+}
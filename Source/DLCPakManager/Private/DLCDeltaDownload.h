@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+
+namespace DLCPackageManagerPrivate
+{
+	// Downloads delta patch from cached pak file of previous package version to pak file of new version and
+	// rebuilds new pak file off the game thread. Failure leaves no target file, so caller falls back to full download.
+	// Must be started on the game thread
+	class FDLCDeltaDownload : public TSharedFromThis<FDLCDeltaDownload, ESPMode::ThreadSafe>
+	{
+	public:
+		using FCallback = TFunction<void(const FDLCDeltaDownload& Download, bool bSuccess)>;
+
+		struct FParams
+		{
+			// Urls of patch. Each url is tried once
+			TArray<FString> Urls;
+			FString BaseFilePath;
+			FString TargetFilePath;
+			int64 TargetFileSize = 0;
+		};
+
+		FDLCDeltaDownload(FParams&& InParams, FCallback&& InCallback);
+
+		void Start();
+
+		const FParams& GetParams() const { return Params; }
+
+		// Size of received patch
+		int64 GetReceivedBytes() const { return ReceivedBytes; }
+		double GetReconstructionSeconds() const { return ReconstructionSeconds; }
+		int32 GetLastHttpStatus() const { return LastHttpStatus; }
+		const FString& GetLastUrl() const { return LastUrl; }
+
+	private:
+		void RequestPatch();
+		void OnPatchResponse(FHttpResponsePtr Response, const bool bSucceeded);
+		void Finish(const bool bSuccess);
+
+		const FParams Params;
+		FCallback Callback;
+
+		int32 UrlIndex = 0;
+
+		int64 ReceivedBytes = 0;
+		double ReconstructionSeconds = 0.0;
+		int32 LastHttpStatus = 0;
+		FString LastUrl;
+	};
+}
@@ -0,0 +1,286 @@
+#include "DLCDeltaPatch.h"
+#include "DLCPackageManagerTrace.h"
+
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace DLCPackageManagerPrivate
+{
+	namespace
+	{
+		// Rolling checksum of rsync: "A" is sum of bytes, "B" is sum of "A" values of window prefixes
+		struct FRollingChecksum
+		{
+			uint32 A = 0;
+			uint32 B = 0;
+			int32 WindowSize = 0;
+
+			FRollingChecksum(const uint8* Data, const int32 InWindowSize)
+				: WindowSize(InWindowSize)
+			{
+				for (int32 Index = 0; Index < WindowSize; ++Index)
+				{
+					A += Data[Index];
+					B += (WindowSize - Index) * Data[Index];
+				}
+			}
+
+			void Roll(const uint8 RemovedByte, const uint8 AddedByte)
+			{
+				A += AddedByte - RemovedByte;
+				B += A - WindowSize * RemovedByte;
+			}
+
+			uint32 Get() const
+			{
+				return (A & 0xFFFF) | (B << 16);
+			}
+		};
+
+		struct FPatchWriter
+		{
+			TArray<uint8> Patch;
+			FMemoryWriter Writer{ Patch };
+
+			int32 OperationsNum = 0;
+			int64 OperationsNumOffset = 0;
+
+			int64 PendingCopyOffset = INDEX_NONE;
+			int64 PendingCopyLength = 0;
+
+			int64 PendingLiteralOffset = INDEX_NONE;
+			int64 PendingLiteralLength = 0;
+
+			void Copy(const int64 BaseOffset, const int64 Length, const TArray<uint8>& TargetData)
+			{
+				FlushLiteral(TargetData);
+
+				if (PendingCopyOffset != INDEX_NONE && PendingCopyOffset + PendingCopyLength == BaseOffset)
+				{
+					PendingCopyLength += Length;
+					return;
+				}
+
+				FlushCopy();
+				PendingCopyOffset = BaseOffset;
+				PendingCopyLength = Length;
+			}
+
+			void Literal(const int64 TargetOffset)
+			{
+				FlushCopy();
+
+				if (PendingLiteralOffset == INDEX_NONE)
+					PendingLiteralOffset = TargetOffset;
+
+				++PendingLiteralLength;
+			}
+
+			void Flush(const TArray<uint8>& TargetData)
+			{
+				FlushCopy();
+				FlushLiteral(TargetData);
+			}
+
+		private:
+			void FlushCopy()
+			{
+				if (PendingCopyOffset == INDEX_NONE)
+					return;
+
+				uint8 Operation = static_cast<uint8>(FDLCDeltaPatch::EOperation::Copy);
+				Writer << Operation << PendingCopyOffset << PendingCopyLength;
+				++OperationsNum;
+
+				PendingCopyOffset = INDEX_NONE;
+				PendingCopyLength = 0;
+			}
+
+			void FlushLiteral(const TArray<uint8>& TargetData)
+			{
+				if (PendingLiteralOffset == INDEX_NONE)
+					return;
+
+				uint8 Operation = static_cast<uint8>(FDLCDeltaPatch::EOperation::Literal);
+				Writer << Operation << PendingLiteralLength;
+				Writer.Serialize(const_cast<uint8*>(TargetData.GetData() + PendingLiteralOffset), PendingLiteralLength);
+				++OperationsNum;
+
+				PendingLiteralOffset = INDEX_NONE;
+				PendingLiteralLength = 0;
+			}
+		};
+	}
+
+	FString FDLCDeltaPatch::GetPatchRelativeUrl(const FString& TargetRelativeUrl, const FString& BaseFileName)
+	{
+		return FString::Printf(TEXT("%s.%s.delta"), *TargetRelativeUrl, *FPaths::GetBaseFilename(BaseFileName));
+	}
+
+	TArray<uint8> FDLCDeltaPatch::Create(const TArray<uint8>& BaseData, const TArray<uint8>& TargetData, const int32 BlockSize)
+	{
+		check(BlockSize > 0);
+
+		// Base blocks by checksum
+		TMultiMap<uint32, int64> BaseBlocks;
+		for (int64 BaseOffset = 0; BaseOffset + BlockSize <= BaseData.Num(); BaseOffset += BlockSize)
+		{
+			BaseBlocks.Add(FRollingChecksum{ BaseData.GetData() + BaseOffset, BlockSize }.Get(), BaseOffset);
+		}
+
+		FPatchWriter PatchWriter;
+
+		uint32 MagicValue = Magic;
+		uint32 FormatVersionValue = FormatVersion;
+		int64 BaseFileSize = BaseData.Num();
+		int64 TargetFileSize = TargetData.Num();
+		PatchWriter.Writer << MagicValue << FormatVersionValue << BaseFileSize << TargetFileSize;
+
+		PatchWriter.OperationsNumOffset = PatchWriter.Writer.Tell();
+		PatchWriter.Writer << PatchWriter.OperationsNum;
+
+		const int64 TargetSize = TargetData.Num();
+		int64 TargetOffset = 0;
+
+		TOptional<FRollingChecksum> Checksum;
+		TArray<int64> MatchingBaseOffsets;
+
+		while (TargetOffset + BlockSize <= TargetSize)
+		{
+			if (!Checksum.IsSet())
+				Checksum.Emplace(TargetData.GetData() + TargetOffset, BlockSize);
+
+			MatchingBaseOffsets.Reset();
+			BaseBlocks.MultiFind(Checksum->Get(), MatchingBaseOffsets);
+
+			bool bIsMatched = false;
+			for (const int64 BaseOffset : MatchingBaseOffsets)
+			{
+				if (FMemory::Memcmp(BaseData.GetData() + BaseOffset, TargetData.GetData() + TargetOffset, BlockSize) == 0)
+				{
+					PatchWriter.Copy(BaseOffset, BlockSize, TargetData);
+					bIsMatched = true;
+					break;
+				}
+			}
+
+			if (bIsMatched)
+			{
+				TargetOffset += BlockSize;
+				Checksum.Reset();
+				continue;
+			}
+
+			PatchWriter.Literal(TargetOffset);
+
+			if (TargetOffset + BlockSize < TargetSize)
+				Checksum->Roll(TargetData[TargetOffset], TargetData[TargetOffset + BlockSize]);
+
+			++TargetOffset;
+		}
+
+		for (; TargetOffset < TargetSize; ++TargetOffset)
+			PatchWriter.Literal(TargetOffset);
+
+		PatchWriter.Flush(TargetData);
+
+		PatchWriter.Writer.Seek(PatchWriter.OperationsNumOffset);
+		PatchWriter.Writer << PatchWriter.OperationsNum;
+
+		return MoveTemp(PatchWriter.Patch);
+	}
+
+	bool FDLCDeltaPatch::Apply(const FString& BaseFilePath, const TArray<uint8>& Patch, const FString& TargetFilePath, const int64 ExpectedTargetFileSize)
+	{
+		DLC_TRACE_CPU_SCOPE(DLC_DeltaPatch_Apply);
+
+		FMemoryReader Reader{ Patch };
+
+		uint32 MagicValue = 0;
+		uint32 FormatVersionValue = 0;
+		int64 BaseFileSize = 0;
+		int64 TargetFileSize = 0;
+		int32 OperationsNum = 0;
+		Reader << MagicValue << FormatVersionValue << BaseFileSize << TargetFileSize << OperationsNum;
+
+		if (Reader.IsError() || MagicValue != Magic || FormatVersionValue != FormatVersion || TargetFileSize != ExpectedTargetFileSize)
+			return false;
+
+		IPlatformFile& PlatformFile = IPlatformFile::GetPlatformPhysical();
+
+		TUniquePtr<IFileHandle> BaseFile{ PlatformFile.OpenRead(*BaseFilePath) };
+		if (!BaseFile.IsValid() || BaseFile->Size() != BaseFileSize)
+			return false;
+
+		//NB: Target is written to temporary file, so incomplete file is never taken for cached one
+		const FString TemporaryFilePath = TargetFilePath + TEXT(".delta.tmp");
+
+		auto WriteTargetFile = [&]()
+		{
+			TUniquePtr<IFileHandle> TargetFile{ PlatformFile.OpenWrite(*TemporaryFilePath) };
+			if (!TargetFile.IsValid())
+				return false;
+
+			static constexpr int64 CopyBufferSize = 1024 * 1024;
+			TArray<uint8> CopyBuffer;
+			CopyBuffer.SetNumUninitialized(CopyBufferSize);
+
+			int64 WrittenBytes = 0;
+
+			for (int32 OperationIndex = 0; OperationIndex < OperationsNum; ++OperationIndex)
+			{
+				uint8 Operation = 0;
+				int64 Length = 0;
+				Reader << Operation;
+
+				if (Operation == static_cast<uint8>(EOperation::Copy))
+				{
+					int64 BaseOffset = 0;
+					Reader << BaseOffset << Length;
+
+					if (Reader.IsError() || BaseOffset < 0 || Length < 0 || BaseOffset + Length > BaseFileSize || !BaseFile->Seek(BaseOffset))
+						return false;
+
+					for (int64 CopiedBytes = 0; CopiedBytes < Length; )
+					{
+						const int64 PartBytes = FMath::Min(CopyBufferSize, Length - CopiedBytes);
+						if (!BaseFile->Read(CopyBuffer.GetData(), PartBytes) || !TargetFile->Write(CopyBuffer.GetData(), PartBytes))
+							return false;
+
+						CopiedBytes += PartBytes;
+					}
+				}
+				else if (Operation == static_cast<uint8>(EOperation::Literal))
+				{
+					Reader << Length;
+
+					if (Reader.IsError() || Length < 0 || Reader.Tell() + Length > Patch.Num()
+						|| !TargetFile->Write(Patch.GetData() + Reader.Tell(), Length))
+					{
+						return false;
+					}
+
+					Reader.Seek(Reader.Tell() + Length);
+				}
+				else
+				{
+					return false;
+				}
+
+				WrittenBytes += Length;
+			}
+
+			return WrittenBytes == TargetFileSize;
+		};
+
+		if (!WriteTargetFile())
+		{
+			PlatformFile.DeleteFile(*TemporaryFilePath);
+			return false;
+		}
+
+		return PlatformFile.MoveFile(*TargetFilePath, *TemporaryFilePath) || (PlatformFile.DeleteFile(*TargetFilePath) && PlatformFile.MoveFile(*TargetFilePath, *TemporaryFilePath));
+	}
+}
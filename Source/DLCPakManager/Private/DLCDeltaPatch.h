@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace DLCPackageManagerPrivate
+{
+	// Binary patch that rebuilds pak file of new package version from pak file of cached version.
+	// Patch is a list of operations: copying of base file range or literal bytes.
+	// Patches are published on CDN next to target pak file (see "GetPatchRelativeUrl()" and "UDLCPakToolsCommandlet")
+	struct FDLCDeltaPatch
+	{
+		static constexpr uint32 Magic = 0x44434C44; // "DLCD"
+		static constexpr uint32 FormatVersion = 1;
+
+		// Size of base file blocks that are matched in target file
+		static constexpr int32 DefaultBlockSize = 8 * 1024;
+
+		static FString GetPatchRelativeUrl(const FString& TargetRelativeUrl, const FString& BaseFileName);
+
+		// Matches blocks of base file at any offset of target file with rolling checksum
+		static TArray<uint8> Create(const TArray<uint8>& BaseData, const TArray<uint8>& TargetData, const int32 BlockSize = DefaultBlockSize);
+
+		// Writes target file rebuilt from base file. Blocking call, so it is expected to be made off the game thread
+		static bool Apply(const FString& BaseFilePath, const TArray<uint8>& Patch, const FString& TargetFilePath, const int64 ExpectedTargetFileSize);
+
+		// Format: magic, format version, base file size, target file size, operations number and operations.
+		// Copy operation is base file offset and length, literal operation is length and bytes
+		enum class EOperation : uint8
+		{
+			Copy,
+			Literal
+		};
+	};
+}
@@ -0,0 +1,105 @@
+#include "DLCDependencyGraph.h"
+#include "DLCPackageManager_Private.h"
+#include "DLCPackageManagerTrace.h"
+
+#include "AssetRegistryModule.h"
+#include "Misc/StringBuilder.h"
+
+namespace DLCPackageManagerPrivate
+{
+	const TArray<FName>& FDLCDependencyGraph::GetDependencyDLCPackageNames(const FName& AssetPackageName)
+	{
+		if (const TArray<FName>* CachedDLCPackageNames = DependencyDLCPackageNames.Find(AssetPackageName))
+			return *CachedDLCPackageNames;
+
+		return DependencyDLCPackageNames.Add(AssetPackageName, WalkDependencyDLCPackageNames(AssetPackageName));
+	}
+
+	void FDLCDependencyGraph::Reset()
+	{
+		DependencyDLCPackageNames.Reset();
+	}
+
+	bool FDLCDependencyGraph::HasPackageDependencies()
+	{
+		static constexpr int32 CheckedAssetsNum = 64;
+
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+		FARFilter Filter;
+		Filter.PackagePaths.Add(FName{ TEXT("/Game") });
+		Filter.bRecursivePaths = true;
+
+		bool bHasDependencies = false;
+		int32 CheckedAssetsLeft = CheckedAssetsNum;
+		TArray<FName> Dependencies;
+
+		AssetRegistry.EnumerateAssets(Filter, [&AssetRegistry, &bHasDependencies, &CheckedAssetsLeft, &Dependencies](const FAssetData& AssetData)
+		{
+			Dependencies.Reset();
+			AssetRegistry.GetDependencies(AssetData.PackageName, Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+
+			bHasDependencies = Dependencies.Num() > 0;
+			return !bHasDependencies && --CheckedAssetsLeft > 0;
+		});
+
+		return bHasDependencies;
+	}
+
+	TArray<FName> FDLCDependencyGraph::WalkDependencyDLCPackageNames(const FName& AssetPackageName) const
+	{
+		DLC_TRACE_CPU_SCOPE(DLC_WalkDependencyDLCPackages);
+
+		static const FStringView GamePackagePrefix{ TEXT("/Game/") };
+
+		TArray<FName> Result;
+
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+		TStringBuilder<NAME_SIZE> PackageNameBuilder;
+		AssetPackageName.AppendString(PackageNameBuilder);
+		const TOptional<FStringView> OwnDLCChunkId = FDLCPackageManager_Private::GetDLCChunkId(PackageNameBuilder.ToView());
+		const FName OwnDLCPackageName = OwnDLCChunkId.IsSet() ? FName{ OwnDLCChunkId->Len(), OwnDLCChunkId->GetData() } : NAME_None;
+
+		TSet<FName> VisitedPackageNames{ AssetPackageName };
+		TArray<FName> PackageNamesToVisit{ AssetPackageName };
+		TArray<FName> Dependencies;
+
+		while (PackageNamesToVisit.Num() > 0 && VisitedPackageNames.Num() < MaxWalkedPackagesNum)
+		{
+			const FName PackageName = PackageNamesToVisit.Pop(false);
+
+			Dependencies.Reset();
+			AssetRegistry.GetDependencies(PackageName, Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+
+			for (const FName& Dependency : Dependencies)
+			{
+				bool bIsAlreadyVisited = false;
+				VisitedPackageNames.Add(Dependency, &bIsAlreadyVisited);
+				if (bIsAlreadyVisited)
+					continue;
+
+				PackageNameBuilder.Reset();
+				Dependency.AppendString(PackageNameBuilder);
+
+				//NB: Engine, script and plugin packages are not walked. They are not placed in DLC and do not reference it
+				if (!PackageNameBuilder.ToView().StartsWith(GamePackagePrefix))
+					continue;
+
+				const TOptional<FStringView> DLCChunkId = FDLCPackageManager_Private::GetDLCChunkId(PackageNameBuilder.ToView());
+				if (DLCChunkId.IsSet())
+				{
+					const FName DLCPackageName{ DLCChunkId->Len(), DLCChunkId->GetData() };
+					if (DLCPackageName != OwnDLCPackageName)
+					{
+						Result.AddUnique(DLCPackageName);
+					}
+				}
+
+				PackageNamesToVisit.Add(Dependency);
+			}
+		}
+
+		return Result;
+	}
+}
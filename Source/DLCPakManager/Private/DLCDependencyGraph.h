@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace DLCPackageManagerPrivate
+{
+	// Finds DLC packages ("/Game/DLC_<Name>/...") that are hard referenced by asset package, directly or through other
+	// packages, by dependencies of asset registry. Closure of asset package is walked on its first request and memoized,
+	// so repeated requests cost single hash lookup. Packages missing in asset registry have no dependencies.
+	// Only game content ("/Game/...") is walked: engine, script and plugin packages cannot reference DLC packages
+	class FDLCDependencyGraph
+	{
+	public:
+		// Walk of one closure stops after this number of packages, so single request cannot stall the game thread
+		static constexpr int32 MaxWalkedPackagesNum = 16 * 1024;
+
+		// Names of DLC packages of dependency closure, without DLC package of the asset package itself
+		const TArray<FName>& GetDependencyDLCPackageNames(const FName& AssetPackageName);
+
+		// Should be called when catalog or asset registry is changed
+		void Reset();
+
+		// Cooked asset registry keeps package dependencies only if it is serialized with them. Checks first game assets
+		static bool HasPackageDependencies();
+
+	private:
+		TArray<FName> WalkDependencyDLCPackageNames(const FName& AssetPackageName) const;
+
+		TMap<FName, TArray<FName>> DependencyDLCPackageNames;
+	};
+}
@@ -0,0 +1,433 @@
+#include "DLCDownloadScheduler.h"
+#include "PrivateHacking.h"
+#include "PrivateHacking_ChunkDownloader.h"
+#include "DLCResumableDownload.h"
+#include "DLCDeltaDownload.h"
+#include "DLCDeltaPatch.h"
+#include "DLCPackageManagerTrace.h"
+
+#include "ChunkDownloader.h"
+
+namespace DLCPackageManagerPrivate
+{
+	FDLCDownloadScheduler::FDLCDownloadScheduler(const TSharedRef<FChunkDownloader>& InChunkDownloader, const int32 InMaxChunksInFlight, const uint64 InResumableDownloadMinBytes,
+		const int32 InMaxResumableDownloadConnections)
+		: ChunkDownloader(InChunkDownloader), MaxChunksInFlight(FMath::Max(InMaxChunksInFlight, 1)), ResumableDownloadMinBytes(InResumableDownloadMinBytes)
+		, MaxResumableDownloadConnections(FMath::Max(InMaxResumableDownloadConnections, 1))
+	{
+		BaseTargetDownloadsInFlight = GetChunkDownloaderHackedAccess().TargetDownloadsInFlight;
+	}
+
+	void FDLCDownloadScheduler::RequestChunk(const int32 ChunkId, const EDLCLoadPriority Priority, FCallback&& Callback, const int32 DeltaBaseChunkId)
+	{
+		if (FChunkRequest* ExistingRequest = Requests.Find(ChunkId))
+		{
+			ExistingRequest->Callbacks.Add(MoveTemp(Callback));
+			RaiseChunkPriority(ChunkId, Priority);
+			return;
+		}
+
+		FChunkRequest& Request = Requests.Add(ChunkId);
+		Request.ChunkId = ChunkId;
+		Request.Priority = Priority;
+		Request.Callbacks.Add(MoveTemp(Callback));
+		Request.DeltaBaseChunkId = DeltaBaseChunkId;
+
+		PendingQueues[static_cast<int32>(Priority)].Add(ChunkId);
+
+		Dispatch();
+	}
+
+	void FDLCDownloadScheduler::RaiseChunkPriority(const int32 ChunkId, const EDLCLoadPriority Priority)
+	{
+		FChunkRequest* Request = Requests.Find(ChunkId);
+		if (!Request || !IsMoreUrgent(Priority, Request->Priority))
+			return;
+
+		const EDLCLoadPriority PreviousPriority = Request->Priority;
+		Request->Priority = Priority;
+
+		if (!Request->bInFlight)
+		{
+			PendingQueues[static_cast<int32>(PreviousPriority)].Remove(ChunkId);
+			PendingQueues[static_cast<int32>(Priority)].Add(ChunkId);
+
+			Dispatch();
+			return;
+		}
+
+		--InFlightChunksNum[static_cast<int32>(PreviousPriority)];
+		++InFlightChunksNum[static_cast<int32>(Priority)];
+
+		ReprioritizeChunkDownloaderQueue(ChunkId, Priority);
+		UpdateTargetDownloadsInFlight();
+
+		//NB: ChunkDownloader is not requested while resumable downloads or delta patching are in progress. Otherwise it would download same pak files
+		if (Request->ResumableDownloadsNum > 0 || Request->bDeltaDownloadInProgress)
+			return;
+
+		//NB: Repeated request makes ChunkDownloader issue downloads with updated queue order and limit
+		ChunkDownloader->DownloadChunk(ChunkId, [](bool bSuccess) { }, ToChunkDownloaderPriority(Priority));
+	}
+
+	int32 FDLCDownloadScheduler::GetPendingChunksNum(const EDLCLoadPriority Priority) const
+	{
+		return PendingQueues[static_cast<int32>(Priority)].Num();
+	}
+
+	int32 FDLCDownloadScheduler::GetInFlightChunksNum(const EDLCLoadPriority Priority) const
+	{
+		return InFlightChunksNum[static_cast<int32>(Priority)];
+	}
+
+	bool FDLCDownloadScheduler::IsIdleForPrefetch() const
+	{
+		for (const EDLCLoadPriority Priority : { EDLCLoadPriority::Blocking, EDLCLoadPriority::VisibleSoon })
+		{
+			if (GetPendingChunksNum(Priority) > 0 || GetInFlightChunksNum(Priority) > 0)
+				return false;
+		}
+
+		return true;
+	}
+
+	uint64 FDLCDownloadScheduler::GetResumableDownloadProgressBytes(const FString& PakFileName) const
+	{
+		const TSharedRef<FDLCResumableDownload, ESPMode::ThreadSafe>* Download = ResumableDownloads.Find(PakFileName);
+		return Download ? static_cast<uint64>((*Download)->GetProgressBytes()) : 0;
+	}
+
+	void FDLCDownloadScheduler::Dispatch()
+	{
+		DLC_TRACE_CPU_SCOPE(DLC_Scheduler_Dispatch);
+
+		for (int32 PriorityIndex = 0; PriorityIndex < PriorityClassesNum; ++PriorityIndex)
+		{
+			const EDLCLoadPriority Priority = static_cast<EDLCLoadPriority>(PriorityIndex);
+			TArray<int32>& PendingQueue = PendingQueues[PriorityIndex];
+
+			while (PendingQueue.Num() > 0)
+			{
+				int32 AllInFlightChunksNum = 0;
+				for (const int32 Num : InFlightChunksNum)
+					AllInFlightChunksNum += Num;
+
+				const bool bHasFreeSlot = (AllInFlightChunksNum < MaxChunksInFlight);
+
+				bool bCanStart = false;
+				switch (Priority)
+				{
+					case EDLCLoadPriority::Blocking:    bCanStart = true;                                    break;
+					case EDLCLoadPriority::VisibleSoon: bCanStart = bHasFreeSlot;                            break;
+					case EDLCLoadPriority::Prefetch:    bCanStart = bHasFreeSlot && IsIdleForPrefetch();     break;
+					default: check(false);
+				}
+
+				// Less urgent classes should wait too
+				if (!bCanStart)
+					return;
+
+				const int32 ChunkId = PendingQueue[0];
+				PendingQueue.RemoveAt(0);
+
+				StartDownload(Requests.FindChecked(ChunkId));
+			}
+		}
+	}
+
+	void FDLCDownloadScheduler::StartDownload(FChunkRequest& Request)
+	{
+		Request.bInFlight = true;
+		++InFlightChunksNum[static_cast<int32>(Request.Priority)];
+
+		UpdateTargetDownloadsInFlight();
+
+		if (StartDeltaDownload(Request))
+			return;
+
+		StartFullDownload(Request);
+	}
+
+	void FDLCDownloadScheduler::StartFullDownload(FChunkRequest& Request)
+	{
+		if (StartResumableDownloads(Request) > 0)
+			return;
+
+		StartChunkDownloaderDownload(Request);
+	}
+
+	bool FDLCDownloadScheduler::StartDeltaDownload(FChunkRequest& Request)
+	{
+		using FPakFile = FHackingType_ChunkDownloader::FPakFile;
+		using FChunk = FHackingType_ChunkDownloader::FChunk;
+
+		if (Request.DeltaBaseChunkId == INDEX_NONE)
+			return false;
+
+		FHackingType_ChunkDownloader& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+
+		const TSharedRef<FChunk>* Chunk = ChunkDownloaderHacked.Chunks.Find(Request.ChunkId);
+		const TSharedRef<FChunk>* BaseChunk = ChunkDownloaderHacked.Chunks.Find(Request.DeltaBaseChunkId);
+		if (!Chunk || !BaseChunk || ChunkDownloaderHacked.BuildBaseUrls.Num() == 0)
+			return false;
+
+		//NB: Pak files of chunks with several pak files cannot be paired reliably
+		if ((*Chunk)->PakFiles.Num() != 1 || (*BaseChunk)->PakFiles.Num() != 1)
+			return false;
+
+		const TSharedRef<FPakFile>& PakFile = (*Chunk)->PakFiles[0];
+		const TSharedRef<FPakFile>& BasePakFile = (*BaseChunk)->PakFiles[0];
+		if (PakFile->bIsCached || PakFile->bIsEmbedded || PakFile->Download.IsValid() || !BasePakFile->bIsCached)
+			return false;
+
+		// Partial data of full download is closer to completion than patch
+		const FString TargetFilePath = ChunkDownloaderHacked.CacheFolder / PakFile->Entry.FileName;
+		if (FDLCResumableDownload::HasPartialFile(TargetFilePath))
+			return false;
+
+		FDLCDeltaDownload::FParams Params;
+		Params.BaseFilePath = ChunkDownloaderHacked.CacheFolder / BasePakFile->Entry.FileName;
+		Params.TargetFilePath = TargetFilePath;
+		Params.TargetFileSize = PakFile->Entry.FileSize;
+		for (const FString& BuildBaseUrl : ChunkDownloaderHacked.BuildBaseUrls)
+			Params.Urls.Add(BuildBaseUrl / FDLCDeltaPatch::GetPatchRelativeUrl(PakFile->Entry.RelativeUrl, BasePakFile->Entry.FileName));
+
+		const double StartTime = FPlatformTime::Seconds();
+		const int32 ChunkId = Request.ChunkId;
+
+		const auto Download = MakeShared<FDLCDeltaDownload, ESPMode::ThreadSafe>(MoveTemp(Params),
+			[WeakThis = TWeakPtr<FDLCDownloadScheduler, ESPMode::ThreadSafe>{ AsShared() }, ChunkId, PakFileName = PakFile->Entry.FileName, StartTime](const FDLCDeltaDownload& FinishedDownload, const bool bSuccess)
+			{
+				const TSharedPtr<FDLCDownloadScheduler, ESPMode::ThreadSafe> This = WeakThis.Pin();
+				if (!This)
+					return;
+
+				if (FinishedDownload.GetReceivedBytes() > 0)
+				{
+					// Same analytics as ChunkDownloader reports for its downloads
+					if (This->ChunkDownloader->OnDownloadAnalytics)
+					{
+						This->ChunkDownloader->OnDownloadAnalytics(PakFileName, FinishedDownload.GetLastUrl(), FinishedDownload.GetReceivedBytes(),
+							FTimespan::FromSeconds(FPlatformTime::Seconds() - StartTime), bSuccess ? FinishedDownload.GetLastHttpStatus() : 0);
+					}
+
+					if (This->DeltaPatchCallback)
+					{
+						This->DeltaPatchCallback(FinishedDownload.GetParams().TargetFileSize, FinishedDownload.GetReceivedBytes(),
+							FinishedDownload.GetReconstructionSeconds(), bSuccess);
+					}
+				}
+
+				This->OnDeltaDownloadFinished(ChunkId, PakFileName, bSuccess);
+			});
+
+		Request.bDeltaDownloadInProgress = true;
+
+		Download->Start();
+		return true;
+	}
+
+	void FDLCDownloadScheduler::OnDeltaDownloadFinished(const int32 ChunkId, const FString& PakFileName, const bool bSuccess)
+	{
+		using FPakFile = FHackingType_ChunkDownloader::FPakFile;
+
+		FHackingType_ChunkDownloader& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+
+		if (bSuccess)
+		{
+			if (const TSharedRef<FPakFile>* PakFile = ChunkDownloaderHacked.PakFiles.Find(PakFileName))
+			{
+				(*PakFile)->bIsCached = true;
+				(*PakFile)->SizeOnDisk = (*PakFile)->Entry.FileSize;
+
+				ChunkDownloaderHacked.SaveLocalManifest();
+			}
+		}
+
+		FChunkRequest* Request = Requests.Find(ChunkId);
+		if (!Request)
+			return;
+
+		Request->bDeltaDownloadInProgress = false;
+
+		if (bSuccess)
+		{
+			OnChunkDownloaded(ChunkId, true);
+			return;
+		}
+
+		StartFullDownload(*Request);
+	}
+
+	void FDLCDownloadScheduler::StartChunkDownloaderDownload(const FChunkRequest& Request)
+	{
+		const int32 ChunkId = Request.ChunkId;
+		ChunkDownloader->DownloadChunk(ChunkId, [WeakThis = TWeakPtr<FDLCDownloadScheduler, ESPMode::ThreadSafe>{ AsShared() }, ChunkId](bool bSuccess)
+		{
+			if (const TSharedPtr<FDLCDownloadScheduler, ESPMode::ThreadSafe> This = WeakThis.Pin())
+			{
+				This->OnChunkDownloaded(ChunkId, bSuccess);
+			}
+		},
+		ToChunkDownloaderPriority(Request.Priority));
+	}
+
+	int32 FDLCDownloadScheduler::StartResumableDownloads(FChunkRequest& Request)
+	{
+		using FPakFile = FHackingType_ChunkDownloader::FPakFile;
+
+		FHackingType_ChunkDownloader& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+
+		const TSharedRef<FHackingType_ChunkDownloader::FChunk>* Chunk = ChunkDownloaderHacked.Chunks.Find(Request.ChunkId);
+		if (!Chunk || ChunkDownloaderHacked.BuildBaseUrls.Num() == 0)
+			return 0;
+
+		const int32 ChunkId = Request.ChunkId;
+
+		for (const TSharedRef<FPakFile>& PakFile : (*Chunk)->PakFiles)
+		{
+			if (PakFile->bIsCached || PakFile->bIsEmbedded || PakFile->Download.IsValid())
+				continue;
+
+			const FString TargetFilePath = ChunkDownloaderHacked.CacheFolder / PakFile->Entry.FileName;
+			if (PakFile->Entry.FileSize < ResumableDownloadMinBytes && !FDLCResumableDownload::HasPartialFile(TargetFilePath))
+				continue;
+
+			FDLCResumableDownload::FParams Params;
+			Params.TargetFilePath = TargetFilePath;
+			Params.FileVersion = PakFile->Entry.FileVersion;
+			Params.FileSize = PakFile->Entry.FileSize;
+			Params.MaxConnectionsNum = MaxResumableDownloadConnections;
+			for (const FString& BuildBaseUrl : ChunkDownloaderHacked.BuildBaseUrls)
+				Params.Urls.Add(BuildBaseUrl / PakFile->Entry.RelativeUrl);
+
+			const double StartTime = FPlatformTime::Seconds();
+
+			const auto Download = MakeShared<FDLCResumableDownload, ESPMode::ThreadSafe>(MoveTemp(Params),
+				[WeakThis = TWeakPtr<FDLCDownloadScheduler, ESPMode::ThreadSafe>{ AsShared() }, ChunkId, PakFileName = PakFile->Entry.FileName, StartTime](const FDLCResumableDownload& FinishedDownload, const bool bSuccess)
+				{
+					const TSharedPtr<FDLCDownloadScheduler, ESPMode::ThreadSafe> This = WeakThis.Pin();
+					if (!This)
+						return;
+
+					// Same analytics as ChunkDownloader reports for its downloads
+					if (This->ChunkDownloader->OnDownloadAnalytics)
+					{
+						This->ChunkDownloader->OnDownloadAnalytics(PakFileName, FinishedDownload.GetLastUrl(), FinishedDownload.GetReceivedBytes(),
+							FTimespan::FromSeconds(FPlatformTime::Seconds() - StartTime), bSuccess ? FinishedDownload.GetLastHttpStatus() : 0);
+					}
+
+					This->OnResumableDownloadFinished(ChunkId, PakFileName, bSuccess);
+				});
+
+			++Request.ResumableDownloadsNum;
+			ResumableDownloads.Add(PakFile->Entry.FileName, Download);
+
+			Download->Start();
+		}
+
+		return Request.ResumableDownloadsNum;
+	}
+
+	void FDLCDownloadScheduler::OnResumableDownloadFinished(const int32 ChunkId, const FString& PakFileName, const bool bSuccess)
+	{
+		using FPakFile = FHackingType_ChunkDownloader::FPakFile;
+
+		FHackingType_ChunkDownloader& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+
+		if (bSuccess)
+		{
+			if (const TSharedRef<FPakFile>* PakFile = ChunkDownloaderHacked.PakFiles.Find(PakFileName))
+			{
+				(*PakFile)->bIsCached = true;
+				(*PakFile)->SizeOnDisk = (*PakFile)->Entry.FileSize;
+
+				ChunkDownloaderHacked.SaveLocalManifest();
+			}
+		}
+
+		FChunkRequest* Request = Requests.Find(ChunkId);
+		if (!Request)
+			return;
+
+		Request->bResumableDownloadsFailed |= !bSuccess;
+		if (--Request->ResumableDownloadsNum > 0)
+			return;
+
+		if (Request->bResumableDownloadsFailed)
+		{
+			OnChunkDownloaded(ChunkId, false);
+			return;
+		}
+
+		// Rest pak files of chunk are downloaded by ChunkDownloader. It skips cached ones
+		StartChunkDownloaderDownload(*Request);
+	}
+
+	void FDLCDownloadScheduler::OnChunkDownloaded(const int32 ChunkId, const bool bSuccess)
+	{
+		FChunkRequest Request;
+		if (!Requests.RemoveAndCopyValue(ChunkId, Request))
+			return;
+
+		--InFlightChunksNum[static_cast<int32>(Request.Priority)];
+		UpdateTargetDownloadsInFlight();
+
+		for (FCallback& Callback : Request.Callbacks)
+			Callback(bSuccess);
+
+		Dispatch();
+	}
+
+	void FDLCDownloadScheduler::ReprioritizeChunkDownloaderQueue(const int32 ChunkId, const EDLCLoadPriority Priority)
+	{
+		using FPakFile = FHackingType_ChunkDownloader::FPakFile;
+
+		FHackingType_ChunkDownloader& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+
+		const TSharedRef<FHackingType_ChunkDownloader::FChunk>* Chunk = ChunkDownloaderHacked.Chunks.Find(ChunkId);
+		if (!Chunk)
+			return;
+
+		const int32 ChunkDownloaderPriority = ToChunkDownloaderPriority(Priority);
+		for (const TSharedRef<FPakFile>& PakFile : (*Chunk)->PakFiles)
+		{
+			PakFile->Priority = FMath::Max(PakFile->Priority, ChunkDownloaderPriority);
+		}
+
+		ChunkDownloaderHacked.DownloadRequests.StableSort([](const TSharedRef<FPakFile>& A, const TSharedRef<FPakFile>& B)
+		{
+			return A->Priority > B->Priority;
+		});
+	}
+
+	void FDLCDownloadScheduler::UpdateTargetDownloadsInFlight()
+	{
+		// Each blocking chunk gets additional pak download slot, so it does not wait for slots of other downloads
+		const int32 BlockingInFlightChunksNum = GetInFlightChunksNum(EDLCLoadPriority::Blocking);
+		TRACE_COUNTER_SET(DLCChunksInFlight, InFlightChunksNum[0] + InFlightChunksNum[1] + InFlightChunksNum[2]);
+
+		GetChunkDownloaderHackedAccess().TargetDownloadsInFlight = BaseTargetDownloadsInFlight + FMath::Min(BlockingInFlightChunksNum, BaseTargetDownloadsInFlight);
+	}
+
+	int32 FDLCDownloadScheduler::ToChunkDownloaderPriority(const EDLCLoadPriority Priority)
+	{
+		switch (Priority)
+		{
+			case EDLCLoadPriority::Blocking:    return 100;
+			case EDLCLoadPriority::VisibleSoon: return 10;
+			case EDLCLoadPriority::Prefetch:    return 1;
+			default: check(false);              return 1;
+		}
+	}
+
+	bool FDLCDownloadScheduler::IsMoreUrgent(const EDLCLoadPriority Priority, const EDLCLoadPriority OtherPriority)
+	{
+		return static_cast<uint8>(Priority) < static_cast<uint8>(OtherPriority);
+	}
+
+	FHackingType_ChunkDownloader& FDLCDownloadScheduler::GetChunkDownloaderHackedAccess()
+	{
+		return GetHackedType<FHackingType_ChunkDownloader>(ChunkDownloader.Get());
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "DLCLoadPriority.h"
+
+class FChunkDownloader;
+
+namespace DLCPackageManagerPrivate
+{
+	class FHackingType_ChunkDownloader;
+	class FDLCResumableDownload;
+
+	// Orders chunk downloads by priority classes:
+	// - "Blocking" chunks are started at once, even over the limit of chunks in flight
+	// - "VisibleSoon" chunks are started while there are free slots
+	// - "Prefetch" chunks are started only when there are no other downloads
+	// Raising of chunk class reorders pending queue and ChunkDownloader queue of pak files.
+	// Large pak files and pak files with partial data are downloaded by resumable downloads, other ones - by ChunkDownloader.
+	// Chunk with cached base chunk is rebuilt from delta patch first, failed patching falls back to full download.
+	// Scheduler is owned by shared pointer: downloads keep only weak pointer to it, so they may finish after its destruction
+	class FDLCDownloadScheduler : public TSharedFromThis<FDLCDownloadScheduler, ESPMode::ThreadSafe>
+	{
+	public:
+		using FCallback = TFunction<void(bool bSuccess)>;
+		using FDeltaPatchCallback = TFunction<void(int64 TargetBytes, int64 PatchBytes, double ReconstructionSeconds, bool bSuccess)>;
+
+		// Pak files smaller than "InResumableDownloadMinBytes" are downloaded by ChunkDownloader unless they have partial data.
+		// "MAX_uint64" disables resumable downloads of new pak files. Each resumable download has up to "InMaxResumableDownloadConnections" segments in flight
+		FDLCDownloadScheduler(const TSharedRef<FChunkDownloader>& InChunkDownloader, const int32 InMaxChunksInFlight, const uint64 InResumableDownloadMinBytes,
+			const int32 InMaxResumableDownloadConnections);
+
+		// Requesting of already requested chunk with more urgent priority raises its priority.
+		// "DeltaBaseChunkId" is cached chunk of previous package version. Delta patching is used only if both chunks have single pak file
+		void RequestChunk(const int32 ChunkId, const EDLCLoadPriority Priority, FCallback&& Callback, const int32 DeltaBaseChunkId = INDEX_NONE);
+
+		// Called on every finished delta patching, including failed ones
+		void SetDeltaPatchCallback(FDeltaPatchCallback&& InDeltaPatchCallback) { DeltaPatchCallback = MoveTemp(InDeltaPatchCallback); }
+
+		// Does nothing if chunk is not requested or already has same or more urgent priority
+		void RaiseChunkPriority(const int32 ChunkId, const EDLCLoadPriority Priority);
+
+		int32 GetPendingChunksNum(const EDLCLoadPriority Priority) const;
+		int32 GetInFlightChunksNum(const EDLCLoadPriority Priority) const;
+
+		// There are no pending or downloading chunks except prefetched ones
+		bool IsIdleForPrefetch() const;
+
+		// Bytes of pak file received by its resumable download, including segment in flight. Zero if pak file is not
+		// downloaded by resumable download: ChunkDownloader does not report progress of its downloads
+		uint64 GetResumableDownloadProgressBytes(const FString& PakFileName) const;
+
+	private:
+		static constexpr int32 PriorityClassesNum = 3;
+
+		struct FChunkRequest
+		{
+			int32 ChunkId = INDEX_NONE;
+			EDLCLoadPriority Priority = EDLCLoadPriority::Prefetch;
+			bool bInFlight = false;
+			TArray<FCallback> Callbacks;
+
+			// Resumable downloads are finished before ChunkDownloader downloads the rest pak files of chunk
+			int32 ResumableDownloadsNum = 0;
+			bool bResumableDownloadsFailed = false;
+
+			int32 DeltaBaseChunkId = INDEX_NONE;
+			bool bDeltaDownloadInProgress = false;
+		};
+
+		void Dispatch();
+		void StartDownload(FChunkRequest& Request);
+		void StartFullDownload(FChunkRequest& Request);
+		bool StartDeltaDownload(FChunkRequest& Request);
+		void OnDeltaDownloadFinished(const int32 ChunkId, const FString& PakFileName, const bool bSuccess);
+		void StartChunkDownloaderDownload(const FChunkRequest& Request);
+		// Returns number of started downloads
+		int32 StartResumableDownloads(FChunkRequest& Request);
+		void OnResumableDownloadFinished(const int32 ChunkId, const FString& PakFileName, const bool bSuccess);
+		void OnChunkDownloaded(const int32 ChunkId, const bool bSuccess);
+
+		void ReprioritizeChunkDownloaderQueue(const int32 ChunkId, const EDLCLoadPriority Priority);
+		void UpdateTargetDownloadsInFlight();
+
+		static int32 ToChunkDownloaderPriority(const EDLCLoadPriority Priority);
+		static bool IsMoreUrgent(const EDLCLoadPriority Priority, const EDLCLoadPriority OtherPriority);
+
+		FHackingType_ChunkDownloader& GetChunkDownloaderHackedAccess();
+
+		TSharedRef<FChunkDownloader> ChunkDownloader;
+		const int32 MaxChunksInFlight;
+		const uint64 ResumableDownloadMinBytes;
+		const int32 MaxResumableDownloadConnections;
+		FDeltaPatchCallback DeltaPatchCallback;
+		int32 BaseTargetDownloadsInFlight = 1;
+
+		TMap<int32, FChunkRequest> Requests;
+		// Pak file name to its resumable download in flight
+		TMap<FString, TSharedRef<FDLCResumableDownload, ESPMode::ThreadSafe>> ResumableDownloads;
+		TArray<int32> PendingQueues[PriorityClassesNum];
+		int32 InFlightChunksNum[PriorityClassesNum] = { };
+	};
+}
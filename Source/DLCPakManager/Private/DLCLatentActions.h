@@ -0,0 +1,131 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Async.h"
+#include "Async/Future.h"
+#include "Engine/Engine.h"
+#include "Engine/LatentActionManager.h"
+#include "LatentActions.h"
+#include "UObject/ObjectKey.h"
+
+namespace DLCPackageManagerPrivate
+{
+	// Latent actions waiting for futures are not added to latent action manager, so they are not updated every frame.
+	// Continuation of future adds action with ready result, which finishes on its first update.
+	// Waiting actions are identified by callback target and UUID like actions of latent action manager
+	class FDLCWaitingLatentActions
+	{
+	public:
+		//NB: Key is made while callback target is alive, because callback target of latent info is not weak pointer
+		typedef TPair<FObjectKey, int32> FKey;
+
+		static FKey MakeKey(const FLatentActionInfo& LatentInfo) { return FKey{ FObjectKey{ LatentInfo.CallbackTarget }, LatentInfo.UUID }; }
+
+		// Game thread only. Returns false if action is already waiting
+		static bool Add(const FKey& Key)
+		{
+			check(IsInGameThread());
+
+			bool bIsAlreadyInSet = false;
+			Get().Add(Key, &bIsAlreadyInSet);
+			return !bIsAlreadyInSet;
+		}
+
+		// Game thread only
+		static void Remove(const FKey& Key)
+		{
+			check(IsInGameThread());
+
+			Get().Remove(Key);
+		}
+
+	private:
+		static TSet<FKey>& Get()
+		{
+			static TSet<FKey> Keys;
+			return Keys;
+		}
+	};
+
+	// - - - - - - - - - - - - -
+
+	template<typename T_Result>
+	class TReadyResultLatentAction : public FPendingLatentAction
+	{
+	public:
+		typedef TFunction<void(const T_Result& Result)> FBeforeExecResultPreparingFunction;
+
+		TReadyResultLatentAction(const FLatentActionInfo& LatentInfo, T_Result&& InResult, const FBeforeExecResultPreparingFunction& InBeforeExecResultPreparing)
+			:
+			ExecutionFunction(LatentInfo.ExecutionFunction),
+			OutputLink(LatentInfo.Linkage),
+			CallbackTarget(LatentInfo.CallbackTarget),
+			Result(MoveTemp(InResult)),
+			BeforeExecResultPreparing(InBeforeExecResultPreparing)
+		{
+			check(!!BeforeExecResultPreparing);
+		}
+
+		void UpdateOperation(FLatentResponse& Response) override
+		{
+			BeforeExecResultPreparing(Result);
+			Response.FinishAndTriggerIf(true, ExecutionFunction, OutputLink, CallbackTarget);
+		}
+
+	private:
+		FName ExecutionFunction;
+		int32 OutputLink;
+		FWeakObjectPtr CallbackTarget;
+
+		T_Result Result;
+		FBeforeExecResultPreparingFunction BeforeExecResultPreparing;
+	};
+
+	// Game thread only. Action is not started if same action is waiting or added to latent action manager
+	template<typename T_Result>
+	void StartFutureLatentAction(
+		const UObject* WCO,
+		const FLatentActionInfo& LatentInfo,
+		TFuture<T_Result>&& Future,
+		const typename TReadyResultLatentAction<T_Result>::FBeforeExecResultPreparingFunction& BeforeExecResultPreparing)
+	{
+		check(Future.IsValid());
+
+		UWorld* World = GEngine->GetWorldFromContextObject(WCO, EGetWorldErrorMode::LogAndReturnNull);
+		if (World == nullptr)
+			return;
+
+		const FDLCWaitingLatentActions::FKey Key = FDLCWaitingLatentActions::MakeKey(LatentInfo);
+		if (World->GetLatentActionManager().FindExistingAction<TReadyResultLatentAction<T_Result>>(LatentInfo.CallbackTarget, LatentInfo.UUID) != nullptr ||
+			!FDLCWaitingLatentActions::Add(Key))
+			return;
+
+		const TWeakObjectPtr<UWorld> WeakWorld{ World };
+		const FWeakObjectPtr WeakCallbackTarget{ LatentInfo.CallbackTarget };
+		Future.Next([WeakWorld, WeakCallbackTarget, Key, LatentInfo, BeforeExecResultPreparing](T_Result Result)
+		{
+			auto AddReadyAction = [WeakWorld, WeakCallbackTarget, Key, LatentInfo, BeforeExecResultPreparing, Result = MoveTemp(Result)]() mutable
+			{
+				FDLCWaitingLatentActions::Remove(Key);
+
+				UWorld* World = WeakWorld.Get();
+				UObject* CallbackTarget = WeakCallbackTarget.Get();
+				if (World == nullptr || CallbackTarget == nullptr)
+					return;
+
+				World->GetLatentActionManager().AddNewAction(CallbackTarget, LatentInfo.UUID,
+					new TReadyResultLatentAction<T_Result>(LatentInfo, MoveTemp(Result), BeforeExecResultPreparing));
+			};
+
+			//NB: Futures of package manager are usually completed on game thread, so action is added without extra task
+			if (IsInGameThread())
+			{
+				AddReadyAction();
+			}
+			else
+			{
+				AsyncTask(ENamedThreads::GameThread, MoveTemp(AddReadyAction));
+			}
+		});
+	}
+}
@@ -0,0 +1,159 @@
+#include "DLCMountScheduler.h"
+#include "DLCPackageManagerTrace.h"
+
+#include "ChunkDownloader.h"
+#include "Containers/Ticker.h"
+
+namespace DLCPackageManagerPrivate
+{
+	FDLCMountScheduler::FDLCMountScheduler(const TSharedRef<FChunkDownloader>& InChunkDownloader, const int32 InMaxMountsInFlight, const double InFrameBudgetSeconds)
+		: ChunkDownloader(InChunkDownloader), MaxMountsInFlight(FMath::Max(InMaxMountsInFlight, 1)), FrameBudgetSeconds(InFrameBudgetSeconds)
+	{
+		TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FDLCMountScheduler::Tick));
+	}
+
+	FDLCMountScheduler::~FDLCMountScheduler()
+	{
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	}
+
+	void FDLCMountScheduler::RequestMount(const int32 ChunkId, const EDLCLoadPriority Priority, FCallback&& Callback)
+	{
+		if (FMountRequest* ExistingRequest = Requests.Find(ChunkId))
+		{
+			ExistingRequest->Callbacks.Add(MoveTemp(Callback));
+			RaiseMountPriority(ChunkId, Priority);
+			return;
+		}
+
+		FMountRequest& Request = Requests.Add(ChunkId);
+		Request.ChunkId = ChunkId;
+		Request.Priority = Priority;
+		Request.Callbacks.Add(MoveTemp(Callback));
+
+		PendingQueues[static_cast<int32>(Priority)].Add(ChunkId);
+
+		Dispatch();
+	}
+
+	void FDLCMountScheduler::RaiseMountPriority(const int32 ChunkId, const EDLCLoadPriority Priority)
+	{
+		FMountRequest* Request = Requests.Find(ChunkId);
+		if (!Request || static_cast<uint8>(Priority) >= static_cast<uint8>(Request->Priority))
+			return;
+
+		const EDLCLoadPriority PreviousPriority = Request->Priority;
+		Request->Priority = Priority;
+
+		// Priority of mount in flight affects only order of its completion
+		if (Request->bFinished)
+		{
+			FinishedQueues[static_cast<int32>(PreviousPriority)].Remove(ChunkId);
+			FinishedQueues[static_cast<int32>(Priority)].Add(ChunkId);
+		}
+		else if (!Request->bInFlight)
+		{
+			PendingQueues[static_cast<int32>(PreviousPriority)].Remove(ChunkId);
+			PendingQueues[static_cast<int32>(Priority)].Add(ChunkId);
+
+			Dispatch();
+		}
+	}
+
+	int32 FDLCMountScheduler::GetPendingMountsNum() const
+	{
+		int32 Result = 0;
+		for (const TArray<int32>& PendingQueue : PendingQueues)
+			Result += PendingQueue.Num();
+
+		return Result;
+	}
+
+	bool FDLCMountScheduler::Tick(float DeltaTime)
+	{
+		//NB: Callbacks may request and finish other mounts, so most urgent finished mount is taken again after every completion
+		auto PopMostUrgentFinishedMount = [this](int32& OutChunkId)
+		{
+			for (TArray<int32>& FinishedQueue : FinishedQueues)
+			{
+				if (FinishedQueue.Num() > 0)
+				{
+					OutChunkId = FinishedQueue[0];
+					FinishedQueue.RemoveAt(0);
+					return true;
+				}
+			}
+
+			return false;
+		};
+
+		int32 ChunkId = INDEX_NONE;
+		if (!PopMostUrgentFinishedMount(ChunkId))
+			return true;
+
+		DLC_TRACE_CPU_SCOPE(DLC_MountScheduler_Tick);
+
+		const double StartTime = FPlatformTime::Seconds();
+		do
+		{
+			CompleteMount(ChunkId);
+		}
+		while (FPlatformTime::Seconds() - StartTime < FrameBudgetSeconds && PopMostUrgentFinishedMount(ChunkId));
+
+		return true;
+	}
+
+	void FDLCMountScheduler::Dispatch()
+	{
+		for (TArray<int32>& PendingQueue : PendingQueues)
+		{
+			//NB: "Blocking" mounts are limited too: they are dispatched first, but unlimited mounts of many chunks would load
+			// indices of all their pak files at once
+			while (PendingQueue.Num() > 0 && InFlightMountsNum < MaxMountsInFlight)
+			{
+				const int32 ChunkId = PendingQueue[0];
+				PendingQueue.RemoveAt(0);
+
+				FMountRequest& Request = Requests.FindChecked(ChunkId);
+				Request.bInFlight = true;
+				++InFlightMountsNum;
+
+				ChunkDownloader->MountChunk(ChunkId, [WeakThis = TWeakPtr<FDLCMountScheduler, ESPMode::ThreadSafe>{ AsShared() }, ChunkId](const bool bSuccess)
+				{
+					if (const TSharedPtr<FDLCMountScheduler, ESPMode::ThreadSafe> This = WeakThis.Pin())
+					{
+						This->OnMountFinished(ChunkId, bSuccess);
+					}
+				});
+			}
+		}
+	}
+
+	void FDLCMountScheduler::OnMountFinished(const int32 ChunkId, const bool bSuccess)
+	{
+		FMountRequest* Request = Requests.Find(ChunkId);
+		if (!Request || Request->bFinished)
+			return;
+
+		--InFlightMountsNum;
+		Request->bInFlight = false;
+		Request->bFinished = true;
+		Request->bSuccess = bSuccess;
+		FinishedQueues[static_cast<int32>(Request->Priority)].Add(ChunkId);
+
+		// Next mounts are started right away, so worker threads are not idle while finished mounts wait for completion
+		Dispatch();
+	}
+
+	void FDLCMountScheduler::CompleteMount(const int32 ChunkId)
+	{
+		FMountRequest Request;
+		if (!Requests.RemoveAndCopyValue(ChunkId, Request))
+			return;
+
+		for (FCallback& Callback : Request.Callbacks)
+		{
+			Callback(Request.bSuccess);
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "DLCLoadPriority.h"
+
+class FChunkDownloader;
+
+namespace DLCPackageManagerPrivate
+{
+	// Orders mounts of downloaded chunks by priority classes and limits number of mounts in flight of all classes.
+	// ChunkDownloader registers pak files and loads their indices on worker threads, so game thread only starts mounts
+	// and finishes them. Finished mounts are completed by ticker within per-frame time budget (at least one mount per frame),
+	// so chunks finished at once do not call all their callbacks in one frame. Requests of same chunk are coalesced
+	class FDLCMountScheduler : public TSharedFromThis<FDLCMountScheduler, ESPMode::ThreadSafe>
+	{
+	public:
+		using FCallback = TFunction<void(bool bSuccess)>;
+
+		FDLCMountScheduler(const TSharedRef<FChunkDownloader>& InChunkDownloader, const int32 InMaxMountsInFlight, const double InFrameBudgetSeconds);
+		~FDLCMountScheduler();
+
+		// Requesting of already requested chunk adds callback and raises its priority if it is more urgent
+		void RequestMount(const int32 ChunkId, const EDLCLoadPriority Priority, FCallback&& Callback);
+
+		// Does nothing if chunk is not requested or already has same or more urgent priority
+		void RaiseMountPriority(const int32 ChunkId, const EDLCLoadPriority Priority);
+
+		int32 GetPendingMountsNum() const;
+
+	private:
+		static constexpr int32 PriorityClassesNum = 3;
+
+		struct FMountRequest
+		{
+			int32 ChunkId = INDEX_NONE;
+			EDLCLoadPriority Priority = EDLCLoadPriority::Prefetch;
+			bool bInFlight = false;
+			// Mount is finished by ChunkDownloader and waits for completion by ticker
+			bool bFinished = false;
+			bool bSuccess = false;
+			TArray<FCallback> Callbacks;
+		};
+
+		bool Tick(float DeltaTime);
+		void Dispatch();
+		void OnMountFinished(const int32 ChunkId, const bool bSuccess);
+		void CompleteMount(const int32 ChunkId);
+
+		TSharedRef<FChunkDownloader> ChunkDownloader;
+		const int32 MaxMountsInFlight;
+		const double FrameBudgetSeconds;
+
+		TMap<int32, FMountRequest> Requests;
+		TArray<int32> PendingQueues[PriorityClassesNum];
+		int32 InFlightMountsNum = 0;
+
+		// Mounts finished by ChunkDownloader that wait for their callbacks, by priority classes
+		TArray<int32> FinishedQueues[PriorityClassesNum];
+
+		FDelegateHandle TickerHandle;
+	};
+}
@@ -5,29 +5,183 @@
 #include "Version.h"
 #include "DLCPackageManager_Private.h"
 #include "DLCPackageManager_Debug.h"
+#include "DLCDownloadScheduler.h"
+#include "DLCMountScheduler.h"
+#include "DLCAccessHistory.h"
+#include "DLCCacheEviction.h"
+#include "DLCPakVerifier.h"
+#include "DLCCatalogSnapshot.h"
+#include "DLCDependencyGraph.h"
+#include "DLCPackageManagerTrace.h"
 
 #include "ChunkDownloader.h"
+#include "Async/Async.h"
 #include "Engine/StreamableManager.h"
 #include "Engine/AssetManager.h"
 #include "GenericPlatform/GenericPlatformFile.h"
-#include "Algo/MaxElement.h"
+#include "HAL/FileManager.h"
+#include "Misc/StringBuilder.h"
+#include "Misc/FileHelper.h"
+#include "Misc/SecureHash.h"
+#include "Misc/CoreDelegates.h"
+#include "UObject/UObjectGlobals.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
 
-FDLCPackageManager::FDLCPackageManager(const FString& DeploymentName, const FString& ContentBuildId)
+const FName FDLCPackageManager::DefaultInstanceName{ TEXT("Default") };
+
+FDLCPackageManager::FDLCPackageManager(const FName& InInstanceName, const FDLCPackageManagerSettings& InSettings)
+	: InstanceName(InInstanceName), Settings(InSettings)
+{
+	//NB: Promise is created with instance, so requests of other threads may wait for initialization that is not started yet
+	PackageManagerInitializationPromise = MakeShared<TMultiPromise<void>>();
+}
+
+void FDLCPackageManager::Initialize()
 {
-	using EPrintType = FDLCPackageManager_Debug::EPrintType;
+	check(IsInGameThread());
+
+	if (bIsInitializationStarted)
+		return;
+
+	bIsInitializationStarted = true;
+
 	FDLCPackageManager_Debug::FLogging_Initialization Logging{ };
 
-	Logging.PrintLog(EPrintType::Status, TEXT("Started"));
+	DLC_LOG(Logging, Status, TEXT("Started"));
 
-	ChunkDownloader = FChunkDownloader::GetOrCreate();
-	PackageManagerInitializationPromise = MakeShared<TMultiPromise<void>>();
+	InitializationStartTime = FPlatformTime::Seconds();
+
+	DLC_LOG(Logging, StatusImportant, TEXT("Instance [%s]: deployment [%s], content build [%s], platform [%s], [%d] concurrent downloads"),
+		*InstanceName.ToString(), *Settings.DeploymentName, *Settings.ContentBuildId, *Settings.PlatformName, Settings.MaxConcurrentDownloads);
+
+	//NB: Default instance shares global ChunkDownloader. Other instances need own ChunkDownloader to be independent
+	if (InstanceName == DefaultInstanceName)
+		ChunkDownloader = FChunkDownloader::GetOrCreate();
+	else
+		ChunkDownloader = MakeShared<FChunkDownloader>();
 	
-	//NB: Cache was used despite changes in CDN Manifest
-	//TODO: Find why CDN manifest was not reloaded
 	// load the cached build ID
-	ChunkDownloader->Initialize("Windows", 8);
+	ChunkDownloader->Initialize(Settings.PlatformName, Settings.MaxConcurrentDownloads);
+
+	const uint64 ResumableDownloadMinBytes = Settings.bEnableResumableDownloads ?
+		static_cast<uint64>(Settings.ResumableDownloadMinMegabytes) * 1024 * 1024 :
+		MAX_uint64;
+	DownloadScheduler = MakeShared<DLCPackageManagerPrivate::FDLCDownloadScheduler, ESPMode::ThreadSafe>(ChunkDownloader.ToSharedRef(), Settings.MaxConcurrentDownloads, ResumableDownloadMinBytes,
+		Settings.MaxResumableDownloadConnections);
+	MountScheduler = MakeShared<DLCPackageManagerPrivate::FDLCMountScheduler, ESPMode::ThreadSafe>(ChunkDownloader.ToSharedRef(), Settings.MaxConcurrentMounts, Settings.MountFrameBudgetMilliseconds / 1000.0);
+
+	//NB: Callbacks stored by subsystems and ChunkDownloader keep weak pointer, so they do not keep manager alive
+	DownloadScheduler->SetDeltaPatchCallback([WeakThis = FWeakThis{ AsShared() }](const int64 TargetBytes, const int64 PatchBytes, const double ReconstructionSeconds, const bool bSuccess)
+	{
+		if (const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin())
+		{
+			This->Metrics.OnDeltaPatchApplied(TargetBytes, PatchBytes, ReconstructionSeconds, bSuccess);
+		}
+	});
+
+	if (Settings.bVerifyPakFiles)
+	{
+		PakVerifier = MakeShared<DLCPackageManagerPrivate::FDLCPakVerifier, ESPMode::ThreadSafe>(ChunkDownloader.ToSharedRef(), [WeakThis = FWeakThis{ AsShared() }](const DLCPackageManagerPrivate::FDLCPakVerifier::FPakFileResult& Result)
+		{
+			if (const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin())
+			{
+				This->Metrics.OnPakFileVerified(Result.PakFileName, Result.HashedBytes, Result.HashingSeconds, Result.CorruptedBlocksNum, Result.bVerified);
+			}
+		});
+	}
+
+	//NB: Default instance shares global ChunkDownloader, so analytics handler that was set by game is kept and called first
+	ChunkDownloader->OnDownloadAnalytics = [WeakThis = FWeakThis{ AsShared() }, PreviousOnDownloadAnalytics = ChunkDownloader->OnDownloadAnalytics](
+		const FString& FileName, const FString& Url, uint64 SizeBytes, const FTimespan& DownloadTime, int32 HttpStatus)
+	{
+		if (PreviousOnDownloadAnalytics)
+		{
+			PreviousOnDownloadAnalytics(FileName, Url, SizeBytes, DownloadTime, HttpStatus);
+		}
+
+		const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin();
+		if (!This)
+			return;
+
+		using FPakFile = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FPakFile;
+		const TSharedRef<FPakFile>* PakFile = This->GetChunkDownloaderHackedAccess().PakFiles.Find(FileName);
+
+		This->Metrics.OnPakFileDownloaded(PakFile ? (*PakFile)->Entry.ChunkId : INDEX_NONE, FileName, SizeBytes, DownloadTime.GetTotalSeconds(), HttpStatus);
+	};
+
+	//NB: Instances sharing cache folder would drop pak files of each other, so other instances use own subfolder by default
+	const FString CacheFolder = (Settings.CacheFolder.IsEmpty() && InstanceName != DefaultInstanceName) ?
+		FDLCPackageManagerSettings::GetDefaultCacheFolder(InstanceName) :
+		Settings.CacheFolder;
+
+	if (!CacheFolder.IsEmpty())
+	{
+		//NB: ChunkDownloader always initializes its default cache folder, so custom folder is applied after initialization.
+		// Pak files found in default folder are dropped: they belong to default folder owner. Pak files cached in custom
+		// folder by previous sessions are taken from its local manifest
+		auto& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+		ChunkDownloaderHacked.CacheFolder = CacheFolder;
+		IFileManager::Get().MakeDirectory(*CacheFolder, true);
+
+		if (ChunkDownloaderHacked.LoadLocalManifest())
+		{
+			DLC_LOG(Logging, Status, TEXT("Local manifest of cache folder [%s] is loaded: [%d] pak files"), *CacheFolder, ChunkDownloaderHacked.PakFiles.Num());
+		}
+	}
+
+	for (const FString& PinnedPackage : Settings.PinnedPackages)
+	{
+		PinnedDLCPackageNames.Add(FName{ *PinnedPackage });
+	}
+
+	if (Settings.bDownloadDependencyPackages)
+	{
+		DependencyGraph = MakeUnique<DLCPackageManagerPrivate::FDLCDependencyGraph>();
+
+		if (!DLCPackageManagerPrivate::FDLCDependencyGraph::HasPackageDependencies())
+		{
+			DLC_LOG(Logging, Warning, TEXT("Asset registry has no package dependencies of game assets, so dependency packages are not found. Cooked asset registry should be serialized with dependencies"));
+		}
+	}
+
+	AccessHistory = MakeUnique<DLCPackageManagerPrivate::FDLCAccessHistory>();
+	AccessHistory->LoadFromFile(GetAccessHistoryFilePath());
+
+	ResolvedObjectsFutureStates = MakeUnique<DLCPackageManagerPrivate::TReadyFutureStates<FName, UObject*>>();
+
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddRaw(this, &FDLCPackageManager::OnPostGarbageCollect);
+
+	const FString& DeploymentName = Settings.DeploymentName;
+	const FString& ContentBuildId = Settings.ContentBuildId;
+
+	if (Settings.StartupMode == EDLCManifestStartupMode::StaleWhileRevalidate)
+	{
+		//NB: Cached build is used only if it was made for same content build. Otherwise "UpdateBuild()" downloads
+		// manifest of new content build anyway
+		if (ChunkDownloader->LoadCachedBuild(DeploymentName) && GetChunkDownloaderHackedAccess().ContentBuildId == ContentBuildId)
+		{
+			DLC_LOG(Logging, StatusImportant, TEXT("Catalog is built from cached manifest. Manifest will be revalidated in background"));
+
+			Initialize_PackagesInfo([This = AsShared()]() { This->FinishInitialization(); });
+
+			RevalidateCachedManifest();
+			return;
+		}
+
+		DLC_LOG(Logging, StatusImportant, TEXT("There where no manifest file cache for content build [%s]"), *ContentBuildId);
+	}
+
+	UpdateBuild_ForcingManifestDownload(DeploymentName, ContentBuildId);
+}
+
+void FDLCPackageManager::UpdateBuild_ForcingManifestDownload(const FString& DeploymentName, const FString& ContentBuildId)
+{
+	FDLCPackageManager_Debug::FLogging_Initialization Logging{ };
 
-	//NB: We remove build manifest cache to force uploading of all actual DLC files list
+	//NB: Cache is used by ChunkDownloader despite changes in CDN Manifest if content build id is not changed.
+	// We remove build manifest cache to force uploading of all actual DLC files list
 	struct FChunkDownloaderCacheMovingState
 	{
 		bool bMovedCacheExist;
@@ -42,255 +196,1805 @@ FDLCPackageManager::FDLCPackageManager(const FString& DeploymentName, const FStr
 
 	if (!CacheMovingState.bMovedCacheExist)
 	{
-		Logging.PrintLog(EPrintType::StatusImportant, TEXT("There where no manifrst file cache"));
+		DLC_LOG(Logging, StatusImportant, TEXT("There where no manifrst file cache"));
 	}
 
-	ChunkDownloader->UpdateBuild(DeploymentName, ContentBuildId, [this, CacheMovingState = MoveTemp(CacheMovingState), DeploymentName, Logging](bool bSuccess)
+	//NB: Validators are saved again after downloading. Stale ones should not be paired with downloaded manifest if session ends before it
+	IFileManager::Get().Delete(*GetManifestValidatorsFilePath());
+
+	ChunkDownloader->UpdateBuild(DeploymentName, ContentBuildId, [WeakThis = FWeakThis{ AsShared() }, CacheMovingState = MoveTemp(CacheMovingState), DeploymentName, Logging](bool bSuccess)
 	{
-		Logging.PrintLog(EPrintType::Status, TEXT("Build updated %s"), bSuccess ? TEXT("successful") : TEXT("unsuccessful"));
+		const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin();
+		if (!This)
+			return;
+
+		DLC_LOG(Logging, Status, TEXT("Build updated %s"), bSuccess ? TEXT("successful") : TEXT("unsuccessful"));
 
 		if (CacheMovingState.bMovedCacheExist)
 		{
 			if (bSuccess)
 			{
-				IPlatformFile::GetPlatformPhysical().DeleteFile(*GetChunkDownloaderCachedManifestFilePath());
+				IPlatformFile::GetPlatformPhysical().DeleteFile(*CacheMovingState.MovedCachePath);
 			}
 			else
 			{
 				IPlatformFile::GetPlatformPhysical().MoveFile(*CacheMovingState.MovedCachePath, *CacheMovingState.OriginalCachePath);
-				ChunkDownloader->LoadCachedBuild(DeploymentName);
+				This->ChunkDownloader->LoadCachedBuild(DeploymentName);
 			}
 		}
 
-		Initialize_PackagesInfo();
+		if (bSuccess)
+		{
+			// Manifest was downloaded without validators, so only its content hash is known
+			FDLCPackageManager_Private::FManifestValidators Validators;
+			Validators.ContentHash = FDLCPackageManager_Private::GetManifestFileContentHash(This->GetChunkDownloaderCachedManifestFilePath());
+			FDLCPackageManager_Private::SaveManifestValidators(This->GetManifestValidatorsFilePath(), Validators);
+		}
 
-		this->PackageManagerInitializationPromise->SetValue();
+		This->Initialize_PackagesInfo([This]() { This->FinishInitialization(); });
 	});
 }
 
-FDLCPackageManager& FDLCPackageManager::Get()
+void FDLCPackageManager::FinishInitialization()
 {
-	static const FString DeploymentName = "PatchingDemoLive";
-	static const FString ContentBuildId = "PatchingDemoKey";
-	static FDLCPackageManager Downloader{ DeploymentName, ContentBuildId };
-	return Downloader;
+	FDLCPackageManager_Debug::FLogging_Initialization Logging{ };
+
+	DLC_LOG(Logging, StatusImportant, TEXT("Finished in [%.3f] seconds with [%d] DLC packages"),
+		FPlatformTime::Seconds() - InitializationStartTime, DLCPackages.Num());
+
+	PackageManagerInitializationPromise->SetValue();
 }
-	
-TFuture<UObject*> FDLCPackageManager::GetLoadedPath(const FSoftObjectPtr& SoftObjectPtr)
+
+void FDLCPackageManager::RevalidateCachedManifest()
 {
-	using EPrintType = FDLCPackageManager_Debug::EPrintType;
-	FDLCPackageManager_Debug::FLogging_Loading Logging{ SoftObjectPtr };
+	FDLCPackageManager_Debug::FLogging_ManifestRevalidation Logging{ };
 
-	Logging.PrintLog(EPrintType::Status, TEXT("Start"));
-	
-	if (SoftObjectPtr.IsNull())
+	const auto& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+	if (ChunkDownloaderHacked.BuildBaseUrls.Num() == 0)
 	{
-		Logging.PrintLog(EPrintType::Warning, TEXT("Empty soft reference passed"));
-		
-		return DLCPackageManagerPrivate::FilledFuture<UObject*>(nullptr);
+		DLC_LOG(Logging, Warning, TEXT("No CDN urls for deployment [%s]. Cached manifest is kept"), *ChunkDownloaderHacked.LastDeploymentName);
+		return;
 	}
 
-	if (SoftObjectPtr.IsValid())
-	{
-		Logging.PrintLog(EPrintType::Status, TEXT("Reference is already resolved"));
+	//NB: Same manifest url as ChunkDownloader uses for manifest downloading
+	const FString ManifestUrl = ChunkDownloaderHacked.BuildBaseUrls[0] / FString::Printf(TEXT("BuildManifest-%s.txt"), *ChunkDownloaderHacked.PlatformName);
 
-		return DLCPackageManagerPrivate::FilledFuture<UObject*>(SoftObjectPtr.Get());
+	FDLCPackageManager_Private::FManifestValidators CachedValidators = FDLCPackageManager_Private::LoadManifestValidators(GetManifestValidatorsFilePath());
+	if (CachedValidators.ContentHash.IsEmpty())
+	{
+		CachedValidators.ContentHash = FDLCPackageManager_Private::GetManifestFileContentHash(GetChunkDownloaderCachedManifestFilePath());
 	}
 
-	auto LoadingPromise = MakeShared<DLCPackageManagerPrivate::TPromiseWithWorkaroundedCanceling<UObject*>>();
-	TFuture<UObject*> LoadingFuture = LoadingPromise->GetFuture();
+	DLC_LOG(Logging, Status, TEXT("Requesting [%s] with ETag [%s]"), *ManifestUrl, *CachedValidators.ETag);
 
-	Logging.PrintLog(EPrintType::Status, TEXT("Start waiting package manager initialization"));
+	const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(ManifestUrl);
+	Request->SetVerb(TEXT("GET"));
+	if (!CachedValidators.ETag.IsEmpty())
+	{
+		Request->SetHeader(TEXT("If-None-Match"), CachedValidators.ETag);
+	}
 
-	PackageManagerInitializationPromise->MakeFuture().Next([LoadingPromise, SoftObjectPtr, this, Logging](int32)
+	Request->OnProcessRequestComplete().BindLambda([WeakThis = FWeakThis{ AsShared() }, CachedValidators, Logging](FHttpRequestPtr, FHttpResponsePtr Response, bool bSucceeded)
 	{
-		Logging.PrintLog(EPrintType::Status, TEXT("Finish waiting package manager initialization"));
-		
-		const TOptional<FString> DLCChunkId = FDLCPackageManager_Private::GetDLCChunkId(SoftObjectPtr);
-		
-		TFuture<void> DownloadedDLCChunkFuture;
+		const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin();
+		if (!This)
+			return;
 
-		if (DLCChunkId.IsSet())
+		if (!bSucceeded || !Response.IsValid())
 		{
-			Logging.PrintLog(EPrintType::Status, TEXT("Found chunk [%s] for path. Starting DLC chunk downloading"),
-				*DLCChunkId.GetValue());
-			
-			DownloadedDLCChunkFuture = DownloadDLCChunk(DLCChunkId.GetValue());
+			DLC_LOG(Logging, Warning, TEXT("Request failed. Cached manifest is kept"));
+			return;
 		}
-		else
+
+		const int32 ResponseCode = Response->GetResponseCode();
+		if (ResponseCode == EHttpResponseCodes::NotModified)
 		{
-			Logging.PrintLog(EPrintType::Status, TEXT("No DLC chunks for path, reference is expected to be placed in the main package"));
-			
-			DownloadedDLCChunkFuture = DLCPackageManagerPrivate::FilledFuture();
+			DLC_LOG(Logging, StatusImportant, TEXT("Manifest is not modified"));
+			return;
 		}
 
-		DownloadedDLCChunkFuture.Next([LoadingPromise, SoftObjectPtr, Logging](int32)
+		if (!EHttpResponseCodes::IsOk(ResponseCode))
 		{
-			Logging.PrintLog(EPrintType::Status, TEXT("Asset by soft reference is ready to be loaded to RAM"));
-			
-			UAssetManager* Manager = UAssetManager::GetIfValid();
-			check(Manager);
-			Manager->GetStreamableManager().RequestAsyncLoad(
-				{ SoftObjectPtr.ToSoftObjectPath() },
-				[LoadingPromise, SoftObjectPtr, Logging]()
-				{					
-					UObject* Result = SoftObjectPtr.Get();
-
-					if (Result)
-						Logging.PrintLog(EPrintType::StatusImportant, TEXT("Asset is loaded to RAM and ready for use"));
-					else
-						Logging.PrintLog(EPrintType::StatusImportant, TEXT("Unexpected asset loading error"));
-				
-					LoadingPromise->EmplaceValue(MoveTemp(Result));
-				});
-		});
-	});
-
-	return LoadingFuture;
-}
+			DLC_LOG(Logging, Warning, TEXT("Unexpected response code [%d]. Cached manifest is kept"), ResponseCode);
+			return;
+		}
 
-FDLCPackageManager::~FDLCPackageManager()
-{
-	FChunkDownloader::Shutdown();
-}
+		const TArray<uint8>& Content = Response->GetContent();
 
-void FDLCPackageManager::Initialize_PackagesInfo()
-{
-	using EPrintType = FDLCPackageManager_Debug::EPrintType;
-	FDLCPackageManager_Debug::FLogging_Initialization Logging{ };
+		FDLCPackageManager_Private::FManifestValidators NewValidators;
+		NewValidators.ETag = Response->GetHeader(TEXT("ETag"));
+		NewValidators.ContentHash = FMD5::HashBytes(Content.GetData(), Content.Num());
 
-	using FPakFile = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FPakFile;
+		if (NewValidators.ContentHash == CachedValidators.ContentHash)
+		{
+			DLC_LOG(Logging, StatusImportant, TEXT("Manifest content is not changed"));
 
-	const auto& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+			FDLCPackageManager_Private::SaveManifestValidators(This->GetManifestValidatorsFilePath(), NewValidators);
+			return;
+		}
 
-	for (const TPair<FString, TSharedRef<FPakFile>>& PakFile : ChunkDownloaderHacked.PakFiles)
-	{
-		const FPakFileEntry& PakFileEntry = PakFile.Value->Entry;
+		DLC_LOG(Logging, StatusImportant, TEXT("Manifest is changed. Reloading build and rebuilding catalog"));
 
-		const FString& DLCChunkID = FDLCPackageManager_Private::GetDLCChunkIDForPakFileEntry(PakFileEntry);
+		//NB: Catalog snapshot is keyed by content hash of validators. Validators of replaced manifest are deleted before
+		// it is written, so if session ends before new validators are saved, hash of manifest file is used instead of stale one
+		IFileManager::Get().Delete(*This->GetManifestValidatorsFilePath());
 
-		TOptional<FDLCPackageManager_Private::FParsedDLCChunkID> ParsedDLCChunkIDResult = FDLCPackageManager_Private::ParseDLCChunkID(DLCChunkID);
-		if (!ParsedDLCChunkIDResult.IsSet())
+		//NB: Downloaded manifest replaces cached one, so ChunkDownloader may load it as cached build
+		if (!FFileHelper::SaveArrayToFile(Content, *This->GetChunkDownloaderCachedManifestFilePath()))
 		{
-			Logging.PrintLog(EPrintType::Error, TEXT("Package info parse failure. Cannot parse package with DLC chunk id [%s], chunk id [%d]. Version ignored"),
-				*DLCChunkID, PakFileEntry.ChunkId);
+			DLC_LOG(Logging, Error, TEXT("Cannot save manifest to cache"));
+			return;
+		}
 
-			continue;
+		if (!This->ChunkDownloader->LoadCachedBuild(This->GetChunkDownloaderHackedAccess().LastDeploymentName))
+		{
+			DLC_LOG(Logging, Error, TEXT("Cannot load downloaded manifest"));
+			return;
 		}
 
-		const FDLCPackageManager_Private::FParsedDLCChunkID& ParsedDLCChunkID = ParsedDLCChunkIDResult.GetValue();
-		const FString& DLCPackageName = ParsedDLCChunkID.Name;
+		FDLCPackageManager_Private::SaveManifestValidators(This->GetManifestValidatorsFilePath(), NewValidators);
 
-		FDLCPackage* PackagePtr = FindDLCPackage(DLCPackageName);
-		if (!PackagePtr)
-		{
-			TSharedPtr<FDLCPackage>& NewPackageSharedPtr = DLCPackages[DLCPackages.Emplace()];
-			NewPackageSharedPtr = MakeShared<FDLCPackage>();
+		This->Initialize_PackagesInfo();
+	});
 
-			PackagePtr = NewPackageSharedPtr.Get();
-			PackagePtr->Name = DLCPackageName;
-		}
+	Request->ProcessRequest();
+}
 
-		TArray<FDLCPackage::FVersionInfo>& VersionInfos = PackagePtr->VersionInfos;
-		FDLCPackage::FVersionInfo& NewVersion = VersionInfos[VersionInfos.Emplace()];
-		NewVersion.Version = MakeShared<DLCPackageManagerPrivate::FVersion>(ParsedDLCChunkID.Version);
-	}
+FDLCPackageManager& FDLCPackageManager::Get()
+{
+	return Get(DefaultInstanceName);
 }
 
-const FDLCPackageManager::FDLCPackage::FVersionInfo& FDLCPackageManager::FDLCPackage::GetLatestVersionInfo() const
+namespace
 {
-	return *Algo::MaxElementBy(
-		VersionInfos,
-		[](const FDLCPackage::FVersionInfo& Version) {
-			return *Version.Version;
-		});
+	struct FDLCPackageManagerInstances
+	{
+		TMap<FName, TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe>> Instances;
+		FCriticalSection Mutex;
+	};
+
+	FDLCPackageManagerInstances& GetDLCPackageManagerInstances()
+	{
+		static FDLCPackageManagerInstances Instances;
+		return Instances;
+	}
 }
 
-FString FDLCPackageManager::GetChunkDownloaderCachedManifestFilePath() const
+FDLCPackageManager& FDLCPackageManager::Get(const FName& InstanceName)
 {
-	const auto& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+	FDLCPackageManagerInstances& Instances = GetDLCPackageManagerInstances();
+	FScopeLock Lock{ &Instances.Mutex };
 
-	return ChunkDownloaderHacked.CacheFolder / ChunkDownloaderHacked.CACHED_BUILD_MANIFEST;
+	TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe>& Instance = Instances.Instances.FindOrAdd(InstanceName);
+	if (!Instance.IsValid())
+	{
+		Instance = MakeShareable(new FDLCPackageManager{ InstanceName, FDLCPackageManagerSettings::LoadFromConfig(InstanceName) });
+
+		//NB: ChunkDownloader, tickers and HTTP requests of initialization are game thread only. Requests of other threads
+		// are forwarded to the game thread after this task, so they find initialization started
+		if (!IsInGameThread())
+		{
+			AsyncTask(ENamedThreads::GameThread, [Instance = Instance]() { Instance->Initialize(); });
+		}
+	}
+
+	//NB: Instance may be created by other thread, and its initialization task may be not done yet
+	if (IsInGameThread())
+	{
+		Instance->Initialize();
+	}
+
+	return *Instance;
 }
 
-TFuture<void> FDLCPackageManager::DownloadDLCChunk(const FString& DLCChunkID)
+bool FDLCPackageManager::HasInstance(const FName& InstanceName)
 {
-	using EPrintType = FDLCPackageManager_Debug::EPrintType;
-	FDLCPackageManager_Debug::FLogging_DLCChunkDownloading Logging{ DLCChunkID };
+	FDLCPackageManagerInstances& Instances = GetDLCPackageManagerInstances();
+	FScopeLock Lock{ &Instances.Mutex };
 
-	Logging.PrintLog(EPrintType::Status, TEXT("Start"));
+	const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe>* Instance = Instances.Instances.Find(InstanceName);
+	return Instance && Instance->IsValid();
+}
 	
-	FDLCPackage* DLCPackage = FindDLCPackage(DLCChunkID);
-	//TODO: Return error "No chunk with proivded Id"
-	if (!DLCPackage)
+struct FDLCPackageManager::FLoadingRequest
+{
+	FLoadingRequest(const FSoftObjectPtr& InSoftObjectPtr, const EDLCLoadPriority InPriority, FDLCPackageManager_Debug::FLogging_Loading&& InLogging)
+		: SoftObjectPtr(InSoftObjectPtr), Priority(InPriority), Logging(MoveTemp(InLogging))
 	{
-		Logging.PrintLog(EPrintType::Warning, TEXT("Cannot find Chunk Id for DLC Chunk Id"));
-		
-		return DLCPackageManagerPrivate::FilledFuture();
+		static uint32 LastRequestNumber = 0;
+		RequestNumber = ++LastRequestNumber;
+
+		TRACE_COUNTER_INCREMENT(DLCLoadingRequests);
 	}
 
-	FDLCPackage::FStatus& PackageStatus = DLCPackage->Status;
-	if (PackageStatus.IsType<FDLCPackage::FStatus_NotDownloaded>())
+	~FLoadingRequest()
 	{
-		PackageStatus.Emplace<FDLCPackage::FStatus_DownloadingAndMounting>();
-		PackageStatus.Get<FDLCPackage::FStatus_DownloadingAndMounting>().Promise = MakeShared<TMultiPromise<void>>();
-		
-		const FDLCPackageManager::FDLCPackage::FVersionInfo& VersionInfo = DLCPackage->GetLatestVersionInfo();
-		const int32 VersionChunkId = VersionInfo.ChunkId;
+		TRACE_COUNTER_DECREMENT(DLCLoadingRequests);
+	}
 
-		Logging.PrintLog(EPrintType::Status, TEXT("DLC Chunk had [NotDownloaded] state. Switching to [DownloadingAndMounting] state. DLC version [%s] aka chunk pak [%d]"),
-			*VersionInfo.Version->ToString(), VersionChunkId);
-		
-		//TODO: Put here tracking of concrete chunk loading process
-		ChunkDownloader->DownloadChunks({ VersionChunkId }, [](const bool bSuccess){ }, 1);
+	const FSoftObjectPtr SoftObjectPtr;
+	const EDLCLoadPriority Priority;
+	const FDLCPackageManager_Debug::FLogging_Loading Logging;
 
-		ChunkDownloader->BeginLoadingMode([this, &PackageStatus, VersionChunkId, Debug_DLCChunkID = DLCChunkID, Logging](const bool bSuccess)
-		{
-			//TODO: Check if "this" is OK
-			this->ChunkDownloader->MountChunk(VersionChunkId, [&PackageStatus, Debug_DLCChunkID, Logging](const bool bSuccess)
-			{
-				Logging.PrintLog(EPrintType::Status, TEXT("DLC Chunk had [DownloadingAndMounting] state. After filling promise it finaly will have [Mounted] state"));
-				
-				//TODO: Check if "this" is OK
-				//TODO: Move promise and setup "FChunkState_Mounted" state before filling promise for more consistent state in callbacks after filling promise
-				PackageStatus.Get<FDLCPackage::FStatus_DownloadingAndMounting>().Promise->SetValue();
+	FDLCPackageManagerMetrics::FRequestRecord MetricsRecord;
+	DLCPackageManagerPrivate::TPromiseWithWorkaroundedCanceling<UObject*> Promise;
 
-				PackageStatus.Emplace<FDLCPackage::FStatus_Mounted>();
-			});
+	// Identifies request on trace timeline
+	uint32 RequestNumber = 0;
+	DLCPackageManagerPrivate::FDLCTraceRegion StageRegion;
+};
+
+TFuture<UObject*> FDLCPackageManager::GetLoadedPath(const FSoftObjectPtr& SoftObjectPtr, const EDLCLoadPriority Priority)
+{
+	//NB: Package states are changed only on the game thread, so requests of other threads are forwarded to it
+	if (!IsInGameThread())
+	{
+		return DLCPackageManagerPrivate::CallOnGameThread<UObject*>([This = AsShared(), SoftObjectPtr, Priority]()
+		{
+			return This->GetLoadedPath(SoftObjectPtr, Priority);
 		});
 	}
+
+	DLC_TRACE_CPU_SCOPE(DLC_GetLoadedPath);
+
+	FDLCPackageManager_Debug::FLogging_Loading Logging{ SoftObjectPtr };
+
+	DLC_LOG(Logging, Status, TEXT("Start"));
 	
-	if (auto* ChunkState_DownloadingAndMounting = PackageStatus.TryGet<FDLCPackage::FStatus_DownloadingAndMounting>())
+	if (SoftObjectPtr.IsNull())
 	{
-		Logging.PrintLog(EPrintType::Status, TEXT("Actually started downloading request. Waiting [DownloadingAndMounting] finish"));
+		DLC_LOG(Logging, Warning, TEXT("Empty soft reference passed"));
 		
-		return ChunkState_DownloadingAndMounting->Promise->MakeFuture();
+		return DLCPackageManagerPrivate::DefaultFilledFuture<UObject*>();
 	}
 
-	//TODO: Put "Success" result info
-	check(PackageStatus.IsType<FDLCPackage::FStatus_Mounted>());
+	if (SoftObjectPtr.IsValid())
+	{
+		DLC_LOG(Logging, Status, TEXT("Reference is already resolved"));
+
+		//NB: Resolved object is acquired as loaded one, so every request is paired with its release
+		AcquireResolvedPath(SoftObjectPtr.ToSoftObjectPath());
 
-	Logging.PrintLog(EPrintType::Status, TEXT("DLC Chunk is finaly in [FChunkState_Mounted] state. Return filled future"));
-	
-	return DLCPackageManagerPrivate::FilledFuture();
+		//NB: Repeated requests of resolved object share ready future state instead of allocating new one
+		return ResolvedObjectsFutureStates->MakeFuture(SoftObjectPtr.ToSoftObjectPath().GetAssetPathName(), SoftObjectPtr.Get());
+	}
+
+	const TSharedRef<FLoadingRequest> Request = MakeShared<FLoadingRequest>(SoftObjectPtr, Priority, MoveTemp(Logging));
+	TFuture<UObject*> LoadingFuture = Request->Promise.GetFuture();
+
+	Request->MetricsRecord.StartTime = FPlatformTime::Seconds();
+	Request->StageRegion.Begin(TEXT("DLC load #%u: initialization wait"), Request->RequestNumber);
+
+	DLC_LOG(Request->Logging, Status, TEXT("Start waiting package manager initialization"));
+
+	DLCPackageManagerPrivate::WhenReady(PackageManagerInitializationPromise->MakeFuture(), [This = AsShared(), Request]()
+	{
+		This->GetLoadedPath_Download(Request);
+	});
+
+	return LoadingFuture;
 }
 
-const DLCPackageManagerPrivate::FHackingType_ChunkDownloader& FDLCPackageManager::GetChunkDownloaderHackedAccess() const
+// - - - - - - - - - - - - -
+
+void FDLCPackageManager::GetLoadedPath_Download(const TSharedRef<FLoadingRequest>& Request)
 {
-	return DLCPackageManagerPrivate::GetHackedType<DLCPackageManagerPrivate::FHackingType_ChunkDownloader>(*ChunkDownloader.Get());
+	DLC_TRACE_CPU_SCOPE(DLC_GetLoadedPath_Download);
+
+	const FDLCPackageManager_Debug::FLogging_Loading& Logging = Request->Logging;
+
+	DLC_LOG(Logging, Status, TEXT("Finish waiting package manager initialization"));
+
+	Request->MetricsRecord.InitializationWaitEndTime = FPlatformTime::Seconds();
+
+	//NB: Packages of hard referenced assets are downloaded in parallel with package of the path,
+	// so loading does not find them missing
+	TArray<FDLCPackage*> DLCPackagesToDownload;
+	FDLCPackage* DLCPackage = AcquireDLCPackagesForPath(Request->SoftObjectPtr.ToSoftObjectPath(), DLCPackagesToDownload);
+
+	TArray<TFuture<void>> DownloadedDLCChunkFutures;
+
+	if (DLCPackage)
+	{
+		Request->MetricsRecord.DLCPackageName = DLCPackage->Name;
+		Request->StageRegion.Begin(TEXT("DLC load #%u: package [%s] wait"), Request->RequestNumber, *DLCPackage->Name.ToString());
+
+		OnDLCPackagesRequested({ DLCPackage }, Request->Priority);
+
+		DLCPackagesToDownload.Insert(DLCPackage, 0);
+
+		DLC_LOG(Logging, Status, TEXT("Found chunk [%s] for path with [%d] dependency chunks. Starting DLC chunks downloading"),
+			*DLCPackage->Name.ToString(), DLCPackagesToDownload.Num() - 1);
+
+		DownloadedDLCChunkFutures = DownloadDLCPackages(DLCPackagesToDownload, Request->Priority);
+
+		PrefetchSuccessors({ DLCPackage }, Request->Priority);
+	}
+	else
+	{
+		DLC_LOG(Logging, Status, TEXT("No DLC chunks for path, reference is expected to be placed in the main package"));
+	}
+
+	DLCPackageManagerPrivate::WhenAllReady(MoveTemp(DownloadedDLCChunkFutures), [This = AsShared(), Request]()
+	{
+		This->GetLoadedPath_Load(Request);
+	});
+}
+
+void FDLCPackageManager::GetLoadedPath_Load(const TSharedRef<FLoadingRequest>& Request)
+{
+	DLC_TRACE_CPU_SCOPE(DLC_GetLoadedPath_Load);
+
+	DLC_LOG(Request->Logging, Status, TEXT("Asset by soft reference is ready to be loaded to RAM"));
+
+	Request->MetricsRecord.DLCChunkReadyTime = FPlatformTime::Seconds();
+	Request->StageRegion.Begin(TEXT("DLC load #%u: streamable loading"), Request->RequestNumber);
+
+	UAssetManager* Manager = UAssetManager::GetIfValid();
+	check(Manager);
+
+	Manager->GetStreamableManager().RequestAsyncLoad({ Request->SoftObjectPtr.ToSoftObjectPath() }, [This = AsShared(), Request]()
+	{
+		This->GetLoadedPath_Finish(Request);
+	});
+}
+
+void FDLCPackageManager::GetLoadedPath_Finish(const TSharedRef<FLoadingRequest>& Request)
+{
+	DLC_TRACE_CPU_SCOPE(DLC_GetLoadedPath_Finish);
+
+	Request->StageRegion.End();
+
+	UObject* Result = Request->SoftObjectPtr.Get();
+
+	if (Result)
+		DLC_LOG(Request->Logging, StatusImportant, TEXT("Asset is loaded to RAM and ready for use"));
+	else
+		DLC_LOG(Request->Logging, StatusImportant, TEXT("Unexpected asset loading error"));
+
+	Request->MetricsRecord.LoadEndTime = FPlatformTime::Seconds();
+	Request->MetricsRecord.bSucceeded = (Result != nullptr);
+	Metrics.OnRequestFinished(Request->MetricsRecord);
+
+	Request->Promise.EmplaceValue(MoveTemp(Result));
 }
 
-const FDLCPackageManager::FDLCPackage* FDLCPackageManager::FindDLCPackage(const FString& PackageName) const
+struct FDLCPackageManager::FBatchLoadingRequest
+{
+	FBatchLoadingRequest(const EDLCLoadPriority InPriority, FDLCPackageManager_Debug::FLogging_BatchLoading&& InLogging)
+		: Priority(InPriority), Logging(MoveTemp(InLogging)) { }
+
+	const EDLCLoadPriority Priority;
+	const FDLCPackageManager_Debug::FLogging_BatchLoading Logging;
+
+	TArray<UObject*> Results;
+
+	// References that are not resolved yet and their indices in results
+	TArray<FSoftObjectPtr> PendingSoftObjectPtrs;
+	TArray<int32> PendingResultIndices;
+
+	int32 PendingGroupsNum = 0;
+	DLCPackageManagerPrivate::TPromiseWithWorkaroundedCanceling<TArray<UObject*>> Promise;
+
+	FDLCPackageManagerMetrics::FRequestRecord MetricsRecord;
+};
+
+TFuture<TArray<UObject*>> FDLCPackageManager::GetLoadedPaths(TArrayView<const FSoftObjectPtr> SoftObjectPtrs, const EDLCLoadPriority Priority)
 {
-	const TSharedPtr<FDLCPackage>* DLCPackagePtrPtr = DLCPackages.FindByPredicate(
-		[&PackageName](const TSharedPtr<FDLCPackage>& Package) {
-			return (Package->Name == PackageName);
+	if (!IsInGameThread())
+	{
+		return DLCPackageManagerPrivate::CallOnGameThread<TArray<UObject*>>([This = AsShared(), SoftObjectPtrsCopy = TArray<FSoftObjectPtr>{ SoftObjectPtrs }, Priority]()
+		{
+			return This->GetLoadedPaths(SoftObjectPtrsCopy, Priority);
 		});
-	return DLCPackagePtrPtr ? DLCPackagePtrPtr->Get() : nullptr;
+	}
+
+	DLC_TRACE_CPU_SCOPE(DLC_GetLoadedPaths);
+
+	const TSharedRef<FBatchLoadingRequest> Request = MakeShared<FBatchLoadingRequest>(Priority, FDLCPackageManager_Debug::FLogging_BatchLoading{ SoftObjectPtrs.Num() });
+	const FDLCPackageManager_Debug::FLogging_BatchLoading& Logging = Request->Logging;
+
+	DLC_LOG(Logging, Status, TEXT("Start"));
+
+	Request->Results.SetNumZeroed(SoftObjectPtrs.Num());
+	Request->MetricsRecord.StartTime = FPlatformTime::Seconds();
+	Request->MetricsRecord.ObjectsNum = SoftObjectPtrs.Num();
+
+	for (int32 Index = 0; Index < SoftObjectPtrs.Num(); ++Index)
+	{
+		const FSoftObjectPtr& SoftObjectPtr = SoftObjectPtrs[Index];
+
+		if (SoftObjectPtr.IsNull())
+		{
+			DLC_LOG(Logging, Warning, TEXT("Empty soft reference passed at index [%d]"), Index);
+			continue;
+		}
+
+		if (SoftObjectPtr.IsValid())
+		{
+			//NB: Resolved object is acquired as loaded one, so every reference is paired with its release
+			AcquireResolvedPath(SoftObjectPtr.ToSoftObjectPath());
+
+			Request->Results[Index] = SoftObjectPtr.Get();
+			continue;
+		}
+
+		Request->PendingSoftObjectPtrs.Add(SoftObjectPtr);
+		Request->PendingResultIndices.Add(Index);
+	}
+
+	if (Request->PendingSoftObjectPtrs.Num() == 0)
+	{
+		DLC_LOG(Logging, Status, TEXT("All references are already resolved"));
+
+		return DLCPackageManagerPrivate::FilledFuture(MoveTemp(Request->Results));
+	}
+
+	TFuture<TArray<UObject*>> LoadingFuture = Request->Promise.GetFuture();
+
+	DLC_LOG(Logging, Status, TEXT("Start waiting package manager initialization"));
+
+	DLCPackageManagerPrivate::WhenReady(PackageManagerInitializationPromise->MakeFuture(), [This = AsShared(), Request]()
+	{
+		This->GetLoadedPaths_Download(Request);
+	});
+
+	return LoadingFuture;
 }
 
-FDLCPackageManager::FDLCPackage* FDLCPackageManager::FindDLCPackage(const FString& PackageName)
+void FDLCPackageManager::GetLoadedPaths_Download(const TSharedRef<FBatchLoadingRequest>& Request)
 {
-	const FDLCPackage* ConstPackage = const_cast<const FDLCPackageManager*>(this)->FindDLCPackage(PackageName);
-	return const_cast<FDLCPackage*>(ConstPackage);
+	DLC_TRACE_CPU_SCOPE(DLC_GetLoadedPaths_Download);
+
+	const FDLCPackageManager_Debug::FLogging_BatchLoading& Logging = Request->Logging;
+	const EDLCLoadPriority Priority = Request->Priority;
+
+	DLC_LOG(Logging, Status, TEXT("Finish waiting package manager initialization"));
+
+	Request->MetricsRecord.InitializationWaitEndTime = FPlatformTime::Seconds();
+
+	// Group pending references by DLC chunk. References without DLC chunk are expected to be placed in the main package
+
+	TMap<FDLCPackage*, TArray<int32>> DLCChunkGroups;
+	TArray<int32> MainPackageGroup;
+
+	// Other DLC packages hard referenced by references of group (see "FindDependencyDLCPackagesForPath()")
+	TMap<FDLCPackage*, TArray<FDLCPackage*>> DLCChunkGroupsDependencies;
+
+	for (int32 PendingIndex = 0; PendingIndex < Request->PendingSoftObjectPtrs.Num(); ++PendingIndex)
+	{
+		TArray<FDLCPackage*> DependencyDLCPackages;
+		FDLCPackage* DLCPackage = AcquireDLCPackagesForPath(Request->PendingSoftObjectPtrs[PendingIndex].ToSoftObjectPath(), DependencyDLCPackages);
+
+		if (DLCPackage)
+		{
+			TArray<FDLCPackage*>& GroupDependencies = DLCChunkGroupsDependencies.FindOrAdd(DLCPackage);
+			for (FDLCPackage* DependencyDLCPackage : DependencyDLCPackages)
+			{
+				GroupDependencies.AddUnique(DependencyDLCPackage);
+			}
+		}
+
+		TArray<int32>& Group = DLCPackage ? DLCChunkGroups.FindOrAdd(DLCPackage) : MainPackageGroup;
+		Group.Add(PendingIndex);
+	}
+
+	TArray<FDLCPackage*> DLCPackagesToDownload;
+	DLCChunkGroups.GenerateKeyArray(DLCPackagesToDownload);
+
+	DLC_LOG(Logging, Status, TEXT("Found [%d] DLC chunks for [%d] references. Starting DLC chunks downloading"),
+		DLCPackagesToDownload.Num(), Request->PendingSoftObjectPtrs.Num());
+
+	OnDLCPackagesRequested(DLCPackagesToDownload, Priority);
+
+	TArray<TFuture<void>> DownloadedDLCChunkFutures = DownloadDLCPackages(DLCPackagesToDownload, Priority);
+
+	PrefetchSuccessors(DLCPackagesToDownload, Priority);
+
+	//NB: Number of groups should be set before any group loading start because downloaded chunk futures may be already filled
+	Request->PendingGroupsNum = DLCPackagesToDownload.Num() + (MainPackageGroup.Num() > 0 ? 1 : 0);
+
+	for (int32 DLCChunkIndex = 0; DLCChunkIndex < DLCPackagesToDownload.Num(); ++DLCChunkIndex)
+	{
+		FDLCPackage* GroupDLCPackage = DLCPackagesToDownload[DLCChunkIndex];
+
+		//NB: Dependency packages may be shared by groups or be requested packages themselves, so every group gets own futures of them
+		TArray<TFuture<void>> GroupFutures;
+		GroupFutures.Add(MoveTemp(DownloadedDLCChunkFutures[DLCChunkIndex]));
+		GroupFutures.Append(DownloadDLCPackages(DLCChunkGroupsDependencies[GroupDLCPackage], Priority));
+
+		DLCPackageManagerPrivate::WhenAllReady(MoveTemp(GroupFutures),
+			[This = AsShared(), Request, PendingIndices = MoveTemp(DLCChunkGroups[GroupDLCPackage])]()
+			{
+				This->GetLoadedPaths_LoadGroup(Request, PendingIndices);
+			});
+	}
+
+	if (MainPackageGroup.Num() > 0)
+	{
+		GetLoadedPaths_LoadGroup(Request, MainPackageGroup);
+	}
+}
+
+void FDLCPackageManager::GetLoadedPaths_LoadGroup(const TSharedRef<FBatchLoadingRequest>& Request, const TArray<int32>& PendingIndices)
+{
+	DLC_TRACE_CPU_SCOPE(DLC_GetLoadedPaths_LoadGroup);
+
+	// Batch is ready for loading when its last group is ready
+	Request->MetricsRecord.DLCChunkReadyTime = FPlatformTime::Seconds();
+
+	TArray<FSoftObjectPath> SoftObjectPaths;
+	SoftObjectPaths.Reserve(PendingIndices.Num());
+	for (const int32 PendingIndex : PendingIndices)
+		SoftObjectPaths.Add(Request->PendingSoftObjectPtrs[PendingIndex].ToSoftObjectPath());
+
+	DLC_LOG(Request->Logging, Status, TEXT("Group of [%d] assets is ready to be loaded to RAM"), PendingIndices.Num());
+
+	UAssetManager* Manager = UAssetManager::GetIfValid();
+	check(Manager);
+	Manager->GetStreamableManager().RequestAsyncLoad(MoveTemp(SoftObjectPaths), [This = AsShared(), Request, PendingIndices]()
+	{
+		This->GetLoadedPaths_FinishGroup(Request, PendingIndices);
+	});
+}
+
+void FDLCPackageManager::GetLoadedPaths_FinishGroup(const TSharedRef<FBatchLoadingRequest>& Request, const TArray<int32>& PendingIndices)
+{
+	DLC_TRACE_CPU_SCOPE(DLC_GetLoadedPaths_FinishGroup);
+
+	const FDLCPackageManager_Debug::FLogging_BatchLoading& Logging = Request->Logging;
+
+	for (const int32 PendingIndex : PendingIndices)
+	{
+		UObject* Result = Request->PendingSoftObjectPtrs[PendingIndex].Get();
+		if (!Result)
+		{
+			DLC_LOG(Logging, StatusImportant, TEXT("Unexpected asset loading error for [%s]"),
+				*Request->PendingSoftObjectPtrs[PendingIndex].ToString());
+		}
+
+		Request->Results[Request->PendingResultIndices[PendingIndex]] = Result;
+	}
+
+	if (--Request->PendingGroupsNum > 0)
+		return;
+
+	DLC_LOG(Logging, StatusImportant, TEXT("Assets are loaded to RAM and ready for use"));
+
+	Request->MetricsRecord.LoadEndTime = FPlatformTime::Seconds();
+	Request->MetricsRecord.bSucceeded = !Request->Results.Contains(nullptr);
+	Metrics.OnRequestFinished(Request->MetricsRecord);
+
+	Request->Promise.EmplaceValue(MoveTemp(Request->Results));
+}
+
+TFuture<bool> FDLCPackageManager::PreloadDLCPackages(TArrayView<const FName> PackageNames, const EDLCLoadPriority Priority)
+{
+	if (!IsInGameThread())
+	{
+		return DLCPackageManagerPrivate::CallOnGameThread<bool>([This = AsShared(), PackageNamesCopy = TArray<FName>{ PackageNames }, Priority]()
+		{
+			return This->PreloadDLCPackages(PackageNamesCopy, Priority);
+		});
+	}
+
+	DLC_TRACE_CPU_SCOPE(DLC_PreloadDLCPackages);
+
+	const TSharedRef<DLCPackageManagerPrivate::TPromiseWithWorkaroundedCanceling<bool>> Promise = MakeShared<DLCPackageManagerPrivate::TPromiseWithWorkaroundedCanceling<bool>>();
+	TFuture<bool> Result = Promise->GetFuture();
+
+	PackageManagerInitializationPromise->MakeFuture().Next([This = AsShared(), PackageNamesCopy = TArray<FName>{ PackageNames }, Priority, Promise](int32)
+	{
+		TArray<FDLCPackage*> PackagesToPreload;
+		bool bAllPackagesFound = true;
+
+		for (const FName& PackageName : PackageNamesCopy)
+		{
+			FDLCPackage* DLCPackage = This->FindDLCPackage(PackageName);
+			if (!DLCPackage)
+			{
+				DLC_LOG(FDLCPackageManager_Debug::FLogging_DLCChunkDownloading{ PackageName }, Warning, TEXT("Cannot find package for preloading"));
+
+				bAllPackagesFound = false;
+				continue;
+			}
+
+			PackagesToPreload.AddUnique(DLCPackage);
+		}
+
+		if (PackagesToPreload.Num() == 0)
+		{
+			Promise->EmplaceValue(bAllPackagesFound);
+			return;
+		}
+
+		TArray<FName> PreloadedPackageNames;
+		for (const FDLCPackage* DLCPackage : PackagesToPreload)
+		{
+			PreloadedPackageNames.Add(DLCPackage->Name);
+		}
+
+		DLCPackageManagerPrivate::WhenAllReady(This->DownloadDLCPackages(PackagesToPreload, Priority), [WeakThis = FWeakThis{ This }, Promise, bAllPackagesFound, PreloadedPackageNames]()
+		{
+			const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin();
+
+			//NB: Package that failed downloading or mounting is finished without mounting
+			bool bAllPackagesMounted = This.IsValid();
+			for (int32 Index = 0; bAllPackagesMounted && Index < PreloadedPackageNames.Num(); ++Index)
+			{
+				const FDLCPackage* DLCPackage = This->FindDLCPackage(PreloadedPackageNames[Index]);
+				bAllPackagesMounted = DLCPackage && DLCPackage->Status.IsType<FDLCPackage::FStatus_Mounted>();
+			}
+
+			Promise->EmplaceValue(bAllPackagesFound && bAllPackagesMounted);
+		});
+	});
+
+	return Result;
+}
+
+bool FDLCPackageManager::IsInitialized() const
+{
+	return PackageManagerInitializationPromise->IsSet();
+}
+
+FName FDLCPackageManager::GetDLCPackageNameForPath(const FSoftObjectPath& SoftObjectPath)
+{
+	check(IsInGameThread());
+
+	if (!IsInitialized())
+		return NAME_None;
+
+	const FDLCPackage* DLCPackage = FindDLCPackageForPath(SoftObjectPath);
+	return DLCPackage ? DLCPackage->Name : NAME_None;
+}
+
+FDLCPackagesProgress FDLCPackageManager::GetDLCPackagesProgress(TArrayView<const FName> PackageNames) const
+{
+	check(IsInGameThread());
+
+	using FChunk = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FChunk;
+	using FPakFile = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FPakFile;
+
+	FDLCPackagesProgress Result;
+
+	for (const FName& PackageName : PackageNames)
+	{
+		const FDLCPackage* DLCPackage = FindDLCPackage(PackageName);
+		if (!DLCPackage || DLCPackage->LatestVersionInfoIndex == INDEX_NONE)
+			continue;
+
+		++Result.PackagesNum;
+
+		const FDLCPackage::FStatus_Mounted* MountedStatus = DLCPackage->Status.TryGet<FDLCPackage::FStatus_Mounted>();
+		const FDLCPackage::FStatus_DownloadingAndMounting* DownloadingStatus = DLCPackage->Status.TryGet<FDLCPackage::FStatus_DownloadingAndMounting>();
+
+		const int32 ChunkId =
+			MountedStatus ? MountedStatus->ChunkId :
+			DownloadingStatus ? DownloadingStatus->ChunkId :
+			DLCPackage->GetLatestVersionInfo().ChunkId;
+
+		if (MountedStatus)
+		{
+			++Result.MountedPackagesNum;
+		}
+
+		const TSharedRef<FChunk>* Chunk = GetChunkDownloaderHackedAccess().Chunks.Find(ChunkId);
+		if (!Chunk)
+			continue;
+
+		for (const TSharedRef<FPakFile>& PakFile : (*Chunk)->PakFiles)
+		{
+			const uint64 PakFileBytes = PakFile->Entry.FileSize;
+
+			Result.TotalBytes += PakFileBytes;
+			if (MountedStatus || PakFile->bIsCached)
+			{
+				Result.DownloadedBytes += PakFileBytes;
+				continue;
+			}
+
+			//NB: Large pak files are downloaded by resumable downloads, so their progress is updated while they are received
+			const uint64 InFlightBytes = DownloadScheduler.IsValid() ? DownloadScheduler->GetResumableDownloadProgressBytes(PakFile->Entry.FileName) : 0;
+			Result.DownloadedBytes += FMath::Min(FMath::Max(PakFile->SizeOnDisk, InFlightBytes), PakFileBytes);
+		}
+	}
+
+	return Result;
+}
+
+void FDLCPackageManager::ReleaseLoadedPath(const FSoftObjectPtr& SoftObjectPtr)
+{
+	if (!IsInGameThread())
+	{
+		AsyncTask(ENamedThreads::GameThread, [This = AsShared(), SoftObjectPtr]() { This->ReleaseLoadedPath(SoftObjectPtr); });
+		return;
+	}
+
+	//NB: Loading requested before initialization acquires packages when initialization is finished, so its release waits
+	// for initialization too. Continuations of initialization are called in order of their adding
+	DLCPackageManagerPrivate::WhenReady(PackageManagerInitializationPromise->MakeFuture(), [This = AsShared(), SoftObjectPath = SoftObjectPtr.ToSoftObjectPath()]()
+	{
+		This->ReleaseDLCPackagesForPath(SoftObjectPath);
+	});
+}
+
+void FDLCPackageManager::ReleaseLoadedPaths(TArrayView<const FSoftObjectPtr> SoftObjectPtrs)
+{
+	if (!IsInGameThread())
+	{
+		AsyncTask(ENamedThreads::GameThread, [This = AsShared(), SoftObjectPtrsCopy = TArray<FSoftObjectPtr>{ SoftObjectPtrs }]() { This->ReleaseLoadedPaths(SoftObjectPtrsCopy); });
+		return;
+	}
+
+	for (const FSoftObjectPtr& SoftObjectPtr : SoftObjectPtrs)
+	{
+		ReleaseLoadedPath(SoftObjectPtr);
+	}
+}
+
+FDLCPackageManager::~FDLCPackageManager()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
+	if (AccessHistory->HasUnsavedChanges())
+	{
+		AccessHistory->SaveToFile(GetAccessHistoryFilePath());
+	}
+
+	if (ChunkDownloader == FChunkDownloader::Get())
+	{
+		FChunkDownloader::Shutdown();
+	}
+	else
+	{
+		ChunkDownloader->Finalize();
+	}
+}
+
+void FDLCPackageManager::Initialize_PackagesInfo(TFunction<void()>&& OnBuilt)
+{
+	DLC_TRACE_CPU_SCOPE(DLC_Initialize_PackagesInfo);
+
+	using FPakFile = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FPakFile;
+	using FDLCCatalogEntry = DLCPackageManagerPrivate::FDLCCatalogEntry;
+
+	const uint32 BuildNumber = ++LastCatalogBuildNumber;
+
+	//NB: Pak files are shared with ChunkDownloader and their entries are not changed after creation,
+	// so entries stay valid for parsing even if ChunkDownloader replaces its pak files
+	TArray<TSharedRef<FPakFile>> PakFiles;
+	GetChunkDownloaderHackedAccess().PakFiles.GenerateValueArray(PakFiles);
+
+	// Empty snapshot path means that snapshot is not used
+	const FString CatalogSnapshotFilePath = Settings.bEnableCatalogSnapshot ? GetCatalogSnapshotFilePath() : FString{ };
+	const FString ManifestFilePath = GetChunkDownloaderCachedManifestFilePath();
+	const FString ManifestValidatorsFilePath = GetManifestValidatorsFilePath();
+
+	auto ParseCatalogEntries = [PakFiles = MoveTemp(PakFiles), CatalogSnapshotFilePath, ManifestFilePath, ManifestValidatorsFilePath]()
+	{
+		DLC_TRACE_CPU_SCOPE(DLC_ParseCatalogEntries);
+
+		//NB: Validators keep content hash of cached manifest, so manifest is hashed only if validators were not saved
+		FString ManifestHash;
+		if (!CatalogSnapshotFilePath.IsEmpty())
+		{
+			ManifestHash = FDLCPackageManager_Private::LoadManifestValidators(ManifestValidatorsFilePath).ContentHash;
+			if (ManifestHash.IsEmpty())
+			{
+				ManifestHash = FDLCPackageManager_Private::GetManifestFileContentHash(ManifestFilePath);
+			}
+		}
+
+		if (!ManifestHash.IsEmpty())
+		{
+			TOptional<TArray<FDLCCatalogEntry>> SnapshotCatalogEntries = DLCPackageManagerPrivate::FDLCCatalogSnapshot::Load(CatalogSnapshotFilePath, ManifestHash, PakFiles.Num());
+			if (SnapshotCatalogEntries.IsSet())
+			{
+				DLC_LOG(FDLCPackageManager_Debug::FLogging_Initialization{ }, Status, TEXT("Catalog of [%d] entries is loaded from snapshot [%s]"),
+					SnapshotCatalogEntries->Num(), *CatalogSnapshotFilePath);
+
+				return MoveTemp(SnapshotCatalogEntries.GetValue());
+			}
+		}
+
+		TArray<FDLCCatalogEntry> CatalogEntries;
+		CatalogEntries.Reserve(PakFiles.Num());
+
+		for (const TSharedRef<FPakFile>& PakFile : PakFiles)
+		{
+			const FPakFileEntry& PakFileEntry = PakFile->Entry;
+
+			TOptional<FDLCCatalogEntry> CatalogEntry = FDLCPackageManager_Private::ParseCatalogEntry(
+				FDLCPackageManager_Private::GetDLCChunkIDForPakFileEntry(PakFileEntry), PakFileEntry.ChunkId);
+
+			if (CatalogEntry.IsSet())
+			{
+				CatalogEntries.Add(CatalogEntry.GetValue());
+			}
+		}
+
+		if (!ManifestHash.IsEmpty() && !DLCPackageManagerPrivate::FDLCCatalogSnapshot::Save(CatalogSnapshotFilePath, ManifestHash, PakFiles.Num(), CatalogEntries))
+		{
+			DLC_LOG(FDLCPackageManager_Debug::FLogging_Initialization{ }, Warning, TEXT("Cannot save catalog snapshot [%s]"), *CatalogSnapshotFilePath);
+		}
+
+		return CatalogEntries;
+	};
+
+	if (!Settings.bBuildCatalogOffGameThread)
+	{
+		Initialize_PackagesInfo_Apply(BuildNumber, ParseCatalogEntries());
+
+		if (OnBuilt)
+		{
+			OnBuilt();
+		}
+
+		return;
+	}
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis = FWeakThis{ AsShared() }, BuildNumber, ParseCatalogEntries = MoveTemp(ParseCatalogEntries), OnBuilt = MoveTemp(OnBuilt)]() mutable
+	{
+		TArray<FDLCCatalogEntry> CatalogEntries = ParseCatalogEntries();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, BuildNumber, CatalogEntries = MoveTemp(CatalogEntries), OnBuilt = MoveTemp(OnBuilt)]()
+		{
+			const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin();
+			if (!This)
+				return;
+
+			This->Initialize_PackagesInfo_Apply(BuildNumber, CatalogEntries);
+
+			if (OnBuilt)
+			{
+				OnBuilt();
+			}
+		});
+	});
+}
+
+void FDLCPackageManager::Initialize_PackagesInfo_Apply(const uint32 BuildNumber, const TArray<DLCPackageManagerPrivate::FDLCCatalogEntry>& CatalogEntries)
+{
+	DLC_TRACE_CPU_SCOPE(DLC_Initialize_PackagesInfo_Apply);
+
+	FDLCPackageManager_Debug::FLogging_Initialization Logging{ };
+
+	//NB: Catalog of newer manifest may be applied before catalog of older one if they are built off the game thread
+	if (BuildNumber < AppliedCatalogBuildNumber)
+	{
+		DLC_LOG(Logging, Status, TEXT("Catalog build [%u] is outdated by applied build [%u]. Build ignored"), BuildNumber, AppliedCatalogBuildNumber);
+		return;
+	}
+
+	AppliedCatalogBuildNumber = BuildNumber;
+
+	ResolvedPathsCache.Empty(ResolvedPathsCacheCapacity);
+
+	if (DependencyGraph.IsValid())
+	{
+		DependencyGraph->Reset();
+	}
+
+	//NB: Catalog may be rebuilt after manifest revalidation. Packages are reused to keep their statuses
+	// and references to them from pending callbacks
+	TMap<FName, TSharedPtr<FDLCPackage>> PreviousDLCPackages = MoveTemp(DLCPackages);
+
+	DLCPackages.Reset();
+	DLCPackages.Reserve(CatalogEntries.Num());
+
+	for (const DLCPackageManagerPrivate::FDLCCatalogEntry& CatalogEntry : CatalogEntries)
+	{
+		const FName DLCPackageName = CatalogEntry.PackageName;
+
+		TSharedPtr<FDLCPackage>& PackageSharedPtr = DLCPackages.FindOrAdd(DLCPackageName);
+		if (!PackageSharedPtr.IsValid())
+		{
+			if (TSharedPtr<FDLCPackage>* PreviousPackageSharedPtr = PreviousDLCPackages.Find(DLCPackageName))
+			{
+				PackageSharedPtr = *PreviousPackageSharedPtr;
+				PackageSharedPtr->VersionInfos.Reset();
+				PackageSharedPtr->LatestVersionInfoIndex = INDEX_NONE;
+			}
+			else
+			{
+				PackageSharedPtr = MakeShared<FDLCPackage>();
+				PackageSharedPtr->Name = DLCPackageName;
+			}
+		}
+
+		FDLCPackage& Package = *PackageSharedPtr;
+
+		TArray<FDLCPackage::FVersionInfo>& VersionInfos = Package.VersionInfos;
+		const int32 NewVersionIndex = VersionInfos.Emplace();
+		FDLCPackage::FVersionInfo& NewVersion = VersionInfos[NewVersionIndex];
+		NewVersion.VersionKey = CatalogEntry.VersionKey;
+		NewVersion.ChunkId = CatalogEntry.ChunkId;
+
+		if (Package.LatestVersionInfoIndex == INDEX_NONE || VersionInfos[Package.LatestVersionInfoIndex].VersionKey < NewVersion.VersionKey)
+		{
+			Package.LatestVersionInfoIndex = NewVersionIndex;
+		}
+	}
+
+	// Packages removed from manifest are kept while they are in use
+	for (TPair<FName, TSharedPtr<FDLCPackage>>& PreviousPackage : PreviousDLCPackages)
+	{
+		const FDLCPackage::FStatus& PreviousPackageStatus = PreviousPackage.Value->Status;
+		const bool bIsInUse = PreviousPackageStatus.IsType<FDLCPackage::FStatus_DownloadingAndMounting>() || PreviousPackageStatus.IsType<FDLCPackage::FStatus_Mounted>() ||
+			PreviousPackage.Value->UsersNum > 0;
+
+		if (!DLCPackages.Contains(PreviousPackage.Key) && bIsInUse)
+		{
+			DLC_LOG(Logging, Warning, TEXT("Package [%s] is removed from manifest while it is in use. Package is kept"),
+				*PreviousPackage.Key.ToString());
+
+			DLCPackages.Add(PreviousPackage.Key, MoveTemp(PreviousPackage.Value));
+		}
+	}
+
+	// New catalog may supersede cached versions
+	RequestCacheEviction();
+}
+
+const FDLCPackageManager::FDLCPackage::FVersionInfo& FDLCPackageManager::FDLCPackage::GetLatestVersionInfo() const
+{
+	return VersionInfos[LatestVersionInfoIndex];
+}
+
+FString FDLCPackageManager::GetChunkDownloaderCachedManifestFilePath() const
+{
+	const auto& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+
+	return ChunkDownloaderHacked.CacheFolder / ChunkDownloaderHacked.CACHED_BUILD_MANIFEST;
+}
+
+FString FDLCPackageManager::GetAccessHistoryFilePath() const
+{
+	return GetChunkDownloaderHackedAccess().CacheFolder / FDLCPackageManager_Private::AccessHistoryFileName;
+}
+
+FString FDLCPackageManager::GetManifestValidatorsFilePath() const
+{
+	return GetChunkDownloaderCachedManifestFilePath() + FDLCPackageManager_Private::ManifestValidatorsFilePostfix;
+}
+
+FString FDLCPackageManager::GetCatalogSnapshotFilePath() const
+{
+	return GetChunkDownloaderCachedManifestFilePath() + DLCPackageManagerPrivate::FDLCCatalogSnapshot::FilePostfix;
+}
+
+struct FDLCPackageManager::FDLCPackageDownload
+{
+	FDLCPackage::FStatus* PackageStatus;
+	FName PackageName;
+	int32 VersionChunkId;
+	int32 DeltaBaseChunkId;
+	EDLCLoadPriority Priority;
+	FDLCPackageManager_Debug::FLogging_DLCChunkDownloading Logging;
+	TSharedRef<DLCPackageManagerPrivate::FDLCTraceRegion> StageRegion;
+	int32 AttemptsNum = 1;
+};
+
+TArray<TFuture<void>> FDLCPackageManager::DownloadDLCPackages(const TArray<FDLCPackage*>& DLCPackagesToDownload, const EDLCLoadPriority Priority)
+{
+	//NB: Package states and ChunkDownloader are not synchronized. Public API forwards calls of other threads to the game thread
+	check(IsInGameThread());
+
+	DLC_TRACE_CPU_SCOPE(DLC_DownloadDLCPackages);
+
+	TArray<TFuture<void>> Result;
+	Result.Reserve(DLCPackagesToDownload.Num());
+
+	TArray<TSharedRef<FDLCPackageDownload>> PackageDownloads;
+
+	for (FDLCPackage* DLCPackage : DLCPackagesToDownload)
+	{
+		check(DLCPackage);
+
+		FDLCPackageManager_Debug::FLogging_DLCChunkDownloading Logging{ DLCPackage->Name };
+
+		DLC_LOG(Logging, Status, TEXT("Start"));
+
+		FDLCPackage::FStatus& PackageStatus = DLCPackage->Status;
+		if (PackageStatus.IsType<FDLCPackage::FStatus_NotDownloaded>() || PackageStatus.IsType<FDLCPackage::FStatus_CachedNotMounted>())
+		{
+			const FDLCPackageManager::FDLCPackage::FVersionInfo& VersionInfo = DLCPackage->GetLatestVersionInfo();
+			const int32 VersionChunkId = VersionInfo.ChunkId;
+
+			PackageStatus.Emplace<FDLCPackage::FStatus_DownloadingAndMounting>();
+			PackageStatus.Get<FDLCPackage::FStatus_DownloadingAndMounting>().Promise = MakeShared<TMultiPromise<void>>();
+			PackageStatus.Get<FDLCPackage::FStatus_DownloadingAndMounting>().ChunkId = VersionChunkId;
+
+			DLC_LOG(Logging, Status, TEXT("DLC Chunk had [%s] state. Switching to [DownloadingAndMounting] state. DLC version [%s] aka chunk pak [%d]"),
+				PackageStatus.IsType<FDLCPackage::FStatus_NotDownloaded>() ? TEXT("NotDownloaded") : TEXT("CachedNotMounted"),
+				*DLCPackageManagerPrivate::FVersion::FromKey(VersionInfo.VersionKey).ToString(), VersionChunkId);
+
+			PackageDownloads.Add(MakeShared<FDLCPackageDownload>(FDLCPackageDownload{ &PackageStatus, DLCPackage->Name, VersionChunkId, FindDeltaBaseChunkId(*DLCPackage),
+				Priority, Logging, MakeShared<DLCPackageManagerPrivate::FDLCTraceRegion>() }));
+		}
+		else if (auto* ChunkState_DownloadingAndMounting = PackageStatus.TryGet<FDLCPackage::FStatus_DownloadingAndMounting>())
+		{
+			// Package may be requested with more urgent priority than it is downloaded now
+			DownloadScheduler->RaiseChunkPriority(ChunkState_DownloadingAndMounting->ChunkId, Priority);
+			MountScheduler->RaiseMountPriority(ChunkState_DownloadingAndMounting->ChunkId, Priority);
+		}
+
+		if (auto* ChunkState_DownloadingAndMounting = PackageStatus.TryGet<FDLCPackage::FStatus_DownloadingAndMounting>())
+		{
+			DLC_LOG(Logging, Status, TEXT("Actually started downloading request. Waiting [DownloadingAndMounting] finish"));
+
+			Result.Emplace(ChunkState_DownloadingAndMounting->Promise->MakeFuture());
+			continue;
+		}
+
+		//TODO: Put "Success" result info
+		check(PackageStatus.IsType<FDLCPackage::FStatus_Mounted>());
+
+		DLC_LOG(Logging, Status, TEXT("DLC Chunk is finaly in [FChunkState_Mounted] state. Return filled future"));
+
+		Result.Emplace(DLCPackageManagerPrivate::FilledFuture());
+	}
+
+	for (const TSharedRef<FDLCPackageDownload>& PackageDownload : PackageDownloads)
+	{
+		Metrics.OnChunkRequested(PackageDownload->VersionChunkId, PackageDownload->PackageName);
+
+		// Chunk that is cached (for example, unmounted after release) needs only mounting
+		if (IsChunkCached(PackageDownload->VersionChunkId))
+		{
+			OnDLCPackageDownloaded(PackageDownload, true);
+			continue;
+		}
+
+		RequestDLCPackageDownload(PackageDownload);
+	}
+
+	return Result;
+}
+
+void FDLCPackageManager::RequestDLCPackageDownload(const TSharedRef<FDLCPackageDownload>& Download)
+{
+	Download->StageRegion->Begin(TEXT("DLC package [%s]: downloading"), *Download->PackageName.ToString());
+
+	//NB: Chunk is mounted only after it is downloaded by scheduler. Otherwise "MountChunk()" would start downloading
+	// bypassing the scheduler
+	DownloadScheduler->RequestChunk(Download->VersionChunkId, Download->Priority, [WeakThis = FWeakThis{ AsShared() }, Download](const bool bDownloaded)
+	{
+		if (const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin())
+		{
+			This->OnDLCPackageDownloaded(Download, bDownloaded);
+		}
+	},
+	Download->DeltaBaseChunkId);
+}
+
+void FDLCPackageManager::OnDLCPackageDownloaded(const TSharedRef<FDLCPackageDownload>& Download, const bool bDownloaded)
+{
+	if (!bDownloaded)
+	{
+		DLC_LOG(Download->Logging, Warning, TEXT("Downloading failed, attempt [%d]"), Download->AttemptsNum);
+
+		RetryOrFailDLCPackageDownload(Download);
+		return;
+	}
+
+	if (!PakVerifier.IsValid())
+	{
+		MountDLCPackage(Download);
+		return;
+	}
+
+	Download->StageRegion->Begin(TEXT("DLC package [%s]: verification"), *Download->PackageName.ToString());
+
+	PakVerifier->VerifyChunk(Download->VersionChunkId, [WeakThis = FWeakThis{ AsShared() }, Download](const bool bVerified)
+	{
+		const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin();
+		if (!This.IsValid())
+			return;
+
+		if (!bVerified)
+		{
+			//NB: Verifier drops pak files that cannot be repaired from cache, so they are downloaded again
+			DLC_LOG(Download->Logging, Warning, TEXT("Verification failed, attempt [%d]"), Download->AttemptsNum);
+
+			This->RetryOrFailDLCPackageDownload(Download);
+			return;
+		}
+
+		This->MountDLCPackage(Download);
+	});
+}
+
+void FDLCPackageManager::MountDLCPackage(const TSharedRef<FDLCPackageDownload>& Download)
+{
+	Download->StageRegion->Begin(TEXT("DLC package [%s]: mounting"), *Download->PackageName.ToString());
+
+	//NB: Mount is started by scheduler, so mounts of many downloaded chunks do not finish in one frame
+	MountScheduler->RequestMount(Download->VersionChunkId, Download->Priority, [WeakThis = FWeakThis{ AsShared() }, Download](const bool bSuccess)
+	{
+		const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin();
+		if (!This.IsValid())
+		{
+			Download->StageRegion->End();
+			return;
+		}
+
+		if (!bSuccess)
+		{
+			This->FailDLCPackageDownload(*Download);
+			return;
+		}
+
+		Download->StageRegion->End();
+
+		This->Metrics.OnChunkMounted(Download->VersionChunkId, true);
+
+		DLC_LOG(Download->Logging, Status, TEXT("DLC Chunk had [DownloadingAndMounting] state. After filling promise it finaly will have [Mounted] state"));
+
+		//TODO: Move promise and setup "FChunkState_Mounted" state before filling promise for more consistent state in callbacks after filling promise
+		Download->PackageStatus->Get<FDLCPackage::FStatus_DownloadingAndMounting>().Promise->SetValue();
+
+		Download->PackageStatus->Emplace<FDLCPackage::FStatus_Mounted>();
+		Download->PackageStatus->Get<FDLCPackage::FStatus_Mounted>().ChunkId = Download->VersionChunkId;
+
+		// Downloaded pak files may exceed disk budget
+		This->RequestCacheEviction();
+	});
+}
+
+void FDLCPackageManager::RetryOrFailDLCPackageDownload(const TSharedRef<FDLCPackageDownload>& Download)
+{
+	if (Download->AttemptsNum >= FDLCPackageManager_Private::MaxPackageDownloadAttemptsNum)
+	{
+		FailDLCPackageDownload(*Download);
+		return;
+	}
+
+	++Download->AttemptsNum;
+	RequestDLCPackageDownload(Download);
+}
+
+void FDLCPackageManager::FailDLCPackageDownload(const FDLCPackageDownload& Download)
+{
+	DLC_LOG(Download.Logging, Error, TEXT("Package is not mounted after [%d] attempts. Waiting loadings are finished without it"), Download.AttemptsNum);
+
+	Download.StageRegion->End();
+
+	Metrics.OnChunkMounted(Download.VersionChunkId, false);
+
+	//NB: Status is reset before promise is filled, so callbacks of promise see not mounted package and next request
+	// of the package starts downloading again
+	const TSharedPtr<DLCPackageManagerPrivate::TMultiPromise<void>> Promise = Download.PackageStatus->Get<FDLCPackage::FStatus_DownloadingAndMounting>().Promise;
+	if (IsChunkCached(Download.VersionChunkId))
+		Download.PackageStatus->Emplace<FDLCPackage::FStatus_CachedNotMounted>();
+	else
+		Download.PackageStatus->Emplace<FDLCPackage::FStatus_NotDownloaded>();
+
+	Promise->SetValue();
+}
+
+void FDLCPackageManager::OnDLCPackagesRequested(const TArray<FDLCPackage*>& RequestedPackages, const EDLCLoadPriority Priority)
+{
+	// Only on-demand requests are learned. Otherwise prefetching would learn from its own predictions
+	if (Priority == EDLCLoadPriority::Prefetch)
+		return;
+
+	for (const FDLCPackage* Package : RequestedPackages)
+	{
+		FDLCPrefetch Prefetch;
+		if (Prefetches.RemoveAndCopyValue(Package->Name, Prefetch))
+		{
+			//NB: Prefetch that is still queued or downloading is a hit too, but it has not downloaded anything yet
+			Metrics.OnPrefetchHit(Prefetch.bIsDownloaded ? Prefetch.DownloadBytes : 0);
+		}
+		else if (Package->Status.IsType<FDLCPackage::FStatus_NotDownloaded>())
+		{
+			Metrics.OnPrefetchMiss();
+		}
+
+		AccessHistory->RecordAccess(Package->Name);
+	}
+
+	if (AccessHistory->GetUnsavedAccessesNum() >= FDLCPackageManager_Private::AccessHistorySavingInterval)
+	{
+		AccessHistory->SaveToFileAsync(GetAccessHistoryFilePath());
+	}
+}
+
+void FDLCPackageManager::PrefetchSuccessors(const TArray<FDLCPackage*>& RequestedPackages, const EDLCLoadPriority Priority)
+{
+	if (!Settings.bEnablePrefetch || Priority == EDLCLoadPriority::Prefetch)
+		return;
+
+	for (const FDLCPackage* Package : RequestedPackages)
+	{
+		const auto Predictions = AccessHistory->PredictSuccessors(Package->Name, Settings.MaxPrefetchPredictions, Settings.MinPrefetchProbability);
+		for (const DLCPackageManagerPrivate::FDLCAccessHistory::FPrediction& Prediction : Predictions)
+		{
+			FDLCPackage* PredictedPackage = FindDLCPackage(Prediction.PackageName);
+			if (!PredictedPackage || !PredictedPackage->Status.IsType<FDLCPackage::FStatus_NotDownloaded>() || Prefetches.Contains(PredictedPackage->Name))
+				continue;
+
+			const int32 VersionChunkId = PredictedPackage->GetLatestVersionInfo().ChunkId;
+			if (IsChunkCached(VersionChunkId))
+				continue;
+
+			const uint64 PackageBytes = GetDLCPackageDownloadSize(*PredictedPackage);
+
+			FDLCPackageManager_Debug::FLogging_DLCChunkDownloading Logging{ Prediction.PackageName };
+			DLC_LOG(Logging, Status, TEXT("Prefetching after [%s] with probability [%.2f], [%llu] bytes"),
+				*Package->Name.ToString(), Prediction.Probability, PackageBytes);
+
+			Prefetches.Add(PredictedPackage->Name, FDLCPrefetch{ PackageBytes, false });
+			Metrics.OnPrefetchIssued();
+
+			//NB: Prefetch only downloads chunk. Package stays not mounted, so its request mounts cached chunk. Request of
+			// package while it is prefetched raises priority of same chunk download
+			DownloadScheduler->RequestChunk(VersionChunkId, EDLCLoadPriority::Prefetch, [WeakThis = FWeakThis{ AsShared() }, PackageName = PredictedPackage->Name](const bool bDownloaded)
+			{
+				const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin();
+				if (!This.IsValid())
+					return;
+
+				// Package is already requested, so its prefetch is counted as hit
+				FDLCPrefetch* Prefetch = This->Prefetches.Find(PackageName);
+				if (!Prefetch)
+					return;
+
+				if (!bDownloaded)
+				{
+					This->Prefetches.Remove(PackageName);
+					return;
+				}
+
+				Prefetch->bIsDownloaded = true;
+				This->Metrics.OnPrefetchDownloaded(Prefetch->DownloadBytes);
+
+				// Downloaded pak files may exceed disk budget
+				This->RequestCacheEviction();
+			},
+			FindDeltaBaseChunkId(*PredictedPackage));
+		}
+	}
+}
+
+uint64 FDLCPackageManager::GetDLCPackageDownloadSize(const FDLCPackage& DLCPackage) const
+{
+	using FChunk = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FChunk;
+	using FPakFile = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FPakFile;
+
+	const TSharedRef<FChunk>* Chunk = GetChunkDownloaderHackedAccess().Chunks.Find(DLCPackage.GetLatestVersionInfo().ChunkId);
+	if (!Chunk)
+		return 0;
+
+	uint64 Result = 0;
+	for (const TSharedRef<FPakFile>& PakFile : (*Chunk)->PakFiles)
+	{
+		if (!PakFile->bIsCached)
+		{
+			Result += PakFile->Entry.FileSize;
+		}
+	}
+
+	return Result;
+}
+
+int32 FDLCPackageManager::FindDeltaBaseChunkId(const FDLCPackage& DLCPackage) const
+{
+	if (!Settings.bEnableDeltaPatches || DLCPackage.LatestVersionInfoIndex == INDEX_NONE)
+		return INDEX_NONE;
+
+	const FDLCPackage::FVersionInfo& LatestVersionInfo = DLCPackage.GetLatestVersionInfo();
+	if (IsChunkCached(LatestVersionInfo.ChunkId))
+		return INDEX_NONE;
+
+	// Newest cached version is the closest to the latest one
+	const FDLCPackage::FVersionInfo* BaseVersionInfo = nullptr;
+	for (const FDLCPackage::FVersionInfo& VersionInfo : DLCPackage.VersionInfos)
+	{
+		if (VersionInfo.ChunkId == LatestVersionInfo.ChunkId || !IsChunkCached(VersionInfo.ChunkId))
+			continue;
+
+		if (!BaseVersionInfo || BaseVersionInfo->VersionKey < VersionInfo.VersionKey)
+		{
+			BaseVersionInfo = &VersionInfo;
+		}
+	}
+
+	return BaseVersionInfo ? BaseVersionInfo->ChunkId : INDEX_NONE;
+}
+
+bool FDLCPackageManager::IsChunkCached(const int32 ChunkId) const
+{
+	using FChunk = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FChunk;
+
+	const TSharedRef<FChunk>* Chunk = GetChunkDownloaderHackedAccess().Chunks.Find(ChunkId);
+	return Chunk && (*Chunk)->IsCached();
+}
+
+FDLCPackageManager::FDLCPackage* FDLCPackageManager::AcquireDLCPackagesForPath(const FSoftObjectPath& SoftObjectPath, TArray<FDLCPackage*>& OutDependencyDLCPackages)
+{
+	OutDependencyDLCPackages.Reset();
+
+	FDLCPackage* DLCPackage = FindDLCPackageForPath(SoftObjectPath);
+	if (!DLCPackage)
+		return nullptr;
+
+	OutDependencyDLCPackages = FindDependencyDLCPackagesForPath(SoftObjectPath);
+
+	const FName AssetPathName = SoftObjectPath.GetAssetPathName();
+	TArray<FDLCPackagesAcquisition>& Acquisitions = PathsAcquisitions.FindOrAdd(AssetPathName);
+
+	auto IsSameAcquisition = [DLCPackage, &OutDependencyDLCPackages](const FDLCPackagesAcquisition& Acquisition)
+	{
+		if (Acquisition.Packages.Num() != OutDependencyDLCPackages.Num() + 1 || Acquisition.Packages[0].Get() != DLCPackage)
+			return false;
+
+		for (int32 DependencyIndex = 0; DependencyIndex < OutDependencyDLCPackages.Num(); ++DependencyIndex)
+		{
+			if (Acquisition.Packages[DependencyIndex + 1].Get() != OutDependencyDLCPackages[DependencyIndex])
+				return false;
+		}
+
+		return true;
+	};
+
+	//NB: Only the newest acquisition is shared, so acquisitions are still released in order of loadings
+	if (Acquisitions.Num() > 0 && IsSameAcquisition(Acquisitions.Last()))
+	{
+		++Acquisitions.Last().LoadingsNum;
+	}
+	else
+	{
+		FDLCPackagesAcquisition& Acquisition = Acquisitions.Emplace_GetRef();
+		Acquisition.Packages.Reserve(OutDependencyDLCPackages.Num() + 1);
+		Acquisition.Packages.Add(DLCPackages.FindChecked(DLCPackage->Name));
+		for (FDLCPackage* DependencyDLCPackage : OutDependencyDLCPackages)
+		{
+			Acquisition.Packages.Add(DLCPackages.FindChecked(DependencyDLCPackage->Name));
+		}
+	}
+
+	auto AcquireDLCPackage = [this, AssetPathName](FDLCPackage& AcquiredDLCPackage)
+	{
+		++AcquiredDLCPackage.UsersNum;
+		AcquiredDLCPackage.RequestedAssetPaths.Add(AssetPathName);
+
+		ReleasedDLCPackageNames.Remove(AcquiredDLCPackage.Name);
+	};
+
+	AcquireDLCPackage(*DLCPackage);
+	for (FDLCPackage* DependencyDLCPackage : OutDependencyDLCPackages)
+	{
+		AcquireDLCPackage(*DependencyDLCPackage);
+	}
+
+	return DLCPackage;
+}
+
+void FDLCPackageManager::AcquireResolvedPath(const FSoftObjectPath& SoftObjectPath)
+{
+	DLCPackageManagerPrivate::WhenReady(PackageManagerInitializationPromise->MakeFuture(), [This = AsShared(), SoftObjectPath]()
+	{
+		TArray<FDLCPackage*> DependencyDLCPackages;
+		This->AcquireDLCPackagesForPath(SoftObjectPath, DependencyDLCPackages);
+	});
+}
+
+void FDLCPackageManager::ReleaseDLCPackagesForPath(const FSoftObjectPath& SoftObjectPath)
+{
+	const FDLCPackageManager_Debug::FLogging_Loading Logging{ FSoftObjectPtr{ SoftObjectPath } };
+
+	const FName AssetPathName = SoftObjectPath.GetAssetPathName();
+
+	TArray<FDLCPackagesAcquisition>* Acquisitions = PathsAcquisitions.Find(AssetPathName);
+	if (!Acquisitions)
+	{
+		// Paths that are not placed in DLC have no acquisitions
+		if (FindDLCPackageForPath(SoftObjectPath))
+		{
+			DLC_LOG(Logging, Warning, TEXT("Path is released more times than it was requested. Release ignored"));
+		}
+
+		return;
+	}
+
+	//NB: Packages acquired by loading are released even if dependencies of path or catalog were changed after it
+	FDLCPackagesAcquisition& Acquisition = (*Acquisitions)[0];
+
+	for (const TSharedPtr<FDLCPackage>& ReleasedDLCPackage : Acquisition.Packages)
+	{
+		check(ReleasedDLCPackage->UsersNum > 0);
+
+		if (--ReleasedDLCPackage->UsersNum == 0)
+		{
+			DLC_LOG(Logging, Status, TEXT("DLC package [%s] has no users. It will be unmounted after its objects are garbage collected"),
+				*ReleasedDLCPackage->Name.ToString());
+
+			ReleasedDLCPackageNames.Add(ReleasedDLCPackage->Name);
+		}
+	}
+
+	if (--Acquisition.LoadingsNum == 0)
+	{
+		Acquisitions->RemoveAt(0, 1, false);
+		if (Acquisitions->Num() == 0)
+		{
+			PathsAcquisitions.Remove(AssetPathName);
+		}
+	}
+}
+
+void FDLCPackageManager::OnPostGarbageCollect()
+{
+	DLC_TRACE_CPU_SCOPE(DLC_OnPostGarbageCollect);
+
+	// States of collected objects are not needed anymore
+	ResolvedObjectsFutureStates->Reset();
+
+	if (ReleasedDLCPackageNames.Num() == 0)
+		return;
+
+	bool bUnmountedAny = false;
+
+	for (auto ReleasedNameIt = ReleasedDLCPackageNames.CreateIterator(); ReleasedNameIt; ++ReleasedNameIt)
+	{
+		FDLCPackage* DLCPackage = FindDLCPackage(*ReleasedNameIt);
+		if (!DLCPackage || DLCPackage->UsersNum > 0)
+		{
+			ReleasedNameIt.RemoveCurrent();
+			continue;
+		}
+
+		// Package released before mounting finish is unmounted after next garbage collection
+		if (DLCPackage->Status.IsType<FDLCPackage::FStatus_DownloadingAndMounting>())
+			continue;
+
+		if (!DLCPackage->Status.IsType<FDLCPackage::FStatus_Mounted>())
+		{
+			ReleasedNameIt.RemoveCurrent();
+			continue;
+		}
+
+		//NB: Objects may be still referenced by game code that released them. Unmounting of pak with resident objects
+		// would break their lazy loaded data, so package waits for next garbage collection
+		if (HasResidentRequestedObjects(*DLCPackage))
+			continue;
+
+		UnmountDLCPackage(*DLCPackage);
+		bUnmountedAny = true;
+
+		ReleasedNameIt.RemoveCurrent();
+	}
+
+	// Unmounted pak files may be evicted
+	if (bUnmountedAny)
+	{
+		RequestCacheEviction();
+	}
+}
+
+bool FDLCPackageManager::HasResidentRequestedObjects(const FDLCPackage& DLCPackage) const
+{
+	//NB: Only requested objects are checked. Their dependencies from same package are collected with them
+	// unless they are referenced by something else
+	for (const FName& AssetPath : DLCPackage.RequestedAssetPaths)
+	{
+		if (FSoftObjectPath{ AssetPath }.ResolveObject())
+			return true;
+	}
+
+	return false;
+}
+
+void FDLCPackageManager::UnmountDLCPackage(FDLCPackage& DLCPackage)
+{
+	DLC_TRACE_CPU_SCOPE(DLC_UnmountDLCPackage);
+
+	FDLCPackageManager_Debug::FLogging_DLCChunkUnmounting Logging{ DLCPackage.Name };
+
+	using FChunk = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FChunk;
+	using FPakFile = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FPakFile;
+
+	auto& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+
+	const int32 ChunkId = DLCPackage.Status.Get<FDLCPackage::FStatus_Mounted>().ChunkId;
+
+	if (!FCoreDelegates::OnUnmountPak.IsBound())
+	{
+		DLC_LOG(Logging, Warning, TEXT("Pak files unmounting is not supported. Package stays mounted"));
+		return;
+	}
+
+	if (const TSharedRef<FChunk>* Chunk = ChunkDownloaderHacked.Chunks.Find(ChunkId))
+	{
+		for (const TSharedRef<FPakFile>& PakFile : (*Chunk)->PakFiles)
+		{
+			if (!PakFile->bIsMounted)
+				continue;
+
+			//NB: Same path as ChunkDownloader uses for mounting
+			const FString PakFilePath = (PakFile->bIsEmbedded ? ChunkDownloaderHacked.EmbeddedFolder : ChunkDownloaderHacked.CacheFolder) / PakFile->Entry.FileName;
+
+			if (FCoreDelegates::OnUnmountPak.Execute(PakFilePath))
+				PakFile->bIsMounted = false;
+			else
+				DLC_LOG(Logging, Error, TEXT("Cannot unmount pak file [%s]"), *PakFilePath);
+		}
+
+		//NB: Chunk is marked as not mounted even if some pak files were not unmounted. "MountChunk()" mounts only
+		// not mounted pak files, so next loading restores consistent state
+		(*Chunk)->bIsMounted = false;
+	}
+
+	DLC_LOG(Logging, StatusImportant, TEXT("Chunk [%d] is unmounted. Package is cached, not mounted"), ChunkId);
+
+	DLCPackage.Status.Emplace<FDLCPackage::FStatus_CachedNotMounted>();
+	DLCPackage.RequestedAssetPaths.Reset();
+}
+
+void FDLCPackageManager::SetDLCPackagePinned(const FName& PackageName, const bool bPinned)
+{
+	if (!IsInGameThread())
+	{
+		AsyncTask(ENamedThreads::GameThread, [This = AsShared(), PackageName, bPinned]() { This->SetDLCPackagePinned(PackageName, bPinned); });
+		return;
+	}
+
+	if (bPinned)
+	{
+		PinnedDLCPackageNames.Add(PackageName);
+	}
+	else if (PinnedDLCPackageNames.Remove(PackageName) > 0)
+	{
+		RequestCacheEviction();
+	}
+}
+
+bool FDLCPackageManager::IsDLCPackagePinned(const FName& PackageName) const
+{
+	return PinnedDLCPackageNames.Contains(PackageName);
+}
+
+bool FDLCPackageManager::CanEvictChunk(const FDLCPackage& DLCPackage, const int32 ChunkId) const
+{
+	if (DLCPackage.LatestVersionInfoIndex != INDEX_NONE && DLCPackage.GetLatestVersionInfo().ChunkId == ChunkId && IsDLCPackagePinned(DLCPackage.Name))
+		return false;
+
+	//NB: Downloaded pak files of chunk that is waiting for mounting are not mounted yet, but they are in use.
+	// Same is true for pak files of delta patching base
+	const auto* Status_DownloadingAndMounting = DLCPackage.Status.TryGet<FDLCPackage::FStatus_DownloadingAndMounting>();
+	return !Status_DownloadingAndMounting || (Status_DownloadingAndMounting->ChunkId != ChunkId && FindDeltaBaseChunkId(DLCPackage) != ChunkId);
+}
+
+void FDLCPackageManager::RequestCacheEviction()
+{
+	DLC_TRACE_CPU_SCOPE(DLC_RequestCacheEviction);
+
+	FDLCPackageManager_Debug::FLogging_CacheEviction Logging{ };
+
+	using FPakFile = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FPakFile;
+	using FCandidate = DLCPackageManagerPrivate::FDLCCacheEvictionCandidate;
+
+	if (bCacheEvictionInProgress)
+	{
+		bCacheEvictionRequested = true;
+		return;
+	}
+
+	const auto& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+
+	// Pak files of chunks that are not versions of packages are not managed by package manager
+	TMap<int32, const FDLCPackage*> ChunkIdsPackages;
+	for (const TPair<FName, TSharedPtr<FDLCPackage>>& Package : DLCPackages)
+	{
+		for (const FDLCPackage::FVersionInfo& VersionInfo : Package.Value->VersionInfos)
+			ChunkIdsPackages.Add(VersionInfo.ChunkId, Package.Value.Get());
+	}
+
+	TArray<FCandidate> Candidates;
+	uint64 UsedBytes = 0;
+	bool bHasSupersededCandidates = false;
+
+	for (const TPair<FString, TSharedRef<FPakFile>>& PakFilePair : ChunkDownloaderHacked.PakFiles)
+	{
+		const FPakFile& PakFile = *PakFilePair.Value;
+
+		if (PakFile.Download.IsValid())
+		{
+			//NB: Downloading pak file will take its full size
+			UsedBytes += PakFile.Entry.FileSize;
+			continue;
+		}
+
+		if (!PakFile.bIsCached || PakFile.bIsEmbedded)
+			continue;
+
+		UsedBytes += PakFile.SizeOnDisk;
+
+		const FDLCPackage* const* Package = ChunkIdsPackages.Find(PakFile.Entry.ChunkId);
+		if (PakFile.bIsMounted || !Package || !CanEvictChunk(**Package, PakFile.Entry.ChunkId))
+			continue;
+
+		FCandidate& Candidate = Candidates.Emplace_GetRef();
+		Candidate.FileName = PakFile.Entry.FileName;
+		Candidate.FilePath = ChunkDownloaderHacked.CacheFolder / PakFile.Entry.FileName;
+		Candidate.SizeOnDisk = PakFile.SizeOnDisk;
+		Candidate.PackageName = (*Package)->Name;
+		Candidate.ChunkId = PakFile.Entry.ChunkId;
+		//NB: Newest cached version is kept as delta patching base until the latest version is cached
+		Candidate.bSuperseded = ((*Package)->GetLatestVersionInfo().ChunkId != PakFile.Entry.ChunkId) && FindDeltaBaseChunkId(**Package) != PakFile.Entry.ChunkId;
+		//NB: Prefetched package that was not requested yet is kept as just used, otherwise it would be evicted right after prefetching
+		Candidate.LastAccessTime = Prefetches.Contains((*Package)->Name) ? FDateTime::UtcNow() : AccessHistory->GetLastAccessTime((*Package)->Name);
+
+		bHasSupersededCandidates |= Candidate.bSuperseded;
+	}
+
+	const uint64 BudgetBytes = static_cast<uint64>(Settings.DiskBudgetMegabytes) * 1024 * 1024;
+	const bool bIsOverBudget = (BudgetBytes > 0 && UsedBytes > BudgetBytes);
+
+	if (Candidates.Num() == 0 || (!bHasSupersededCandidates && !bIsOverBudget))
+		return;
+
+	DLC_LOG(Logging, Status, TEXT("Started for [%d] candidates, [%llu] bytes used of [%llu] bytes budget"),
+		Candidates.Num(), UsedBytes, BudgetBytes);
+
+	bCacheEvictionInProgress = true;
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis = FWeakThis{ AsShared() }, Candidates = MoveTemp(Candidates), UsedBytes, BudgetBytes]() mutable
+	{
+		TArray<int32> EvictedCandidateIndices = DLCPackageManagerPrivate::SelectEvictedCandidates(Candidates, UsedBytes, BudgetBytes);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Candidates = MoveTemp(Candidates), EvictedCandidateIndices = MoveTemp(EvictedCandidateIndices)]()
+		{
+			if (const TSharedPtr<FDLCPackageManager, ESPMode::ThreadSafe> This = WeakThis.Pin())
+			{
+				This->ApplyCacheEviction(Candidates, EvictedCandidateIndices);
+			}
+		});
+	});
+}
+
+void FDLCPackageManager::ApplyCacheEviction(const TArray<DLCPackageManagerPrivate::FDLCCacheEvictionCandidate>& Candidates, const TArray<int32>& EvictedCandidateIndices)
+{
+	DLC_TRACE_CPU_SCOPE(DLC_ApplyCacheEviction);
+
+	FDLCPackageManager_Debug::FLogging_CacheEviction Logging{ };
+
+	using FPakFile = DLCPackageManagerPrivate::FHackingType_ChunkDownloader::FPakFile;
+
+	auto& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+
+	TArray<FString> FilePathsToDelete;
+
+	for (const int32 CandidateIndex : EvictedCandidateIndices)
+	{
+		const DLCPackageManagerPrivate::FDLCCacheEvictionCandidate& Candidate = Candidates[CandidateIndex];
+
+		//NB: Pak files and packages may be requested while candidates were selected, so candidates are checked again
+		const TSharedRef<FPakFile>* PakFile = ChunkDownloaderHacked.PakFiles.Find(Candidate.FileName);
+		const FDLCPackage* Package = FindDLCPackage(Candidate.PackageName);
+		if (!PakFile || !(*PakFile)->bIsCached || (*PakFile)->bIsMounted || (*PakFile)->Download.IsValid() || !Package || !CanEvictChunk(*Package, Candidate.ChunkId))
+			continue;
+
+		DLC_LOG(Logging, Status, TEXT("Evicting [%s] of package [%s]%s, [%llu] bytes"), *Candidate.FileName,
+			*Candidate.PackageName.ToString(), Candidate.bSuperseded ? TEXT(" (superseded version)") : TEXT(""), Candidate.SizeOnDisk);
+
+		//NB: Pak file is marked as not cached before its removing, so ChunkDownloader downloads it again if it is requested.
+		// Local manifest of ChunkDownloader is saved with next download, missing files are dropped by ChunkDownloader on loading
+		(*PakFile)->bIsCached = false;
+		(*PakFile)->SizeOnDisk = 0;
+		ChunkDownloaderHacked.bNeedsManifestSave = true;
+
+		Metrics.OnPakFileEvicted(Candidate.SizeOnDisk);
+
+		FilePathsToDelete.Add(Candidate.FilePath);
+	}
+
+	if (FilePathsToDelete.Num() > 0)
+	{
+		DLC_LOG(Logging, StatusImportant, TEXT("Evicted [%d] pak files"), FilePathsToDelete.Num());
+
+		Async(EAsyncExecution::ThreadPool, [FilePathsToDelete = MoveTemp(FilePathsToDelete)]()
+		{
+			for (const FString& FilePath : FilePathsToDelete)
+				IFileManager::Get().Delete(*FilePath, false, true, true);
+		});
+	}
+
+	bCacheEvictionInProgress = false;
+
+	if (bCacheEvictionRequested)
+	{
+		bCacheEvictionRequested = false;
+		RequestCacheEviction();
+	}
+}
+
+const DLCPackageManagerPrivate::FHackingType_ChunkDownloader& FDLCPackageManager::GetChunkDownloaderHackedAccess() const
+{
+	return DLCPackageManagerPrivate::GetHackedType<DLCPackageManagerPrivate::FHackingType_ChunkDownloader>(*ChunkDownloader.Get());
+}
+
+DLCPackageManagerPrivate::FHackingType_ChunkDownloader& FDLCPackageManager::GetChunkDownloaderHackedAccess()
+{
+	return DLCPackageManagerPrivate::GetHackedType<DLCPackageManagerPrivate::FHackingType_ChunkDownloader>(*ChunkDownloader.Get());
+}
+
+const FDLCPackageManager::FDLCPackage* FDLCPackageManager::FindDLCPackage(const FName& PackageName) const
+{
+	const TSharedPtr<FDLCPackage>* DLCPackagePtrPtr = DLCPackages.Find(PackageName);
+	return DLCPackagePtrPtr ? DLCPackagePtrPtr->Get() : nullptr;
+}
+
+FDLCPackageManager::FDLCPackage* FDLCPackageManager::FindDLCPackage(const FName& PackageName)
+{
+	const FDLCPackage* ConstPackage = const_cast<const FDLCPackageManager*>(this)->FindDLCPackage(PackageName);
+	return const_cast<FDLCPackage*>(ConstPackage);
+}
+
+FDLCPackageManager::FDLCPackage* FDLCPackageManager::FindDLCPackage(const FStringView& PackageName)
+{
+	//NB: "FNAME_Find" is used to not pollute name table with names of unknown packages
+	const FName PackageFName{ PackageName.Len(), PackageName.GetData(), FNAME_Find };
+	return PackageFName.IsNone() ? nullptr : FindDLCPackage(PackageFName);
+}
+
+FDLCPackageManager::FDLCPackage* FDLCPackageManager::FindDLCPackageForPath(const FSoftObjectPath& SoftObjectPath)
+{
+	const FName AssetPathName = SoftObjectPath.GetAssetPathName();
+	if (AssetPathName.IsNone())
+		return nullptr;
+
+	if (FDLCPackage* const* CachedDLCPackagePtr = ResolvedPathsCache.FindAndTouch(AssetPathName))
+		return *CachedDLCPackagePtr;
+
+	TStringBuilder<NAME_SIZE> AssetPathBuilder;
+	AssetPathName.AppendString(AssetPathBuilder);
+
+	FDLCPackage* DLCPackage = nullptr;
+
+	const TOptional<FStringView> DLCChunkId = FDLCPackageManager_Private::GetDLCChunkId(AssetPathBuilder.ToView());
+	if (DLCChunkId.IsSet())
+	{
+		DLCPackage = FindDLCPackage(DLCChunkId.GetValue());
+
+		//TODO: Return error "No chunk with proivded Id"
+		if (!DLCPackage)
+		{
+			const FDLCPackageManager_Debug::FLogging_Loading Logging{ FSoftObjectPtr{ SoftObjectPath } };
+			DLC_LOG(Logging, Warning, TEXT("Cannot find DLC package [%s] for path"), *FString{ DLCChunkId.GetValue() });
+		}
+	}
+
+	//NB: Cache drops least recently resolved path on overflow, so scans of many cold paths do not drop hot paths
+	ResolvedPathsCache.Add(AssetPathName, DLCPackage);
+
+	return DLCPackage;
+}
+
+TArray<FDLCPackageManager::FDLCPackage*> FDLCPackageManager::FindDependencyDLCPackagesForPath(const FSoftObjectPath& SoftObjectPath)
+{
+	TArray<FDLCPackage*> Result;
+	if (!DependencyGraph.IsValid())
+		return Result;
+
+	const FName AssetPackageName{ *SoftObjectPath.GetLongPackageName() };
+	for (const FName& DependencyDLCPackageName : DependencyGraph->GetDependencyDLCPackageNames(AssetPackageName))
+	{
+		FDLCPackage* DependencyDLCPackage = FindDLCPackage(DependencyDLCPackageName);
+		if (!DependencyDLCPackage)
+		{
+			const FDLCPackageManager_Debug::FLogging_Loading Logging{ FSoftObjectPtr{ SoftObjectPath } };
+			DLC_LOG(Logging, Warning, TEXT("Cannot find DLC package [%s] of path dependencies"), *DependencyDLCPackageName.ToString());
+
+			continue;
+		}
+
+		Result.Add(DependencyDLCPackage);
+	}
+
+	return Result;
 }
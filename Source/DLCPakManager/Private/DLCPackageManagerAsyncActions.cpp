@@ -0,0 +1,187 @@
+#include "DLCPackageManagerAsyncActions.h"
+#include "DLCPackageManager.h"
+
+#include "Containers/Ticker.h"
+
+bool FDLCLoadingProgress::operator==(const FDLCLoadingProgress& Other) const
+{
+	return
+		(Stage == Other.Stage) &&
+		(DownloadedBytes == Other.DownloadedBytes) &&
+		(TotalBytes == Other.TotalBytes) &&
+		(MountedPackagesNum == Other.MountedPackagesNum) &&
+		(PackagesNum == Other.PackagesNum);
+}
+
+void UDLCLoadingAsyncActionBase::Activate()
+{
+	LastProgress = ComputeProgress();
+	OnProgress.Broadcast(LastProgress);
+
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UDLCLoadingAsyncActionBase::Tick));
+
+	StartLoading();
+}
+
+void UDLCLoadingAsyncActionBase::FinishLoading()
+{
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	LastProgress = ComputeProgress();
+	LastProgress.Stage = EDLCLoadingStage::Finished;
+	OnProgress.Broadcast(LastProgress);
+
+	SetReadyToDestroy();
+}
+
+bool UDLCLoadingAsyncActionBase::Tick(float DeltaTime)
+{
+	const FDLCLoadingProgress Progress = ComputeProgress();
+	if (!(Progress == LastProgress))
+	{
+		LastProgress = Progress;
+		OnProgress.Broadcast(LastProgress);
+	}
+
+	return true;
+}
+
+FDLCLoadingProgress UDLCLoadingAsyncActionBase::ComputeProgress()
+{
+	FDLCPackageManager& PackageManager = FDLCPackageManager::Get();
+
+	FDLCLoadingProgress Result;
+	if (!PackageManager.IsInitialized())
+		return Result;
+
+	//NB: Catalog is needed to find packages of objects, so they are resolved once after initialization
+	if (!bArePackageNamesResolved)
+	{
+		for (const FSoftObjectPath& SoftObjectPath : SoftObjectPaths)
+		{
+			const FName PackageName = PackageManager.GetDLCPackageNameForPath(SoftObjectPath);
+			if (!PackageName.IsNone())
+			{
+				PackageNames.AddUnique(PackageName);
+			}
+		}
+
+		bArePackageNamesResolved = true;
+	}
+
+	const FDLCPackagesProgress PackagesProgress = PackageManager.GetDLCPackagesProgress(PackageNames);
+
+	Result.DownloadedBytes = static_cast<int64>(PackagesProgress.DownloadedBytes);
+	Result.TotalBytes = static_cast<int64>(PackagesProgress.TotalBytes);
+	Result.Percent = PackagesProgress.TotalBytes > 0 ? 100.0f * PackagesProgress.DownloadedBytes / PackagesProgress.TotalBytes : 100.0f;
+	Result.MountedPackagesNum = PackagesProgress.MountedPackagesNum;
+	Result.PackagesNum = PackagesProgress.PackagesNum;
+
+	Result.Stage =
+		(PackagesProgress.DownloadedBytes < PackagesProgress.TotalBytes) ? EDLCLoadingStage::Downloading :
+		(PackagesProgress.MountedPackagesNum < PackagesProgress.PackagesNum) ? EDLCLoadingStage::Mounting :
+		bHasLoadingStage ? EDLCLoadingStage::Loading : EDLCLoadingStage::Finished;
+
+	return Result;
+}
+
+// - - -
+
+UDLCLoadObjectsAsyncAction* UDLCLoadObjectsAsyncAction::LoadDLCObjects(const UObject* WCO, const TArray<TSoftObjectPtr<UObject>>& SoftObjects)
+{
+	UDLCLoadObjectsAsyncAction* Action = NewObject<UDLCLoadObjectsAsyncAction>();
+	Action->RegisterWithGameInstance(WCO);
+
+	for (const TSoftObjectPtr<UObject>& SoftObject : SoftObjects)
+	{
+		Action->SoftObjectPaths.Add(SoftObject.ToSoftObjectPath());
+	}
+
+	return Action;
+}
+
+void UDLCLoadObjectsAsyncAction::StartLoading()
+{
+	TArray<FSoftObjectPtr> SoftObjectPtrs;
+	SoftObjectPtrs.Reserve(SoftObjectPaths.Num());
+	for (const FSoftObjectPath& SoftObjectPath : SoftObjectPaths)
+	{
+		SoftObjectPtrs.Emplace(SoftObjectPath);
+	}
+
+	FDLCPackageManager::Get().GetLoadedPaths(SoftObjectPtrs).Next([WeakThis = TWeakObjectPtr<UDLCLoadObjectsAsyncAction>{ this }](const TArray<UObject*>& Objects)
+	{
+		if (UDLCLoadObjectsAsyncAction* This = WeakThis.Get())
+		{
+			This->FinishLoading();
+			This->OnCompleted.Broadcast(Objects);
+		}
+	});
+}
+
+// - - -
+
+UDLCLoadClassesAsyncAction* UDLCLoadClassesAsyncAction::LoadDLCClasses(const UObject* WCO, const TArray<TSoftClassPtr<UObject>>& SoftClasses)
+{
+	UDLCLoadClassesAsyncAction* Action = NewObject<UDLCLoadClassesAsyncAction>();
+	Action->RegisterWithGameInstance(WCO);
+
+	for (const TSoftClassPtr<UObject>& SoftClass : SoftClasses)
+	{
+		Action->SoftObjectPaths.Add(SoftClass.ToSoftObjectPath());
+	}
+
+	return Action;
+}
+
+void UDLCLoadClassesAsyncAction::StartLoading()
+{
+	TArray<FSoftObjectPtr> SoftObjectPtrs;
+	SoftObjectPtrs.Reserve(SoftObjectPaths.Num());
+	for (const FSoftObjectPath& SoftObjectPath : SoftObjectPaths)
+	{
+		SoftObjectPtrs.Emplace(SoftObjectPath);
+	}
+
+	FDLCPackageManager::Get().GetLoadedPaths(SoftObjectPtrs).Next([WeakThis = TWeakObjectPtr<UDLCLoadClassesAsyncAction>{ this }](const TArray<UObject*>& Objects)
+	{
+		if (UDLCLoadClassesAsyncAction* This = WeakThis.Get())
+		{
+			TArray<UClass*> Classes;
+			Classes.Reserve(Objects.Num());
+			for (UObject* Object : Objects)
+			{
+				Classes.Add(Cast<UClass>(Object));
+			}
+
+			This->FinishLoading();
+			This->OnCompleted.Broadcast(Classes);
+		}
+	});
+}
+
+// - - -
+
+UDLCPreloadPackagesAsyncAction* UDLCPreloadPackagesAsyncAction::PreloadDLCPackages(const UObject* WCO, const TArray<FName>& Packages)
+{
+	UDLCPreloadPackagesAsyncAction* Action = NewObject<UDLCPreloadPackagesAsyncAction>();
+	Action->RegisterWithGameInstance(WCO);
+
+	Action->PackageNames = Packages;
+	Action->bHasLoadingStage = false;
+
+	return Action;
+}
+
+void UDLCPreloadPackagesAsyncAction::StartLoading()
+{
+	FDLCPackageManager::Get().PreloadDLCPackages(PackageNames).Next([WeakThis = TWeakObjectPtr<UDLCPreloadPackagesAsyncAction>{ this }](const bool bAllPackagesFound)
+	{
+		if (UDLCPreloadPackagesAsyncAction* This = WeakThis.Get())
+		{
+			This->FinishLoading();
+			This->OnCompleted.Broadcast(bAllPackagesFound);
+		}
+	});
+}
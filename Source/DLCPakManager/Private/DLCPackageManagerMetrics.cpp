@@ -0,0 +1,366 @@
+#include "DLCPackageManagerMetrics.h"
+
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+
+void FDLCLatencyHistogram::AddSample(const double Value)
+{
+	if (Samples.Num() < MaxSamplesNum)
+	{
+		Samples.Add(Value);
+	}
+	else
+	{
+		Samples[NextSampleIndex] = Value;
+	}
+
+	NextSampleIndex = (NextSampleIndex + 1) % MaxSamplesNum;
+	++TotalSamplesNum;
+	Max = FMath::Max(Max, Value);
+}
+
+double FDLCLatencyHistogram::GetPercentile(const double Percentile) const
+{
+	if (Samples.Num() == 0)
+		return 0.0;
+
+	TArray<double> SortedSamples = Samples;
+	SortedSamples.Sort();
+
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile / 100.0 * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+	return SortedSamples[Index];
+}
+
+int32 FDLCLatencyHistogram::GetSamplesNum() const
+{
+	return Samples.Num();
+}
+
+int64 FDLCLatencyHistogram::GetTotalSamplesNum() const
+{
+	return TotalSamplesNum;
+}
+
+double FDLCLatencyHistogram::GetMax() const
+{
+	return Max;
+}
+
+// - - - - - - - - - - - - -
+
+void FDLCPackageManagerMetrics::OnRequestFinished(const FRequestRecord& Record)
+{
+	if (Record.InitializationWaitEndTime > 0.0)
+		InitializationWaitHistogram.AddSample(Record.InitializationWaitEndTime - Record.StartTime);
+
+	if (Record.DLCChunkReadyTime > 0.0)
+		DLCChunkWaitHistogram.AddSample(Record.DLCChunkReadyTime - Record.InitializationWaitEndTime);
+
+	if (Record.LoadEndTime > 0.0)
+	{
+		LoadHistogram.AddSample(Record.LoadEndTime - Record.DLCChunkReadyTime);
+		RequestHistogram.AddSample(Record.LoadEndTime - Record.StartTime);
+	}
+
+	if (!Record.bSucceeded)
+		++FailedRequestsNum;
+
+	if (RecentRequests.Num() < MaxRecentRequestsNum)
+	{
+		RecentRequests.Add(Record);
+	}
+	else
+	{
+		RecentRequests[NextRecentRequestIndex] = Record;
+	}
+
+	NextRecentRequestIndex = (NextRecentRequestIndex + 1) % MaxRecentRequestsNum;
+}
+
+void FDLCPackageManagerMetrics::OnChunkRequested(const int32 ChunkId, const FName& DLCPackageName)
+{
+	FChunkRecord& Record = Chunks.FindOrAdd(ChunkId);
+	Record = FChunkRecord{ };
+	Record.ChunkId = ChunkId;
+	Record.DLCPackageName = DLCPackageName;
+	Record.DownloadStartTime = FPlatformTime::Seconds();
+}
+
+void FDLCPackageManagerMetrics::OnPakFileDownloaded(const int32 ChunkId, const FString& FileName, const uint64 SizeBytes, const double FileDownloadSeconds, const int32 HttpStatus)
+{
+	const bool bSuccess = (HttpStatus >= 200 && HttpStatus < 300);
+	if (bSuccess)
+	{
+		DownloadedBytes += SizeBytes;
+		DownloadSeconds += FileDownloadSeconds;
+		++DownloadedFilesNum;
+		PakDownloadHistogram.AddSample(FileDownloadSeconds);
+	}
+	else
+	{
+		++FailedDownloadsNum;
+	}
+
+	if (FChunkRecord* Record = Chunks.Find(ChunkId))
+	{
+		Record->DownloadEndTime = FPlatformTime::Seconds();
+		Record->DownloadedBytes += bSuccess ? SizeBytes : 0;
+		Record->DownloadedFilesNum += bSuccess ? 1 : 0;
+		Record->LastHttpStatus = HttpStatus;
+	}
+}
+
+void FDLCPackageManagerMetrics::OnChunkMounted(const int32 ChunkId, const bool bSuccess)
+{
+	FChunkRecord* Record = Chunks.Find(ChunkId);
+	if (!Record)
+		return;
+
+	Record->MountEndTime = FPlatformTime::Seconds();
+	Record->bMounted = bSuccess;
+
+	// Chunk without downloaded files was taken from cache
+	const double DownloadEndTime = (Record->DownloadedFilesNum > 0) ? Record->DownloadEndTime : Record->DownloadStartTime;
+
+	if (Record->DownloadedFilesNum > 0)
+		ChunkDownloadHistogram.AddSample(DownloadEndTime - Record->DownloadStartTime);
+
+	ChunkMountHistogram.AddSample(Record->MountEndTime - DownloadEndTime);
+}
+
+void FDLCPackageManagerMetrics::OnPrefetchIssued()
+{
+	++PrefetchIssuedNum;
+}
+
+void FDLCPackageManagerMetrics::OnPrefetchDownloaded(const uint64 PackageBytes)
+{
+	PrefetchDownloadedBytes += PackageBytes;
+}
+
+void FDLCPackageManagerMetrics::OnPrefetchHit(const uint64 DownloadedPackageBytes)
+{
+	++PrefetchHitsNum;
+	PrefetchHitBytes += DownloadedPackageBytes;
+}
+
+void FDLCPackageManagerMetrics::OnPrefetchMiss()
+{
+	++PrefetchMissesNum;
+}
+
+void FDLCPackageManagerMetrics::OnPakFileEvicted(const uint64 SizeBytes)
+{
+	++EvictedPakFilesNum;
+	EvictedBytes += SizeBytes;
+}
+
+void FDLCPackageManagerMetrics::OnPakFileVerified(const FString& FileName, const uint64 HashedBytes, const double HashingSeconds, const int32 InCorruptedBlocksNum, const bool bVerified)
+{
+	if (HashedBytes > 0)
+	{
+		VerifiedBytes += HashedBytes;
+		VerificationSeconds += HashingSeconds;
+		PakVerificationHistogram.AddSample(HashingSeconds);
+	}
+
+	CorruptedBlocksNum += InCorruptedBlocksNum;
+
+	if (!bVerified)
+		++FailedVerificationsNum;
+}
+
+void FDLCPackageManagerMetrics::OnDeltaPatchApplied(const int64 TargetBytes, const int64 PatchBytes, const double ReconstructionSeconds, const bool bSuccess)
+{
+	DeltaPatchBytes += PatchBytes;
+
+	if (!bSuccess)
+	{
+		++FailedDeltaPatchesNum;
+		//NB: Full pak file is downloaded after failed patching
+		DeltaSavedBytes -= PatchBytes;
+		return;
+	}
+
+	++DeltaPatchedFilesNum;
+	DeltaSavedBytes += TargetBytes - PatchBytes;
+	DeltaReconstructionHistogram.AddSample(ReconstructionSeconds);
+}
+
+double FDLCPackageManagerMetrics::GetDownloadThroughput() const
+{
+	return (DownloadSeconds > 0.0) ? (DownloadedBytes / DownloadSeconds) : 0.0;
+}
+
+double FDLCPackageManagerMetrics::GetVerificationThroughput() const
+{
+	return (VerificationSeconds > 0.0) ? (VerifiedBytes / VerificationSeconds) : 0.0;
+}
+
+double FDLCPackageManagerMetrics::GetPrefetchHitRate() const
+{
+	const int64 RequestsNum = PrefetchHitsNum + PrefetchMissesNum;
+	return (RequestsNum > 0) ? (static_cast<double>(PrefetchHitsNum) / RequestsNum) : 0.0;
+}
+
+// - - - - - - - - - - - - -
+
+namespace DLCPackageManagerMetricsPrivate
+{
+	struct FNamedHistogram
+	{
+		const TCHAR* Name;
+		const FDLCLatencyHistogram* Histogram;
+	};
+
+	struct FNamedCounter
+	{
+		const TCHAR* Name;
+		double Value;
+		// Rates and throughputs are fractional, other counters are whole numbers
+		bool bIsFractional;
+	};
+
+	//NB: Same lists are used by all dump formats, so formats do not diverge
+	TArray<FNamedHistogram> GetNamedHistograms(const FDLCPackageManagerMetrics& Metrics)
+	{
+		return {
+			{ TEXT("InitializationWait"), &Metrics.GetInitializationWaitHistogram() },
+			{ TEXT("DLCChunkWait"), &Metrics.GetDLCChunkWaitHistogram() },
+			{ TEXT("Load"), &Metrics.GetLoadHistogram() },
+			{ TEXT("Request"), &Metrics.GetRequestHistogram() },
+			{ TEXT("PakDownload"), &Metrics.GetPakDownloadHistogram() },
+			{ TEXT("ChunkDownload"), &Metrics.GetChunkDownloadHistogram() },
+			{ TEXT("ChunkMount"), &Metrics.GetChunkMountHistogram() },
+			{ TEXT("PakVerification"), &Metrics.GetPakVerificationHistogram() },
+			{ TEXT("DeltaReconstruction"), &Metrics.GetDeltaReconstructionHistogram() }
+		};
+	}
+
+	TArray<FNamedCounter> GetNamedCounters(const FDLCPackageManagerMetrics& Metrics)
+	{
+		return {
+			{ TEXT("DownloadedBytes"), static_cast<double>(Metrics.GetDownloadedBytes()), false },
+			{ TEXT("DownloadedFiles"), static_cast<double>(Metrics.GetDownloadedFilesNum()), false },
+			{ TEXT("FailedDownloads"), static_cast<double>(Metrics.GetFailedDownloadsNum()), false },
+			{ TEXT("FailedRequests"), static_cast<double>(Metrics.GetFailedRequestsNum()), false },
+			{ TEXT("DownloadThroughput"), Metrics.GetDownloadThroughput(), true },
+			{ TEXT("PrefetchIssued"), static_cast<double>(Metrics.GetPrefetchIssuedNum()), false },
+			{ TEXT("PrefetchHits"), static_cast<double>(Metrics.GetPrefetchHitsNum()), false },
+			{ TEXT("PrefetchMisses"), static_cast<double>(Metrics.GetPrefetchMissesNum()), false },
+			{ TEXT("PrefetchHitRate"), Metrics.GetPrefetchHitRate(), true },
+			{ TEXT("PrefetchWastedBytes"), static_cast<double>(Metrics.GetPrefetchWastedBytes()), false },
+			{ TEXT("EvictedPakFiles"), static_cast<double>(Metrics.GetEvictedPakFilesNum()), false },
+			{ TEXT("EvictedBytes"), static_cast<double>(Metrics.GetEvictedBytes()), false },
+			{ TEXT("VerifiedBytes"), static_cast<double>(Metrics.GetVerifiedBytes()), false },
+			{ TEXT("VerificationThroughput"), Metrics.GetVerificationThroughput(), true },
+			{ TEXT("CorruptedBlocks"), static_cast<double>(Metrics.GetCorruptedBlocksNum()), false },
+			{ TEXT("FailedVerifications"), static_cast<double>(Metrics.GetFailedVerificationsNum()), false },
+			{ TEXT("DeltaPatchedFiles"), static_cast<double>(Metrics.GetDeltaPatchedFilesNum()), false },
+			{ TEXT("FailedDeltaPatches"), static_cast<double>(Metrics.GetFailedDeltaPatchesNum()), false },
+			{ TEXT("DeltaPatchBytes"), static_cast<double>(Metrics.GetDeltaPatchBytes()), false },
+			{ TEXT("DeltaSavedBytes"), static_cast<double>(Metrics.GetDeltaSavedBytes()), false }
+		};
+	}
+}
+
+FString FDLCPackageManagerMetrics::ToJson() const
+{
+	using namespace DLCPackageManagerMetricsPrivate;
+
+	FString Result;
+	const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Result);
+
+	Writer->WriteObjectStart();
+
+	Writer->WriteObjectStart(TEXT("Counters"));
+	for (const FNamedCounter& NamedCounter : GetNamedCounters(*this))
+	{
+		Writer->WriteValue(NamedCounter.Name, NamedCounter.Value);
+	}
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectStart(TEXT("Histograms"));
+	for (const FNamedHistogram& NamedHistogram : GetNamedHistograms(*this))
+	{
+		const FDLCLatencyHistogram& Histogram = *NamedHistogram.Histogram;
+		Writer->WriteObjectStart(NamedHistogram.Name);
+		Writer->WriteValue(TEXT("Count"), static_cast<double>(Histogram.GetTotalSamplesNum()));
+		Writer->WriteValue(TEXT("P50"), Histogram.GetPercentile(50.0));
+		Writer->WriteValue(TEXT("P95"), Histogram.GetPercentile(95.0));
+		Writer->WriteValue(TEXT("P99"), Histogram.GetPercentile(99.0));
+		Writer->WriteValue(TEXT("Max"), Histogram.GetMax());
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteObjectEnd();
+
+	Writer->WriteArrayStart(TEXT("Chunks"));
+	for (const TPair<int32, FChunkRecord>& ChunkPair : Chunks)
+	{
+		const FChunkRecord& Chunk = ChunkPair.Value;
+
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("ChunkId"), Chunk.ChunkId);
+		Writer->WriteValue(TEXT("Package"), Chunk.DLCPackageName.ToString());
+		Writer->WriteValue(TEXT("DownloadStartTime"), Chunk.DownloadStartTime);
+		Writer->WriteValue(TEXT("DownloadEndTime"), Chunk.DownloadEndTime);
+		Writer->WriteValue(TEXT("MountEndTime"), Chunk.MountEndTime);
+		Writer->WriteValue(TEXT("DownloadedBytes"), static_cast<double>(Chunk.DownloadedBytes));
+		Writer->WriteValue(TEXT("HttpStatus"), Chunk.LastHttpStatus);
+		Writer->WriteValue(TEXT("Mounted"), Chunk.bMounted);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteArrayStart(TEXT("RecentRequests"));
+	for (const FRequestRecord& Request : RecentRequests)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Package"), Request.DLCPackageName.ToString());
+		Writer->WriteValue(TEXT("Objects"), Request.ObjectsNum);
+		Writer->WriteValue(TEXT("StartTime"), Request.StartTime);
+		Writer->WriteValue(TEXT("InitializationWaitEndTime"), Request.InitializationWaitEndTime);
+		Writer->WriteValue(TEXT("DLCChunkReadyTime"), Request.DLCChunkReadyTime);
+		Writer->WriteValue(TEXT("LoadEndTime"), Request.LoadEndTime);
+		Writer->WriteValue(TEXT("Succeeded"), Request.bSucceeded);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	return Result;
+}
+
+FString FDLCPackageManagerMetrics::ToCsv() const
+{
+	using namespace DLCPackageManagerMetricsPrivate;
+
+	//NB: Histograms and counters have different columns, so they are written as two tables separated by empty line
+	FString Result = TEXT("Histogram,Count,P50,P95,P99,Max\n");
+	for (const FNamedHistogram& NamedHistogram : GetNamedHistograms(*this))
+	{
+		const FDLCLatencyHistogram& Histogram = *NamedHistogram.Histogram;
+		Result += FString::Printf(TEXT("%s,%lld,%f,%f,%f,%f\n"), NamedHistogram.Name, Histogram.GetTotalSamplesNum(),
+			Histogram.GetPercentile(50.0), Histogram.GetPercentile(95.0), Histogram.GetPercentile(99.0), Histogram.GetMax());
+	}
+
+	Result += TEXT("\nCounter,Value\n");
+	for (const FNamedCounter& NamedCounter : GetNamedCounters(*this))
+	{
+		Result += NamedCounter.bIsFractional ?
+			FString::Printf(TEXT("%s,%f\n"), NamedCounter.Name, NamedCounter.Value) :
+			FString::Printf(TEXT("%s,%lld\n"), NamedCounter.Name, static_cast<int64>(NamedCounter.Value));
+	}
+
+	return Result;
+}
+
+bool FDLCPackageManagerMetrics::DumpToFile(const FString& FilePath) const
+{
+	const bool bIsCsv = FPaths::GetExtension(FilePath).Equals(TEXT("csv"), ESearchCase::IgnoreCase);
+	return FFileHelper::SaveStringToFile(bIsCsv ? ToCsv() : ToJson(), *FilePath);
+}
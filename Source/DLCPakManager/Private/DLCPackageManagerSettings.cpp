@@ -0,0 +1,70 @@
+#include "DLCPackageManagerSettings.h"
+
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Paths.h"
+
+FDLCPackageManagerSettings FDLCPackageManagerSettings::LoadFromConfig(const FName& InstanceName, const FString& ConfigFileName)
+{
+	FDLCPackageManagerSettings Result;
+
+	const FString SectionName = GetConfigSectionName(InstanceName);
+
+	GConfig->GetString(*SectionName, TEXT("DeploymentName"), Result.DeploymentName, ConfigFileName);
+	GConfig->GetString(*SectionName, TEXT("ContentBuildId"), Result.ContentBuildId, ConfigFileName);
+	GConfig->GetString(*SectionName, TEXT("PlatformName"), Result.PlatformName, ConfigFileName);
+	GConfig->GetInt(*SectionName, TEXT("MaxConcurrentDownloads"), Result.MaxConcurrentDownloads, ConfigFileName);
+	GConfig->GetInt(*SectionName, TEXT("MaxConcurrentMounts"), Result.MaxConcurrentMounts, ConfigFileName);
+	GConfig->GetFloat(*SectionName, TEXT("MountFrameBudgetMilliseconds"), Result.MountFrameBudgetMilliseconds, ConfigFileName);
+	GConfig->GetString(*SectionName, TEXT("CacheFolder"), Result.CacheFolder, ConfigFileName);
+	GConfig->GetBool(*SectionName, TEXT("bEnablePrefetch"), Result.bEnablePrefetch, ConfigFileName);
+	GConfig->GetInt(*SectionName, TEXT("MaxPrefetchPredictions"), Result.MaxPrefetchPredictions, ConfigFileName);
+	GConfig->GetFloat(*SectionName, TEXT("MinPrefetchProbability"), Result.MinPrefetchProbability, ConfigFileName);
+	GConfig->GetInt(*SectionName, TEXT("DiskBudgetMegabytes"), Result.DiskBudgetMegabytes, ConfigFileName);
+	GConfig->GetArray(*SectionName, TEXT("PinnedPackages"), Result.PinnedPackages, ConfigFileName);
+	GConfig->GetBool(*SectionName, TEXT("bEnableResumableDownloads"), Result.bEnableResumableDownloads, ConfigFileName);
+	GConfig->GetInt(*SectionName, TEXT("ResumableDownloadMinMegabytes"), Result.ResumableDownloadMinMegabytes, ConfigFileName);
+	GConfig->GetInt(*SectionName, TEXT("MaxResumableDownloadConnections"), Result.MaxResumableDownloadConnections, ConfigFileName);
+	GConfig->GetBool(*SectionName, TEXT("bVerifyPakFiles"), Result.bVerifyPakFiles, ConfigFileName);
+	GConfig->GetBool(*SectionName, TEXT("bEnableDeltaPatches"), Result.bEnableDeltaPatches, ConfigFileName);
+	GConfig->GetBool(*SectionName, TEXT("bBuildCatalogOffGameThread"), Result.bBuildCatalogOffGameThread, ConfigFileName);
+	GConfig->GetBool(*SectionName, TEXT("bEnableCatalogSnapshot"), Result.bEnableCatalogSnapshot, ConfigFileName);
+	GConfig->GetBool(*SectionName, TEXT("bDownloadDependencyPackages"), Result.bDownloadDependencyPackages, ConfigFileName);
+
+	FString StartupModeString;
+	if (GConfig->GetString(*SectionName, TEXT("StartupMode"), StartupModeString, ConfigFileName))
+	{
+		if (StartupModeString == TEXT("ForceManifestDownload"))
+		{
+			Result.StartupMode = EDLCManifestStartupMode::ForceManifestDownload;
+		}
+		else if (StartupModeString == TEXT("StaleWhileRevalidate"))
+		{
+			Result.StartupMode = EDLCManifestStartupMode::StaleWhileRevalidate;
+		}
+	}
+
+	if (Result.PlatformName.IsEmpty())
+	{
+		Result.PlatformName = ANSI_TO_TCHAR(FPlatformProperties::IniPlatformName());
+	}
+
+	Result.MaxConcurrentDownloads = FMath::Max(Result.MaxConcurrentDownloads, 1);
+	Result.MaxConcurrentMounts = FMath::Max(Result.MaxConcurrentMounts, 1);
+	Result.MountFrameBudgetMilliseconds = FMath::Max(Result.MountFrameBudgetMilliseconds, 0.0f);
+	Result.DiskBudgetMegabytes = FMath::Max(Result.DiskBudgetMegabytes, 0);
+	Result.ResumableDownloadMinMegabytes = FMath::Max(Result.ResumableDownloadMinMegabytes, 0);
+	Result.MaxResumableDownloadConnections = FMath::Max(Result.MaxResumableDownloadConnections, 1);
+
+	return Result;
+}
+
+FString FDLCPackageManagerSettings::GetConfigSectionName(const FName& InstanceName)
+{
+	return FString::Printf(TEXT("DLCPakManager %s"), *InstanceName.ToString());
+}
+
+FString FDLCPackageManagerSettings::GetDefaultCacheFolder(const FName& InstanceName)
+{
+	//NB: Should match default folder of "FChunkDownloader::Initialize()"
+	return FPaths::ProjectPersistentDownloadDir() / TEXT("PakCache") / InstanceName.ToString();
+}
@@ -0,0 +1,523 @@
+#include "DLCPackageManager.h"
+#include "DLCPackageManager_Debug.h"
+#include "DLCResumableDownload.h"
+
+#include "Algo/Count.h"
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+
+#if WITH_DLC_PAK_TOOLS
+
+// Tests of package manager are started by "DLC.Test.<Name>" console commands on instance with real DLC content.
+// Results are printed as important status if test is passed and as error otherwise
+
+// Internal state of package manager checked by tests
+struct FDLCPackageManager_Tests
+{
+	struct FState
+	{
+		int32 MountedPackagesNum = 0;
+		int32 UsersNum = 0;
+		int32 AcquisitionsNum = 0;
+
+		bool operator==(const FState& Other) const
+		{
+			return MountedPackagesNum == Other.MountedPackagesNum && UsersNum == Other.UsersNum && AcquisitionsNum == Other.AcquisitionsNum;
+		}
+
+		FString ToString() const
+		{
+			return FString::Printf(TEXT("[%d] mounted packages, [%d] users, [%d] acquisitions"), MountedPackagesNum, UsersNum, AcquisitionsNum);
+		}
+	};
+
+	static FState GetState(const FDLCPackageManager& PackageManager)
+	{
+		check(IsInGameThread());
+
+		FState Result;
+
+		for (const TPair<FName, TSharedPtr<FDLCPackageManager::FDLCPackage>>& DLCPackage : PackageManager.DLCPackages)
+		{
+			Result.MountedPackagesNum += DLCPackage.Value->Status.IsType<FDLCPackageManager::FDLCPackage::FStatus_Mounted>() ? 1 : 0;
+			Result.UsersNum += DLCPackage.Value->UsersNum;
+		}
+
+		for (const TPair<FName, TArray<FDLCPackageManager::FDLCPackagesAcquisition>>& PathAcquisitions : PackageManager.PathsAcquisitions)
+		{
+			for (const FDLCPackageManager::FDLCPackagesAcquisition& Acquisition : PathAcquisitions.Value)
+			{
+				Result.AcquisitionsNum += Acquisition.LoadingsNum;
+			}
+		}
+
+		return Result;
+	}
+};
+
+namespace DLCPackageManagerPrivate
+{
+	namespace
+	{
+		bool LoadTestSoftObjectPaths(const FString& ParamsString, TArray<FSoftObjectPtr>& OutSoftObjectPtrs)
+		{
+			FString PathsFilePath;
+			TArray<FString> PathLines;
+			if (!FParse::Value(*ParamsString, TEXT("PathsFile="), PathsFilePath) || !FFileHelper::LoadFileToStringArray(PathLines, *PathsFilePath))
+				return false;
+
+			for (FString& PathLine : PathLines)
+			{
+				PathLine.TrimStartAndEndInline();
+				if (!PathLine.IsEmpty() && !PathLine.StartsWith(TEXT("#")))
+				{
+					OutSoftObjectPtrs.Emplace(FSoftObjectPath{ PathLine });
+				}
+			}
+
+			return OutSoftObjectPtrs.Num() > 0;
+		}
+
+		// Calls function on next tick after garbage collection, so released packages are unmounted before it
+		void CollectGarbageAndCall(TFunction<void()>&& Function)
+		{
+			FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Function = MoveTemp(Function)](const float)
+			{
+				CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+				AsyncTask(ENamedThreads::GameThread, Function);
+				return false;
+			}));
+		}
+
+		// - - - - - - - - - - - - -
+
+		// Load and release cycles of same paths. Every loading is released, so state of package manager after cycles
+		// should match its state before them: no users, no acquisitions and no extra mounted packages.
+		// Paths are loaded by batch loading and then loaded again as resolved references by single loading
+		class FAcquireReleaseTest : public TSharedFromThis<FAcquireReleaseTest>
+		{
+		public:
+			FAcquireReleaseTest(const FName& InInstanceName, TArray<FSoftObjectPtr>&& InSoftObjectPtrs, const int32 InCyclesNum)
+				: InstanceName(InInstanceName), SoftObjectPtrs(MoveTemp(InSoftObjectPtrs)), CyclesNum(InCyclesNum) { }
+
+			void Start()
+			{
+				//NB: Preloading of no packages finishes after initialization, so baseline state is taken from initialized manager
+				const TArray<FName> NoPackages;
+				FDLCPackageManager::Get(InstanceName).PreloadDLCPackages(NoPackages).Next([This = AsShared()](bool)
+				{
+					This->InitialState = FDLCPackageManager_Tests::GetState(FDLCPackageManager::Get(This->InstanceName));
+					This->InitialUsedPhysicalBytes = FPlatformMemory::GetStats().UsedPhysical;
+
+					This->RunCycle(0);
+				});
+			}
+
+		private:
+			void RunCycle(const int32 CycleIndex)
+			{
+				if (CycleIndex >= CyclesNum)
+				{
+					Finish();
+					return;
+				}
+
+				FDLCPackageManager& PackageManager = FDLCPackageManager::Get(InstanceName);
+				PackageManager.GetLoadedPaths(SoftObjectPtrs).Next([This = AsShared(), CycleIndex](const TArray<UObject*>& LoadedObjects)
+				{
+					This->FailedLoadsNum += Algo::Count(LoadedObjects, nullptr);
+
+					FDLCPackageManager& PackageManager = FDLCPackageManager::Get(This->InstanceName);
+
+					// Loaded objects are resolved now, so they are acquired without loading
+					for (const FSoftObjectPtr& SoftObjectPtr : This->SoftObjectPtrs)
+					{
+						PackageManager.GetLoadedPath(SoftObjectPtr);
+					}
+
+					PackageManager.ReleaseLoadedPaths(This->SoftObjectPtrs);
+					PackageManager.ReleaseLoadedPaths(This->SoftObjectPtrs);
+
+					CollectGarbageAndCall([This, CycleIndex]() { This->RunCycle(CycleIndex + 1); });
+				});
+			}
+
+			void Finish()
+			{
+				const FDLCPackageManager_Debug::FLogging_Test Logging{ TEXT("AcquireRelease") };
+
+				const FDLCPackageManager_Tests::FState FinalState = FDLCPackageManager_Tests::GetState(FDLCPackageManager::Get(InstanceName));
+				const int64 UsedPhysicalBytesDelta = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical) - static_cast<int64>(InitialUsedPhysicalBytes);
+
+				if (FinalState == InitialState && FailedLoadsNum == 0)
+				{
+					DLC_LOG(Logging, StatusImportant, TEXT("Passed: [%d] cycles of [%d] paths. State: %s. Used physical memory delta [%lld] bytes"),
+						CyclesNum, SoftObjectPtrs.Num(), *FinalState.ToString(), UsedPhysicalBytesDelta);
+				}
+				else
+				{
+					DLC_LOG(Logging, Error, TEXT("Failed: [%d] cycles of [%d] paths, [%d] failed loads. State before: %s, after: %s. Used physical memory delta [%lld] bytes"),
+						CyclesNum, SoftObjectPtrs.Num(), FailedLoadsNum, *InitialState.ToString(), *FinalState.ToString(), UsedPhysicalBytesDelta);
+				}
+			}
+
+			const FName InstanceName;
+			const TArray<FSoftObjectPtr> SoftObjectPtrs;
+			const int32 CyclesNum;
+
+			FDLCPackageManager_Tests::FState InitialState;
+			uint64 InitialUsedPhysicalBytes = 0;
+			int32 FailedLoadsNum = 0;
+		};
+
+		void RunAcquireReleaseTestCommand(const TArray<FString>& Args)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+			const FDLCPackageManager_Debug::FLogging_Test Logging{ TEXT("AcquireRelease") };
+
+			FString InstanceName = FDLCPackageManager::DefaultInstanceName.ToString();
+			FParse::Value(*ParamsString, TEXT("Instance="), InstanceName);
+
+			int32 CyclesNum = 8;
+			FParse::Value(*ParamsString, TEXT("Cycles="), CyclesNum);
+
+			TArray<FSoftObjectPtr> SoftObjectPtrs;
+			if (!LoadTestSoftObjectPaths(ParamsString, SoftObjectPtrs) || CyclesNum <= 0)
+			{
+				DLC_LOG(Logging, Error, TEXT("Cannot read paths file or invalid cycles number [%d]"), CyclesNum);
+				return;
+			}
+
+			MakeShared<FAcquireReleaseTest>(FName{ *InstanceName }, MoveTemp(SoftObjectPtrs), CyclesNum)->Start();
+		}
+
+		FAutoConsoleCommand DLCAcquireReleaseTestCommand(
+			TEXT("DLC.Test.AcquireRelease"),
+			TEXT("Checks that load and release cycles return package manager to its initial state. Usage: DLC.Test.AcquireRelease Instance=<name> PathsFile=<file> [Cycles=<number>]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunAcquireReleaseTestCommand));
+
+		// - - - - - - - - - - - - -
+
+		// Many threads request overlapping paths at once by single and batch loading, wait for results and release them
+		// from the same threads. Calls of other threads are forwarded to the game thread, so every request should succeed
+		// and state of package manager after release and garbage collection should match its state before requests
+		class FCrossThreadStressTest : public TSharedFromThis<FCrossThreadStressTest, ESPMode::ThreadSafe>
+		{
+		public:
+			static constexpr int32 MaxBatchPathsNum = 4;
+
+			FCrossThreadStressTest(const FName& InInstanceName, TArray<FSoftObjectPtr>&& InSoftObjectPtrs, const int32 InThreadsNum, const int32 InRequestsPerThreadNum)
+				: InstanceName(InInstanceName), SoftObjectPtrs(MoveTemp(InSoftObjectPtrs)), ThreadsNum(InThreadsNum), RequestsPerThreadNum(InRequestsPerThreadNum) { }
+
+			void Start()
+			{
+				//NB: Instance is requested from other thread first, so creation of instance off the game thread is tested too
+				// if instance does not exist yet
+				Async(EAsyncExecution::Thread, [This = AsShared()]()
+				{
+					const TArray<FName> NoPackages;
+					FDLCPackageManager::Get(This->InstanceName).PreloadDLCPackages(NoPackages).Next([This](bool)
+					{
+						AsyncTask(ENamedThreads::GameThread, [This]() { This->StartThreads(); });
+					});
+				});
+			}
+
+		private:
+			void StartThreads()
+			{
+				check(IsInGameThread());
+
+				InitialState = FDLCPackageManager_Tests::GetState(FDLCPackageManager::Get(InstanceName));
+				ThreadsLeft = ThreadsNum;
+				StartTime = FPlatformTime::Seconds();
+
+				//NB: Dedicated threads are used, because requesting threads wait for futures fulfilled by the game thread,
+				// and waiting pool threads could block work of package manager that is done by thread pool
+				for (int32 ThreadIndex = 0; ThreadIndex < ThreadsNum; ++ThreadIndex)
+				{
+					Async(EAsyncExecution::Thread, [This = AsShared(), ThreadIndex]() { This->RunThread(ThreadIndex); });
+				}
+			}
+
+			// Not game thread
+			void RunThread(const int32 ThreadIndex)
+			{
+				//NB: Every thread has own copy of paths, so resolving of soft pointers is not shared between threads
+				const TArray<FSoftObjectPtr> ThreadSoftObjectPtrs = SoftObjectPtrs;
+				const int32 PathsNum = ThreadSoftObjectPtrs.Num();
+
+				FDLCPackageManager& PackageManager = FDLCPackageManager::Get(InstanceName);
+
+				// Even requests load single path, odd ones load batch of following paths. Threads start from different paths
+				TArray<TFuture<UObject*>> SingleFutures;
+				TArray<TFuture<TArray<UObject*>>> BatchFutures;
+				TArray<TArray<FSoftObjectPtr>> BatchesSoftObjectPtrs;
+				for (int32 RequestIndex = 0; RequestIndex < RequestsPerThreadNum; ++RequestIndex)
+				{
+					const int32 FirstPathIndex = (ThreadIndex + RequestIndex) % PathsNum;
+					if (RequestIndex % 2 == 0)
+					{
+						SingleFutures.Add(PackageManager.GetLoadedPath(ThreadSoftObjectPtrs[FirstPathIndex]));
+						continue;
+					}
+
+					TArray<FSoftObjectPtr>& BatchSoftObjectPtrs = BatchesSoftObjectPtrs.AddDefaulted_GetRef();
+					for (int32 BatchPathIndex = 0; BatchPathIndex < FMath::Min(MaxBatchPathsNum, PathsNum); ++BatchPathIndex)
+					{
+						BatchSoftObjectPtrs.Add(ThreadSoftObjectPtrs[(FirstPathIndex + BatchPathIndex) % PathsNum]);
+					}
+
+					BatchFutures.Add(PackageManager.GetLoadedPaths(BatchSoftObjectPtrs));
+				}
+
+				int32 ThreadFailedLoadsNum = 0;
+				for (int32 SingleIndex = 0; SingleIndex < SingleFutures.Num(); ++SingleIndex)
+				{
+					ThreadFailedLoadsNum += SingleFutures[SingleIndex].Get() ? 0 : 1;
+					PackageManager.ReleaseLoadedPath(ThreadSoftObjectPtrs[(ThreadIndex + SingleIndex * 2) % PathsNum]);
+				}
+				for (int32 BatchIndex = 0; BatchIndex < BatchFutures.Num(); ++BatchIndex)
+				{
+					ThreadFailedLoadsNum += Algo::Count(BatchFutures[BatchIndex].Get(), nullptr);
+					PackageManager.ReleaseLoadedPaths(BatchesSoftObjectPtrs[BatchIndex]);
+				}
+
+				FailedLoadsNum += ThreadFailedLoadsNum;
+
+				//NB: Releases of this thread are forwarded to the game thread before this task, so they are done before garbage collection
+				if (--ThreadsLeft == 0)
+				{
+					AsyncTask(ENamedThreads::GameThread, [This = AsShared()]()
+					{
+						This->RequestsSeconds = FPlatformTime::Seconds() - This->StartTime;
+						CollectGarbageAndCall([This]() { This->Finish(); });
+					});
+				}
+			}
+
+			void Finish()
+			{
+				const FDLCPackageManager_Debug::FLogging_Test Logging{ TEXT("CrossThreadStress") };
+
+				const FDLCPackageManager_Tests::FState FinalState = FDLCPackageManager_Tests::GetState(FDLCPackageManager::Get(InstanceName));
+				const int32 FinalFailedLoadsNum = FailedLoadsNum;
+
+				if (FinalState == InitialState && FinalFailedLoadsNum == 0)
+				{
+					DLC_LOG(Logging, StatusImportant, TEXT("Passed: [%d] threads with [%d] requests each of [%d] paths in [%.3f] seconds. State: %s"),
+						ThreadsNum, RequestsPerThreadNum, SoftObjectPtrs.Num(), RequestsSeconds, *FinalState.ToString());
+				}
+				else
+				{
+					DLC_LOG(Logging, Error, TEXT("Failed: [%d] threads with [%d] requests each of [%d] paths, [%d] failed loads. State before: %s, after: %s"),
+						ThreadsNum, RequestsPerThreadNum, SoftObjectPtrs.Num(), FinalFailedLoadsNum, *InitialState.ToString(), *FinalState.ToString());
+				}
+			}
+
+			const FName InstanceName;
+			const TArray<FSoftObjectPtr> SoftObjectPtrs;
+			const int32 ThreadsNum;
+			const int32 RequestsPerThreadNum;
+
+			FDLCPackageManager_Tests::FState InitialState;
+			double StartTime = 0.0;
+			double RequestsSeconds = 0.0;
+
+			TAtomic<int32> ThreadsLeft{ 0 };
+			TAtomic<int32> FailedLoadsNum{ 0 };
+		};
+
+		void RunCrossThreadStressTestCommand(const TArray<FString>& Args)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+			const FDLCPackageManager_Debug::FLogging_Test Logging{ TEXT("CrossThreadStress") };
+
+			FString InstanceName = FDLCPackageManager::DefaultInstanceName.ToString();
+			FParse::Value(*ParamsString, TEXT("Instance="), InstanceName);
+
+			int32 ThreadsNum = 8;
+			FParse::Value(*ParamsString, TEXT("Threads="), ThreadsNum);
+
+			int32 RequestsPerThreadNum = 64;
+			FParse::Value(*ParamsString, TEXT("Requests="), RequestsPerThreadNum);
+
+			TArray<FSoftObjectPtr> SoftObjectPtrs;
+			if (!LoadTestSoftObjectPaths(ParamsString, SoftObjectPtrs) || ThreadsNum <= 0 || RequestsPerThreadNum <= 0)
+			{
+				DLC_LOG(Logging, Error, TEXT("Cannot read paths file or invalid threads number [%d] or requests number [%d]"), ThreadsNum, RequestsPerThreadNum);
+				return;
+			}
+
+			MakeShared<FCrossThreadStressTest, ESPMode::ThreadSafe>(FName{ *InstanceName }, MoveTemp(SoftObjectPtrs), ThreadsNum, RequestsPerThreadNum)->Start();
+		}
+
+		FAutoConsoleCommand DLCCrossThreadStressTestCommand(
+			TEXT("DLC.Test.CrossThreadStress"),
+			TEXT("Checks that loads and releases of overlapping paths requested from many threads at once succeed and return package manager to its initial state. Usage: DLC.Test.CrossThreadStress Instance=<name> PathsFile=<file> [Threads=<number>] [Requests=<number per thread>]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunCrossThreadStressTestCommand));
+
+		// - - - - - - - - - - - - -
+
+		// Resumable downloading of file from CDN that drops connections ("ServeCDN" mode of "UDLCPakToolsCommandlet" with "-DropEvery=").
+		// Download is canceled when half of file is on disk and is started again, so it continues from partial file. Failed downloads
+		// are started again too, until restarts are exhausted. Downloaded file should match its local copy, and last download
+		// should not receive bytes that were on disk before cancellation
+		class FResumableDownloadTest : public TSharedFromThis<FResumableDownloadTest>
+		{
+		public:
+			FResumableDownloadTest(const FString& InUrl, const FString& InExpectedFilePath, const int32 InConnectionsNum, const int32 InMaxRestartsNum)
+				: Url(InUrl), ExpectedFilePath(InExpectedFilePath), ConnectionsNum(InConnectionsNum), MaxRestartsNum(InMaxRestartsNum) { }
+
+			void Start()
+			{
+				const FDLCPackageManager_Debug::FLogging_Test Logging{ TEXT("ResumableDownload") };
+
+				if (!FFileHelper::LoadFileToArray(ExpectedData, *ExpectedFilePath) || ExpectedData.Num() == 0)
+				{
+					DLC_LOG(Logging, Error, TEXT("Failed: cannot read expected file [%s]"), *ExpectedFilePath);
+					return;
+				}
+
+				TargetFilePath = FPaths::ProjectSavedDir() / TEXT("DLCTests") / FPaths::GetCleanFilename(ExpectedFilePath);
+
+				IFileManager& FileManager = IFileManager::Get();
+				FileManager.Delete(*TargetFilePath);
+				FileManager.Delete(*FDLCResumableDownload::GetPartFilePath(TargetFilePath));
+				FileManager.Delete(*FDLCResumableDownload::GetStateFilePath(TargetFilePath));
+
+				CancelTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FResumableDownloadTest::CancelAtHalf));
+
+				StartDownload();
+			}
+
+		private:
+			void StartDownload()
+			{
+				FDLCResumableDownload::FParams Params;
+				Params.Urls.Add(Url);
+				Params.TargetFilePath = TargetFilePath;
+				Params.FileVersion = TEXT("ResumableDownloadTest");
+				Params.FileSize = ExpectedData.Num();
+				Params.MaxConnectionsNum = ConnectionsNum;
+
+				Download = MakeShared<FDLCResumableDownload, ESPMode::ThreadSafe>(MoveTemp(Params), [This = AsShared()](const FDLCResumableDownload& FinishedDownload, const bool bSuccess)
+				{
+					This->OnDownloadFinished(FinishedDownload, bSuccess);
+				});
+
+				Download->Start();
+			}
+
+			bool CancelAtHalf(const float)
+			{
+				if (!Download.IsValid() || Download->GetDownloadedBytes() < ExpectedData.Num() / 2)
+					return true;
+
+				bIsCanceled = true;
+				DownloadedBytesAtCancel = Download->GetDownloadedBytes();
+
+				Download->Cancel();
+				return false;
+			}
+
+			void OnDownloadFinished(const FDLCResumableDownload& FinishedDownload, const bool bSuccess)
+			{
+				TotalReceivedBytes += FinishedDownload.GetReceivedBytes();
+
+				if (bSuccess)
+				{
+					Finish(FinishedDownload.GetReceivedBytes());
+					return;
+				}
+
+				if (RestartsNum >= MaxRestartsNum)
+				{
+					Finish(INDEX_NONE);
+					return;
+				}
+
+				++RestartsNum;
+
+				//NB: Finished download is still on the stack, so it is replaced on next tick
+				AsyncTask(ENamedThreads::GameThread, [This = AsShared()]() { This->StartDownload(); });
+			}
+
+			// Received bytes are negative if download failed
+			void Finish(const int64 LastReceivedBytes)
+			{
+				const FDLCPackageManager_Debug::FLogging_Test Logging{ TEXT("ResumableDownload") };
+
+				FTicker::GetCoreTicker().RemoveTicker(CancelTickerHandle);
+
+				TArray<uint8> DownloadedData;
+				const bool bIsDownloaded = LastReceivedBytes >= 0 && FFileHelper::LoadFileToArray(DownloadedData, *TargetFilePath) && DownloadedData == ExpectedData;
+				const bool bIsResumed = !bIsCanceled || LastReceivedBytes <= ExpectedData.Num() - DownloadedBytesAtCancel;
+
+				if (bIsDownloaded && bIsResumed)
+				{
+					DLC_LOG(Logging, StatusImportant, TEXT("Passed: [%d] bytes downloaded by [%d] connections with [%d] restarts, [%lld] bytes received. Canceled at [%lld] bytes, [%lld] bytes received after it"),
+						ExpectedData.Num(), ConnectionsNum, RestartsNum, TotalReceivedBytes, DownloadedBytesAtCancel, LastReceivedBytes);
+				}
+				else
+				{
+					DLC_LOG(Logging, Error, TEXT("Failed: [%d] bytes by [%d] connections with [%d] restarts, [%lld] bytes received. File matches: [%d]. Canceled at [%lld] bytes, [%lld] bytes received after it"),
+						ExpectedData.Num(), ConnectionsNum, RestartsNum, TotalReceivedBytes, bIsDownloaded, DownloadedBytesAtCancel, LastReceivedBytes);
+				}
+
+				IFileManager::Get().Delete(*TargetFilePath);
+			}
+
+			const FString Url;
+			const FString ExpectedFilePath;
+			const int32 ConnectionsNum;
+			const int32 MaxRestartsNum;
+
+			TArray<uint8> ExpectedData;
+			FString TargetFilePath;
+
+			TSharedPtr<FDLCResumableDownload, ESPMode::ThreadSafe> Download;
+			FDelegateHandle CancelTickerHandle;
+
+			bool bIsCanceled = false;
+			int64 DownloadedBytesAtCancel = 0;
+			int32 RestartsNum = 0;
+			int64 TotalReceivedBytes = 0;
+		};
+
+		void RunResumableDownloadTestCommand(const TArray<FString>& Args)
+		{
+			const FString ParamsString = FString::Join(Args, TEXT(" "));
+			const FDLCPackageManager_Debug::FLogging_Test Logging{ TEXT("ResumableDownload") };
+
+			FString Url;
+			FString ExpectedFilePath;
+			if (!FParse::Value(*ParamsString, TEXT("Url="), Url) || !FParse::Value(*ParamsString, TEXT("Expected="), ExpectedFilePath))
+			{
+				DLC_LOG(Logging, Error, TEXT("No Url= or Expected= passed"));
+				return;
+			}
+
+			int32 ConnectionsNum = 4;
+			FParse::Value(*ParamsString, TEXT("Connections="), ConnectionsNum);
+
+			int32 MaxRestartsNum = 16;
+			FParse::Value(*ParamsString, TEXT("Restarts="), MaxRestartsNum);
+
+			MakeShared<FResumableDownloadTest>(Url, ExpectedFilePath, FMath::Max(ConnectionsNum, 1), FMath::Max(MaxRestartsNum, 0))->Start();
+		}
+
+		FAutoConsoleCommand DLCResumableDownloadTestCommand(
+			TEXT("DLC.Test.ResumableDownload"),
+			TEXT("Checks that resumable download of file from CDN with dropped connections is resumed and matches local copy of file. Usage: DLC.Test.ResumableDownload Url=<file url> Expected=<local copy of file> [Connections=<number>] [Restarts=<number>]"),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&RunResumableDownloadTestCommand));
+	}
+}
+
+#endif
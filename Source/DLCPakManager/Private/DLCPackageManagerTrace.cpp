@@ -0,0 +1,7 @@
+#include "DLCPackageManagerTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(DLCPakManagerChannel)
+
+TRACE_DECLARE_INT_COUNTER(DLCChunksInFlight, TEXT("DLC/ChunksInFlight"));
+TRACE_DECLARE_INT_COUNTER(DLCWaitingPromises, TEXT("DLC/WaitingPromises"));
+TRACE_DECLARE_INT_COUNTER(DLCLoadingRequests, TEXT("DLC/LoadingRequests"));
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+// Unreal Insights instrumentation of DLC pipeline. Enabled by "-trace=cpu,bookmark,DLCPakManager" (or "Trace.Enable DLCPakManager"):
+// - CPU scopes of pipeline functions
+// - Start and finish bookmarks of asynchronous stages of every request and chunk: initialization wait, chunk downloading,
+//   verification, mounting and loading. Bookmarks contain request number or package name to follow single load on timeline.
+//   Engines with trace regions ("TRACE_BEGIN_REGION") also show stages as timing regions
+// - Counters of chunks in flight, waiting promises and loading requests
+
+UE_TRACE_CHANNEL_EXTERN(DLCPakManagerChannel)
+
+TRACE_DECLARE_INT_COUNTER_EXTERN(DLCChunksInFlight)
+TRACE_DECLARE_INT_COUNTER_EXTERN(DLCWaitingPromises)
+TRACE_DECLARE_INT_COUNTER_EXTERN(DLCLoadingRequests)
+
+#define DLC_TRACE_CPU_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, DLCPakManagerChannel)
+
+namespace DLCPackageManagerPrivate
+{
+	// Asynchronous stage of request or chunk. Stage may be finished on other thread and in other frame, so it is marked
+	// by bookmarks instead of CPU scope. Name is formatted only when channel is enabled
+	class FDLCTraceRegion
+	{
+	public:
+		template<typename FmtType, typename... Types>
+		void Begin(const FmtType& NameFmt, Types ... NameArgs)
+		{
+			if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(DLCPakManagerChannel))
+				return;
+
+			End();
+
+			Name = FString::Printf(NameFmt, NameArgs ...);
+			TRACE_BOOKMARK(TEXT("%s: started"), *Name);
+#if defined(TRACE_BEGIN_REGION)
+			TRACE_BEGIN_REGION(*Name);
+#endif
+		}
+
+		void End()
+		{
+			if (Name.IsEmpty())
+				return;
+
+			TRACE_BOOKMARK(TEXT("%s: finished"), *Name);
+#if defined(TRACE_END_REGION)
+			TRACE_END_REGION(*Name);
+#endif
+			Name.Reset();
+		}
+
+		~FDLCTraceRegion()
+		{
+			End();
+		}
+
+	private:
+		FString Name;
+	};
+}
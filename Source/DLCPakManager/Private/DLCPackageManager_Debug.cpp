@@ -1,3 +1,18 @@
 #include "DLCPackageManager_Debug.h"
 
 DEFINE_LOG_CATEGORY(LogDLCLoading)
+
+void FDLCPackageManager_Debug::FLogging::PrintFormattedLog(const EPrintType LogType, const FString& Message) const
+{
+	const auto StringToPrint = FString::Printf(TEXT("%s %s: %s"),
+		*GetLogPrefix(), FDLCPackageManager_Debug::GetLogPerfixForLogType(LogType), *Message);
+
+	switch (LogType)
+	{
+		case EPrintType::Status:          { UE_LOG(LogDLCLoading, VeryVerbose, TEXT("%s"), *StringToPrint);  break; };
+		case EPrintType::StatusImportant: { UE_LOG(LogDLCLoading, Verbose, TEXT("%s"), *StringToPrint);      break; };
+		case EPrintType::Warning:         { UE_LOG(LogDLCLoading, Warning, TEXT("%s"), *StringToPrint);      break; };
+		case EPrintType::Error:           { UE_LOG(LogDLCLoading, Error, TEXT("%s"), *StringToPrint);        break; };
+		default: check(false);            { };
+	}
+}
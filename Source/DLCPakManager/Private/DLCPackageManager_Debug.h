@@ -1,11 +1,59 @@
 #pragma once
 
+#include "DLCTraceSink.h"
+
 DECLARE_LOG_CATEGORY_EXTERN(LogDLCLoading, VeryVerbose, All);
 
+// Most detailed print type that is compiled: 0 - errors, 1 - warnings, 2 - important statuses, 3 - all statuses.
+// Print calls of less important types are compiled out together with formatting of their arguments
+#ifndef DLC_LOGGING_COMPILED_LEVEL
+	#if UE_BUILD_SHIPPING
+		#define DLC_LOGGING_COMPILED_LEVEL 1
+	#else
+		#define DLC_LOGGING_COMPILED_LEVEL 3
+	#endif
+#endif
+
+// Prints message of logging object: DLC_LOG(Logging, Warning, TEXT("Format"), Args...).
+// Whole call is dropped if print type is not compiled, and its arguments are evaluated only if print type is enabled
+// for log or trace, so arguments like "*Name.ToString()" cost nothing for suppressed messages
+#define DLC_LOG(Logging, Type, ...) DLC_LOG_##Type(Logging, __VA_ARGS__)
+
+#define DLC_LOG_IMPL(Logging, Type, ...) \
+	do \
+	{ \
+		if (FDLCPackageManager_Debug::IsPrintTypeActive(FDLCPackageManager_Debug::EPrintType::Type)) \
+		{ \
+			(Logging).PrintLog(FDLCPackageManager_Debug::EPrintType::Type, __VA_ARGS__); \
+		} \
+	} while (0)
+
+#define DLC_LOG_COMPILED_OUT(...) do { } while (0)
+
+#define DLC_LOG_Error(Logging, ...) DLC_LOG_IMPL(Logging, Error, __VA_ARGS__)
+
+#if DLC_LOGGING_COMPILED_LEVEL >= 1
+	#define DLC_LOG_Warning(Logging, ...) DLC_LOG_IMPL(Logging, Warning, __VA_ARGS__)
+#else
+	#define DLC_LOG_Warning(Logging, ...) DLC_LOG_COMPILED_OUT()
+#endif
+
+#if DLC_LOGGING_COMPILED_LEVEL >= 2
+	#define DLC_LOG_StatusImportant(Logging, ...) DLC_LOG_IMPL(Logging, StatusImportant, __VA_ARGS__)
+#else
+	#define DLC_LOG_StatusImportant(Logging, ...) DLC_LOG_COMPILED_OUT()
+#endif
+
+#if DLC_LOGGING_COMPILED_LEVEL >= 3
+	#define DLC_LOG_Status(Logging, ...) DLC_LOG_IMPL(Logging, Status, __VA_ARGS__)
+#else
+	#define DLC_LOG_Status(Logging, ...) DLC_LOG_COMPILED_OUT()
+#endif
+
 
 struct FDLCPackageManager_Debug
 {
-	enum class EPrintType
+	enum class EPrintType : uint8
 	{
 		Status,
 		StatusImportant,
@@ -18,37 +66,77 @@ struct FDLCPackageManager_Debug
 		switch (PrintType)
 		{
 			case EPrintType::Status:          return TEXT("status");
-			case EPrintType::StatusImportant: return TEXT("status");
+			case EPrintType::StatusImportant: return TEXT("important status");
 			case EPrintType::Warning:         return TEXT("warning");
 			case EPrintType::Error:           return TEXT("error");
 			default: check(false);            return TEXT("error");
 		}
 	}
 
+	static constexpr int32 GetPrintTypeLevel(const EPrintType PrintType)
+	{
+		return PrintType == EPrintType::Error ? 0 :
+			PrintType == EPrintType::Warning ? 1 :
+			PrintType == EPrintType::StatusImportant ? 2 : 3;
+	}
+
+	static constexpr bool IsPrintTypeCompiled(const EPrintType PrintType)
+	{
+		return GetPrintTypeLevel(PrintType) <= DLC_LOGGING_COMPILED_LEVEL;
+	}
+
+	static bool IsPrintTypeEnabled(const EPrintType PrintType)
+	{
+#if NO_LOGGING
+		return false;
+#else
+		switch (PrintType)
+		{
+			case EPrintType::Status:          return !LogDLCLoading.IsSuppressed(ELogVerbosity::VeryVerbose);
+			case EPrintType::StatusImportant: return !LogDLCLoading.IsSuppressed(ELogVerbosity::Verbose);
+			case EPrintType::Warning:         return !LogDLCLoading.IsSuppressed(ELogVerbosity::Warning);
+			case EPrintType::Error:           return !LogDLCLoading.IsSuppressed(ELogVerbosity::Error);
+			default: check(false);            return true;
+		}
+#endif
+	}
+
+	// Message of print type is either printed to log or recorded to trace
+	static bool IsPrintTypeActive(const EPrintType PrintType)
+	{
+		return IsPrintTypeCompiled(PrintType) && (IsPrintTypeEnabled(PrintType) || DLCPackageManagerPrivate::FDLCTraceSink::IsEnabled());
+	}
+
+	// Prefix is built only for printed messages, so logging objects keep only their context.
+	// Messages are printed by "DLC_LOG()" macro, so arguments of suppressed messages are not evaluated
 	struct FLogging
 	{
 	public:
 		template<typename FmtType, typename... Types>
-		void PrintLog(const EPrintType LogType, const FmtType& MessageFmt, Types ... MessageArgs) const
+		void PrintLog(const EPrintType LogType, const FmtType& MessageFmt, const Types& ... MessageArgs) const
 		{
-			const FString Message = FString::Printf(MessageFmt, MessageArgs ...);
-			const auto StringToPrint = FString::Printf(TEXT("%s %s: %s"),
-				*GetLogPrefix(), FDLCPackageManager_Debug::GetLogPerfixForLogType(LogType), *Message);
+			if (!IsPrintTypeCompiled(LogType))
+				return;
 
-			switch (LogType)
+			if (DLCPackageManagerPrivate::FDLCTraceSink::IsEnabled())
 			{
-				case EPrintType::Status:          { UE_LOG(LogDLCLoading, VeryVerbose, TEXT("%s"), *StringToPrint);  break; };
-				case EPrintType::StatusImportant: { UE_LOG(LogDLCLoading, Verbose, TEXT("%s"), *StringToPrint);      break; };
-				case EPrintType::Warning:         { UE_LOG(LogDLCLoading, Warning, TEXT("%s"), *StringToPrint);      break; };
-				case EPrintType::Error:           { UE_LOG(LogDLCLoading, Error, TEXT("%s"), *StringToPrint);        break; };
-				default: check(false);            { };
+				DLCPackageManagerPrivate::FDLCTraceSink::Record(static_cast<uint8>(LogType), GetTraceContext(), MessageFmt, MessageArgs ...);
 			}
+
+			if (!IsPrintTypeEnabled(LogType))
+				return;
+
+			PrintFormattedLog(LogType, FString::Printf(MessageFmt, MessageArgs ...));
 		}
 
 		virtual ~FLogging() { }
 
 	protected:
 		virtual FString GetLogPrefix() const = 0;
+		virtual DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const = 0;
+
+	private:
+		void PrintFormattedLog(const EPrintType LogType, const FString& Message) const;
 	};
 
 	// - - -
@@ -57,6 +145,25 @@ struct FDLCPackageManager_Debug
 	{
 	protected:
 		FString GetLogPrefix() const override { return TEXT("Initialization"); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Initialization") }; }
+	};
+
+	// - - -
+
+	struct FLogging_ManifestRevalidation : public FLogging
+	{
+	protected:
+		FString GetLogPrefix() const override { return TEXT("Manifest revalidation"); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Manifest revalidation") }; }
+	};
+
+	// - - -
+
+	struct FLogging_CacheEviction : public FLogging
+	{
+	protected:
+		FString GetLogPrefix() const override { return TEXT("Cache eviction"); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Cache eviction") }; }
 	};
 
 	// - - -
@@ -65,13 +172,30 @@ struct FDLCPackageManager_Debug
 	{
 	public:
 		FLogging_Loading(const FSoftObjectPtr& SoftObjectPtr)
-			: Prefix(FString::Printf(TEXT("Loading of object [%s]"), *SoftObjectPtr.ToString())) { }
+			: SoftObjectPath(SoftObjectPtr.ToSoftObjectPath()) { }
 
 	protected:
-		FString GetLogPrefix() const override { return Prefix; }
+		FString GetLogPrefix() const override { return FString::Printf(TEXT("Loading of object [%s]"), *SoftObjectPath.ToString()); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Loading of object"), SoftObjectPath.GetAssetPathName() }; }
 
 	private:
-		const FString Prefix;
+		FSoftObjectPath SoftObjectPath;
+	};
+
+	// - - -
+
+	struct FLogging_BatchLoading : public FLogging
+	{
+	public:
+		FLogging_BatchLoading(const int32 InObjectsNum)
+			: ObjectsNum(InObjectsNum) { }
+
+	protected:
+		FString GetLogPrefix() const override { return FString::Printf(TEXT("Batch loading of [%d] objects"), ObjectsNum); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Batch loading"), NAME_None, ObjectsNum }; }
+
+	private:
+		int32 ObjectsNum;
 	};
 
 	// - - -
@@ -79,13 +203,110 @@ struct FDLCPackageManager_Debug
 	struct FLogging_DLCChunkDownloading : public FLogging
 	{
 	public:
-		FLogging_DLCChunkDownloading(const FString& DLCChunkID)
-			: Prefix(FString::Printf(TEXT("Downloading DLC chunk [%s]"), *DLCChunkID)) { }
+		FLogging_DLCChunkDownloading(const FName& InDLCPackageName)
+			: DLCPackageName(InDLCPackageName) { }
+
+	protected:
+		FString GetLogPrefix() const override { return FString::Printf(TEXT("Downloading DLC chunk [%s]"), *DLCPackageName.ToString()); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Downloading DLC chunk"), DLCPackageName }; }
+
+	private:
+		FName DLCPackageName;
+	};
+
+	// - - -
+
+	struct FLogging_ResumableDownload : public FLogging
+	{
+	public:
+		FLogging_ResumableDownload(const FString& InFilePath)
+			: FilePath(InFilePath) { }
+
+	protected:
+		FString GetLogPrefix() const override { return FString::Printf(TEXT("Resumable download of [%s]"), *FilePath); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Resumable download") }; }
+
+	private:
+		FString FilePath;
+	};
+
+	// - - -
+
+	struct FLogging_PakVerification : public FLogging
+	{
+	public:
+		FLogging_PakVerification(const FString& InPakFileName)
+			: PakFileName(InPakFileName) { }
+
+	protected:
+		FString GetLogPrefix() const override { return FString::Printf(TEXT("Verification of pak file [%s]"), *PakFileName); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Verification of pak file") }; }
+
+	private:
+		FString PakFileName;
+	};
+
+	// - - -
+
+	struct FLogging_DeltaPatch : public FLogging
+	{
+	public:
+		FLogging_DeltaPatch(const FString& InPakFileName)
+			: PakFileName(InPakFileName) { }
+
+	protected:
+		FString GetLogPrefix() const override { return FString::Printf(TEXT("Delta patching of pak file [%s]"), *PakFileName); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Delta patching of pak file") }; }
+
+	private:
+		FString PakFileName;
+	};
+
+	// - - -
+
+	struct FLogging_Benchmark : public FLogging
+	{
+	public:
+		FLogging_Benchmark(const FName& InInstanceName)
+			: InstanceName(InInstanceName) { }
+
+	protected:
+		FString GetLogPrefix() const override { return FString::Printf(TEXT("Benchmark of instance [%s]"), *InstanceName.ToString()); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Benchmark of instance"), InstanceName }; }
+
+	private:
+		FName InstanceName;
+	};
+
+	// - - -
+
+	struct FLogging_Test : public FLogging
+	{
+	public:
+		FLogging_Test(const TCHAR* InTestName)
+			: TestName(InTestName) { }
+
+	protected:
+		FString GetLogPrefix() const override { return FString::Printf(TEXT("Test [%s]"), TestName); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Test") }; }
+
+	private:
+		const TCHAR* TestName;
+	};
+
+	// - - -
+
+	struct FLogging_DLCChunkUnmounting : public FLogging
+	{
+	public:
+		FLogging_DLCChunkUnmounting(const FName& InDLCPackageName)
+			: DLCPackageName(InDLCPackageName) { }
 
 	protected:
-		FString GetLogPrefix() const override { return Prefix; }
+		FString GetLogPrefix() const override { return FString::Printf(TEXT("Unmounting DLC chunk [%s]"), *DLCPackageName.ToString()); }
+		DLCPackageManagerPrivate::FDLCTraceContext GetTraceContext() const override { return { TEXT("Unmounting DLC chunk"), DLCPackageName }; }
 
 	private:
-		const FString Prefix;
+		FName DLCPackageName;
 	};
 };
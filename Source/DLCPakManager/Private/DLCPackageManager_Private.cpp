@@ -1,38 +1,85 @@
 #include "DLCPackageManager_Private.h"
+#include "DLCPackageManager_Debug.h"
+
+#include "Misc/FileHelper.h"
+#include "Misc/SecureHash.h"
 
 const FString FDLCPackageManager_Private::MovedFilePrefix = TEXT(".renamed");
+const FString FDLCPackageManager_Private::ManifestValidatorsFilePostfix = TEXT(".validators");
+const FString FDLCPackageManager_Private::AccessHistoryFileName = TEXT("DLCAccessHistory.txt");
 
-TOptional<FString> FDLCPackageManager_Private::GetDLCChunkId(const FSoftObjectPtr& SoftObjectPtr)
+FDLCPackageManager_Private::FManifestValidators FDLCPackageManager_Private::LoadManifestValidators(const FString& ValidatorsFilePath)
 {
-	const FSoftObjectPath& SoftObjectPath = SoftObjectPtr.ToSoftObjectPath();
+	FManifestValidators Result;
 
-	if (SoftObjectPath.IsNull())
-		return { };
+	// File format: first line is ETag, second line is content hash
+	TArray<FString> Lines;
+	if (FFileHelper::LoadFileToStringArray(Lines, *ValidatorsFilePath) && Lines.Num() == 2)
+	{
+		Result.ETag = MoveTemp(Lines[0]);
+		Result.ContentHash = MoveTemp(Lines[1]);
+	}
 
-	TArray<FString> PathElements;
-	SoftObjectPath.ToString().ParseIntoArray(PathElements, TEXT("/"));
+	return Result;
+}
 
-	// Check path root: is "Game" root and is not last in path
+bool FDLCPackageManager_Private::SaveManifestValidators(const FString& ValidatorsFilePath, const FManifestValidators& Validators)
+{
+	return FFileHelper::SaveStringArrayToFile({ Validators.ETag, Validators.ContentHash }, *ValidatorsFilePath);
+}
 
-	static const FString RootName{ TEXT("Game") };
-	const int32 RootPathElementIndex = PathElements.IndexOfByKey(RootName);
-	if (RootPathElementIndex == INDEX_NONE || (RootPathElementIndex == PathElements.Num() - 1))
-		return { };
+FString FDLCPackageManager_Private::GetManifestFileContentHash(const FString& ManifestFilePath)
+{
+	TArray<uint8> Content;
+	return FFileHelper::LoadFileToArray(Content, *ManifestFilePath, FILEREAD_Silent) ?
+		FMD5::HashBytes(Content.GetData(), Content.Num()) :
+		FString{ };
+}
 
-	// Check if sub-root is DLC root
+TOptional<FStringView> FDLCPackageManager_Private::GetDLCChunkId(const FStringView& ObjectPath)
+{
+	static const FStringView RootName{ TEXT("Game") };
+	static const FStringView DLCSubRootPathElementPrefix{ TEXT("DLC_") };
 
-	const FString& SubRootPathElement = PathElements[RootPathElementIndex + 1];
-	static const FString DLCSubRootPathElementPrefix{ TEXT("DLC_") };
+	bool bIsRootFound = false;
 
-	FString BeforePrefixString;
-	FString AfterPrefixString;
-	SubRootPathElement.Split(DLCSubRootPathElementPrefix, &BeforePrefixString, &AfterPrefixString, ESearchCase::CaseSensitive);
+	FStringView PathRest = ObjectPath;
+	while (!PathRest.IsEmpty())
+	{
+		FStringView PathElement;
 
-	//Check if there is some text before DLC prefix (should be no text)
-	if (!BeforePrefixString.IsEmpty())
-		return { };
+		int32 SeparatorIndex = INDEX_NONE;
+		if (PathRest.FindChar(TEXT('/'), SeparatorIndex))
+		{
+			PathElement = PathRest.Left(SeparatorIndex);
+			PathRest = PathRest.RightChop(SeparatorIndex + 1);
+		}
+		else
+		{
+			PathElement = PathRest;
+			PathRest = FStringView{ };
+		}
+
+		if (PathElement.IsEmpty())
+			continue;
+
+		// Check path root: is "Game" root and is not last in path
 
-	return { MoveTemp(AfterPrefixString) };
+		if (!bIsRootFound)
+		{
+			bIsRootFound = PathElement.Equals(RootName, ESearchCase::IgnoreCase);
+			continue;
+		}
+
+		// Check if sub-root is DLC root folder (should start with DLC prefix and should be followed by other path elements)
+
+		if (PathRest.IsEmpty() || !PathElement.StartsWith(DLCSubRootPathElementPrefix, ESearchCase::CaseSensitive))
+			return { };
+
+		return { PathElement.RightChop(DLCSubRootPathElementPrefix.Len()) };
+	}
+
+	return { };
 }
 
 const FString& FDLCPackageManager_Private::GetDLCChunkIDForPakFileEntry(const FPakFileEntry& PakFileEntry)
@@ -44,15 +91,17 @@ const FString& FDLCPackageManager_Private::GetDLCChunkIDForPakFileEntry(const FP
 // - - - -
 
 TOptional<FDLCPackageManager_Private::FParsedDLCChunkID> FDLCPackageManager_Private::ParseDLCChunkID(
-	const FString& DLCChunkID, const FParseDLCChunkIDSettings& Settings)
+	const FStringView& DLCChunkID, const FParseDLCChunkIDSettings& Settings)
 {
-	FDLCPackageManager::FDLCPackage::FVersionInfo Result;
-
-	static const FString ChunkIdDelimiter{ TEXT("_") };
+	FStringView DLCPackageName = DLCChunkID;
+	FStringView VersionString;
 
-	FString DLCPackageNameString;
-	FString VersionString;
-	DLCChunkID.Split(ChunkIdDelimiter, &DLCPackageNameString, &VersionString, ESearchCase::CaseSensitive);
+	int32 DelimiterIndex = INDEX_NONE;
+	if (DLCChunkID.FindChar(TEXT('_'), DelimiterIndex))
+	{
+		DLCPackageName = DLCChunkID.Left(DelimiterIndex);
+		VersionString = DLCChunkID.RightChop(DelimiterIndex + 1);
+	}
 
 	TOptional<DLCPackageManagerPrivate::FVersion> Version;
 	
@@ -66,6 +115,34 @@ TOptional<FDLCPackageManager_Private::FParsedDLCChunkID> FDLCPackageManager_Priv
 	}
 
 	return Version.IsSet() ?
-		TOptional<FParsedDLCChunkID>{ FParsedDLCChunkID{ DLCPackageNameString, Version.GetValue() } } :
+		TOptional<FParsedDLCChunkID>{ FParsedDLCChunkID{ DLCPackageName, Version.GetValue() } } :
 		TOptional<FParsedDLCChunkID>{ };
 }
+
+TOptional<DLCPackageManagerPrivate::FDLCCatalogEntry> FDLCPackageManager_Private::ParseCatalogEntry(const FStringView& DLCChunkID, const int32 ChunkId)
+{
+	const TOptional<FParsedDLCChunkID> ParsedDLCChunkID = ParseDLCChunkID(DLCChunkID);
+	if (!ParsedDLCChunkID.IsSet() || ParsedDLCChunkID->Name.IsEmpty())
+	{
+		DLC_LOG(FDLCPackageManager_Debug::FLogging_Initialization{ }, Error, TEXT("Package info parse failure. Cannot parse package with DLC chunk id [%s], chunk id [%d]. Version ignored"),
+			*FString{ DLCChunkID }, ChunkId);
+
+		return { };
+	}
+
+	if (!ParsedDLCChunkID->Version.CanBePackedToKey())
+	{
+		DLC_LOG(FDLCPackageManager_Debug::FLogging_Initialization{ }, Error, TEXT("Package info parse failure. Version [%s] of DLC chunk id [%s] is out of supported range. Version ignored"),
+			*ParsedDLCChunkID->Version.ToString(), *FString{ DLCChunkID });
+
+		return { };
+	}
+
+	//NB: Name of known package is found in name table without allocations
+	DLCPackageManagerPrivate::FDLCCatalogEntry Result;
+	Result.PackageName = FName{ ParsedDLCChunkID->Name.Len(), ParsedDLCChunkID->Name.GetData() };
+	Result.VersionKey = ParsedDLCChunkID->Version.ToKey();
+	Result.ChunkId = ChunkId;
+
+	return Result;
+}
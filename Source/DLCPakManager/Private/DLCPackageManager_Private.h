@@ -1,20 +1,50 @@
 #pragma once
 
 #include "Version.h"
+#include "Containers/StringView.h"
 
 struct FPakFileEntry;
 
+namespace DLCPackageManagerPrivate
+{
+	// Version of package placed in pak file. Parsing does not touch package manager state, so it may be done off the game thread
+	struct FDLCCatalogEntry
+	{
+		FName PackageName;
+		FVersion::FKey VersionKey = 0;
+		int32 ChunkId = INDEX_NONE;
+	};
+}
+
 struct FDLCPackageManager_Private
 {
 	static const FString MovedFilePrefix;
+	static const FString ManifestValidatorsFilePostfix;
+	static const FString AccessHistoryFileName;
+	static constexpr int32 AccessHistorySavingInterval = 16;
+	// Attempts of downloading and verification of package chunk before package fails
+	static constexpr int32 MaxPackageDownloadAttemptsNum = 3;
+
+	// Validators of cached build manifest that allow to skip downloading and parsing of unchanged manifest
+	struct FManifestValidators
+	{
+		FString ETag;
+		FString ContentHash;
+	};
 
-	static TOptional<FString> GetDLCChunkId(const FSoftObjectPtr& SoftObjectPtr);
+	static FManifestValidators LoadManifestValidators(const FString& ValidatorsFilePath);
+	static bool SaveManifestValidators(const FString& ValidatorsFilePath, const FManifestValidators& Validators);
+	static FString GetManifestFileContentHash(const FString& ManifestFilePath);
+
+	// Returns view on DLC chunk id part of object path ("/Game/DLC_<Id>/..."). No allocations are made
+	static TOptional<FStringView> GetDLCChunkId(const FStringView& ObjectPath);
 
 	static const FString& GetDLCChunkIDForPakFileEntry(const FPakFileEntry& PakFileEntry);
 
+	// "<Name>[_<Version>]". Name is view on passed DLC chunk id. No allocations are made
 	struct FParsedDLCChunkID
 	{
-		FString Name;
+		FStringView Name;
 		DLCPackageManagerPrivate::FVersion Version;
 	};
 
@@ -23,5 +53,8 @@ struct FDLCPackageManager_Private
 		TOptional<DLCPackageManagerPrivate::FVersion> DefaultVersion = DLCPackageManagerPrivate::FVersion::VersionOne;
 	};
 
-	static TOptional<FParsedDLCChunkID> ParseDLCChunkID(const FString& DLCChunkID, const FParseDLCChunkIDSettings& Settings = {});
+	static TOptional<FParsedDLCChunkID> ParseDLCChunkID(const FStringView& DLCChunkID, const FParseDLCChunkIDSettings& Settings = {});
+
+	// Entries that cannot be parsed are logged and skipped
+	static TOptional<DLCPackageManagerPrivate::FDLCCatalogEntry> ParseCatalogEntry(const FStringView& DLCChunkID, const int32 ChunkId);
 };
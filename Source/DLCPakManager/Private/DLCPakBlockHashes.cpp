@@ -0,0 +1,165 @@
+#include "DLCPakBlockHashes.h"
+#include "DLCPackageManagerTrace.h"
+
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
+#include "HAL/PlatformFilemanager.h"
+
+namespace DLCPackageManagerPrivate
+{
+	const FString FDLCPakBlockHashes::FilePostfix = TEXT(".hash");
+
+	namespace
+	{
+		// Calls "BlockFunction(BlockIndex, BlockData, BlockBytes)" for every block of file in parallel.
+		// Blocks are split into contiguous ranges, so every task reads its range sequentially with single file handle.
+		// Returns false for blocks that cannot be read
+		template<typename BlockFunctionType>
+		TBitArray<> ForEachFileBlockParallel(const FString& FilePath, const int64 BlockSize, const int64 FileSize, const BlockFunctionType& BlockFunction)
+		{
+			const int32 BlocksNum = static_cast<int32>((FileSize + BlockSize - 1) / BlockSize);
+			const int32 TasksNum = FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 1, FMath::Max(BlocksNum, 1));
+
+			TArray<bool> BlocksRead;
+			BlocksRead.SetNumZeroed(BlocksNum);
+
+			ParallelFor(TasksNum, [&](const int32 TaskIndex)
+			{
+				const int32 FirstBlockIndex = static_cast<int64>(BlocksNum) * TaskIndex / TasksNum;
+				const int32 EndBlockIndex = static_cast<int64>(BlocksNum) * (TaskIndex + 1) / TasksNum;
+				if (FirstBlockIndex == EndBlockIndex)
+					return;
+
+				TUniquePtr<IFileHandle> File{ IPlatformFile::GetPlatformPhysical().OpenRead(*FilePath) };
+				if (!File.IsValid() || !File->Seek(FirstBlockIndex * BlockSize))
+					return;
+
+				TArray<uint8> Buffer;
+				Buffer.SetNumUninitialized(BlockSize);
+
+				for (int32 BlockIndex = FirstBlockIndex; BlockIndex < EndBlockIndex; ++BlockIndex)
+				{
+					const int64 BlockBytes = FMath::Min(BlockSize, FileSize - BlockIndex * BlockSize);
+					if (!File->Read(Buffer.GetData(), BlockBytes))
+						return;
+
+					BlockFunction(BlockIndex, Buffer.GetData(), BlockBytes);
+					BlocksRead[BlockIndex] = true;
+				}
+			});
+
+			TBitArray<> Result;
+			for (const bool bBlockRead : BlocksRead)
+				Result.Add(bBlockRead);
+
+			return Result;
+		}
+	}
+
+	int32 FDLCPakBlockHashes::GetBlocksNum() const
+	{
+		return static_cast<int32>((FileSize + BlockSize - 1) / BlockSize);
+	}
+
+	int64 FDLCPakBlockHashes::GetBlockOffset(const int32 BlockIndex) const
+	{
+		return BlockIndex * BlockSize;
+	}
+
+	int64 FDLCPakBlockHashes::GetBlockBytes(const int32 BlockIndex) const
+	{
+		return FMath::Clamp<int64>(FileSize - GetBlockOffset(BlockIndex), 0, BlockSize);
+	}
+
+	TOptional<FDLCPakBlockHashes> FDLCPakBlockHashes::Parse(const FString& Text)
+	{
+		TArray<FString> Lines;
+		Text.ParseIntoArrayLines(Lines);
+
+		FDLCPakBlockHashes Result;
+		if (Lines.Num() < 2 || !FParse::Value(*Lines[0], TEXT("BlockSize="), Result.BlockSize) || !FParse::Value(*Lines[1], TEXT("FileSize="), Result.FileSize))
+			return { };
+
+		if (Result.BlockSize <= 0 || Result.FileSize < 0 || Lines.Num() - 2 != Result.GetBlocksNum())
+			return { };
+
+		Result.BlockHashes.Reserve(Lines.Num() - 2);
+		for (int32 LineIndex = 2; LineIndex < Lines.Num(); ++LineIndex)
+			Result.BlockHashes.Add(FCString::Strtoui64(*Lines[LineIndex], nullptr, 16));
+
+		return Result;
+	}
+
+	FString FDLCPakBlockHashes::ToString() const
+	{
+		FString Result = FString::Printf(TEXT("BlockSize=%lld\nFileSize=%lld\n"), BlockSize, FileSize);
+		for (const uint64 BlockHash : BlockHashes)
+			Result += FString::Printf(TEXT("%016llx\n"), BlockHash);
+
+		return Result;
+	}
+
+	uint64 FDLCPakBlockHashes::HashBlock(const uint8* Data, const int64 Bytes)
+	{
+		return CityHash64(reinterpret_cast<const char*>(Data), static_cast<uint32>(Bytes));
+	}
+
+	TOptional<FDLCPakBlockHashes> FDLCPakBlockHashes::ComputeForFile(const FString& FilePath, const int64 BlockSize)
+	{
+		DLC_TRACE_CPU_SCOPE(DLC_PakBlockHashes_ComputeForFile);
+
+		FDLCPakBlockHashes Result;
+		Result.BlockSize = BlockSize;
+		Result.FileSize = IPlatformFile::GetPlatformPhysical().FileSize(*FilePath);
+		if (Result.FileSize < 0)
+			return { };
+
+		Result.BlockHashes.SetNumZeroed(Result.GetBlocksNum());
+
+		const TBitArray<> BlocksRead = ForEachFileBlockParallel(FilePath, BlockSize, Result.FileSize,
+			[&Result](const int32 BlockIndex, const uint8* BlockData, const int64 BlockBytes)
+			{
+				Result.BlockHashes[BlockIndex] = HashBlock(BlockData, BlockBytes);
+			});
+
+		if (BlocksRead.Find(false) != INDEX_NONE)
+			return { };
+
+		return Result;
+	}
+
+	TArray<int32> FDLCPakBlockHashes::FindCorruptedBlocks(const FString& FilePath) const
+	{
+		DLC_TRACE_CPU_SCOPE(DLC_PakBlockHashes_FindCorruptedBlocks);
+
+		const int32 BlocksNum = GetBlocksNum();
+
+		TArray<bool> BlocksCorruption;
+		BlocksCorruption.SetNumZeroed(BlocksNum);
+
+		const TBitArray<> BlocksRead = ForEachFileBlockParallel(FilePath, BlockSize, FileSize,
+			[this, &BlocksCorruption](const int32 BlockIndex, const uint8* BlockData, const int64 BlockBytes)
+			{
+				BlocksCorruption[BlockIndex] = (HashBlock(BlockData, BlockBytes) != BlockHashes[BlockIndex]);
+			});
+
+		TArray<int32> Result;
+		for (int32 BlockIndex = 0; BlockIndex < BlocksNum; ++BlockIndex)
+		{
+			if (BlocksCorruption[BlockIndex] || !BlocksRead[BlockIndex])
+				Result.Add(BlockIndex);
+		}
+
+		return Result;
+	}
+
+	bool FDLCPakBlockHashes::TruncateToFileSize(const FString& FilePath) const
+	{
+		IPlatformFile& PlatformFile = IPlatformFile::GetPlatformPhysical();
+		if (PlatformFile.FileSize(*FilePath) <= FileSize)
+			return true;
+
+		TUniquePtr<IFileHandle> File{ PlatformFile.OpenWrite(*FilePath, true) };
+		return File.IsValid() && File->Truncate(FileSize);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace DLCPackageManagerPrivate
+{
+	// Hashes of fixed size blocks of pak file. They are published on CDN next to pak file as "<RelativeUrl>.hash"
+	// (see "UDLCPakToolsCommandlet"). File format:
+	//   BlockSize=<bytes>
+	//   FileSize=<bytes>
+	//   <CityHash64 of block in hex>
+	//   ...
+	struct FDLCPakBlockHashes
+	{
+		static constexpr int64 DefaultBlockSize = 1024 * 1024;
+		static const FString FilePostfix;
+
+		int64 BlockSize = DefaultBlockSize;
+		int64 FileSize = 0;
+		TArray<uint64> BlockHashes;
+
+		int32 GetBlocksNum() const;
+		int64 GetBlockOffset(const int32 BlockIndex) const;
+		int64 GetBlockBytes(const int32 BlockIndex) const;
+
+		static TOptional<FDLCPakBlockHashes> Parse(const FString& Text);
+		FString ToString() const;
+
+		static uint64 HashBlock(const uint8* Data, const int64 Bytes);
+
+		// Blocks are hashed in parallel. Blocking call, so it is expected to be made off the game thread
+		static TOptional<FDLCPakBlockHashes> ComputeForFile(const FString& FilePath, const int64 BlockSize = DefaultBlockSize);
+
+		// Indices of blocks of file that do not match hashes. Blocks that cannot be read are corrupted too.
+		// Blocks are hashed in parallel. Blocking call, so it is expected to be made off the game thread
+		TArray<int32> FindCorruptedBlocks(const FString& FilePath) const;
+
+		// Bytes past hashed file size are not covered by hashes, so they are dropped. False if file is longer and cannot be truncated
+		bool TruncateToFileSize(const FString& FilePath) const;
+	};
+}
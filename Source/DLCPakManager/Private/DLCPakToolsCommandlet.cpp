@@ -0,0 +1,587 @@
+#include "DLCPakToolsCommandlet.h"
+#include "DLCPakBlockHashes.h"
+#include "DLCDeltaPatch.h"
+#include "DLCPackageManager_Private.h"
+#include "DLCCatalogSnapshot.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Math/RandomStream.h"
+#include "Containers/Ticker.h"
+
+#if WITH_DLC_PAK_TOOLS
+#include "HttpServerModule.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "IHttpRouter.h"
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogDLCPakTools, Log, All);
+
+UDLCPakToolsCommandlet::UDLCPakToolsCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+#if !WITH_DLC_PAK_TOOLS
+
+int32 UDLCPakToolsCommandlet::Main(const FString& Params)
+{
+	UE_LOG(LogDLCPakTools, Error, TEXT("DLC pak tools are compiled out of shipping builds"));
+	return 1;
+}
+
+#else
+
+namespace
+{
+	// Parses "bytes=<Start>-[<End>]" range. End is inclusive
+	bool ParseByteRange(const FString& RangeHeader, const int64 FileSize, int64& OutStart, int64& OutEnd)
+	{
+		FString Range = RangeHeader;
+		if (!Range.RemoveFromStart(TEXT("bytes=")))
+			return false;
+
+		FString StartString;
+		FString EndString;
+		if (!Range.Split(TEXT("-"), &StartString, &EndString))
+			return false;
+
+		OutStart = FCString::Atoi64(*StartString);
+		OutEnd = EndString.IsEmpty() ? FileSize - 1 : FMath::Min(FCString::Atoi64(*EndString), FileSize - 1);
+
+		return !StartString.IsEmpty() && OutStart >= 0 && OutStart <= OutEnd;
+	}
+
+	bool LoadFileRange(const FString& FilePath, const int64 Offset, const int64 Bytes, TArray<uint8>& OutData)
+	{
+		const TUniquePtr<FArchive> Reader{ IFileManager::Get().CreateFileReader(*FilePath) };
+		if (!Reader.IsValid())
+			return false;
+
+		OutData.SetNumUninitialized(Bytes);
+		Reader->Seek(Offset);
+		Reader->Serialize(OutData.GetData(), Bytes);
+
+		return !Reader->IsError();
+	}
+}
+
+int32 UDLCPakToolsCommandlet::Main(const FString& Params)
+{
+	FString Mode;
+	FParse::Value(*Params, TEXT("Mode="), Mode);
+
+	if (Mode == TEXT("Hash"))
+		return Main_Hash(Params);
+	if (Mode == TEXT("Delta"))
+		return Main_Delta(Params);
+	if (Mode == TEXT("GenerateCDN"))
+		return Main_GenerateCDN(Params);
+	if (Mode == TEXT("Catalog"))
+		return Main_Catalog(Params);
+	if (Mode == TEXT("ServeCDN"))
+		return Main_ServeCDN(Params);
+
+	UE_LOG(LogDLCPakTools, Error, TEXT("Unknown mode [%s]. Supported modes: Hash, Delta, GenerateCDN, Catalog, ServeCDN"), *Mode);
+	return 1;
+}
+
+int32 UDLCPakToolsCommandlet::Main_Hash(const FString& Params)
+{
+	using FDLCPakBlockHashes = DLCPackageManagerPrivate::FDLCPakBlockHashes;
+
+	FString Path;
+	if (!FParse::Value(*Params, TEXT("Path="), Path))
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("No -Path= passed"));
+		return 1;
+	}
+
+	int64 BlockSize = FDLCPakBlockHashes::DefaultBlockSize;
+	FParse::Value(*Params, TEXT("BlockSize="), BlockSize);
+	if (BlockSize <= 0)
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("Invalid block size [%lld]"), BlockSize);
+		return 1;
+	}
+
+	const TArray<FString> PakFilePaths = FindPakFiles(Path);
+	if (PakFilePaths.Num() == 0)
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("No pak files found for [%s]"), *Path);
+		return 1;
+	}
+
+	int64 HashedBytes = 0;
+	double HashingSeconds = 0.0;
+
+	for (const FString& PakFilePath : PakFilePaths)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		const TOptional<FDLCPakBlockHashes> Hashes = FDLCPakBlockHashes::ComputeForFile(PakFilePath, BlockSize);
+		const double PakFileHashingSeconds = FPlatformTime::Seconds() - StartTime;
+
+		if (!Hashes.IsSet())
+		{
+			UE_LOG(LogDLCPakTools, Error, TEXT("Cannot read [%s]"), *PakFilePath);
+			return 1;
+		}
+
+		const FString HashesFilePath = PakFilePath + FDLCPakBlockHashes::FilePostfix;
+		if (!FFileHelper::SaveStringToFile(Hashes->ToString(), *HashesFilePath))
+		{
+			UE_LOG(LogDLCPakTools, Error, TEXT("Cannot write [%s]"), *HashesFilePath);
+			return 1;
+		}
+
+		HashedBytes += Hashes->FileSize;
+		HashingSeconds += PakFileHashingSeconds;
+
+		UE_LOG(LogDLCPakTools, Display, TEXT("[%s]: [%d] blocks, [%.3f] GB/s"), *PakFilePath, Hashes->GetBlocksNum(),
+			PakFileHashingSeconds > 0.0 ? Hashes->FileSize / PakFileHashingSeconds / 1e9 : 0.0);
+	}
+
+	UE_LOG(LogDLCPakTools, Display, TEXT("Hashed [%d] pak files, [%lld] bytes in [%.3f] seconds, [%.3f] GB/s"), PakFilePaths.Num(), HashedBytes, HashingSeconds,
+		HashingSeconds > 0.0 ? HashedBytes / HashingSeconds / 1e9 : 0.0);
+
+	return 0;
+}
+
+int32 UDLCPakToolsCommandlet::Main_Delta(const FString& Params)
+{
+	using FDLCDeltaPatch = DLCPackageManagerPrivate::FDLCDeltaPatch;
+
+	FString BaseFilePath;
+	FString TargetFilePath;
+	if (!FParse::Value(*Params, TEXT("Base="), BaseFilePath) || !FParse::Value(*Params, TEXT("Target="), TargetFilePath))
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("No -Base= or -Target= passed"));
+		return 1;
+	}
+
+	FString OutputFilePath = FPaths::GetPath(TargetFilePath) / FDLCDeltaPatch::GetPatchRelativeUrl(FPaths::GetCleanFilename(TargetFilePath), FPaths::GetCleanFilename(BaseFilePath));
+	FParse::Value(*Params, TEXT("Output="), OutputFilePath);
+
+	int32 BlockSize = FDLCDeltaPatch::DefaultBlockSize;
+	FParse::Value(*Params, TEXT("BlockSize="), BlockSize);
+	if (BlockSize <= 0)
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("Invalid block size [%d]"), BlockSize);
+		return 1;
+	}
+
+	TArray<uint8> BaseData;
+	TArray<uint8> TargetData;
+	if (!FFileHelper::LoadFileToArray(BaseData, *BaseFilePath) || !FFileHelper::LoadFileToArray(TargetData, *TargetFilePath))
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("Cannot read [%s] or [%s]"), *BaseFilePath, *TargetFilePath);
+		return 1;
+	}
+
+	const double CreationStartTime = FPlatformTime::Seconds();
+	const TArray<uint8> Patch = FDLCDeltaPatch::Create(BaseData, TargetData, BlockSize);
+	const double CreationSeconds = FPlatformTime::Seconds() - CreationStartTime;
+
+	if (!FFileHelper::SaveArrayToFile(Patch, *OutputFilePath))
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("Cannot write [%s]"), *OutputFilePath);
+		return 1;
+	}
+
+	// Patch is applied the same way as on client to check it and to measure reconstruction time
+	const FString RebuiltFilePath = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("DLCDelta"), TEXT(".pak"));
+
+	const double ReconstructionStartTime = FPlatformTime::Seconds();
+	const bool bApplied = FDLCDeltaPatch::Apply(BaseFilePath, Patch, RebuiltFilePath, TargetData.Num());
+	const double ReconstructionSeconds = FPlatformTime::Seconds() - ReconstructionStartTime;
+
+	TArray<uint8> RebuiltData;
+	const bool bRebuilt = bApplied && FFileHelper::LoadFileToArray(RebuiltData, *RebuiltFilePath) && RebuiltData == TargetData;
+	IFileManager::Get().Delete(*RebuiltFilePath);
+
+	if (!bRebuilt)
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("Patch [%s] does not rebuild [%s]"), *OutputFilePath, *TargetFilePath);
+		return 1;
+	}
+
+	const int64 SavedBytes = TargetData.Num() - Patch.Num();
+	UE_LOG(LogDLCPakTools, Display, TEXT("[%s]: patch [%d] bytes for target [%d] bytes, saved [%lld] bytes ([%.1f]%%), created in [%.3f] seconds, rebuilt in [%.3f] seconds"),
+		*OutputFilePath, Patch.Num(), TargetData.Num(), SavedBytes, TargetData.Num() > 0 ? 100.0 * SavedBytes / TargetData.Num() : 0.0,
+		CreationSeconds, ReconstructionSeconds);
+
+	return 0;
+}
+
+int32 UDLCPakToolsCommandlet::Main_GenerateCDN(const FString& Params)
+{
+	using FDLCPakBlockHashes = DLCPackageManagerPrivate::FDLCPakBlockHashes;
+
+	FString OutputPath;
+	if (!FParse::Value(*Params, TEXT("Output="), OutputPath))
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("No -Output= passed"));
+		return 1;
+	}
+
+	FString BuildId = TEXT("PatchingDemoKey");
+	FString Platform = ANSI_TO_TCHAR(FPlatformProperties::IniPlatformName());
+	int32 PackagesNum = 8;
+	int32 PakMegabytes = 16;
+	int32 FilesPerPak = 4;
+	int32 Seed = 0;
+	FString UnrealPakPath = FPaths::EngineDir() / TEXT("Binaries") / FPlatformProcess::GetBinariesSubdirectory() / TEXT("UnrealPak") + (PLATFORM_WINDOWS ? TEXT(".exe") : TEXT(""));
+
+	FParse::Value(*Params, TEXT("BuildId="), BuildId);
+	FParse::Value(*Params, TEXT("Platform="), Platform);
+	FParse::Value(*Params, TEXT("Packages="), PackagesNum);
+	FParse::Value(*Params, TEXT("PakMegabytes="), PakMegabytes);
+	FParse::Value(*Params, TEXT("FilesPerPak="), FilesPerPak);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("UnrealPak="), UnrealPakPath);
+
+	if (PackagesNum <= 0 || PakMegabytes <= 0 || FilesPerPak <= 0)
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("Invalid packages number [%d], pak size [%d] MB or files per pak number [%d]"), PackagesNum, PakMegabytes, FilesPerPak);
+		return 1;
+	}
+
+	// CDN layout expected by ChunkDownloader: "<CdnBaseUrl>/<BuildId>/BuildManifest-<Platform>.txt" with pak files
+	// placed by their relative urls
+	const FString BuildFolder = OutputPath / BuildId;
+	const FString SourceFolder = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("DLCBenchmark"));
+
+	//NB: Data is random to make it incompressible, so downloaded bytes match requested pak size. Stream is seeded to keep runs reproducible
+	FRandomStream RandomStream{ Seed };
+	const int64 FileBytes = FMath::Max<int64>(static_cast<int64>(PakMegabytes) * 1024 * 1024 / FilesPerPak, sizeof(uint32));
+
+	FString Manifest = FString::Printf(TEXT("$NUM_ENTRIES = %d\n$BUILD_ID = %s\n"), PackagesNum, *BuildId);
+	FString PackageNames;
+
+	int64 GeneratedBytes = 0;
+
+	for (int32 PackageIndex = 0; PackageIndex < PackagesNum; ++PackageIndex)
+	{
+		const FString PackageName = FString::Printf(TEXT("Bench%d"), PackageIndex);
+		const int32 ChunkId = PackageIndex + 1;
+
+		const FString PakFileName = FString::Printf(TEXT("pakchunk%d-%s.pak"), ChunkId, *Platform);
+		const FString RelativeUrl = TEXT("/") + Platform / PakFileName;
+		const FString PakFilePath = FPaths::ConvertRelativePathToFull(BuildFolder + RelativeUrl);
+
+		FString ResponseFileText;
+
+		for (int32 FileIndex = 0; FileIndex < FilesPerPak; ++FileIndex)
+		{
+			TArray<uint32> Data;
+			Data.SetNumUninitialized(FileBytes / sizeof(uint32));
+			for (uint32& Word : Data)
+			{
+				Word = RandomStream.GetUnsignedInt();
+			}
+
+			const FString SourceFilePath = FPaths::ConvertRelativePathToFull(SourceFolder / PackageName / FString::Printf(TEXT("Data%d.bin"), FileIndex));
+			if (!FFileHelper::SaveArrayToFile(TArrayView<const uint8>{ reinterpret_cast<const uint8*>(Data.GetData()), Data.Num() * static_cast<int32>(sizeof(uint32)) }, *SourceFilePath))
+			{
+				UE_LOG(LogDLCPakTools, Error, TEXT("Cannot write [%s]"), *SourceFilePath);
+				return 1;
+			}
+
+			ResponseFileText += FString::Printf(TEXT("\"%s\" \"../../../%s/Content/DLC_%s/Data%d.bin\"\n"), *SourceFilePath, FApp::GetProjectName(), *PackageName, FileIndex);
+		}
+
+		PackageNames += PackageName + TEXT("\n");
+
+		const FString ResponseFilePath = FPaths::ConvertRelativePathToFull(SourceFolder / PackageName + TEXT(".txt"));
+		if (!FFileHelper::SaveStringToFile(ResponseFileText, *ResponseFilePath))
+		{
+			UE_LOG(LogDLCPakTools, Error, TEXT("Cannot write [%s]"), *ResponseFilePath);
+			return 1;
+		}
+
+		IFileManager::Get().MakeDirectory(*FPaths::GetPath(PakFilePath), true);
+
+		int32 ReturnCode = 0;
+		FString StdOut;
+		FString StdErr;
+		const FString UnrealPakParams = FString::Printf(TEXT("\"%s\" -create=\"%s\""), *PakFilePath, *ResponseFilePath);
+		if (!FPlatformProcess::ExecProcess(*UnrealPakPath, *UnrealPakParams, &ReturnCode, &StdOut, &StdErr) || ReturnCode != 0)
+		{
+			UE_LOG(LogDLCPakTools, Error, TEXT("UnrealPak [%s] failed with code [%d]: %s"), *UnrealPakPath, ReturnCode, *StdErr);
+			return 1;
+		}
+
+		const TOptional<FDLCPakBlockHashes> Hashes = FDLCPakBlockHashes::ComputeForFile(PakFilePath);
+		if (!Hashes.IsSet() || !FFileHelper::SaveStringToFile(Hashes->ToString(), *(PakFilePath + FDLCPakBlockHashes::FilePostfix)))
+		{
+			UE_LOG(LogDLCPakTools, Error, TEXT("Cannot write block hashes of [%s]"), *PakFilePath);
+			return 1;
+		}
+
+		GeneratedBytes += Hashes->FileSize;
+
+		// Version is part of DLC chunk id (see "FDLCPackageManager_Private::ParseDLCChunkID()")
+		Manifest += FString::Printf(TEXT("%s\t%lld\t%s_1.0.0\t%d\t%s\n"), *PakFileName, Hashes->FileSize, *PackageName, ChunkId, *RelativeUrl);
+	}
+
+	IFileManager::Get().DeleteDirectory(*SourceFolder, false, true);
+
+	const FString ManifestFilePath = BuildFolder / FString::Printf(TEXT("BuildManifest-%s.txt"), *Platform);
+	const FString PackageNamesFilePath = OutputPath / TEXT("DLCBenchmarkPackages.txt");
+	if (!FFileHelper::SaveStringToFile(Manifest, *ManifestFilePath) || !FFileHelper::SaveStringToFile(PackageNames, *PackageNamesFilePath))
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("Cannot write [%s] or [%s]"), *ManifestFilePath, *PackageNamesFilePath);
+		return 1;
+	}
+
+	UE_LOG(LogDLCPakTools, Display, TEXT("Generated [%d] packages, [%lld] bytes in [%s]. Package names are written to [%s]"),
+		PackagesNum, GeneratedBytes, *BuildFolder, *PackageNamesFilePath);
+
+	return 0;
+}
+
+int32 UDLCPakToolsCommandlet::Main_Catalog(const FString& Params)
+{
+	using FDLCCatalogEntry = DLCPackageManagerPrivate::FDLCCatalogEntry;
+
+	FString EntriesNumsString = TEXT("10000,100000");
+	int32 VersionsPerPackage = 2;
+	FParse::Value(*Params, TEXT("Entries="), EntriesNumsString, false);
+	FParse::Value(*Params, TEXT("VersionsPerPackage="), VersionsPerPackage);
+
+	TArray<FString> EntriesNumStrings;
+	EntriesNumsString.ParseIntoArray(EntriesNumStrings, TEXT(","));
+
+	if (EntriesNumStrings.Num() == 0 || VersionsPerPackage <= 0)
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("No entries numbers or invalid versions per package number [%d]"), VersionsPerPackage);
+		return 1;
+	}
+
+	for (const FString& EntriesNumString : EntriesNumStrings)
+	{
+		const int32 EntriesNum = FCString::Atoi(*EntriesNumString);
+		if (EntriesNum <= 0)
+		{
+			UE_LOG(LogDLCPakTools, Error, TEXT("Invalid entries number [%s]"), *EntriesNumString);
+			return 1;
+		}
+
+		TArray<FString> DLCChunkIDs;
+		DLCChunkIDs.Reserve(EntriesNum);
+		for (int32 EntryIndex = 0; EntryIndex < EntriesNum; ++EntryIndex)
+		{
+			DLCChunkIDs.Add(FString::Printf(TEXT("Package%d_1.%d.0"), EntryIndex / VersionsPerPackage, EntryIndex % VersionsPerPackage));
+		}
+
+		const double ParsingStartTime = FPlatformTime::Seconds();
+
+		TArray<FDLCCatalogEntry> CatalogEntries;
+		CatalogEntries.Reserve(EntriesNum);
+		for (int32 EntryIndex = 0; EntryIndex < EntriesNum; ++EntryIndex)
+		{
+			TOptional<FDLCCatalogEntry> CatalogEntry = FDLCPackageManager_Private::ParseCatalogEntry(DLCChunkIDs[EntryIndex], EntryIndex);
+			if (CatalogEntry.IsSet())
+			{
+				CatalogEntries.Add(CatalogEntry.GetValue());
+			}
+		}
+
+		const double ParsingSeconds = FPlatformTime::Seconds() - ParsingStartTime;
+
+		//NB: Applying of entries to package manager needs its instance, so it is measured by "DLC.Benchmark.Catalog" console command
+		UE_LOG(LogDLCPakTools, Display, TEXT("[%d] entries: parsed in [%.3f] ms ([%.1f] ns per entry)"),
+			EntriesNum, ParsingSeconds * 1e3, ParsingSeconds * 1e9 / EntriesNum);
+
+		// Snapshot is saved and loaded the same way as by package manager for unchanged manifest
+		const FString SnapshotFilePath = FPaths::ProjectSavedDir() / TEXT("DLCCatalogBenchmark") + DLCPackageManagerPrivate::FDLCCatalogSnapshot::FilePostfix;
+		const FString ManifestHash = FMD5::HashAnsiString(*EntriesNumString);
+
+		if (!DLCPackageManagerPrivate::FDLCCatalogSnapshot::Save(SnapshotFilePath, ManifestHash, EntriesNum, CatalogEntries))
+		{
+			UE_LOG(LogDLCPakTools, Error, TEXT("Cannot save catalog snapshot [%s]"), *SnapshotFilePath);
+			return 1;
+		}
+
+		const double LoadingStartTime = FPlatformTime::Seconds();
+		const TOptional<TArray<FDLCCatalogEntry>> SnapshotCatalogEntries = DLCPackageManagerPrivate::FDLCCatalogSnapshot::Load(SnapshotFilePath, ManifestHash, EntriesNum);
+		const double LoadingSeconds = FPlatformTime::Seconds() - LoadingStartTime;
+
+		const int64 SnapshotBytes = IFileManager::Get().FileSize(*SnapshotFilePath);
+		IFileManager::Get().Delete(*SnapshotFilePath);
+
+		if (!SnapshotCatalogEntries.IsSet() || SnapshotCatalogEntries->Num() != CatalogEntries.Num())
+		{
+			UE_LOG(LogDLCPakTools, Error, TEXT("Loaded catalog snapshot does not match parsed catalog"));
+			return 1;
+		}
+
+		UE_LOG(LogDLCPakTools, Display, TEXT("[%d] entries: snapshot of [%lld] bytes loaded in [%.3f] ms ([%.1f] ns per entry), [%.1f] times faster than parsing"),
+			EntriesNum, SnapshotBytes, LoadingSeconds * 1e3, LoadingSeconds * 1e9 / EntriesNum, LoadingSeconds > 0.0 ? ParsingSeconds / LoadingSeconds : 0.0);
+	}
+
+	return 0;
+}
+
+int32 UDLCPakToolsCommandlet::Main_ServeCDN(const FString& Params)
+{
+	FString RootPath;
+	if (!FParse::Value(*Params, TEXT("Root="), RootPath))
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("No -Root= passed"));
+		return 1;
+	}
+
+	uint32 Port = 8080;
+	FString Route = TEXT("UnrealPatchingCDN");
+	int32 LatencyMs = 0;
+	int32 BandwidthKBps = 0;
+	double DurationSeconds = 0.0;
+	int32 FailEvery = 0;
+	int32 DropEvery = 0;
+
+	FParse::Value(*Params, TEXT("Port="), Port);
+	FParse::Value(*Params, TEXT("Route="), Route);
+	FParse::Value(*Params, TEXT("LatencyMs="), LatencyMs);
+	FParse::Value(*Params, TEXT("BandwidthKBps="), BandwidthKBps);
+	FParse::Value(*Params, TEXT("DurationSeconds="), DurationSeconds);
+	FParse::Value(*Params, TEXT("FailEvery="), FailEvery);
+	FParse::Value(*Params, TEXT("DropEvery="), DropEvery);
+
+	const TSharedPtr<IHttpRouter> Router = FHttpServerModule::Get().GetHttpRouter(Port);
+	if (!Router.IsValid())
+	{
+		UE_LOG(LogDLCPakTools, Error, TEXT("Cannot create HTTP router for port [%u]"), Port);
+		return 1;
+	}
+
+	const FString RoutePath = TEXT("/") + Route;
+
+	// Concurrent transfers share bandwidth: transfer starts when latency passed and previous transfers are finished
+	const TSharedRef<double> LinkFreeTime = MakeShared<double>(0.0);
+	const TSharedRef<int32> PakRequestsNum = MakeShared<int32>(0);
+
+	const FHttpRouteHandle RouteHandle = Router->BindRoute(FHttpPath{ RoutePath }, EHttpServerRequestVerbs::VERB_GET,
+		[RootPath, RoutePath, LatencyMs, BandwidthKBps, FailEvery, DropEvery, LinkFreeTime, PakRequestsNum](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+	{
+		FString RelativePath = Request.RelativePath.GetPath();
+		RelativePath.RemoveFromStart(RoutePath);
+
+		const FString FilePath = RootPath / RelativePath;
+		const int64 FileSize = RelativePath.Contains(TEXT("..")) ? INDEX_NONE : IFileManager::Get().FileSize(*FilePath);
+		if (FileSize < 0)
+		{
+			UE_LOG(LogDLCPakTools, Warning, TEXT("Not found [%s]"), *RelativePath);
+			OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::NotFound));
+			return true;
+		}
+
+		//NB: Only pak file requests fail or drop, so manifests and block hashes are always served
+		const int32 PakRequestNumber = RelativePath.EndsWith(TEXT(".pak")) ? ++(*PakRequestsNum) : 0;
+		if (FailEvery > 0 && PakRequestNumber > 0 && PakRequestNumber % FailEvery == 0)
+		{
+			UE_LOG(LogDLCPakTools, Display, TEXT("Injected failure of [%s]"), *RelativePath);
+			OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::ServerError));
+			return true;
+		}
+
+		int64 RangeStart = 0;
+		int64 RangeEnd = FileSize - 1;
+
+		const TArray<FString>* RangeHeader = Request.Headers.Find(TEXT("Range"));
+		const bool bIsRangeRequest = RangeHeader && RangeHeader->Num() > 0 && ParseByteRange((*RangeHeader)[0], FileSize, RangeStart, RangeEnd);
+
+		TUniquePtr<FHttpServerResponse> Response = MakeUnique<FHttpServerResponse>();
+		if (!LoadFileRange(FilePath, RangeStart, RangeEnd - RangeStart + 1, Response->Body))
+		{
+			OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::ServerError));
+			return true;
+		}
+
+		//NB: Server cannot close connection in the middle of body, so dropped connection is simulated by truncated body.
+		// Headers still describe requested range, so client sees response that is shorter than requested
+		if (DropEvery > 0 && PakRequestNumber > 0 && PakRequestNumber % DropEvery == 0)
+		{
+			UE_LOG(LogDLCPakTools, Display, TEXT("Injected connection drop of [%s] after [%d] of [%d] bytes"), *RelativePath, Response->Body.Num() / 2, Response->Body.Num());
+			Response->Body.SetNum(Response->Body.Num() / 2);
+		}
+
+		Response->Code = bIsRangeRequest ? EHttpServerResponseCodes::PartialContent : EHttpServerResponseCodes::Ok;
+		Response->Headers.Add(TEXT("Content-Type"), { TEXT("application/octet-stream") });
+		Response->Headers.Add(TEXT("Content-Length"), { FString::Printf(TEXT("%d"), Response->Body.Num()) });
+		Response->Headers.Add(TEXT("Accept-Ranges"), { TEXT("bytes") });
+		if (bIsRangeRequest)
+		{
+			Response->Headers.Add(TEXT("Content-Range"), { FString::Printf(TEXT("bytes %lld-%lld/%lld"), RangeStart, RangeEnd, FileSize) });
+		}
+
+		const double CurrentTime = FPlatformTime::Seconds();
+		const double TransferSeconds = BandwidthKBps > 0 ? Response->Body.Num() / (BandwidthKBps * 1024.0) : 0.0;
+		const double TransferStartTime = FMath::Max(CurrentTime + LatencyMs / 1000.0, *LinkFreeTime);
+		*LinkFreeTime = TransferStartTime + TransferSeconds;
+
+		const float ResponseDelay = static_cast<float>(*LinkFreeTime - CurrentTime);
+		if (ResponseDelay <= 0.0f)
+		{
+			OnComplete(MoveTemp(Response));
+			return true;
+		}
+
+		//NB: Response is kept in shared holder because ticker delegate should be copyable
+		const TSharedRef<TUniquePtr<FHttpServerResponse>> ResponseHolder = MakeShared<TUniquePtr<FHttpServerResponse>>(MoveTemp(Response));
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([ResponseHolder, OnComplete](const float)
+		{
+			OnComplete(MoveTemp(*ResponseHolder));
+			return false;
+		}), ResponseDelay);
+
+		return true;
+	});
+
+	FHttpServerModule::Get().StartAllListeners();
+
+	UE_LOG(LogDLCPakTools, Display, TEXT("Serving [%s] as [127.0.0.1:%u%s] with [%d] ms latency, [%d] KB/s bandwidth, failure of every [%d] and drop of every [%d] pak file request (zero is unlimited or none)"),
+		*RootPath, Port, *RoutePath, LatencyMs, BandwidthKBps, FailEvery, DropEvery);
+
+	const double StartTime = FPlatformTime::Seconds();
+	double LastTickTime = StartTime;
+
+	while (!IsEngineExitRequested() && (DurationSeconds <= 0.0 || LastTickTime - StartTime < DurationSeconds))
+	{
+		const double CurrentTime = FPlatformTime::Seconds();
+		FTicker::GetCoreTicker().Tick(static_cast<float>(CurrentTime - LastTickTime));
+		LastTickTime = CurrentTime;
+
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	Router->UnbindRoute(RouteHandle);
+	FHttpServerModule::Get().StopAllListeners();
+
+	return 0;
+}
+
+TArray<FString> UDLCPakToolsCommandlet::FindPakFiles(const FString& Path)
+{
+	TArray<FString> Result;
+
+	if (FPaths::FileExists(Path))
+	{
+		Result.Add(Path);
+	}
+	else if (FPaths::DirectoryExists(Path))
+	{
+		IFileManager::Get().FindFilesRecursive(Result, *Path, TEXT("*.pak"), true, false);
+	}
+
+	return Result;
+}
+
+#endif
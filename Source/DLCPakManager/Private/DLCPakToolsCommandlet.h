@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "DLCPakToolsCommandlet.generated.h"
+
+// Tools for preparing DLC pak files for CDN. Tools are compiled out of shipping builds ("WITH_DLC_PAK_TOOLS").
+// Usage: "<Editor> <Project> -run=DLCPakTools -Mode=<Mode> <Mode params>"
+//   Hash -Path=<pak file or folder> [-BlockSize=<bytes>]
+//     Writes block hashes for pak file verification to "<PakFile>.hash" and reports hashing throughput
+//   Delta -Base=<previous version pak file> -Target=<new version pak file> [-Output=<patch file>] [-BlockSize=<bytes>]
+//     Writes delta patch next to target pak file (see "FDLCDeltaPatch::GetPatchRelativeUrl()"),
+//     checks that patch rebuilds target pak file and reports saved bytes and reconstruction time
+//   GenerateCDN -Output=<CDN folder> [-BuildId=<content build id>] [-Platform=<platform>] [-Packages=<number>]
+//     [-PakMegabytes=<size>] [-FilesPerPak=<number>] [-Seed=<number>] [-UnrealPak=<UnrealPak executable>]
+//     Writes synthetic DLC packages "Bench<N>" of incompressible data with their block hashes and build manifest
+//     for benchmarking (see "DLC.Benchmark" console command). Pak files hold raw data files, not cooked assets, so packages
+//     are benchmarked in download and mount mode: their names are written to "<Output>/DLCBenchmarkPackages.txt"
+//   Catalog [-Entries=<number>[,<number>...]] [-VersionsPerPackage=<number>]
+//     Parses synthetic DLC chunk ids the same way as catalog building of package manager and reports time per entry.
+//     Loading of binary catalog snapshot of same entries is timed too (see "FDLCCatalogSnapshot"). Applying of entries
+//     to package manager is measured in game by "DLC.Benchmark.Catalog" console command (see "FDLCCatalogBenchmark")
+//   ServeCDN -Root=<CDN folder> [-Port=<port>] [-Route=<url path>] [-LatencyMs=<ms>] [-BandwidthKBps=<KB per second>] [-FailEvery=<number>]
+//     [-DropEvery=<number>]
+//     Serves CDN folder over HTTP as "127.0.0.1:<Port>/<Route>" until exit is requested. Responses are delayed
+//     by latency and by transfer time of shared bandwidth. Byte ranges are supported for resumable downloads.
+//     Every "FailEvery"-th pak file request is answered by server error, so retrying of failed downloads is benchmarked
+//     by "DLC.Benchmark": failed packages are reported as failed requests and retries are visible in latencies.
+//     Every "DropEvery"-th pak file response is cut in half as if connection was dropped (see "DLC.Test.ResumableDownload")
+UCLASS()
+class UDLCPakToolsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDLCPakToolsCommandlet();
+
+	int32 Main(const FString& Params) override;
+
+private:
+	int32 Main_Hash(const FString& Params);
+	int32 Main_Delta(const FString& Params);
+	int32 Main_GenerateCDN(const FString& Params);
+	int32 Main_Catalog(const FString& Params);
+	int32 Main_ServeCDN(const FString& Params);
+
+	static TArray<FString> FindPakFiles(const FString& Path);
+};
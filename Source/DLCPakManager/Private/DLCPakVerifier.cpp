@@ -0,0 +1,367 @@
+#include "DLCPakVerifier.h"
+#include "PrivateHacking.h"
+#include "PrivateHacking_ChunkDownloader.h"
+#include "DLCPackageManager_Debug.h"
+
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpResponse.h"
+
+namespace DLCPackageManagerPrivate
+{
+	FDLCPakVerifier::FDLCPakVerifier(const TSharedRef<FChunkDownloader>& InChunkDownloader, FPakFileVerifiedCallback&& InOnPakFileVerified)
+		: ChunkDownloader(InChunkDownloader), OnPakFileVerified(MoveTemp(InOnPakFileVerified))
+	{
+	}
+
+	void FDLCPakVerifier::VerifyChunk(const int32 ChunkId, FCallback&& Callback)
+	{
+		using FPakFile = FHackingType_ChunkDownloader::FPakFile;
+
+		const TSharedRef<FHackingType_ChunkDownloader::FChunk>* Chunk = GetChunkDownloaderHackedAccess().Chunks.Find(ChunkId);
+		if (!Chunk)
+		{
+			Callback(true);
+			return;
+		}
+
+		TArray<FPakFileEntry> EntriesToVerify;
+		for (const TSharedRef<FPakFile>& PakFile : (*Chunk)->PakFiles)
+		{
+			if (PakFile->bIsCached && !PakFile->bIsEmbedded && !PakFile->bIsMounted && !VerifiedPakFiles.Contains(GetVerifiedPakFileKey(PakFile->Entry)))
+				EntriesToVerify.Add(PakFile->Entry);
+		}
+
+		if (EntriesToVerify.Num() == 0)
+		{
+			Callback(true);
+			return;
+		}
+
+		struct FChunkVerification
+		{
+			int32 PendingPakFilesNum = 0;
+			bool bVerified = true;
+			FCallback Callback;
+		};
+
+		const auto ChunkVerification = MakeShared<FChunkVerification>();
+		ChunkVerification->PendingPakFilesNum = EntriesToVerify.Num();
+		ChunkVerification->Callback = MoveTemp(Callback);
+
+		for (const FPakFileEntry& Entry : EntriesToVerify)
+		{
+			VerifyPakFile(Entry, [ChunkVerification](const bool bVerified)
+			{
+				ChunkVerification->bVerified &= bVerified;
+				if (--ChunkVerification->PendingPakFilesNum == 0)
+				{
+					ChunkVerification->Callback(ChunkVerification->bVerified);
+				}
+			});
+		}
+	}
+
+	void FDLCPakVerifier::VerifyPakFile(const FPakFileEntry& Entry, FCallback&& Callback)
+	{
+		const FHackingType_ChunkDownloader& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+
+		const FPakFileVerificationRef Verification = MakeShared<FPakFileVerification, ESPMode::ThreadSafe>();
+		Verification->Entry = Entry;
+		Verification->FilePath = ChunkDownloaderHacked.CacheFolder / Entry.FileName;
+		for (const FString& BuildBaseUrl : ChunkDownloaderHacked.BuildBaseUrls)
+			Verification->Urls.Add(BuildBaseUrl / Entry.RelativeUrl);
+		Verification->Result.PakFileName = Entry.FileName;
+		Verification->Callback = MoveTemp(Callback);
+
+		if (Verification->Urls.Num() == 0)
+		{
+			Finish(Verification, true);
+			return;
+		}
+
+		RequestBlockHashes(Verification);
+	}
+
+	void FDLCPakVerifier::RequestBlockHashes(const FPakFileVerificationRef& Verification)
+	{
+		const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+		Request->SetURL(Verification->Urls[Verification->HashesRequestAttemptIndex % Verification->Urls.Num()] + FDLCPakBlockHashes::FilePostfix);
+		Request->SetVerb(TEXT("GET"));
+
+		Request->OnProcessRequestComplete().BindLambda([WeakThis = FWeakThis{ AsShared() }, Verification](FHttpRequestPtr, FHttpResponsePtr Response, bool bSucceeded)
+		{
+			if (const TSharedPtr<FDLCPakVerifier, ESPMode::ThreadSafe> This = WeakThis.Pin())
+			{
+				This->OnBlockHashesReceived(Verification, Response, bSucceeded);
+			}
+		});
+
+		Request->ProcessRequest();
+	}
+
+	void FDLCPakVerifier::OnBlockHashesReceived(const FPakFileVerificationRef& Verification, FHttpResponsePtr Response, const bool bSucceeded)
+	{
+		FDLCPackageManager_Debug::FLogging_PakVerification Logging{ Verification->Entry.FileName };
+
+		const int32 ResponseCode = (bSucceeded && Response.IsValid()) ? Response->GetResponseCode() : 0;
+
+		if (ResponseCode == EHttpResponseCodes::NotFound)
+		{
+			DLC_LOG(Logging, Status, TEXT("No block hashes are published. Pak file is trusted"));
+
+			Finish(Verification, true);
+			return;
+		}
+
+		if (!EHttpResponseCodes::IsOk(ResponseCode))
+		{
+			//NB: No response, timeouts, throttling and server errors are transient, other errors are not fixed by retrying
+			const bool bIsTransientError = ResponseCode == 0 || ResponseCode == EHttpResponseCodes::RequestTimeout
+				|| ResponseCode == EHttpResponseCodes::TooManyRequests || ResponseCode >= EHttpResponseCodes::ServerError;
+
+			if (!bIsTransientError || ++Verification->HashesRequestAttemptIndex >= MaxHashesRequestAttemptsNum)
+			{
+				DLC_LOG(Logging, Error, TEXT("Block hashes are not received, response code [%d]. Pak file is not verified"), ResponseCode);
+
+				Finish(Verification, false);
+				return;
+			}
+
+			DLC_LOG(Logging, Warning, TEXT("Block hashes are not received, response code [%d]. Request is retried, attempt [%d]"), ResponseCode, Verification->HashesRequestAttemptIndex + 1);
+
+			FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThis = FWeakThis{ AsShared() }, Verification](const float)
+			{
+				if (const TSharedPtr<FDLCPakVerifier, ESPMode::ThreadSafe> This = WeakThis.Pin())
+				{
+					This->RequestBlockHashes(Verification);
+				}
+				return false;
+			}), HashesRequestRetryDelaySeconds * Verification->HashesRequestAttemptIndex);
+			return;
+		}
+
+		TOptional<FDLCPakBlockHashes> Hashes = FDLCPakBlockHashes::Parse(Response->GetContentAsString());
+		if (!Hashes.IsSet() || Hashes->FileSize != static_cast<int64>(Verification->Entry.FileSize))
+		{
+			DLC_LOG(Logging, Error, TEXT("Published block hashes are invalid or made for other file. Pak file is not verified"));
+
+			Finish(Verification, false);
+			return;
+		}
+
+		Verification->Hashes = MoveTemp(Hashes.GetValue());
+
+		FindCorruptedBlocks(Verification);
+	}
+
+	void FDLCPakVerifier::FindCorruptedBlocks(const FPakFileVerificationRef& Verification)
+	{
+		Async(EAsyncExecution::ThreadPool, [WeakThis = FWeakThis{ AsShared() }, Verification]()
+		{
+			//NB: Trailing bytes would pass hashing of published size, but pak file with them has wrong footer.
+			// Shorter file is repaired as its missing blocks cannot be read
+			const bool bIsTruncated = Verification->Hashes.TruncateToFileSize(Verification->FilePath);
+
+			const double StartTime = FPlatformTime::Seconds();
+			TArray<int32> CorruptedBlockIndices = bIsTruncated ? Verification->Hashes.FindCorruptedBlocks(Verification->FilePath) : TArray<int32>{ };
+			const double HashingSeconds = FPlatformTime::Seconds() - StartTime;
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Verification, bIsTruncated, CorruptedBlockIndices = MoveTemp(CorruptedBlockIndices), HashingSeconds]() mutable
+			{
+				const TSharedPtr<FDLCPakVerifier, ESPMode::ThreadSafe> This = WeakThis.Pin();
+				if (!This)
+					return;
+
+				FDLCPackageManager_Debug::FLogging_PakVerification Logging{ Verification->Entry.FileName };
+
+				if (!bIsTruncated)
+				{
+					DLC_LOG(Logging, Error, TEXT("Pak file is longer than [%lld] bytes and cannot be truncated"), Verification->Hashes.FileSize);
+
+					This->Finish(Verification, false);
+					return;
+				}
+
+				Verification->Result.HashedBytes = Verification->Hashes.FileSize;
+				Verification->Result.HashingSeconds = HashingSeconds;
+				Verification->Result.CorruptedBlocksNum = CorruptedBlockIndices.Num();
+
+				DLC_LOG(Logging, Status, TEXT("Hashed [%lld] bytes in [%.3f] seconds, [%d] corrupted blocks"),
+					Verification->Hashes.FileSize, HashingSeconds, CorruptedBlockIndices.Num());
+
+				if (CorruptedBlockIndices.Num() == 0)
+				{
+					This->Finish(Verification, true);
+					return;
+				}
+
+				Verification->CorruptedBlockIndices = MoveTemp(CorruptedBlockIndices);
+				This->RepairNextBlocks(Verification);
+			});
+		});
+	}
+
+	void FDLCPakVerifier::RepairNextBlocks(const FPakFileVerificationRef& Verification)
+	{
+		FDLCPackageManager_Debug::FLogging_PakVerification Logging{ Verification->Entry.FileName };
+
+		TArray<int32>& CorruptedBlockIndices = Verification->CorruptedBlockIndices;
+
+		if (Verification->NextCorruptedBlockIndex >= CorruptedBlockIndices.Num())
+		{
+			if (Verification->StillCorruptedBlockIndices.Num() == 0)
+			{
+				DLC_LOG(Logging, StatusImportant, TEXT("[%d] corrupted blocks are repaired"), Verification->Result.CorruptedBlocksNum);
+
+				Finish(Verification, true);
+				return;
+			}
+
+			if (++Verification->RepairPassIndex >= MaxRepairPassesNum)
+			{
+				DLC_LOG(Logging, Error, TEXT("[%d] blocks cannot be repaired"), Verification->StillCorruptedBlockIndices.Num());
+
+				Finish(Verification, false);
+				return;
+			}
+
+			CorruptedBlockIndices = MoveTemp(Verification->StillCorruptedBlockIndices);
+			Verification->StillCorruptedBlockIndices.Reset();
+			Verification->NextCorruptedBlockIndex = 0;
+		}
+
+		// Adjacent corrupted blocks are requested together
+		const int32 FirstBlockIndex = CorruptedBlockIndices[Verification->NextCorruptedBlockIndex];
+		int32 BlocksNum = 1;
+		while (BlocksNum < MaxBlocksPerRequestNum
+			&& Verification->NextCorruptedBlockIndex + BlocksNum < CorruptedBlockIndices.Num()
+			&& CorruptedBlockIndices[Verification->NextCorruptedBlockIndex + BlocksNum] == FirstBlockIndex + BlocksNum)
+		{
+			++BlocksNum;
+		}
+
+		Verification->NextCorruptedBlockIndex += BlocksNum;
+
+		const FDLCPakBlockHashes& Hashes = Verification->Hashes;
+		const int64 FirstByte = Hashes.GetBlockOffset(FirstBlockIndex);
+		const int64 LastByte = Hashes.GetBlockOffset(FirstBlockIndex + BlocksNum - 1) + Hashes.GetBlockBytes(FirstBlockIndex + BlocksNum - 1) - 1;
+
+		const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+		Request->SetURL(Verification->Urls[Verification->RepairPassIndex % Verification->Urls.Num()]);
+		Request->SetVerb(TEXT("GET"));
+		Request->SetHeader(TEXT("Range"), FString::Printf(TEXT("bytes=%lld-%lld"), FirstByte, LastByte));
+
+		Request->OnProcessRequestComplete().BindLambda([WeakThis = FWeakThis{ AsShared() }, Verification, FirstBlockIndex, BlocksNum](FHttpRequestPtr, FHttpResponsePtr Response, bool bSucceeded)
+		{
+			if (const TSharedPtr<FDLCPakVerifier, ESPMode::ThreadSafe> This = WeakThis.Pin())
+			{
+				This->OnBlocksReceived(Verification, FirstBlockIndex, BlocksNum, Response, bSucceeded);
+			}
+		});
+
+		Request->ProcessRequest();
+	}
+
+	void FDLCPakVerifier::OnBlocksReceived(const FPakFileVerificationRef& Verification, const int32 FirstBlockIndex, const int32 BlocksNum, FHttpResponsePtr Response, const bool bSucceeded)
+	{
+		const FDLCPakBlockHashes& Hashes = Verification->Hashes;
+		const int64 FirstByte = Hashes.GetBlockOffset(FirstBlockIndex);
+
+		const bool bIsValidResponse = bSucceeded && Response.IsValid() && Response->GetResponseCode() == EHttpResponseCodes::PartialContent
+			&& Response->GetHeader(TEXT("Content-Range")).StartsWith(FString::Printf(TEXT("bytes %lld-"), FirstByte));
+
+		if (!bIsValidResponse)
+		{
+			for (int32 BlockIndex = FirstBlockIndex; BlockIndex < FirstBlockIndex + BlocksNum; ++BlockIndex)
+				Verification->StillCorruptedBlockIndices.Add(BlockIndex);
+
+			RepairNextBlocks(Verification);
+			return;
+		}
+
+		Async(EAsyncExecution::ThreadPool, [WeakThis = FWeakThis{ AsShared() }, Verification, FirstBlockIndex, BlocksNum, Response]()
+		{
+			const FDLCPakBlockHashes& Hashes = Verification->Hashes;
+			const TArray<uint8>& Content = Response->GetContent();
+
+			TArray<int32> StillCorruptedBlockIndices;
+
+			TUniquePtr<IFileHandle> PakFile{ IPlatformFile::GetPlatformPhysical().OpenWrite(*Verification->FilePath, true) };
+
+			int64 ContentOffset = 0;
+			for (int32 BlockIndex = FirstBlockIndex; BlockIndex < FirstBlockIndex + BlocksNum; ++BlockIndex)
+			{
+				const int64 BlockBytes = Hashes.GetBlockBytes(BlockIndex);
+
+				//NB: Received block is checked before writing, so valid data on disk is not replaced by other corrupted data
+				const bool bIsBlockReceived = (ContentOffset + BlockBytes <= Content.Num())
+					&& FDLCPakBlockHashes::HashBlock(Content.GetData() + ContentOffset, BlockBytes) == Hashes.BlockHashes[BlockIndex];
+
+				const bool bIsBlockWritten = bIsBlockReceived && PakFile.IsValid()
+					&& PakFile->Seek(Hashes.GetBlockOffset(BlockIndex)) && PakFile->Write(Content.GetData() + ContentOffset, BlockBytes);
+
+				if (!bIsBlockWritten)
+					StillCorruptedBlockIndices.Add(BlockIndex);
+
+				ContentOffset += BlockBytes;
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Verification, StillCorruptedBlockIndices = MoveTemp(StillCorruptedBlockIndices)]()
+			{
+				if (const TSharedPtr<FDLCPakVerifier, ESPMode::ThreadSafe> This = WeakThis.Pin())
+				{
+					Verification->StillCorruptedBlockIndices.Append(StillCorruptedBlockIndices);
+					This->RepairNextBlocks(Verification);
+				}
+			});
+		});
+	}
+
+	void FDLCPakVerifier::Finish(const FPakFileVerificationRef& Verification, const bool bVerified)
+	{
+		using FPakFile = FHackingType_ChunkDownloader::FPakFile;
+
+		Verification->Result.bVerified = bVerified;
+
+		if (bVerified)
+		{
+			VerifiedPakFiles.Add(GetVerifiedPakFileKey(Verification->Entry));
+		}
+		//NB: Pak file is kept if it is not verified because hashes are not received: its blocks are not known to be corrupted
+		else if (Verification->Result.CorruptedBlocksNum > 0)
+		{
+			//NB: Pak file that cannot be repaired is dropped from cache, so it is downloaded again as a whole
+			FHackingType_ChunkDownloader& ChunkDownloaderHacked = GetChunkDownloaderHackedAccess();
+			if (const TSharedRef<FPakFile>* PakFile = ChunkDownloaderHacked.PakFiles.Find(Verification->Entry.FileName))
+			{
+				(*PakFile)->bIsCached = false;
+				(*PakFile)->SizeOnDisk = 0;
+				ChunkDownloaderHacked.SaveLocalManifest();
+			}
+
+			IFileManager::Get().Delete(*Verification->FilePath, false, true, true);
+		}
+
+		if (OnPakFileVerified)
+		{
+			OnPakFileVerified(Verification->Result);
+		}
+
+		FCallback Callback = MoveTemp(Verification->Callback);
+		Callback(bVerified);
+	}
+
+	FString FDLCPakVerifier::GetVerifiedPakFileKey(const FPakFileEntry& Entry)
+	{
+		return Entry.FileName + TEXT("@") + Entry.FileVersion;
+	}
+
+	FHackingType_ChunkDownloader& FDLCPakVerifier::GetChunkDownloaderHackedAccess()
+	{
+		return GetHackedType<FHackingType_ChunkDownloader>(ChunkDownloader.Get());
+	}
+}
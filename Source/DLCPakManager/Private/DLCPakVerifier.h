@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DLCPakBlockHashes.h"
+#include "Interfaces/IHttpRequest.h"
+#include "ChunkDownloader.h"//for FPakFileEntry
+
+namespace DLCPackageManagerPrivate
+{
+	class FHackingType_ChunkDownloader;
+
+	// Checks cached pak files of chunk against block hashes published on CDN ("<RelativeUrl>.hash") before mounting.
+	// Corrupted blocks are downloaded again with range requests. Pak file that cannot be repaired is dropped from cache.
+	// Pak files without published hashes (CDN responds 404) are trusted. Other failures of hashes request are retried and
+	// fail verification if hashes are still not received, so pak file is not mounted unverified. Hashing and writing are done off the game thread.
+	// Verifier is owned by shared pointer: requests and tasks keep only weak pointer to it, so they may finish after its destruction
+	class FDLCPakVerifier : public TSharedFromThis<FDLCPakVerifier, ESPMode::ThreadSafe>
+	{
+	public:
+		using FCallback = TFunction<void(bool bVerified)>;
+
+		struct FPakFileResult
+		{
+			FString PakFileName;
+			int64 HashedBytes = 0;
+			double HashingSeconds = 0.0;
+			int32 CorruptedBlocksNum = 0;
+			bool bVerified = false;
+		};
+		using FPakFileVerifiedCallback = TFunction<void(const FPakFileResult& Result)>;
+
+		// Passes over corrupted blocks. Each pass downloads blocks that are still corrupted
+		static constexpr int32 MaxRepairPassesNum = 3;
+		// Adjacent corrupted blocks are downloaded with single range request
+		static constexpr int32 MaxBlocksPerRequestNum = 8;
+		// Requests of block hashes failed by connection or server errors. Each attempt uses next base url after delay
+		static constexpr int32 MaxHashesRequestAttemptsNum = 3;
+		static constexpr float HashesRequestRetryDelaySeconds = 1.0f;
+
+		FDLCPakVerifier(const TSharedRef<FChunkDownloader>& InChunkDownloader, FPakFileVerifiedCallback&& InOnPakFileVerified);
+
+		// Verifies pak files of chunk that are not verified in this session. Must be called on the game thread
+		void VerifyChunk(const int32 ChunkId, FCallback&& Callback);
+
+	private:
+		struct FPakFileVerification
+		{
+			FPakFileEntry Entry;
+			FString FilePath;
+			TArray<FString> Urls;
+
+			int32 HashesRequestAttemptIndex = 0;
+			FDLCPakBlockHashes Hashes;
+			TArray<int32> CorruptedBlockIndices;
+			int32 RepairPassIndex = 0;
+			int32 NextCorruptedBlockIndex = 0;
+			// Blocks that are not repaired in current pass
+			TArray<int32> StillCorruptedBlockIndices;
+
+			FPakFileResult Result;
+			FCallback Callback;
+		};
+		using FPakFileVerificationRef = TSharedRef<FPakFileVerification, ESPMode::ThreadSafe>;
+		using FWeakThis = TWeakPtr<FDLCPakVerifier, ESPMode::ThreadSafe>;
+
+		void VerifyPakFile(const FPakFileEntry& Entry, FCallback&& Callback);
+		void RequestBlockHashes(const FPakFileVerificationRef& Verification);
+		void OnBlockHashesReceived(const FPakFileVerificationRef& Verification, FHttpResponsePtr Response, const bool bSucceeded);
+		void FindCorruptedBlocks(const FPakFileVerificationRef& Verification);
+
+		void RepairNextBlocks(const FPakFileVerificationRef& Verification);
+		void OnBlocksReceived(const FPakFileVerificationRef& Verification, const int32 FirstBlockIndex, const int32 BlocksNum, FHttpResponsePtr Response, const bool bSucceeded);
+
+		void Finish(const FPakFileVerificationRef& Verification, const bool bVerified);
+
+		static FString GetVerifiedPakFileKey(const FPakFileEntry& Entry);
+		FHackingType_ChunkDownloader& GetChunkDownloaderHackedAccess();
+
+		TSharedRef<FChunkDownloader> ChunkDownloader;
+		FPakFileVerifiedCallback OnPakFileVerified;
+
+		// Pak file names with versions
+		TSet<FString> VerifiedPakFiles;
+	};
+}
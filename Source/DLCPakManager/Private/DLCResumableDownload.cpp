@@ -0,0 +1,458 @@
+#include "DLCResumableDownload.h"
+#include "DLCPackageManager_Debug.h"
+#include "DLCPackageManagerTrace.h"
+
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpResponse.h"
+
+namespace DLCPackageManagerPrivate
+{
+	FDLCResumableDownload::FDLCResumableDownload(FParams&& InParams, FCallback&& InCallback)
+		: Params(MoveTemp(InParams)), Callback(MoveTemp(InCallback))
+	{
+		check(Params.Urls.Num() > 0);
+	}
+
+	void FDLCResumableDownload::Start()
+	{
+		Async(EAsyncExecution::ThreadPool, [This = AsShared()]()
+		{
+			FState VerifiedState = LoadVerifiedState(This->Params);
+
+			//NB: Previous session may be interrupted right after writing of the last segment
+			if (VerifiedState.SegmentCrcs.Num() * SegmentSize >= This->Params.FileSize && !CompletePartialFile(This->Params))
+			{
+				VerifiedState.SegmentCrcs.Reset();
+			}
+
+			if (VerifiedState.SegmentCrcs.Num() * SegmentSize < This->Params.FileSize)
+			{
+				TrimPartialFile(This->Params, VerifiedState);
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [This, VerifiedState = MoveTemp(VerifiedState)]() mutable
+			{
+				This->State = MoveTemp(VerifiedState);
+
+				if (This->State.SegmentCrcs.Num() > 0)
+				{
+					FDLCPackageManager_Debug::FLogging_ResumableDownload Logging{ This->Params.TargetFilePath };
+
+					DLC_LOG(Logging, StatusImportant, TEXT("Resuming from [%lld] of [%lld] bytes"), This->GetDownloadedBytes(), This->Params.FileSize);
+				}
+
+				This->NextSegmentIndex = This->State.SegmentCrcs.Num();
+				This->RequestSegments();
+			});
+		});
+	}
+
+	void FDLCResumableDownload::Cancel()
+	{
+		Fail();
+	}
+
+	int64 FDLCResumableDownload::GetDownloadedBytes() const
+	{
+		return FMath::Min(GetNextSegmentOffset(), Params.FileSize);
+	}
+
+	int64 FDLCResumableDownload::GetProgressBytes() const
+	{
+		int64 Result = GetNextSegmentOffset() + WritingBytes;
+		for (const TPair<int32, FSegmentRequest>& SegmentRequest : SegmentRequests)
+			Result += SegmentRequest.Value.InFlightBytes;
+		for (const TPair<int32, FHttpResponsePtr>& ReceivedSegment : ReceivedSegments)
+			Result += ReceivedSegment.Value->GetContent().Num();
+
+		return FMath::Min(Result, Params.FileSize);
+	}
+
+	bool FDLCResumableDownload::HasPartialFile(const FString& TargetFilePath)
+	{
+		return IFileManager::Get().FileExists(*GetStateFilePath(TargetFilePath));
+	}
+
+	FString FDLCResumableDownload::GetPartFilePath(const FString& TargetFilePath)
+	{
+		return TargetFilePath + TEXT(".part");
+	}
+
+	FString FDLCResumableDownload::GetStateFilePath(const FString& TargetFilePath)
+	{
+		return GetPartFilePath(TargetFilePath) + TEXT(".state");
+	}
+
+	FDLCResumableDownload::FState FDLCResumableDownload::LoadVerifiedState(const FParams& Params)
+	{
+		FState Result;
+
+		// State file format: file version, file size and line per written segment with its CRC32
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *GetStateFilePath(Params.TargetFilePath)))
+			return Result;
+
+		if (Lines.Num() < 2 || Lines[0] != Params.FileVersion || FCString::Atoi64(*Lines[1]) != Params.FileSize)
+			return Result;
+
+		TUniquePtr<IFileHandle> PartFile{ IPlatformFile::GetPlatformPhysical().OpenRead(*GetPartFilePath(Params.TargetFilePath)) };
+		if (!PartFile.IsValid())
+			return Result;
+
+		//NB: Segments are checked before appending, because partial file may be damaged by crash during writing
+		TArray<uint8> Buffer;
+		for (int32 LineIndex = 2; LineIndex < Lines.Num(); ++LineIndex)
+		{
+			const int32 SegmentIndex = LineIndex - 2;
+			const int64 SegmentBytes = GetSegmentBytes(SegmentIndex, Params.FileSize);
+			if (SegmentBytes <= 0)
+				break;
+
+			Buffer.SetNumUninitialized(SegmentBytes);
+			if (!PartFile->Seek(SegmentIndex * SegmentSize) || !PartFile->Read(Buffer.GetData(), SegmentBytes))
+				break;
+
+			const uint32 SavedCrc = static_cast<uint32>(FCString::Strtoui64(*Lines[LineIndex], nullptr, 16));
+			if (FCrc::MemCrc32(Buffer.GetData(), SegmentBytes) != SavedCrc)
+				break;
+
+			Result.SegmentCrcs.Add(SavedCrc);
+		}
+
+		return Result;
+	}
+
+	bool FDLCResumableDownload::SaveState(const FParams& Params, const FState& State)
+	{
+		TArray<FString> Lines;
+		Lines.Reserve(State.SegmentCrcs.Num() + 2);
+		Lines.Add(Params.FileVersion);
+		Lines.Add(LexToString(Params.FileSize));
+		for (const uint32 SegmentCrc : State.SegmentCrcs)
+			Lines.Add(FString::Printf(TEXT("%08x"), SegmentCrc));
+
+		return FFileHelper::SaveStringArrayToFile(Lines, *GetStateFilePath(Params.TargetFilePath));
+	}
+
+	bool FDLCResumableDownload::WriteData(const FParams& Params, FState& State, const TArray<uint8>& Data)
+	{
+		DLC_TRACE_CPU_SCOPE(DLC_ResumableDownload_WriteData);
+
+		const int64 Offset = State.SegmentCrcs.Num() * SegmentSize;
+
+		{
+			//NB: File is opened for appending to keep verified segments. Data is written right after them: unverified tail
+			// was trimmed on start (see "TrimPartialFile()")
+			TUniquePtr<IFileHandle> PartFile{ IPlatformFile::GetPlatformPhysical().OpenWrite(*GetPartFilePath(Params.TargetFilePath), true) };
+			if (!PartFile.IsValid() || !PartFile->Seek(Offset) || !PartFile->Write(Data.GetData(), Data.Num()))
+				return false;
+		}
+
+		int64 DataOffset = 0;
+		while (DataOffset < Data.Num())
+		{
+			const int64 SegmentBytes = FMath::Min<int64>(GetSegmentBytes(State.SegmentCrcs.Num(), Params.FileSize), Data.Num() - DataOffset);
+			State.SegmentCrcs.Add(FCrc::MemCrc32(Data.GetData() + DataOffset, SegmentBytes));
+			DataOffset += SegmentBytes;
+		}
+
+		if (State.SegmentCrcs.Num() * SegmentSize < Params.FileSize)
+			return SaveState(Params, State);
+
+		return CompletePartialFile(Params);
+	}
+
+	void FDLCResumableDownload::TrimPartialFile(const FParams& Params, FState& State)
+	{
+		IPlatformFile& PlatformFile = IPlatformFile::GetPlatformPhysical();
+		const FString PartFilePath = GetPartFilePath(Params.TargetFilePath);
+
+		if (State.SegmentCrcs.Num() > 0)
+		{
+			TUniquePtr<IFileHandle> PartFile{ PlatformFile.OpenWrite(*PartFilePath, true) };
+			if (PartFile.IsValid() && PartFile->Truncate(State.SegmentCrcs.Num() * SegmentSize))
+				return;
+
+			State.SegmentCrcs.Reset();
+		}
+
+		//NB: State file is deleted too, so file without verified segments is not reported as partial one
+		PlatformFile.DeleteFile(*PartFilePath);
+		PlatformFile.DeleteFile(*GetStateFilePath(Params.TargetFilePath));
+	}
+
+	bool FDLCResumableDownload::CompletePartialFile(const FParams& Params)
+	{
+		//NB: Segments are written at their offsets, so data past file size would be kept as trailing garbage
+		if (IPlatformFile::GetPlatformPhysical().FileSize(*GetPartFilePath(Params.TargetFilePath)) != Params.FileSize)
+			return false;
+
+		IFileManager& FileManager = IFileManager::Get();
+		if (!FileManager.Move(*Params.TargetFilePath, *GetPartFilePath(Params.TargetFilePath)))
+			return false;
+
+		FileManager.Delete(*GetStateFilePath(Params.TargetFilePath));
+		return true;
+	}
+
+	void FDLCResumableDownload::RequestSegments()
+	{
+		if (bIsFailing || bIsFinished)
+			return;
+
+		const int32 SegmentsNum = GetSegmentsNum();
+		if (State.SegmentCrcs.Num() >= SegmentsNum)
+		{
+			if (!bIsWriting)
+				Finish(true);
+			return;
+		}
+
+		//NB: Segments are requested ahead of written ones at most by connections number, so segments that wait
+		// in memory for writing of slow previous segment are bounded too
+		const int32 EndSegmentIndex = FMath::Min(SegmentsNum, State.SegmentCrcs.Num() + Params.MaxConnectionsNum);
+		while (NextSegmentIndex < EndSegmentIndex)
+		{
+			RequestSegment(NextSegmentIndex++, 0);
+		}
+	}
+
+	void FDLCResumableDownload::RequestSegment(const int32 SegmentIndex, const int32 AttemptsNum)
+	{
+		const int64 Offset = SegmentIndex * SegmentSize;
+		const int64 LastByte = Offset + GetSegmentBytes(SegmentIndex, Params.FileSize) - 1;
+
+		//NB: Concurrent segments start from different urls, so mirrors share the load
+		LastUrl = Params.Urls[(SegmentIndex + AttemptsNum) % Params.Urls.Num()];
+
+		const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+		Request->SetURL(LastUrl);
+		Request->SetVerb(TEXT("GET"));
+		Request->SetHeader(TEXT("Range"), FString::Printf(TEXT("bytes=%lld-%lld"), Offset, LastByte));
+		Request->OnProcessRequestComplete().BindLambda([This = AsShared(), SegmentIndex](FHttpRequestPtr, FHttpResponsePtr Response, bool bSucceeded)
+		{
+			This->OnSegmentResponse(SegmentIndex, Response, bSucceeded);
+		});
+		Request->OnRequestProgress().BindLambda([WeakThis = TWeakPtr<FDLCResumableDownload, ESPMode::ThreadSafe>{ AsShared() }, SegmentIndex](FHttpRequestPtr, int32, int32 BytesReceived)
+		{
+			if (const TSharedPtr<FDLCResumableDownload, ESPMode::ThreadSafe> This = WeakThis.Pin())
+			{
+				if (FSegmentRequest* SegmentRequest = This->SegmentRequests.Find(SegmentIndex))
+					SegmentRequest->InFlightBytes = BytesReceived;
+			}
+		});
+
+		FSegmentRequest& SegmentRequest = SegmentRequests.Add(SegmentIndex);
+		SegmentRequest.HttpRequest = Request;
+		SegmentRequest.AttemptsNum = AttemptsNum;
+
+		Request->ProcessRequest();
+	}
+
+	void FDLCResumableDownload::OnSegmentResponse(const int32 SegmentIndex, FHttpResponsePtr Response, const bool bSucceeded)
+	{
+		//NB: Responses of canceled requests are ignored
+		const FSegmentRequest* SegmentRequest = SegmentRequests.Find(SegmentIndex);
+		if (!SegmentRequest || bIsFailing || bIsFinished)
+			return;
+
+		FDLCPackageManager_Debug::FLogging_ResumableDownload Logging{ Params.TargetFilePath };
+
+		const FString Url = SegmentRequest->HttpRequest->GetURL();
+		LastUrl = Url;
+
+		if (!bSucceeded || !Response.IsValid())
+		{
+			DLC_LOG(Logging, Warning, TEXT("Request of segment [%d] to [%s] failed"), SegmentIndex, *Url);
+
+			RetrySegmentOrFail(SegmentIndex);
+			return;
+		}
+
+		LastHttpStatus = Response->GetResponseCode();
+
+		const int64 Offset = SegmentIndex * SegmentSize;
+		const int64 ExpectedBytes = GetSegmentBytes(SegmentIndex, Params.FileSize);
+		const TArray<uint8>& Content = Response->GetContent();
+
+		if (LastHttpStatus == EHttpResponseCodes::PartialContent)
+		{
+			const FString ExpectedContentRangePrefix = FString::Printf(TEXT("bytes %lld-"), Offset);
+			if (Content.Num() == ExpectedBytes && Response->GetHeader(TEXT("Content-Range")).StartsWith(ExpectedContentRangePrefix))
+			{
+				ReceivedBytes += Content.Num();
+
+				SegmentRequests.Remove(SegmentIndex);
+				ReceivedSegments.Add(SegmentIndex, Response);
+
+				WriteReceivedSegments();
+				RequestSegments();
+				return;
+			}
+		}
+		else if (LastHttpStatus == EHttpResponseCodes::Ok && Content.Num() == Params.FileSize)
+		{
+			//NB: Server without range requests support sends whole file. It replaces partial data, so other segments are not needed
+			DLC_LOG(Logging, Warning, TEXT("Range requests are not supported by [%s]. Whole file is received"), *Url);
+
+			ReceivedBytes += Content.Num();
+
+			TMap<int32, FSegmentRequest> CanceledRequests = MoveTemp(SegmentRequests);
+			SegmentRequests.Reset();
+			for (const TPair<int32, FSegmentRequest>& CanceledRequest : CanceledRequests)
+				CanceledRequest.Value.HttpRequest->CancelRequest();
+
+			ReceivedSegments.Reset();
+			WholeFileResponse = Response;
+			NextSegmentIndex = GetSegmentsNum();
+
+			WriteReceivedSegments();
+			return;
+		}
+
+		DLC_LOG(Logging, Warning, TEXT("Unexpected response [%d] with [%d] bytes for offset [%lld] from [%s]"),
+			LastHttpStatus, Content.Num(), Offset, *Url);
+
+		RetrySegmentOrFail(SegmentIndex);
+	}
+
+	void FDLCResumableDownload::RetrySegmentOrFail(const int32 SegmentIndex)
+	{
+		const int32 AttemptsNum = SegmentRequests.FindAndRemoveChecked(SegmentIndex).AttemptsNum + 1;
+		if (AttemptsNum < MaxSegmentAttemptsNum)
+		{
+			RequestSegment(SegmentIndex, AttemptsNum);
+			return;
+		}
+
+		Fail();
+	}
+
+	void FDLCResumableDownload::WriteReceivedSegments()
+	{
+		if (bIsWriting || bIsFailing || bIsFinished)
+			return;
+
+		//NB: Whole file is written from the start, over verified segments
+		const bool bIsWholeFile = WholeFileResponse.IsValid();
+
+		TArray<FHttpResponsePtr> Responses;
+		if (bIsWholeFile)
+		{
+			Responses.Add(MoveTemp(WholeFileResponse));
+			WholeFileResponse.Reset();
+		}
+		else
+		{
+			FHttpResponsePtr Response;
+			for (int32 SegmentIndex = State.SegmentCrcs.Num(); ReceivedSegments.RemoveAndCopyValue(SegmentIndex, Response); ++SegmentIndex)
+				Responses.Add(MoveTemp(Response));
+		}
+
+		if (Responses.Num() == 0)
+			return;
+
+		bIsWriting = true;
+		WritingBytes = 0;
+		for (const FHttpResponsePtr& Response : Responses)
+			WritingBytes += Response->GetContent().Num();
+
+		//NB: Responses keep content, so they are passed to worker instead of content copies
+		Async(EAsyncExecution::ThreadPool, [This = AsShared(), Responses = MoveTemp(Responses), State = bIsWholeFile ? FState{} : State]() mutable
+		{
+			bool bWritten = true;
+			for (const FHttpResponsePtr& Response : Responses)
+			{
+				bWritten = WriteData(This->Params, State, Response->GetContent());
+				if (!bWritten)
+					break;
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [This, bWritten, State = MoveTemp(State)]() mutable
+			{
+				This->bIsWriting = false;
+				This->WritingBytes = 0;
+
+				if (This->bIsFailing)
+				{
+					This->Finish(false);
+					return;
+				}
+
+				if (!bWritten)
+				{
+					FDLCPackageManager_Debug::FLogging_ResumableDownload Logging{ This->Params.TargetFilePath };
+
+					DLC_LOG(Logging, Error, TEXT("Cannot write downloaded data"));
+
+					This->Fail();
+					return;
+				}
+
+				This->State = MoveTemp(State);
+
+				This->WriteReceivedSegments();
+				This->RequestSegments();
+			});
+		});
+	}
+
+	void FDLCResumableDownload::Fail()
+	{
+		if (bIsFailing || bIsFinished)
+			return;
+
+		bIsFailing = true;
+
+		//NB: Map is moved out first, because canceled request may call its completion right away
+		TMap<int32, FSegmentRequest> CanceledRequests = MoveTemp(SegmentRequests);
+		SegmentRequests.Reset();
+		for (const TPair<int32, FSegmentRequest>& CanceledRequest : CanceledRequests)
+			CanceledRequest.Value.HttpRequest->CancelRequest();
+
+		ReceivedSegments.Reset();
+		WholeFileResponse.Reset();
+
+		if (!bIsWriting)
+			Finish(false);
+	}
+
+	void FDLCResumableDownload::Finish(const bool bSuccess)
+	{
+		if (bIsFinished)
+			return;
+
+		bIsFinished = true;
+
+		FDLCPackageManager_Debug::FLogging_ResumableDownload Logging{ Params.TargetFilePath };
+
+		if (bSuccess)
+			DLC_LOG(Logging, Status, TEXT("Finished"));
+		else
+			DLC_LOG(Logging, Warning, TEXT("Failed at [%lld] of [%lld] bytes. Partial file is kept for resuming"), GetDownloadedBytes(), Params.FileSize);
+
+		FCallback FinishedCallback = MoveTemp(Callback);
+		FinishedCallback(*this, bSuccess);
+	}
+
+	int64 FDLCResumableDownload::GetSegmentBytes(const int32 SegmentIndex, const int64 FileSize)
+	{
+		const int64 SegmentOffset = SegmentIndex * SegmentSize;
+		return FMath::Clamp<int64>(FileSize - SegmentOffset, 0, SegmentSize);
+	}
+
+	int64 FDLCResumableDownload::GetNextSegmentOffset() const
+	{
+		return State.SegmentCrcs.Num() * SegmentSize;
+	}
+
+	int32 FDLCResumableDownload::GetSegmentsNum() const
+	{
+		return static_cast<int32>((Params.FileSize + SegmentSize - 1) / SegmentSize);
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+
+namespace DLCPackageManagerPrivate
+{
+	// Downloads file with HTTP range requests of fixed size segments. Segments are written to "<File>.part" and their
+	// checksums are saved to "<File>.part.state", so interrupted download (including one of previous session) continues
+	// from the last segment that is verified on disk. Complete file is moved to target path.
+	// Up to "MaxConnectionsNum" segments are requested at once. Segments received out of order are kept in memory until
+	// previous ones are written, so partial file is always written from its start.
+	// Must be started on the game thread. File I/O is done off the game thread
+	class FDLCResumableDownload : public TSharedFromThis<FDLCResumableDownload, ESPMode::ThreadSafe>
+	{
+	public:
+		using FCallback = TFunction<void(const FDLCResumableDownload& Download, bool bSuccess)>;
+
+		static constexpr int64 SegmentSize = 8 * 1024 * 1024;
+		// Attempts of single segment. Each attempt uses next url
+		static constexpr int32 MaxSegmentAttemptsNum = 4;
+
+		struct FParams
+		{
+			TArray<FString> Urls;
+			FString TargetFilePath;
+
+			// Partial file of other version is not resumed
+			FString FileVersion;
+			int64 FileSize = 0;
+
+			// Segments in flight. Segments ahead of written ones are limited by it too, so it bounds memory of received segments
+			int32 MaxConnectionsNum = 1;
+		};
+
+		FDLCResumableDownload(FParams&& InParams, FCallback&& InCallback);
+
+		void Start();
+		// Callback is called as for failed download, partial file is kept for resuming. Game thread only
+		void Cancel();
+
+		// Bytes on disk that are verified or written in this session
+		int64 GetDownloadedBytes() const;
+		// Bytes on disk and bytes of segments that are being received or written. Game thread only
+		int64 GetProgressBytes() const;
+		// Bytes received in this session
+		int64 GetReceivedBytes() const { return ReceivedBytes; }
+		int32 GetLastHttpStatus() const { return LastHttpStatus; }
+		const FString& GetLastUrl() const { return LastUrl; }
+
+		static bool HasPartialFile(const FString& TargetFilePath);
+		static FString GetPartFilePath(const FString& TargetFilePath);
+		static FString GetStateFilePath(const FString& TargetFilePath);
+
+	private:
+		// Checksums of segments written to partial file, from its start
+		struct FState
+		{
+			TArray<uint32> SegmentCrcs;
+		};
+
+		// - - - Worker thread - - -
+
+		static FState LoadVerifiedState(const FParams& Params);
+		static bool SaveState(const FParams& Params, const FState& State);
+		static bool WriteData(const FParams& Params, FState& State, const TArray<uint8>& Data);
+		// Drops partial file data after verified segments, so tail of other file version is not kept. Partial file
+		// is deleted if it has no verified segments or cannot be truncated
+		static void TrimPartialFile(const FParams& Params, FState& State);
+		// Moves complete partial file to target path. Partial file of other size is not moved
+		static bool CompletePartialFile(const FParams& Params);
+
+		// - - - Game thread - - -
+
+		struct FSegmentRequest
+		{
+			TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> HttpRequest;
+			int32 AttemptsNum = 0;
+			// Reported by progress of request
+			int64 InFlightBytes = 0;
+		};
+
+		// Requests segments up to connections limit. Finishes download when all segments are written
+		void RequestSegments();
+		void RequestSegment(const int32 SegmentIndex, const int32 AttemptsNum);
+		void OnSegmentResponse(const int32 SegmentIndex, FHttpResponsePtr Response, const bool bSucceeded);
+		void RetrySegmentOrFail(const int32 SegmentIndex);
+		// Writes received segments that follow written ones. Single write is in flight
+		void WriteReceivedSegments();
+		// Cancels requests in flight. Callback is called after write in flight, so failed file may be downloaded again right away
+		void Fail();
+		void Finish(const bool bSuccess);
+
+		static int64 GetSegmentBytes(const int32 SegmentIndex, const int64 FileSize);
+		int64 GetNextSegmentOffset() const;
+		int32 GetSegmentsNum() const;
+
+		const FParams Params;
+		FCallback Callback;
+
+		FState State;
+		// Next segment that was not requested yet
+		int32 NextSegmentIndex = 0;
+		TMap<int32, FSegmentRequest> SegmentRequests;
+		// Received segments that wait for writing of previous ones, by segment index
+		TMap<int32, FHttpResponsePtr> ReceivedSegments;
+		// Response of server without range requests support. It replaces partial data
+		FHttpResponsePtr WholeFileResponse;
+
+		bool bIsWriting = false;
+		int64 WritingBytes = 0;
+		bool bIsFailing = false;
+		bool bIsFinished = false;
+
+		int64 ReceivedBytes = 0;
+		int32 LastHttpStatus = 0;
+		FString LastUrl;
+	};
+}
@@ -0,0 +1,88 @@
+#include "DLCTraceSink.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+namespace DLCPackageManagerPrivate
+{
+	namespace
+	{
+		TAutoConsoleVariable<int32> CVarDLCTraceEnabled(
+			TEXT("DLC.Trace.Enabled"),
+			0,
+			TEXT("Records DLC logging to binary trace without formatting. Trace is printed by \\"DLC.Trace.Dump\\""));
+
+		FAutoConsoleCommandWithOutputDevice DLCTraceDumpCommand(
+			TEXT("DLC.Trace.Dump"),
+			TEXT("Prints binary trace of DLC logging"),
+			FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&FDLCTraceSink::Dump));
+
+		FCriticalSection RecordsMutex;
+		//NB: Ring buffer is allocated by first record, so builds where trace is never enabled do not keep it
+		TArray<FDLCTraceSink::FRecord> Records;
+		uint64 NextRecordIndex = 0;
+	}
+
+	bool FDLCTraceSink::IsEnabled()
+	{
+		return CVarDLCTraceEnabled.GetValueOnAnyThread() != 0;
+	}
+
+	void FDLCTraceSink::WriteRecord(const FRecord& NewRecord)
+	{
+		FScopeLock Lock{ &RecordsMutex };
+
+		if (Records.Num() == 0)
+		{
+			Records.SetNum(MaxRecordsNum);
+		}
+
+		Records[NextRecordIndex % MaxRecordsNum] = NewRecord;
+		++NextRecordIndex;
+	}
+
+	void FDLCTraceSink::Dump(FOutputDevice& Output)
+	{
+		//NB: Records are copied under lock and formatted without it, so logging threads are not blocked by printing
+		TArray<FRecord> DumpedRecords;
+		{
+			FScopeLock Lock{ &RecordsMutex };
+
+			const uint64 EndIndex = NextRecordIndex;
+			const uint64 StartIndex = (EndIndex > MaxRecordsNum) ? (EndIndex - MaxRecordsNum) : 0;
+
+			DumpedRecords.Reserve(static_cast<int32>(EndIndex - StartIndex));
+			for (uint64 RecordIndex = StartIndex; RecordIndex < EndIndex; ++RecordIndex)
+				DumpedRecords.Add(Records[RecordIndex % MaxRecordsNum]);
+		}
+
+		const TCHAR* PrintTypeNames[] = { TEXT("status"), TEXT("important status"), TEXT("warning"), TEXT("error") };
+
+		for (const FRecord& Record : DumpedRecords)
+		{
+			FString ArgsString;
+			for (int32 ArgIndex = 0; ArgIndex < MaxArgsNum; ++ArgIndex)
+			{
+				switch (Record.ArgTypes[ArgIndex])
+				{
+					case EArgType::Int:   ArgsString += FString::Printf(TEXT(" %lld"), static_cast<int64>(Record.Args[ArgIndex])); break;
+					case EArgType::UInt:  ArgsString += FString::Printf(TEXT(" %llu"), Record.Args[ArgIndex]);                      break;
+					case EArgType::Float:
+					{
+						double Value = 0.0;
+						FMemory::Memcpy(&Value, &Record.Args[ArgIndex], sizeof(double));
+						ArgsString += FString::Printf(TEXT(" %f"), Value);
+						break;
+					}
+					default: break;
+				}
+			}
+
+			Output.Logf(TEXT("[%.6f] thread [%u] %s [%s] [%lld] %s: %s |%s"),
+				FPlatformTime::ToSeconds64(Record.Cycles), Record.ThreadId,
+				Record.Context.Kind ? Record.Context.Kind : TEXT(""), *Record.Context.Name.ToString(), Record.Context.Value,
+				PrintTypeNames[FMath::Min<int32>(Record.PrintType, UE_ARRAY_COUNT(PrintTypeNames) - 1)],
+				Record.Format ? Record.Format : TEXT(""), *ArgsString);
+		}
+	}
+}
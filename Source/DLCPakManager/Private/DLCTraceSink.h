@@ -0,0 +1,106 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace DLCPackageManagerPrivate
+{
+	// Context of logging object, kept by trace records instead of formatted prefix
+	struct FDLCTraceContext
+	{
+		// Static string
+		const TCHAR* Kind = nullptr;
+		FName Name;
+		int64 Value = 0;
+	};
+
+	// Binary trace of DLC logging. Records keep format strings, contexts and numeric arguments without any formatting,
+	// so trace may be enabled when logs are suppressed. Records are kept in ring buffer of latest "MaxRecordsNum" records,
+	// that is allocated when trace is enabled and first record is made.
+	// Enabled by "DLC.Trace.Enabled 1" console variable, printed to log by "DLC.Trace.Dump" console command
+	class FDLCTraceSink
+	{
+	public:
+		static constexpr int32 MaxRecordsNum = 16 * 1024;
+		static constexpr int32 MaxArgsNum = 4;
+
+		enum class EArgType : uint8
+		{
+			None,
+			Int,
+			UInt,
+			Float
+		};
+
+		struct FRecord
+		{
+			uint64 Cycles = 0;
+			uint32 ThreadId = 0;
+			uint8 PrintType = 0;
+			FDLCTraceContext Context;
+
+			// Literal passed to logging
+			const TCHAR* Format = nullptr;
+
+			EArgType ArgTypes[MaxArgsNum] = { };
+			uint64 Args[MaxArgsNum] = { };
+		};
+
+		static bool IsEnabled();
+
+		template<typename... Types>
+		static void Record(const uint8 PrintType, const FDLCTraceContext& Context, const TCHAR* Format, const Types& ... Args)
+		{
+			FRecord NewRecord;
+			NewRecord.Cycles = FPlatformTime::Cycles64();
+			NewRecord.ThreadId = FPlatformTLS::GetCurrentThreadId();
+			NewRecord.PrintType = PrintType;
+			NewRecord.Context = Context;
+			NewRecord.Format = Format;
+
+			int32 ArgIndex = 0;
+			int32 Dummy[] = { 0, (CaptureArg(NewRecord, ArgIndex++, Args), 0) ... };
+			(void)Dummy;
+
+			WriteRecord(NewRecord);
+		}
+
+		// Records from oldest to newest
+		static void Dump(FOutputDevice& Output);
+
+	private:
+		//NB: Record is captured without lock and only copied to ring buffer under it, so records of several threads
+		// are never torn and dumping reads consistent copy of buffer
+		static void WriteRecord(const FRecord& NewRecord);
+
+		template<typename Type>
+		static void CaptureArg(FRecord& Record, const int32 ArgIndex, const Type& Arg)
+		{
+			if (ArgIndex >= MaxArgsNum)
+				return;
+
+			//NB: Pointer arguments (strings) may point to temporaries, so they are not kept
+			CaptureArg_Value(Record.ArgTypes[ArgIndex], Record.Args[ArgIndex], Arg);
+		}
+
+		template<typename Type>
+		static typename TEnableIf<TIsIntegral<Type>::Value || TIsEnum<Type>::Value>::Type CaptureArg_Value(EArgType& OutType, uint64& OutArg, const Type Arg)
+		{
+			OutType = TIsSigned<Type>::Value ? EArgType::Int : EArgType::UInt;
+			OutArg = static_cast<uint64>(Arg);
+		}
+
+		template<typename Type>
+		static typename TEnableIf<TIsFloatingPoint<Type>::Value>::Type CaptureArg_Value(EArgType& OutType, uint64& OutArg, const Type Arg)
+		{
+			const double DoubleArg = Arg;
+			OutType = EArgType::Float;
+			FMemory::Memcpy(&OutArg, &DoubleArg, sizeof(double));
+		}
+
+		template<typename Type>
+		static typename TEnableIf<!TIsArithmetic<Type>::Value && !TIsEnum<Type>::Value>::Type CaptureArg_Value(EArgType& OutType, uint64& OutArg, const Type& Arg)
+		{
+			OutType = EArgType::None;
+		}
+	};
+}
@@ -1,3 +1,81 @@
 #include "PrivateHacking_ChunkDownloader.h"
 
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+
 const FString DLCPackageManagerPrivate::FHackingType_ChunkDownloader::CACHED_BUILD_MANIFEST{ TEXT("CachedBuildManifest.txt") };
+const FString DLCPackageManagerPrivate::FHackingType_ChunkDownloader::LOCAL_MANIFEST{ TEXT("LocalManifest.txt") };
+
+bool DLCPackageManagerPrivate::FHackingType_ChunkDownloader::SaveLocalManifest()
+{
+	//NB: Format should match "FChunkDownloader::ParseManifest()"
+	int32 NumEntries = 0;
+	FString PakFileText;
+	for (const TPair<FString, TSharedRef<FPakFile>>& PakFile : PakFiles)
+	{
+		if (PakFile.Value->bIsEmbedded || (!PakFile.Value->bIsCached && PakFile.Value->SizeOnDisk == 0))
+			continue;
+
+		const FPakFileEntry& Entry = PakFile.Value->Entry;
+		PakFileText += FString::Printf(TEXT("%s\t%llu\t%s\t-1\t/\n"), *Entry.FileName, Entry.FileSize, *Entry.FileVersion);
+		++NumEntries;
+	}
+
+	PakFileText = FString::Printf(TEXT("$NUM_ENTRIES = %d\n"), NumEntries) + PakFileText;
+
+	if (!FFileHelper::SaveStringToFile(PakFileText, *(CacheFolder / LOCAL_MANIFEST), FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+		return false;
+
+	bNeedsManifestSave = false;
+	return true;
+}
+
+bool DLCPackageManagerPrivate::FHackingType_ChunkDownloader::LoadLocalManifest()
+{
+	for (auto It = PakFiles.CreateIterator(); It; ++It)
+	{
+		if (!It->Value->bIsEmbedded)
+			It.RemoveCurrent();
+	}
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *(CacheFolder / LOCAL_MANIFEST)))
+		return false;
+
+	//NB: Format should match "SaveLocalManifest()": properties lines start with "$", entry line is
+	// "<FileName>\t<FileSize>\t<FileVersion>\t<ChunkId>\t<RelativeUrl>"
+	IFileManager& FileManager = IFileManager::Get();
+	TArray<FString> Fields;
+	for (const FString& Line : Lines)
+	{
+		if (Line.IsEmpty() || Line.StartsWith(TEXT("$")))
+			continue;
+
+		Fields.Reset();
+		if (Line.ParseIntoArray(Fields, TEXT("\t"), false) != 5)
+			continue;
+
+		FPakFileEntry Entry;
+		Entry.FileName = Fields[0];
+		Entry.FileSize = FCString::Strtoui64(*Fields[1], nullptr, 10);
+		Entry.FileVersion = Fields[2];
+		Entry.ChunkId = FCString::Atoi(*Fields[3]);
+		Entry.RelativeUrl = Fields[4];
+
+		if (PakFiles.Contains(Entry.FileName))
+			continue;
+
+		//NB: File that is larger than its entry is not resumed, so it is not known
+		const int64 SizeOnDisk = FileManager.FileSize(*(CacheFolder / Entry.FileName));
+		if (SizeOnDisk <= 0 || static_cast<uint64>(SizeOnDisk) > Entry.FileSize)
+			continue;
+
+		const TSharedRef<FPakFile> PakFile = MakeShared<FPakFile>();
+		PakFile->Entry = MoveTemp(Entry);
+		PakFile->SizeOnDisk = static_cast<uint64>(SizeOnDisk);
+		PakFile->bIsCached = PakFile->SizeOnDisk == PakFile->Entry.FileSize;
+		PakFiles.Add(PakFile->Entry.FileName, PakFile);
+	}
+
+	return true;
+}
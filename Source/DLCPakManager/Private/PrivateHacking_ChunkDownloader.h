@@ -11,9 +11,19 @@ namespace DLCPackageManagerPrivate
 		//TODO: Add static_assert for checking Unreal version range
 
 		static const FString CACHED_BUILD_MANIFEST;
+		static const FString LOCAL_MANIFEST;
 		
 		typedef TFunction<void(bool bSuccess)> FCallback;
 
+		// Copy of private "FChunkDownloader::SaveLocalManifest()" for pak files cached bypassing ChunkDownloader.
+		// Otherwise ChunkDownloader drops them as unknown files on next initialization
+		bool SaveLocalManifest();
+
+		// Copy of loading of local manifest by private "FChunkDownloader::Initialize()" for cache folder changed after
+		// initialization. Pak files that are not embedded are replaced by pak files of manifest found in "CacheFolder".
+		// Unlike ChunkDownloader, unknown files are not deleted: folder may hold partial downloads and files of package manager
+		bool LoadLocalManifest();
+
 		struct FStats
 		{
 			// number of pak files downloaded
@@ -1,7 +1,5 @@
 #include "Version.h"
 
-#include "Misc/DefaultValueHelper.h"
-
 namespace DLCPackageManagerPrivate
 {
 	FVersion::FVersion(const int32 InMajor, const int32 InMinor, const int32 InPatch)
@@ -9,7 +7,7 @@ namespace DLCPackageManagerPrivate
 
 	const FVersion FVersion::VersionOne = FVersion{ 1, 0, 0 };
 
-	TOptional<FVersion> FVersion::FromString(const FString& Version)
+	TOptional<FVersion> FVersion::FromString(const FStringView& Version)
 	{
 		//TODO: Form an error here
 		if (Version.IsEmpty())
@@ -20,12 +18,22 @@ namespace DLCPackageManagerPrivate
 		TOptional<FVersion> Result;
 		FVersion& ResultValue = Result.Emplace();
 
-		TArray<FString> PathElements;
-		Version.ParseIntoArray(PathElements, TEXT("."));
+		int32* const Members[] = { &ResultValue.Major, &ResultValue.Minor, &ResultValue.Patch };
+		int32 MemberIndex = 0;
+
+		//NB: Empty members are skipped as "ParseIntoArray()" culls them
+		FStringView VersionRest = Version;
+		while (!VersionRest.IsEmpty() && MemberIndex < UE_ARRAY_COUNT(Members))
+		{
+			int32 SeparatorIndex = INDEX_NONE;
+			const FStringView Member = VersionRest.FindChar(TEXT('.'), SeparatorIndex) ? VersionRest.Left(SeparatorIndex) : VersionRest;
+			VersionRest = (SeparatorIndex != INDEX_NONE) ? VersionRest.RightChop(SeparatorIndex + 1) : FStringView{ };
+
+			if (Member.IsEmpty())
+				continue;
 
-		ResultValue.Major = FromString_Member(PathElements, 0).Get(0);
-		ResultValue.Minor = FromString_Member(PathElements, 1).Get(0);
-		ResultValue.Patch = FromString_Member(PathElements, 2).Get(0);
+			*Members[MemberIndex++] = FromString_Member(Member).Get(0);
+		}
 
 		return Result;
 	}
@@ -69,13 +77,54 @@ namespace DLCPackageManagerPrivate
 			(Patch == Other.Patch);
 	}
 
-	TOptional<int32> FVersion::FromString_Member(const TArray<FString>& PathElements, const int32 MemberIndex)
+	bool FVersion::CanBePackedToKey() const
+	{
+		return
+			(Major >= 0 && Major <= KeyMemberMaxValue) &&
+			(Minor >= 0 && Minor <= KeyMemberMaxValue) &&
+			(Patch >= 0 && Patch <= KeyMemberMaxValue);
+	}
+
+	FVersion::FKey FVersion::ToKey() const
+	{
+		checkf(CanBePackedToKey(), TEXT("Version %s cannot be packed to key"), *ToString());
+
+		return
+			(static_cast<FKey>(Major) << (KeyMemberBits * 2)) |
+			(static_cast<FKey>(Minor) << KeyMemberBits) |
+			static_cast<FKey>(Patch);
+	}
+
+	FVersion FVersion::FromKey(const FKey Key)
+	{
+		return FVersion{
+			static_cast<int32>((Key >> (KeyMemberBits * 2)) & KeyMemberMaxValue),
+			static_cast<int32>((Key >> KeyMemberBits) & KeyMemberMaxValue),
+			static_cast<int32>(Key & KeyMemberMaxValue) };
+	}
+
+	TOptional<int32> FVersion::FromString_Member(const FStringView& Member)
 	{
-		if (PathElements.Num() <= MemberIndex)
-			return TOptional<int32>{ };
+		const FStringView TrimmedMember = Member.TrimStartAndEnd();
+
+		int32 DigitsStartIndex = 0;
+		const bool bIsNegative = TrimmedMember.StartsWith(TEXT('-'));
+		if (bIsNegative || TrimmedMember.StartsWith(TEXT('+')))
+		{
+			DigitsStartIndex = 1;
+		}
+
+		bool bSuccess = TrimmedMember.Len() > DigitsStartIndex;
+
+		int64 Value = 0;
+		for (int32 CharIndex = DigitsStartIndex; bSuccess && CharIndex < TrimmedMember.Len(); ++CharIndex)
+		{
+			const TCHAR Char = TrimmedMember[CharIndex];
+			bSuccess = FChar::IsDigit(Char) && Value <= MAX_int32;
+			Value = Value * 10 + (Char - TEXT('0'));
+		}
 
-		int32 Value;
-		const bool bSuccess = FDefaultValueHelper::ParseInt(PathElements[MemberIndex], Value);
+		bSuccess = bSuccess && Value <= MAX_int32;
 
 		if (!bSuccess)
 		{
@@ -83,7 +132,7 @@ namespace DLCPackageManagerPrivate
 		}
 
 		return bSuccess ?
-			TOptional<int32>{ Value } :
+			TOptional<int32>{ static_cast<int32>(bIsNegative ? -Value : Value) } :
 			TOptional<int32>{ };
 	}
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Containers/StringView.h"
+
 namespace DLCPackageManagerPrivate
 {
 	class FVersion
@@ -7,7 +9,8 @@ namespace DLCPackageManagerPrivate
 	public:
 		FVersion(const int32 InMajor = 1, const int32 InMinor = 0, const int32 InPatch = 0);
 
-		static TOptional<FVersion> FromString(const FString& Version);
+		// "<Major>[.<Minor>[.<Patch>]]". Members that are not numbers are zero. No allocations are made
+		static TOptional<FVersion> FromString(const FStringView& Version);
 		static const FVersion VersionOne;
 
 		FString ToString() const;
@@ -19,8 +22,17 @@ namespace DLCPackageManagerPrivate
 		bool operator<(const FVersion& Other) const;
 		bool operator==(const FVersion& Other) const;
 
+		// Packed version representation. Order of keys is same as order of versions
+		using FKey = uint64;
+		static constexpr int32 KeyMemberBits = 20;
+		static constexpr int32 KeyMemberMaxValue = (1 << KeyMemberBits) - 1;
+
+		bool CanBePackedToKey() const;
+		FKey ToKey() const;
+		static FVersion FromKey(const FKey Key);
+
 	private:
-		static TOptional<int32> FromString_Member(const TArray<FString>& PathElements, const int32 MemberIndex);
+		static TOptional<int32> FromString_Member(const FStringView& Member);
 
 		int32 Major = 0;
 		int32 Minor = 0;
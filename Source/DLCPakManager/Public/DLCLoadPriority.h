@@ -0,0 +1,14 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Priority classes of DLC loading requests. Order is from the most urgent class
+enum class EDLCLoadPriority : uint8
+{
+	// Asset is needed right now
+	Blocking,
+	// Asset will be needed soon (for example, it is about to become visible)
+	VisibleSoon,
+	// Asset may be needed. Downloaded only when there are no other downloads
+	Prefetch
+};
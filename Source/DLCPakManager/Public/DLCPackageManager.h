@@ -1,29 +1,73 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/LruCache.h"
 #include "Misc/TVariant.h"
 #include "Engine/AssetManager.h"
+#include "DLCPackageManagerSettings.h"
+#include "DLCPackageManagerMetrics.h"
+#include "DLCLoadPriority.h"
 
 class FChunkDownloader;
 namespace DLCPackageManagerPrivate { template<typename T> class TMultiPromise; }
+namespace DLCPackageManagerPrivate { template<typename TKey, typename TValue> class TReadyFutureStates; }
 namespace DLCPackageManagerPrivate { class FHackingType_ChunkDownloader; }
-namespace DLCPackageManagerPrivate { class FVersion; }
+namespace DLCPackageManagerPrivate { class FDLCDownloadScheduler; }
+namespace DLCPackageManagerPrivate { class FDLCMountScheduler; }
+namespace DLCPackageManagerPrivate { class FDLCMountsBenchmark; }
+namespace DLCPackageManagerPrivate { class FDLCPrioritiesBenchmark; }
+namespace DLCPackageManagerPrivate { class FDLCCatalogBenchmark; }
+namespace DLCPackageManagerPrivate { class FDLCAccessHistory; }
+namespace DLCPackageManagerPrivate { class FDLCPakVerifier; }
+namespace DLCPackageManagerPrivate { class FDLCDependencyGraph; }
+namespace DLCPackageManagerPrivate { struct FDLCCacheEvictionCandidate; }
+namespace DLCPackageManagerPrivate { struct FDLCCatalogEntry; }
 
-class FDLCPackageManager
+// Downloading and mounting progress of set of DLC packages
+struct FDLCPackagesProgress
+{
+	int32 PackagesNum = 0;
+	int32 MountedPackagesNum = 0;
+
+	// Pak files of latest package versions. Pak file downloaded by resumable download is counted while it is received,
+	// pak file downloaded by ChunkDownloader is counted when it is finished
+	uint64 DownloadedBytes = 0;
+	uint64 TotalBytes = 0;
+};
+
+// Manager is owned by shared pointer of its instance. Asynchronous callbacks keep it by shared or weak pointer instead of raw "this"
+class FDLCPackageManager : public TSharedFromThis<FDLCPackageManager, ESPMode::ThreadSafe>
 {
 public:
+	static const FName DefaultInstanceName;
+
+	// Default instance. It shares global ChunkDownloader with other game code
 	static FDLCPackageManager& Get();
 
-	TFuture<UObject*> GetLoadedPath(const FSoftObjectPtr& SoftObjectPtr);
-	
+	// Instance configured by "[DLCPakManager <InstanceName>]" section of game config.
+	// Instances are independent and each of them uses its own ChunkDownloader.
+	// Instance created by other thread is initialized on the game thread, requests wait for its initialization as usual
+	static FDLCPackageManager& Get(const FName& InstanceName);
+	// Instance is created by first "Get()" call. Used to check if instance starts from scratch (see "DLC.Benchmark" console command)
+	static bool HasInstance(const FName& InstanceName);
+
+	// Loading, releasing and pinning may be requested from any thread. Calls of other threads are forwarded
+	// to the game thread, so futures of such calls are fulfilled on the game thread.
+	// Coroutines may await these futures by "DLCAwait()" (see "DLCPackageManagerCoroutines.h")
+	TFuture<UObject*> GetLoadedPath(const FSoftObjectPtr& SoftObjectPtr, const EDLCLoadPriority Priority = EDLCLoadPriority::Blocking);
+
+	// Loads all references with one download request for all needed DLC chunks and
+	// one streamable request per DLC chunk. Results are placed in order of passed references
+	TFuture<TArray<UObject*>> GetLoadedPaths(TArrayView<const FSoftObjectPtr> SoftObjectPtrs, const EDLCLoadPriority Priority = EDLCLoadPriority::Blocking);
+
 	template<typename Type>
-	TFuture<TSubclassOf<Type>> GetLoadedPath(const TSoftClassPtr<Type>& SoftObjectPtr)
+	TFuture<TSubclassOf<Type>> GetLoadedPath(const TSoftClassPtr<Type>& SoftObjectPtr, const EDLCLoadPriority Priority = EDLCLoadPriority::Blocking)
 	{
 		const auto BaseSoftObjectPtr = SoftObjectPtr.IsValid() ?
 			FSoftObjectPtr{ SoftObjectPtr.Get() } :
 			FSoftObjectPtr{ SoftObjectPtr.ToSoftObjectPath() };
 		
-		return GetLoadedPath(BaseSoftObjectPtr).Next([](UObject* LoadedObject)
+		return GetLoadedPath(BaseSoftObjectPtr, Priority).Next([](UObject* LoadedObject)
 		{
 			return LoadedObject ?
 				TSubclassOf<Type>{ CastChecked<UClass>(LoadedObject) } :
@@ -31,38 +75,165 @@ public:
 		});
 	}
 	
+	// Downloads and mounts packages without loading their objects. Result is false if some packages are unknown
+	// or are not mounted because their downloading, verification or mounting failed
+	TFuture<bool> PreloadDLCPackages(TArrayView<const FName> PackageNames, const EDLCLoadPriority Priority = EDLCLoadPriority::Blocking);
+
+	// Game thread only
+	bool IsInitialized() const;
+	// Package of object. "NAME_None" for objects that are not placed in DLC or before initialization. Game thread only
+	FName GetDLCPackageNameForPath(const FSoftObjectPath& SoftObjectPath);
+	// Unknown packages are skipped. Game thread only
+	FDLCPackagesProgress GetDLCPackagesProgress(TArrayView<const FName> PackageNames) const;
+
+	// Every loaded DLC object keeps its DLC package mounted until the object is released. Package without users
+	// is unmounted after garbage collection of its requested objects. It stays cached on disk, so next loading needs only mounting
+	void ReleaseLoadedPath(const FSoftObjectPtr& SoftObjectPtr);
+	void ReleaseLoadedPaths(TArrayView<const FSoftObjectPtr> SoftObjectPtrs);
+
+	const FDLCPackageManagerMetrics& GetMetrics() const { return Metrics; }
+
+	// Latest version of pinned package is never removed from disk cache.
+	// Packages from "PinnedPackages" setting are pinned from the start
+	void SetDLCPackagePinned(const FName& PackageName, const bool bPinned);
+	// Game thread only
+	bool IsDLCPackagePinned(const FName& PackageName) const;
+
 	~FDLCPackageManager();
 
 private:
-	void Initialize_PackagesInfo();
+	// Catalog is built from ChunkDownloader pak files. Pak file entries are parsed off the game thread
+	// if "bBuildCatalogOffGameThread" is set, so "OnBuilt" may be called later
+	void Initialize_PackagesInfo(TFunction<void()>&& OnBuilt = { });
+	void Initialize_PackagesInfo_Apply(const uint32 BuildNumber, const TArray<DLCPackageManagerPrivate::FDLCCatalogEntry>& CatalogEntries);
 
 	//NB: "TMultiPromise<>" is used with "Shared Ptr" to prevent
 	// including "TMultiPromise<>" to public dependencies of the class
 	template<typename T>
 	using TMultiPromise = DLCPackageManagerPrivate::TMultiPromise<T>;
 	
-	// DeploymentName - path for folder in CDN
-	// Example of section in "DefaultGame.ini":
-	//   [/Script/Plugins.ChunkDownloader PatchingDemoLive]
-	//   + CdnBaseUrls = 127.0.0.1/UnrealPatchingCDN
-	FDLCPackageManager(const FString& DeploymentName, const FString& ContentBuildId);
-	
+	FDLCPackageManager(const FName& InInstanceName, const FDLCPackageManagerSettings& InSettings);
+	// Starts initialization on the game thread. Called after manager is owned by shared pointer, so callbacks may capture it.
+	// Repeated calls are ignored
+	void Initialize();
+
+	using FWeakThis = TWeakPtr<FDLCPackageManager, ESPMode::ThreadSafe>;
+
+	void UpdateBuild_ForcingManifestDownload(const FString& DeploymentName, const FString& ContentBuildId);
+	void RevalidateCachedManifest();
+	void FinishInitialization();
+
 	FString GetChunkDownloaderCachedManifestFilePath() const;
+	FString GetManifestValidatorsFilePath() const;
+	FString GetCatalogSnapshotFilePath() const;
+	FString GetAccessHistoryFilePath() const;
 	
-	TFuture<void> DownloadDLCChunk(const FString& DLCChunkID);
+	// Stages of single object loading. State of request is shared by stages instead of being copied to each continuation
+	struct FLoadingRequest;
+	void GetLoadedPath_Download(const TSharedRef<FLoadingRequest>& Request);
+	void GetLoadedPath_Load(const TSharedRef<FLoadingRequest>& Request);
+	void GetLoadedPath_Finish(const TSharedRef<FLoadingRequest>& Request);
 
-	const DLCPackageManagerPrivate::FHackingType_ChunkDownloader& GetChunkDownloaderHackedAccess() const;
+	// Stages of batch loading. References are grouped by DLC package, every group is loaded when its packages are mounted
+	struct FBatchLoadingRequest;
+	void GetLoadedPaths_Download(const TSharedRef<FBatchLoadingRequest>& Request);
+	void GetLoadedPaths_LoadGroup(const TSharedRef<FBatchLoadingRequest>& Request, const TArray<int32>& PendingIndices);
+	void GetLoadedPaths_FinishGroup(const TSharedRef<FBatchLoadingRequest>& Request, const TArray<int32>& PendingIndices);
 
 	struct FDLCPackage;
-	const FDLCPackage* FindDLCPackage(const FString& PackageName) const;
-	FDLCPackage* FindDLCPackage(const FString& PackageName);
+	TArray<TFuture<void>> DownloadDLCPackages(const TArray<FDLCPackage*>& DLCPackagesToDownload, const EDLCLoadPriority Priority);
+
+	// Stages of package downloading started by "DownloadDLCPackages()". Failed downloading or verification is requested
+	// from download scheduler again. Package that still fails is not mounted: its status is reset and its promise is filled,
+	// so waiting loadings finish without it and next request starts downloading again
+	struct FDLCPackageDownload;
+	void RequestDLCPackageDownload(const TSharedRef<FDLCPackageDownload>& Download);
+	void OnDLCPackageDownloaded(const TSharedRef<FDLCPackageDownload>& Download, const bool bDownloaded);
+	void MountDLCPackage(const TSharedRef<FDLCPackageDownload>& Download);
+	void RetryOrFailDLCPackageDownload(const TSharedRef<FDLCPackageDownload>& Download);
+	void FailDLCPackageDownload(const FDLCPackageDownload& Download);
+
+	const DLCPackageManagerPrivate::FHackingType_ChunkDownloader& GetChunkDownloaderHackedAccess() const;
+	DLCPackageManagerPrivate::FHackingType_ChunkDownloader& GetChunkDownloaderHackedAccess();
+
+	const FDLCPackage* FindDLCPackage(const FName& PackageName) const;
+	FDLCPackage* FindDLCPackage(const FName& PackageName);
+	FDLCPackage* FindDLCPackage(const FStringView& PackageName);
+
+	// Returns null for paths that are not placed in DLC. Result is memoized by asset path
+	FDLCPackage* FindDLCPackageForPath(const FSoftObjectPath& SoftObjectPath);
+	// Other DLC packages hard referenced by path. Empty if dependency packages are not downloaded
+	TArray<FDLCPackage*> FindDependencyDLCPackagesForPath(const FSoftObjectPath& SoftObjectPath);
+
+	// Records requests for access history and prefetching metrics
+	void OnDLCPackagesRequested(const TArray<FDLCPackage*>& RequestedPackages, const EDLCLoadPriority Priority);
+	// Downloads packages that are likely requested after requested packages. Prefetched packages are not mounted until they are requested
+	void PrefetchSuccessors(const TArray<FDLCPackage*>& RequestedPackages, const EDLCLoadPriority Priority);
+
+	// Size of not cached pak files of latest package version
+	uint64 GetDLCPackageDownloadSize(const FDLCPackage& DLCPackage) const;
+
+	// Removes pak files of superseded versions and least recently used pak files over disk budget.
+	// Selection and file removing are done off the game thread, ChunkDownloader state is changed on the game thread
+	void RequestCacheEviction();
+	void ApplyCacheEviction(const TArray<DLCPackageManagerPrivate::FDLCCacheEvictionCandidate>& Candidates, const TArray<int32>& EvictedCandidateIndices);
+	bool CanEvictChunk(const FDLCPackage& DLCPackage, const int32 ChunkId) const;
+
+	bool IsChunkCached(const int32 ChunkId) const;
+	// Newest cached version of package that can be patched to its latest version. "INDEX_NONE" if latest version is cached
+	int32 FindDeltaBaseChunkId(const FDLCPackage& DLCPackage) const;
+
+	// Acquires package of path and its dependency packages. Acquired set is recorded, so release of the path releases exactly it
+	// even if dependencies or catalog are changed after loading. Returns package of path, null for paths that are not placed in DLC
+	FDLCPackage* AcquireDLCPackagesForPath(const FSoftObjectPath& SoftObjectPath, TArray<FDLCPackage*>& OutDependencyDLCPackages);
+	// Acquires packages of object that is already loaded. Acquisition waits for initialization, as loading does
+	void AcquireResolvedPath(const FSoftObjectPath& SoftObjectPath);
+	// Releases packages of the oldest not released acquisition of path
+	void ReleaseDLCPackagesForPath(const FSoftObjectPath& SoftObjectPath);
+	void OnPostGarbageCollect();
+	bool HasResidentRequestedObjects(const FDLCPackage& DLCPackage) const;
+	void UnmountDLCPackage(FDLCPackage& DLCPackage);
 
 	friend struct FDLCPackageManager_Private;
 	friend struct FDLCPackageManager_Debug;
+	friend struct FDLCPackageManager_Tests;
+	friend class DLCPackageManagerPrivate::FDLCMountsBenchmark;
+	friend class DLCPackageManagerPrivate::FDLCPrioritiesBenchmark;
+	friend class DLCPackageManagerPrivate::FDLCCatalogBenchmark;
 
 
+	const FName InstanceName;
+	const FDLCPackageManagerSettings Settings;
+
 	TSharedPtr<FChunkDownloader> ChunkDownloader{ };
 
+	FDLCPackageManagerMetrics Metrics;
+	TSharedPtr<DLCPackageManagerPrivate::FDLCDownloadScheduler, ESPMode::ThreadSafe> DownloadScheduler;
+	TSharedPtr<DLCPackageManagerPrivate::FDLCMountScheduler, ESPMode::ThreadSafe> MountScheduler;
+	// Null if pak files verification is disabled
+	TSharedPtr<DLCPackageManagerPrivate::FDLCPakVerifier, ESPMode::ThreadSafe> PakVerifier;
+
+	// Null if dependency packages are not downloaded
+	TUniquePtr<DLCPackageManagerPrivate::FDLCDependencyGraph> DependencyGraph;
+
+	TUniquePtr<DLCPackageManagerPrivate::FDLCAccessHistory> AccessHistory;
+	struct FDLCPrefetch
+	{
+		uint64 DownloadBytes = 0;
+		bool bIsDownloaded = false;
+	};
+	// Prefetched packages that were not requested yet
+	TMap<FName, FDLCPrefetch> Prefetches;
+
+	TSet<FName> PinnedDLCPackageNames;
+	bool bCacheEvictionInProgress = false;
+	// Eviction was requested while previous one was in progress
+	bool bCacheEvictionRequested = false;
+
+	// Packages without users that wait for garbage collection of their objects to be unmounted
+	TSet<FName> ReleasedDLCPackageNames;
+	FDelegateHandle PostGarbageCollectHandle;
+
 	struct FDLCPackage
 	{
 		struct FVersionInfo;
@@ -72,26 +243,63 @@ private:
 		struct FStatus_DownloadingAndMounting
 		{
 			TSharedPtr<TMultiPromise<void>> Promise;
+			int32 ChunkId = INDEX_NONE;
 		};
-		struct FStatus_Mounted { };
+		struct FStatus_Mounted
+		{
+			int32 ChunkId = INDEX_NONE;
+		};
+		// Package was unmounted after release. Its pak files stay cached unless they are evicted
+		struct FStatus_CachedNotMounted { };
 		using FStatus = TVariant<
 			FStatus_NotDownloaded,
 			FStatus_DownloadingAndMounting,
-			FStatus_Mounted>;
+			FStatus_Mounted,
+			FStatus_CachedNotMounted>;
 
-		FString Name;
+		FName Name;
 
 		struct FVersionInfo
 		{
-			TSharedPtr<DLCPackageManagerPrivate::FVersion> Version;
+			// Packed "DLCPackageManagerPrivate::FVersion" (see "FVersion::ToKey()")
+			uint64 VersionKey;
 			int32 ChunkId;
 		};
 		TArray<FVersionInfo> VersionInfos;
 
+		// Resolved during catalog building
+		int32 LatestVersionInfoIndex = INDEX_NONE;
+
 		FStatus Status;
+
+		// Number of not released requests of package objects
+		int32 UsersNum = 0;
+		// Asset paths of objects requested from package since its mounting
+		TSet<FName> RequestedAssetPaths;
 	};
 
 	//NB: Shared ptr is used for possiblity to pass FDLCPackage by reference
-	TArray<TSharedPtr<FDLCPackage>> DLCPackages;
+	TMap<FName, TSharedPtr<FDLCPackage>> DLCPackages;
+
+	// Packages acquired by loadings of path. Acquisitions keep packages alive if they are removed from catalog
+	struct FDLCPackagesAcquisition
+	{
+		TArray<TSharedPtr<FDLCPackage>> Packages;
+		// Successive loadings that acquired same packages share one acquisition, so repeated loadings cost no allocations
+		int32 LoadingsNum = 1;
+	};
+	// Not released acquisitions by asset path in order of loading
+	TMap<FName, TArray<FDLCPackagesAcquisition>> PathsAcquisitions;
+
+	//NB: Cache should be reset on every rebuilding of "DLCPackages". Least recently resolved path is dropped on overflow
+	static constexpr int32 ResolvedPathsCacheCapacity = 4096;
+	TLruCache<FName, FDLCPackage*> ResolvedPathsCache{ ResolvedPathsCacheCapacity };
+	// Futures of already resolved objects by asset path. Dropped after garbage collection
+	TUniquePtr<DLCPackageManagerPrivate::TReadyFutureStates<FName, UObject*>> ResolvedObjectsFutureStates;
 	TSharedPtr<TMultiPromise<void>> PackageManagerInitializationPromise;
+	// Catalog builds may finish out of order if they are made off the game thread
+	uint32 LastCatalogBuildNumber = 0;
+	uint32 AppliedCatalogBuildNumber = 0;
+	double InitializationStartTime = 0.0;
+	bool bIsInitializationStarted = false;
 };
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "UObject/SoftObjectPtr.h"
+#include "DLCPackageManagerAsyncActions.generated.h"
+
+UENUM(BlueprintType)
+enum class EDLCLoadingStage : uint8
+{
+	// Package manager is initializing its catalog
+	Initialization,
+	Downloading,
+	Mounting,
+	// Objects are loaded from mounted packages
+	Loading,
+	Finished
+};
+
+USTRUCT(BlueprintType)
+struct DLCPAKMANAGER_API FDLCLoadingProgress
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "DLC")
+	EDLCLoadingStage Stage = EDLCLoadingStage::Initialization;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DLC")
+	int64 DownloadedBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DLC")
+	int64 TotalBytes = 0;
+
+	// Downloaded part of pak files in [0, 100] range
+	UPROPERTY(BlueprintReadOnly, Category = "DLC")
+	float Percent = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DLC")
+	int32 MountedPackagesNum = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DLC")
+	int32 PackagesNum = 0;
+
+	bool operator==(const FDLCLoadingProgress& Other) const;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDLCLoadingProgressDelegate, const FDLCLoadingProgress&, Progress);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDLCObjectsLoadedDelegate, const TArray<UObject*>&, Objects);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDLCClassesLoadedDelegate, const TArray<UClass*>&, Classes);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDLCPackagesPreloadedDelegate, bool, bAllPackagesFound);
+
+// Reports progress of DLC packages of action every frame while progress changes.
+// Packages of requested objects are resolved after package manager initialization
+UCLASS(Abstract)
+class DLCPAKMANAGER_API UDLCLoadingAsyncActionBase : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintAssignable)
+	FDLCLoadingProgressDelegate OnProgress;
+
+	void Activate() override;
+
+protected:
+	virtual void StartLoading() { }
+	// Stops progress reporting, reports final progress and allows action to be destroyed
+	void FinishLoading();
+
+	// Loading stage is reported when all packages are mounted. Preloading finishes without it
+	bool bHasLoadingStage = true;
+
+	TArray<FSoftObjectPath> SoftObjectPaths;
+	TArray<FName> PackageNames;
+
+private:
+	bool Tick(float DeltaTime);
+	FDLCLoadingProgress ComputeProgress();
+
+	bool bArePackageNamesResolved = false;
+	FDLCLoadingProgress LastProgress;
+	FDelegateHandle TickerHandle;
+};
+
+// - - -
+
+UCLASS()
+class DLCPAKMANAGER_API UDLCLoadObjectsAsyncAction : public UDLCLoadingAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	// Loads all objects with one request, so their packages are downloaded in parallel. Not loaded objects are null
+	UFUNCTION(BlueprintCallable, Category = "Utilities", Meta = (BlueprintInternalUseOnly = "true", WorldContext = "WCO"))
+	static UDLCLoadObjectsAsyncAction* LoadDLCObjects(const UObject* WCO, const TArray<TSoftObjectPtr<UObject>>& SoftObjects);
+
+	UPROPERTY(BlueprintAssignable)
+	FDLCObjectsLoadedDelegate OnCompleted;
+
+protected:
+	void StartLoading() override;
+};
+
+// - - -
+
+UCLASS()
+class DLCPAKMANAGER_API UDLCLoadClassesAsyncAction : public UDLCLoadingAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	// Loads all classes with one request, so their packages are downloaded in parallel. Not loaded classes are null
+	UFUNCTION(BlueprintCallable, Category = "Utilities", Meta = (BlueprintInternalUseOnly = "true", WorldContext = "WCO"))
+	static UDLCLoadClassesAsyncAction* LoadDLCClasses(const UObject* WCO, const TArray<TSoftClassPtr<UObject>>& SoftClasses);
+
+	UPROPERTY(BlueprintAssignable)
+	FDLCClassesLoadedDelegate OnCompleted;
+
+protected:
+	void StartLoading() override;
+};
+
+// - - -
+
+UCLASS()
+class DLCPAKMANAGER_API UDLCPreloadPackagesAsyncAction : public UDLCLoadingAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	// Downloads and mounts packages by their names, so later loading of their objects needs no downloading
+	UFUNCTION(BlueprintCallable, Category = "Utilities", Meta = (BlueprintInternalUseOnly = "true", WorldContext = "WCO"))
+	static UDLCPreloadPackagesAsyncAction* PreloadDLCPackages(const UObject* WCO, const TArray<FName>& Packages);
+
+	UPROPERTY(BlueprintAssignable)
+	FDLCPackagesPreloadedDelegate OnCompleted;
+
+protected:
+	void StartLoading() override;
+};
@@ -25,5 +25,16 @@ public:
 		)
 	)
 	static void LoadDLCAssetPtr(const UObject* WCO, TSoftClassPtr<UObject> SoftPtr, TSubclassOf<UObject>& HardPtr, FLatentActionInfo LatentInfo);
+
+	// Allows DLC package of loaded asset to be unmounted when it has no other users
+	UFUNCTION(BlueprintCallable, Category = "Utilities")
+	static void ReleaseDLCAssetPtr(TSoftClassPtr<UObject> SoftPtr);
+
+	// Release of objects and classes loaded by "LoadDLCObjects" and "LoadDLCClasses" async actions
+	UFUNCTION(BlueprintCallable, Category = "Utilities")
+	static void ReleaseDLCObjectPtrs(const TArray<TSoftObjectPtr<UObject>>& SoftPtrs);
+
+	UFUNCTION(BlueprintCallable, Category = "Utilities")
+	static void ReleaseDLCClassPtrs(const TArray<TSoftClassPtr<UObject>>& SoftPtrs);
 };
 
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Async.h"
+#include "Async/Future.h"
+
+// Awaitable API of package manager for C++20 coroutines. It is compiled only by toolchains with coroutine support:
+// UE4 builds modules with C++14 by default, see "bWithDLCCoroutines" of "DLCPakManager.Build.cs" for this module.
+// Example:
+//   FDLCTask LoadWeapon(TSoftClassPtr<AActor> WeaponClassPtr)
+//   {
+//       TSubclassOf<AActor> WeaponClass = co_await DLCAwait(FDLCPackageManager::Get().GetLoadedPath(WeaponClassPtr));
+//       ...
+//   }
+// Coroutine is resumed on the thread passed to "DLCAwait()", game thread by default. Future that is fulfilled on the game
+// thread resumes coroutine that waits for game thread at once, without task
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define WITH_DLC_COROUTINES 1
+#endif
+#endif
+
+#ifndef WITH_DLC_COROUTINES
+#define WITH_DLC_COROUTINES 0
+#endif
+
+#if WITH_DLC_COROUTINES
+
+#include <coroutine>
+
+namespace DLCPackageManagerPrivate
+{
+	inline bool CanResumeAtOnce(const ENamedThreads::Type ResumeThread)
+	{
+		return ResumeThread == ENamedThreads::GameThread && IsInGameThread();
+	}
+
+	inline void ResumeOnThread(const std::coroutine_handle<> Handle, const ENamedThreads::Type ResumeThread)
+	{
+		if (CanResumeAtOnce(ResumeThread))
+		{
+			Handle.resume();
+			return;
+		}
+
+		AsyncTask(ResumeThread, [Handle]() { Handle.resume(); });
+	}
+}
+
+template<typename ResultType>
+class TDLCAwaitable
+{
+public:
+	TDLCAwaitable(TFuture<ResultType>&& InFuture, const ENamedThreads::Type InResumeThread)
+		: Future(MoveTemp(InFuture)), ResumeThread(InResumeThread) { }
+
+	bool await_ready() const
+	{
+		return Future.IsReady() && DLCPackageManagerPrivate::CanResumeAtOnce(ResumeThread);
+	}
+
+	void await_suspend(const std::coroutine_handle<> Handle)
+	{
+		//NB: Continuation of ready future is called inside "Then()" and may resume and destroy coroutine frame with this
+		// awaitable, so future is moved out of it first. Awaitable lives in the frame until resuming otherwise
+		TFuture<ResultType> WaitedFuture = MoveTemp(Future);
+		WaitedFuture.Then([this, Handle](TFuture<ResultType> ReadyFuture)
+		{
+			Result.Emplace(ReadyFuture.Get());
+			DLCPackageManagerPrivate::ResumeOnThread(Handle, ResumeThread);
+		});
+	}
+
+	ResultType await_resume()
+	{
+		return Result.IsSet() ? MoveTemp(Result.GetValue()) : Future.Get();
+	}
+
+private:
+	TFuture<ResultType> Future;
+	const ENamedThreads::Type ResumeThread;
+
+	// Set by continuation of suspended coroutine
+	TOptional<ResultType> Result;
+};
+
+template<>
+class TDLCAwaitable<void>
+{
+public:
+	TDLCAwaitable(TFuture<void>&& InFuture, const ENamedThreads::Type InResumeThread)
+		: Future(MoveTemp(InFuture)), ResumeThread(InResumeThread) { }
+
+	bool await_ready() const
+	{
+		return Future.IsReady() && DLCPackageManagerPrivate::CanResumeAtOnce(ResumeThread);
+	}
+
+	void await_suspend(const std::coroutine_handle<> Handle)
+	{
+		//NB: Same as for futures with result: frame may be destroyed inside "Then()"
+		TFuture<void> WaitedFuture = MoveTemp(Future);
+		WaitedFuture.Then([ResumeThread = ResumeThread, Handle](TFuture<void>)
+		{
+			DLCPackageManagerPrivate::ResumeOnThread(Handle, ResumeThread);
+		});
+	}
+
+	void await_resume() { }
+
+private:
+	TFuture<void> Future;
+	const ENamedThreads::Type ResumeThread;
+};
+
+template<typename ResultType>
+TDLCAwaitable<ResultType> DLCAwait(TFuture<ResultType>&& Future, const ENamedThreads::Type ResumeThread = ENamedThreads::GameThread)
+{
+	return TDLCAwaitable<ResultType>{ MoveTemp(Future), ResumeThread };
+}
+
+// Return type of fire-and-forget coroutines that await DLC loading. Coroutine frame is freed when its body is finished
+struct FDLCTask
+{
+	struct promise_type
+	{
+		FDLCTask get_return_object() const noexcept { return { }; }
+		std::suspend_never initial_suspend() const noexcept { return { }; }
+		std::suspend_never final_suspend() const noexcept { return { }; }
+		void return_void() const noexcept { }
+		void unhandled_exception() const noexcept { check(false); }
+	};
+};
+
+#endif
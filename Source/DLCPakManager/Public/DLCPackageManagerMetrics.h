@@ -0,0 +1,187 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Bounded set of latest samples with percentile queries
+class FDLCLatencyHistogram
+{
+public:
+	static constexpr int32 MaxSamplesNum = 1024;
+
+	void AddSample(const double Value);
+
+	// Percentile in [0, 100] range. Returns 0 if there are no samples
+	double GetPercentile(const double Percentile) const;
+
+	int32 GetSamplesNum() const;
+	int64 GetTotalSamplesNum() const;
+	double GetMax() const;
+
+private:
+	TArray<double> Samples;
+	int32 NextSampleIndex = 0;
+	int64 TotalSamplesNum = 0;
+	double Max = 0.0;
+};
+
+// Timings and throughput of DLC pipeline of single package manager. All times are in seconds
+class FDLCPackageManagerMetrics
+{
+public:
+	// Timestamps of single "GetLoadedPath()" / "GetLoadedPaths()" request. Unset stages are zero
+	struct FRequestRecord
+	{
+		FName DLCPackageName;
+		int32 ObjectsNum = 1;
+
+		double StartTime = 0.0;
+		double InitializationWaitEndTime = 0.0;
+		double DLCChunkReadyTime = 0.0;
+		double LoadEndTime = 0.0;
+
+		bool bSucceeded = false;
+	};
+
+	// Timestamps of downloading and mounting of single chunk
+	struct FChunkRecord
+	{
+		int32 ChunkId = INDEX_NONE;
+		FName DLCPackageName;
+
+		double DownloadStartTime = 0.0;
+		double DownloadEndTime = 0.0;
+		double MountEndTime = 0.0;
+
+		uint64 DownloadedBytes = 0;
+		int32 DownloadedFilesNum = 0;
+		int32 LastHttpStatus = 0;
+
+		bool bMounted = false;
+	};
+
+	// - - - Recording - - -
+
+	void OnRequestFinished(const FRequestRecord& Record);
+
+	void OnChunkRequested(const int32 ChunkId, const FName& DLCPackageName);
+	void OnPakFileDownloaded(const int32 ChunkId, const FString& FileName, const uint64 SizeBytes, const double FileDownloadSeconds, const int32 HttpStatus);
+	void OnChunkMounted(const int32 ChunkId, const bool bSuccess);
+
+	void OnPrefetchIssued();
+	// Prefetch downloading is finished before package was requested
+	void OnPrefetchDownloaded(const uint64 PackageBytes);
+	// On-demand request of package that was prefetched. Bytes are zero if prefetch downloading was not finished
+	void OnPrefetchHit(const uint64 DownloadedPackageBytes);
+	// On-demand request of package that was not downloaded and was not prefetched
+	void OnPrefetchMiss();
+
+	void OnPakFileEvicted(const uint64 SizeBytes);
+
+	// Pak file without published block hashes is verified with zero hashed bytes
+	void OnPakFileVerified(const FString& FileName, const uint64 HashedBytes, const double HashingSeconds, const int32 InCorruptedBlocksNum, const bool bVerified);
+
+	// Failed patching with received patch is counted too: its bytes are downloaded anyway
+	void OnDeltaPatchApplied(const int64 TargetBytes, const int64 PatchBytes, const double ReconstructionSeconds, const bool bSuccess);
+
+	// - - - Queries - - -
+
+	const FDLCLatencyHistogram& GetInitializationWaitHistogram() const { return InitializationWaitHistogram; }
+	const FDLCLatencyHistogram& GetDLCChunkWaitHistogram() const { return DLCChunkWaitHistogram; }
+	const FDLCLatencyHistogram& GetLoadHistogram() const { return LoadHistogram; }
+	const FDLCLatencyHistogram& GetRequestHistogram() const { return RequestHistogram; }
+	const FDLCLatencyHistogram& GetPakDownloadHistogram() const { return PakDownloadHistogram; }
+	const FDLCLatencyHistogram& GetChunkDownloadHistogram() const { return ChunkDownloadHistogram; }
+	const FDLCLatencyHistogram& GetChunkMountHistogram() const { return ChunkMountHistogram; }
+	const FDLCLatencyHistogram& GetPakVerificationHistogram() const { return PakVerificationHistogram; }
+	const FDLCLatencyHistogram& GetDeltaReconstructionHistogram() const { return DeltaReconstructionHistogram; }
+
+	uint64 GetDownloadedBytes() const { return DownloadedBytes; }
+	int64 GetDownloadedFilesNum() const { return DownloadedFilesNum; }
+	int64 GetFailedDownloadsNum() const { return FailedDownloadsNum; }
+	int64 GetFailedRequestsNum() const { return FailedRequestsNum; }
+
+	// Bytes per second of HTTP transfers (time when no download is active is not counted)
+	double GetDownloadThroughput() const;
+
+	int64 GetPrefetchIssuedNum() const { return PrefetchIssuedNum; }
+	int64 GetPrefetchHitsNum() const { return PrefetchHitsNum; }
+	int64 GetPrefetchMissesNum() const { return PrefetchMissesNum; }
+
+	// Part of on-demand requests of not downloaded packages that were served by prefetching
+	double GetPrefetchHitRate() const;
+
+	// Bytes downloaded by prefetching for packages that were not requested (yet). Queued prefetches are not counted
+	uint64 GetPrefetchWastedBytes() const { return PrefetchDownloadedBytes - PrefetchHitBytes; }
+
+	// Pak files removed from disk cache
+	int64 GetEvictedPakFilesNum() const { return EvictedPakFilesNum; }
+	uint64 GetEvictedBytes() const { return EvictedBytes; }
+
+	uint64 GetVerifiedBytes() const { return VerifiedBytes; }
+	int64 GetCorruptedBlocksNum() const { return CorruptedBlocksNum; }
+	int64 GetFailedVerificationsNum() const { return FailedVerificationsNum; }
+
+	// Bytes per second of pak files hashing
+	double GetVerificationThroughput() const;
+
+	int64 GetDeltaPatchedFilesNum() const { return DeltaPatchedFilesNum; }
+	int64 GetFailedDeltaPatchesNum() const { return FailedDeltaPatchesNum; }
+	uint64 GetDeltaPatchBytes() const { return DeltaPatchBytes; }
+	// Difference of full pak files size and size of their patches
+	int64 GetDeltaSavedBytes() const { return DeltaSavedBytes; }
+
+	const TArray<FRequestRecord>& GetRecentRequests() const { return RecentRequests; }
+	const TMap<int32, FChunkRecord>& GetChunks() const { return Chunks; }
+
+	// - - - Dumping - - -
+
+	FString ToJson() const;
+	// Table of histograms ("Histogram,Count,P50,P95,P99,Max") and table of counters ("Counter,Value") separated by empty line
+	FString ToCsv() const;
+
+	// Format is selected by extension: ".json" or ".csv"
+	bool DumpToFile(const FString& FilePath) const;
+
+private:
+	static constexpr int32 MaxRecentRequestsNum = 256;
+
+	FDLCLatencyHistogram InitializationWaitHistogram;
+	FDLCLatencyHistogram DLCChunkWaitHistogram;
+	FDLCLatencyHistogram LoadHistogram;
+	FDLCLatencyHistogram RequestHistogram;
+	FDLCLatencyHistogram PakDownloadHistogram;
+	FDLCLatencyHistogram ChunkDownloadHistogram;
+	FDLCLatencyHistogram ChunkMountHistogram;
+	FDLCLatencyHistogram PakVerificationHistogram;
+	FDLCLatencyHistogram DeltaReconstructionHistogram;
+
+	uint64 DownloadedBytes = 0;
+	double DownloadSeconds = 0.0;
+	int64 DownloadedFilesNum = 0;
+	int64 FailedDownloadsNum = 0;
+	int64 FailedRequestsNum = 0;
+
+	int64 PrefetchIssuedNum = 0;
+	int64 PrefetchHitsNum = 0;
+	int64 PrefetchMissesNum = 0;
+	uint64 PrefetchDownloadedBytes = 0;
+	uint64 PrefetchHitBytes = 0;
+
+	int64 EvictedPakFilesNum = 0;
+	uint64 EvictedBytes = 0;
+
+	uint64 VerifiedBytes = 0;
+	double VerificationSeconds = 0.0;
+	int64 CorruptedBlocksNum = 0;
+	int64 FailedVerificationsNum = 0;
+
+	int64 DeltaPatchedFilesNum = 0;
+	int64 FailedDeltaPatchesNum = 0;
+	uint64 DeltaPatchBytes = 0;
+	int64 DeltaSavedBytes = 0;
+
+	TArray<FRequestRecord> RecentRequests;
+	int32 NextRecentRequestIndex = 0;
+
+	TMap<int32, FChunkRecord> Chunks;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EDLCManifestStartupMode : uint8
+{
+	// Initialization waits for full manifest downloading on every start
+	ForceManifestDownload,
+	// Catalog is built from cached manifest right away. Manifest is revalidated in background
+	StaleWhileRevalidate
+};
+
+// Settings of single package manager instance.
+// Example of section in "DefaultGame.ini" for instance "Default":
+//   [DLCPakManager Default]
+//   DeploymentName = PatchingDemoLive
+//   ContentBuildId = PatchingDemoKey
+//   PlatformName = Windows
+//   MaxConcurrentDownloads = 8
+//   MaxConcurrentMounts = 2
+//   MountFrameBudgetMilliseconds = 2.0
+//   CacheFolder = 
+//   StartupMode = StaleWhileRevalidate
+//   bEnablePrefetch = True
+//   MaxPrefetchPredictions = 2
+//   MinPrefetchProbability = 0.3
+//   DiskBudgetMegabytes = 2048
+//   +PinnedPackages = CoreContent
+//   bEnableResumableDownloads = True
+//   ResumableDownloadMinMegabytes = 64
+//   MaxResumableDownloadConnections = 4
+//   bVerifyPakFiles = True
+//   bEnableDeltaPatches = True
+//   bBuildCatalogOffGameThread = False
+//   bEnableCatalogSnapshot = True
+//   bDownloadDependencyPackages = True
+struct FDLCPackageManagerSettings
+{
+	// DeploymentName - path for folder in CDN
+	// Example of section in "DefaultGame.ini":
+	//   [/Script/Plugins.ChunkDownloader PatchingDemoLive]
+	//   + CdnBaseUrls = 127.0.0.1/UnrealPatchingCDN
+	FString DeploymentName = TEXT("PatchingDemoLive");
+	FString ContentBuildId = TEXT("PatchingDemoKey");
+
+	// Determines the manifest. Empty value means platform of running build
+	FString PlatformName;
+
+	int32 MaxConcurrentDownloads = 8;
+
+	// Downloaded chunks are mounted on worker threads, at most "MaxConcurrentMounts" at once ("Blocking" chunks are started first).
+	// Callbacks of finished mounts are called within per-frame time budget, but at least one mount is finished every frame
+	int32 MaxConcurrentMounts = 2;
+	float MountFrameBudgetMilliseconds = 2.0f;
+
+	// Folder for downloaded pak files. Empty value means ChunkDownloader default folder for default instance
+	// and "GetDefaultCacheFolder()" for other instances
+	FString CacheFolder;
+
+	EDLCManifestStartupMode StartupMode = EDLCManifestStartupMode::StaleWhileRevalidate;
+
+	// Packages that were requested after requested package in previous sessions are prefetched while there are no other downloads
+	bool bEnablePrefetch = true;
+	int32 MaxPrefetchPredictions = 2;
+	float MinPrefetchProbability = 0.3f;
+
+	// Limit of downloaded pak files size. Least recently used pak files are removed from disk to fit it.
+	// Zero means no limit, but pak files of superseded package versions are removed anyway
+	int32 DiskBudgetMegabytes = 0;
+
+	// Latest versions of pinned packages are never removed from disk
+	TArray<FString> PinnedPackages;
+
+	// Pak files of at least "ResumableDownloadMinMegabytes" size are downloaded by segments that are kept on disk,
+	// so interrupted downloading continues from the last downloaded segment
+	bool bEnableResumableDownloads = true;
+	int32 ResumableDownloadMinMegabytes = 64;
+	// Range requests of segments of single pak file that are in flight at once
+	int32 MaxResumableDownloadConnections = 4;
+
+	// Pak files are checked against block hashes published on CDN before mounting. Corrupted blocks are downloaded again
+	bool bVerifyPakFiles = true;
+
+	// New package version is rebuilt from cached previous version by delta patch from CDN if there is one.
+	// Newest cached version is kept on disk as patching base until the latest version is downloaded
+	bool bEnableDeltaPatches = true;
+
+	// Pak file entries of manifest are parsed on worker thread. Useful for manifests with many thousands of pak files
+	bool bBuildCatalogOffGameThread = false;
+
+	// Parsed catalog is saved as binary snapshot next to cached manifest and is loaded instead of parsing while manifest is not changed
+	bool bEnableCatalogSnapshot = true;
+
+	// DLC packages hard referenced by requested asset (found by asset registry dependencies) are downloaded and mounted
+	// in parallel with package of the asset before its loading, and are kept while the asset is in use
+	bool bDownloadDependencyPackages = true;
+
+	// Settings that are not set in config keep default values
+	static FDLCPackageManagerSettings LoadFromConfig(const FName& InstanceName, const FString& ConfigFileName = GGameIni);
+
+	static FString GetConfigSectionName(const FName& InstanceName);
+
+	// Subfolder of ChunkDownloader default folder named by instance
+	static FString GetDefaultCacheFolder(const FName& InstanceName);
+};